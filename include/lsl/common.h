@@ -80,6 +80,9 @@ typedef enum {
 	/** 64 bit integers. Support for this type is not yet exposed in all languages.
 	 * Also, some builds of liblsl will not be able to send or receive data of this type. */
 	cft_int64 = 7,
+	/** Numeric channels with individual formats (e.g., int16 EEG, float32 IMU and int32
+	 * counters) packed into one record, see lsl_create_record_streaminfo(). */
+	cft_record = 8,
 	/// Can not be transmitted.
 	cft_undefined = 0,
 
@@ -161,10 +164,68 @@ typedef enum {
 	/// The supplied max_buf should be scaled by 0.001.
 	transp_bufsize_thousandths = 2,
 
+	/// Inlets only: max_buflen is an upper bound; the buffer (and the outlet's buffer for this
+	/// inlet) grows and shrinks with the amount of data that's actually waiting to be pulled.
+	transp_adaptive_buffer = 4,
+
 	// prevent compilers from assuming an instance fits in a single byte
 	_lsl_transport_options_maxval = 0x7f000000
 } lsl_transport_options_t;
 
+/**
+ * Runtime statistics of an outlet, see lsl_outlet_get_stats().
+ *
+ * All counters are cumulative since the outlet was created; the session and queue fields
+ * describe the current state.
+ */
+typedef struct {
+	/// Number of samples pushed into the outlet.
+	int64_t samples_pushed;
+	/// Number of payload bytes pushed into the outlet (without time stamps).
+	int64_t bytes_pushed;
+	/// Number of samples sent, summed over all consumer sessions.
+	int64_t samples_sent;
+	/// Number of bytes written to the consumers' sockets, summed over all sessions.
+	int64_t bytes_sent;
+	/// Number of chunks (i.e., socket writes) sent, summed over all sessions.
+	int64_t chunks_written;
+	/// Number of samples dropped because a consumer's buffer was full, summed over all sessions.
+	int64_t samples_dropped;
+	/// Number of currently connected consumers.
+	int32_t num_sessions;
+	/// Number of samples waiting to be sent in the most backlogged session.
+	int32_t max_queue_depth;
+	/// Average time for a chunk write to complete, in seconds.
+	double avg_write_latency;
+	/// Maximum time for a chunk write to complete, in seconds.
+	double max_write_latency;
+} lsl_outlet_stats;
+
+/**
+ * Runtime statistics of an inlet, see lsl_inlet_get_stats().
+ *
+ * All counters are cumulative since the inlet was created.
+ */
+typedef struct {
+	/// Number of samples received and decoded by the inlet.
+	int64_t samples_received;
+	/// Number of samples dropped because the inlet's buffer was full.
+	int64_t samples_dropped;
+	/// Number of samples currently waiting to be pulled.
+	int32_t queue_depth;
+	/// Number of times the data connection was re-established after the first connection.
+	int32_t reconnects;
+	/// Duration of the most recent connection handshake, in seconds (0 if not yet connected).
+	double handshake_time;
+	/// The most recent time correction estimate, in seconds (0 if none is available yet).
+	double time_correction;
+	/// Uncertainty (round-trip time) of the most recent time correction estimate, in seconds
+	/// (-1 if none is available yet).
+	double time_correction_uncertainty;
+	/// Number of samples the inlet can buffer (only changes with transp_adaptive_buffer).
+	int32_t queue_capacity;
+} lsl_inlet_stats;
+
 /// Return an explanation for the last error
 extern LIBLSL_C_API const char *lsl_last_error(void);
 
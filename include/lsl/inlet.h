@@ -269,6 +269,31 @@ extern LIBLSL_C_API unsigned long lsl_pull_chunk_str(lsl_inlet in, char **data_b
 
 extern LIBLSL_C_API unsigned long lsl_pull_chunk_buf(lsl_inlet in, char **data_buffer, uint32_t *lengths_buffer, double *timestamp_buffer, unsigned long data_buffer_elements, unsigned long timestamp_buffer_elements, double timeout, int32_t *ec);
 
+/**
+ * Pull a chunk of samples into a buffer with a custom layout, e.g. an array of records that hold
+ * other fields besides the channel values.
+ *
+ * The values are converted and scattered directly into the buffer. Only the channel values are
+ * written, all other bytes are left untouched.
+ * @param in The lsl_inlet object to act on.
+ * @param[out] data The start of the first sample in the buffer.
+ * @param data_format The numeric type of the values in the buffer (e.g., cft_float32).
+ * @param max_samples The number of samples the buffer can hold.
+ * @param sample_stride The distance between the starts of two consecutive samples in bytes.
+ * @param channel_stride The distance between two consecutive channel values in bytes, or 0 if
+ * they're packed.
+ * @param channel_offsets Optionally an array with each channel's byte offset from the start of a
+ * sample. If given, channel_stride is ignored.
+ * @param[out] timestamp_buffer Optionally a buffer for max_samples time stamps.
+ * @param timeout The timeout for this operation, see lsl_pull_chunk_f().
+ * @param[out] ec Error code: can be either no error, #lsl_argument_error or #lsl_lost_error.
+ * @return The number of samples (not channel values) written to the buffer.
+ */
+extern LIBLSL_C_API unsigned long lsl_pull_chunk_strided(lsl_inlet in, void *data,
+	lsl_channel_format_t data_format, unsigned long max_samples, int32_t sample_stride,
+	int32_t channel_stride, const int32_t *channel_offsets, double *timestamp_buffer,
+	double timeout, int32_t *ec);
+
 /**
 * Query whether samples are currently available for immediate pickup.
 *
@@ -306,4 +331,59 @@ extern LIBLSL_C_API uint32_t lsl_was_clock_reset(lsl_inlet in);
  */
 extern LIBLSL_C_API int32_t lsl_smoothing_halftime(lsl_inlet in, float value);
 
+/**
+ * Only receive the samples that match a filter expression.
+ *
+ * The outlet evaluates the filter before sending samples, so non-matching samples cost neither
+ * bandwidth nor wakeups of the inlet (outlets of older liblsl versions send all samples and the
+ * inlet drops the non-matching ones).
+ *
+ * A filter consists of alternatives separated by `|`, each made up of comparisons separated by `&`
+ * that all have to match. A comparison is an optional channel index (`chN`, default `ch0`), an
+ * operator and a value, e.g. `ch0 == 'Stim' | ch0 ^= 'Resp_'` or `ch2 > 0.5 & ch2 <= 1`.
+ * Numeric streams support `==`, `!=`, `<`, `<=`, `>` and `>=`, string streams `==`, `!=` and `^=`
+ * (prefix match). String values can be enclosed in single or double quotes.
+ *
+ * The filter applies to connections established afterwards, so set it before opening the stream.
+ * @param in The lsl_inlet object to act on.
+ * @param filter The filter expression, or NULL or an empty string to receive all samples.
+ * @return The error code: if nonzero, can be #lsl_argument_error if the filter is invalid.
+ */
+extern LIBLSL_C_API int32_t lsl_set_sample_filter(lsl_inlet in, const char *filter);
+
+/**
+ * Save the time correction and time stamp smoothing state of an inlet.
+ *
+ * Both take a while to converge (up to the smoothing half-time, see lsl_smoothing_halftime()), so
+ * applications that are restarted (e.g., recorders) can save the state before destroying the inlet
+ * and resume with converged estimates with lsl_inlet_import_state().
+ * @param in The lsl_inlet object to act on.
+ * @param[out] ec Error code: if nonzero, can be #lsl_internal_error.
+ * @return An XML string that has to be freed with lsl_destroy_string() (or NULL on error).
+ */
+extern LIBLSL_C_API char *lsl_inlet_export_state(lsl_inlet in, int32_t *ec);
+
+/**
+ * Resume with a state saved by lsl_inlet_export_state().
+ *
+ * The state is keyed by the stream's UID and the boot ids of the source and the local host, so it's
+ * ignored if it belongs to another stream or the clock of either host was reset by a restart.
+ * Call this after lsl_set_postprocessing() and before pulling samples.
+ * @param in The lsl_inlet object to act on.
+ * @param state The saved state.
+ * @param[out] ec Error code: if nonzero, can be #lsl_argument_error if the state can't be parsed.
+ * @return 1 if the state was applied, 0 if it was ignored.
+ */
+extern LIBLSL_C_API int32_t lsl_inlet_import_state(lsl_inlet in, const char *state, int32_t *ec);
+
+/**
+ * Retrieve runtime statistics of an inlet.
+ *
+ * This does not block and doesn't trigger a time correction estimate.
+ * @param in The inlet to query.
+ * @param stats Pointer to a struct that will receive the statistics.
+ * @return An error code (lsl_no_error on success).
+ */
+extern LIBLSL_C_API int32_t lsl_inlet_get_stats(lsl_inlet in, lsl_inlet_stats *stats);
+
 /// @}
@@ -227,6 +227,34 @@ extern LIBLSL_C_API int32_t lsl_push_chunk_buftn(lsl_outlet out, const char **da
  * precedence over the pushthrough flag. */
 extern LIBLSL_C_API int32_t lsl_push_chunk_buftnp(lsl_outlet out, const char **data, const uint32_t *lengths, unsigned long data_elements, const double *timestamps, int32_t pushthrough);
 
+/**
+ * Push a chunk of samples whose channel values are spread over a buffer with a custom layout.
+ *
+ * Device SDKs often deliver records that hold status words or padding besides the channel values.
+ * This gathers the values (with type conversions) directly from such records, so they don't need
+ * to be copied into a packed buffer first.
+ * @param out The lsl_outlet object through which to push the data.
+ * @param data The start of the first sample in the buffer.
+ * @param data_format The numeric type of the values in the buffer (e.g., cft_float32); this
+ * doesn't have to match the stream's channel format.
+ * @param num_samples The number of samples to push.
+ * @param sample_stride The distance between the starts of two consecutive samples in bytes.
+ * @param channel_stride The distance between two consecutive channel values in bytes, or 0 if
+ * they're packed.
+ * @param channel_offsets Optionally an array with each channel's byte offset from the start of a
+ * sample. If given, channel_stride is ignored.
+ * @param timestamp Optionally the capture time of the most recent sample, in agreement with
+ * lsl_local_clock(); if omitted, the current time is used.
+ * The time stamps of other samples are automatically derived based on the sampling rate of the
+ * stream.
+ * @param pushthrough Whether to push the chunk through to the receivers instead of buffering it
+ * with subsequent samples.
+ * @return Error code of the operation or lsl_no_error if successful.
+ */
+extern LIBLSL_C_API int32_t lsl_push_chunk_strided(lsl_outlet out, const void *data,
+	lsl_channel_format_t data_format, unsigned long num_samples, int32_t sample_stride,
+	int32_t channel_stride, const int32_t *channel_offsets, double timestamp, int32_t pushthrough);
+
 /**
 * Check whether consumers are currently registered.
 * While it does not hurt, there is technically no reason to push samples if there is no consumer.
@@ -249,4 +277,15 @@ extern LIBLSL_C_API int32_t lsl_wait_for_consumers(lsl_outlet out, double timeou
  */
 extern LIBLSL_C_API lsl_streaminfo lsl_get_info(lsl_outlet out);
 
+/**
+ * Retrieve runtime statistics of an outlet.
+ *
+ * The counters are maintained with very little overhead and can be polled frequently, e.g. to
+ * alert on backlogs or data loss.
+ * @param out The outlet to query.
+ * @param stats Pointer to a struct that will receive the statistics.
+ * @return An error code (lsl_no_error on success).
+ */
+extern LIBLSL_C_API int32_t lsl_outlet_get_stats(lsl_outlet out, lsl_outlet_stats *stats);
+
 ///@}
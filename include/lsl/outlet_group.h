@@ -0,0 +1,49 @@
+#pragma once
+#include "common.h"
+#include "types.h"
+
+/// @file outlet_group.h Outlet group functions
+
+/** @defgroup lsl_outlet_group The lsl_outlet_group object
+ *
+ * An outlet group pushes one frame, i.e. one sample into each of several outlets, in a single
+ * call. This is meant for devices that acquire several modalities at once (e.g. EEG, accelerometer
+ * and triggers), which are pushed into separate outlets.
+ *
+ * All samples of a frame get the same time stamp, read from the clock only once. Each outlet's
+ * samples are published with a single lock of its buffer, and its senders are only woken up once
+ * per batch: frames that aren't pushed through are kept back (up to 64 per outlet) and published
+ * together with the next frame that is.
+ * @{
+ */
+
+/**
+ * Create a group of outlets.
+ * @param outlets An array of outlets. They have to outlive the group.
+ * @param num_outlets The number of outlets in the array.
+ * @return A new outlet group or NULL if an outlet is NULL or given twice (see lsl_last_error()).
+ */
+extern LIBLSL_C_API lsl_outlet_group lsl_create_outlet_group(
+	const lsl_outlet *outlets, int32_t num_outlets);
+
+/// Publish the samples that were kept back and destroy the group (but not its outlets).
+extern LIBLSL_C_API void lsl_destroy_outlet_group(lsl_outlet_group group);
+
+/**
+ * Push one sample into each outlet of the group.
+ * @param group The outlet group.
+ * @param buffers One pointer per outlet, in the order the outlets were given, to the sample's
+ * values in the outlet's channel format (for string streams, an array of `const char *`), or NULL
+ * to skip an outlet in this frame.
+ * @param timestamp The capture time of all samples, or 0.0 to use the current time.
+ * @param pushthrough Whether to push the samples through to the receivers instead of buffering them
+ * with subsequent samples.
+ * @return Error code of the operation (usually attributable to the wrong data type).
+ */
+extern LIBLSL_C_API int32_t lsl_outlet_group_push(lsl_outlet_group group,
+	const void *const *buffers, double timestamp, int32_t pushthrough);
+
+/// Publish the samples that were kept back and push them through. @return Error code.
+extern LIBLSL_C_API int32_t lsl_outlet_group_flush(lsl_outlet_group group);
+
+/// @}
@@ -0,0 +1,54 @@
+#pragma once
+#include "common.h"
+#include "types.h"
+
+/// @file recorder.h Recording functions
+
+/** @defgroup lsl_recorder The lsl_recorder object
+ *
+ * A recorder writes the samples of inlets and of outlets in this process to XDF files without
+ * passing them through the application.
+ *
+ * Each stream is captured by its own thread that collects the samples into chunks, and a single
+ * writer thread writes them to disk with large buffered writes. Clock offsets of inlets are
+ * recorded every few seconds. The recording can be split into several files of a maximum size,
+ * each of them a complete XDF file whose stream footers include a time index of the stream's
+ * sample chunks.
+ * @{
+ */
+
+/**
+ * Create a recorder and its (first) file.
+ * @param filename The name of the XDF file to write. If the recording is split, the further files
+ * get a numbered suffix before the extension, e.g. `rec_1.xdf`, `rec_2.xdf`, ...
+ * @param max_file_mb Start a new file once the current file exceeds this size in MiB (0: write a
+ * single file).
+ * @return A new recorder or NULL if the file couldn't be created (see lsl_last_error()).
+ */
+extern LIBLSL_C_API lsl_recorder lsl_create_recorder(const char *filename, int32_t max_file_mb);
+
+/// Stop recording, write all remaining data and close the file.
+extern LIBLSL_C_API void lsl_destroy_recorder(lsl_recorder rec);
+
+/**
+ * Record all samples received by an inlet.
+ *
+ * The recorder opens the inlet's stream and consumes its samples, so they can't be pulled by the
+ * application as well. The inlet has to be destroyed after the recorder.
+ * @return An error code (lsl_no_error on success).
+ */
+extern LIBLSL_C_API int32_t lsl_recorder_add_inlet(lsl_recorder rec, lsl_inlet in);
+
+/**
+ * Record all samples pushed into an outlet of this process from now on.
+ *
+ * The samples are taken from the outlet's send buffer, so they're recorded even if no inlet is
+ * connected. The outlet may be destroyed before the recorder.
+ * @return An error code (lsl_no_error on success).
+ */
+extern LIBLSL_C_API int32_t lsl_recorder_add_outlet(lsl_recorder rec, lsl_outlet out);
+
+/// The number of bytes the recorder has written to its files so far.
+extern LIBLSL_C_API int64_t lsl_recorder_bytes_written(lsl_recorder rec);
+
+/// @}
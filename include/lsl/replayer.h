@@ -0,0 +1,55 @@
+#pragma once
+#include "common.h"
+#include "types.h"
+
+/// @file replayer.h Replay functions
+
+/** @defgroup lsl_replayer The lsl_replayer object
+ *
+ * A replayer pushes the recorded streams of an XDF file (e.g. written by an lsl_recorder) through
+ * outlets with their original timing, e.g. to reproduce a real workload for load tests and
+ * benchmarks.
+ *
+ * The file is memory-mapped and every stream gets an outlet as soon as the replayer is created,
+ * so inlets can connect before the replay is started. A single background thread pushes the
+ * samples of all streams when they're due. Time stamps are corrected with the recorded clock
+ * offsets, so streams recorded from different hosts stay aligned.
+ * @{
+ */
+
+/**
+ * Open a recording and create an outlet for each of its streams.
+ * @param filename The name of the XDF file to replay.
+ * @param speed The replay speed relative to the recording, e.g. 2 to replay twice as fast.
+ * @param original_timestamps If nonzero, push the recorded time stamps, mapped to the recording
+ * host's clock with the recorded clock offsets. Otherwise, the time stamps are shifted (and scaled
+ * with the speed) to the time of the replay.
+ * @return A new replayer or NULL if the file couldn't be read (see lsl_last_error()).
+ */
+extern LIBLSL_C_API lsl_replayer lsl_create_replayer(
+	const char *filename, double speed, int32_t original_timestamps);
+
+/// Stop the replay and destroy its outlets.
+extern LIBLSL_C_API void lsl_destroy_replayer(lsl_replayer rep);
+
+/// The number of streams (and outlets) of the replayer.
+extern LIBLSL_C_API int32_t lsl_replayer_num_streams(lsl_replayer rep);
+
+/**
+ * Get the stream info of a replayed stream's outlet.
+ * @return A copy of the stream info (to be destroyed with lsl_destroy_streaminfo()) or NULL if
+ * there's no such stream.
+ */
+extern LIBLSL_C_API lsl_streaminfo lsl_replayer_get_info(lsl_replayer rep, int32_t stream);
+
+/// Start pushing the samples. Has no effect if the replay was already started.
+extern LIBLSL_C_API void lsl_replayer_start(lsl_replayer rep);
+
+/**
+ * Wait until all samples have been pushed.
+ * @param timeout The maximum time to wait in seconds.
+ * @return 1 if the replay has finished, 0 if the timeout expired first.
+ */
+extern LIBLSL_C_API int32_t lsl_replayer_wait(lsl_replayer rep, double timeout);
+
+/// @}
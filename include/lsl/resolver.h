@@ -153,4 +153,32 @@ extern LIBLSL_C_API int32_t lsl_resolve_byprop(lsl_streaminfo *buffer, uint32_t
  */
 extern LIBLSL_C_API int32_t lsl_resolve_bypred(lsl_streaminfo *buffer, uint32_t buffer_elements, const char *pred, int32_t minimum, double timeout);
 
+/**
+ * Resolve the streams that match any of several predicates at once.
+ *
+ * This has the same effect as calling lsl_resolve_bypred() for each predicate, but all queries
+ * are sent in the same discovery waves, so resolving the streams for many predicates takes about
+ * as long as resolving a single one.
+ * The call returns the results of all predicates together, once every predicate has at least
+ * `minimum` results or the timeout has expired, so predicates that are found early wait for the
+ * others.
+ * @param[out] buffer A user-allocated buffer to hold the resolve results, i.e. the results for the
+ * first predicate followed by the results for the second predicate and so on.
+ * A stream that matches several predicates is returned once for each of them.
+ * @attention The same ownership rules as for lsl_resolve_bypred() apply.
+ * @param buffer_elements The user-provided buffer length.
+ * @param[out] counts A user-allocated array of `num_preds` elements that receives the number of
+ * results in the buffer for each predicate.
+ * @param preds An array of `num_preds` predicate strings (see lsl_resolve_bypred()).
+ * @param num_preds The number of predicates.
+ * @param minimum Return at least this number of streams for each predicate.
+ * @param timeout Optionally a timeout of the operation, in seconds (default: no timeout).
+ *                If the timeout expires, less than the desired number of streams (possibly none)
+ * will be returned for some predicates.
+ * @return The total number of results written into the buffer (never more than the provided # of
+ * slots) or a negative number if an error has occurred (values corresponding to lsl_error_code_t).
+ */
+extern LIBLSL_C_API int32_t lsl_resolve_bypreds(lsl_streaminfo *buffer, uint32_t buffer_elements,
+	int32_t *counts, const char **preds, uint32_t num_preds, int32_t minimum, double timeout);
+
 /// @}
@@ -36,6 +36,25 @@
  */
 extern LIBLSL_C_API lsl_streaminfo lsl_create_streaminfo(const char *name, const char *type, int32_t channel_count, double nominal_srate, lsl_channel_format_t channel_format, const char *source_id);
 
+/**
+ * Construct a new streaminfo object for a record stream whose channels have individual formats.
+ *
+ * The channel format of the stream is #cft_record. Each sample is a packed record of the channels
+ * in their own formats, i.e. a channel starts right after the previous one without any padding
+ * (see lsl_get_channel_offset()). Such a record can be pushed and pulled as is with the untyped
+ * functions (e.g. lsl_push_sample_v()), and the typed functions convert each channel individually.
+ * @param name Name of the stream (see lsl_create_streaminfo()).
+ * @param type Content type of the stream.
+ * @param channel_count Number of channels per sample.
+ * @param nominal_srate The sampling rate (in Hz) or #LSL_IRREGULAR_RATE.
+ * @param channel_formats The numeric format of each of the channel_count channels.
+ * @param source_id Unique identifier of the source or device, if available.
+ * @return A newly created streaminfo handle or NULL in the event that an error occurred.
+ */
+extern LIBLSL_C_API lsl_streaminfo lsl_create_record_streaminfo(const char *name,
+	const char *type, int32_t channel_count, double nominal_srate,
+	const lsl_channel_format_t *channel_formats, const char *source_id);
+
 /// Destroy a previously created streaminfo object.
 extern LIBLSL_C_API void lsl_destroy_streaminfo(lsl_streaminfo info);
 
@@ -88,11 +107,19 @@ extern LIBLSL_C_API double lsl_get_nominal_srate(lsl_streaminfo info);
 
 /**
  * Channel format of the stream.
- * All channels in a stream have the same format.
+ * All channels in a stream have the same format, unless it's #cft_record.
  * However, a device might offer multiple time-synched streams  each with its own format.
  */
 extern LIBLSL_C_API lsl_channel_format_t lsl_get_channel_format(lsl_streaminfo info);
 
+/**
+ * Format of a single channel.
+ * For record streams, this is the channel's own format, otherwise the stream's channel format.
+ * @return The channel format or #cft_undefined if there's no such channel.
+ */
+extern LIBLSL_C_API lsl_channel_format_t lsl_get_channel_format_at(
+	lsl_streaminfo info, int32_t channel);
+
 /**
  * Unique identifier of the stream's source, if available.
  *
@@ -177,6 +204,12 @@ extern LIBLSL_C_API int32_t lsl_get_channel_bytes(lsl_streaminfo info);
 /// Number of bytes occupied by a sample (0 for string-typed channels).
 extern LIBLSL_C_API int32_t lsl_get_sample_bytes(lsl_streaminfo info);
 
+/**
+ * Byte offset of a channel within a sample.
+ * @return The offset or -1 if there's no such channel or the channels are strings.
+ */
+extern LIBLSL_C_API int32_t lsl_get_channel_offset(lsl_streaminfo info, int32_t channel);
+
 /**
  * Tries to match the stream info XML element @p info against an
  * <a href="https://en.wikipedia.org/wiki/XPath#Syntax_and_semantics_(XPath_1.0)">XPath</a> query.
@@ -0,0 +1,40 @@
+#pragma once
+#include "common.h"
+
+/// @file trace.h Pipeline tracing functions
+
+/** @defgroup trace Pipeline tracing
+ *
+ * Opt-in tracing of the path samples take through outlets and inlets in this process.
+ *
+ * When enabled, each involved thread records timestamped stage events (push, send buffer fan-out,
+ * queue wait, serialization, socket write, receive/decode, pull) for a subset of the samples into
+ * its own ring buffer. The events can then be exported in the Chrome trace event format that can
+ * be viewed with `chrome://tracing` or https://ui.perfetto.dev.
+ *
+ * Tracing is disabled by default and has next to no overhead in that case.
+ * @{
+ */
+
+/**
+ * Enable or disable tracing.
+ * @param sample_every Trace every n-th sample (approximately, the samples are chosen based on
+ * their time stamps), e.g. 1 to trace all samples or 100 to trace 1% of the samples. 0 disables
+ * tracing. Already recorded events are kept.
+ */
+extern LIBLSL_C_API void lsl_trace_enable(int32_t sample_every);
+
+/// Discard all recorded trace events.
+extern LIBLSL_C_API void lsl_trace_clear(void);
+
+/**
+ * Write all recorded trace events to a file in the Chrome trace event (JSON) format.
+ *
+ * Each thread keeps only its most recent few thousand events.
+ * @param filename The name of the file to write; an existing file is overwritten.
+ * @return An error code (lsl_no_error on success, lsl_internal_error if the file couldn't be
+ * written).
+ */
+extern LIBLSL_C_API int32_t lsl_trace_dump(const char *filename);
+
+/// @}
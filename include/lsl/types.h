@@ -57,4 +57,25 @@ typedef struct lsl_xml_ptr_struct_ *lsl_xml_ptr;
  */
 typedef struct lsl_continuous_resolver_ *lsl_continuous_resolver;
 
+/**
+ * @class lsl_outlet_group
+ * An outlet group handle.
+ * Outlet groups push one sample into each of several outlets with a shared time stamp.
+ */
+typedef struct lsl_outlet_group_struct_ *lsl_outlet_group;
+
+/**
+ * @class lsl_recorder
+ * A recorder handle.
+ * Recorders write the samples of inlets and outlets to XDF files.
+ */
+typedef struct lsl_recorder_struct_ *lsl_recorder;
+
+/**
+ * @class lsl_replayer
+ * A replayer handle.
+ * Replayers push the streams of XDF files through outlets with their original timing.
+ */
+typedef struct lsl_replayer_struct_ *lsl_replayer;
+
 #endif // LSL_TYPES
@@ -24,8 +24,12 @@ extern "C" {
 #include "lsl/common.h"
 #include "lsl/inlet.h"
 #include "lsl/outlet.h"
+#include "lsl/outlet_group.h"
+#include "lsl/recorder.h"
+#include "lsl/replayer.h"
 #include "lsl/resolver.h"
 #include "lsl/streaminfo.h"
+#include "lsl/trace.h"
 #include "lsl/types.h"
 #include "lsl/xml.h"
 
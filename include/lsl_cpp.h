@@ -77,10 +77,21 @@ enum channel_format_t {
 	/// languages. Also, some builds of liblsl will not be able to send or receive data of this
 	/// type.
 	cf_int64 = 7,
+	/// Numeric channels with individual formats packed into one record (see the stream_info
+	/// constructor that takes a format per channel).
+	cf_record = 8,
 	/// Can not be transmitted.
 	cf_undefined = 0
 };
 
+/// The channel format of a numeric type, e.g. `channel_format_of(static_cast<float *>(nullptr))`
+inline channel_format_t channel_format_of(const float *) { return cf_float32; }
+inline channel_format_t channel_format_of(const double *) { return cf_double64; }
+inline channel_format_t channel_format_of(const char *) { return cf_int8; }
+inline channel_format_t channel_format_of(const int16_t *) { return cf_int16; }
+inline channel_format_t channel_format_of(const int32_t *) { return cf_int32; }
+inline channel_format_t channel_format_of(const int64_t *) { return cf_int64; }
+
 /// Post-processing options for stream inlets.
 enum processing_options_t {
 	/// No automatic post-processing; return the ground-truth time stamps for manual post-processing
@@ -103,6 +114,12 @@ enum processing_options_t {
 	post_ALL = 1 | 2 | 4 | 8
 };
 
+/// Runtime statistics of an outlet, see stream_outlet::get_stats() and ::lsl_outlet_stats.
+using outlet_stats = lsl_outlet_stats;
+
+/// Runtime statistics of an inlet, see stream_inlet::get_stats() and ::lsl_inlet_stats.
+using inlet_stats = lsl_inlet_stats;
+
 /**
  * Protocol version.
  *
@@ -185,6 +202,33 @@ public:
 		if (obj == nullptr) throw std::invalid_argument(lsl_last_error());
 	}
 
+	/**
+	 * Construct a new stream_info object for a record stream whose channels have individual
+	 * formats.
+	 *
+	 * Each sample is a packed record (i.e., without padding) of the channels in their own formats,
+	 * see channel_offset(). It can be pushed and pulled as is with push_numeric_raw() and
+	 * pull_numeric_raw(), and the typed push/pull functions convert each channel individually.
+	 * @param name Name of the stream.
+	 * @param type Content type of the stream.
+	 * @param channel_formats The numeric format of each channel.
+	 * @param nominal_srate The sampling rate (in Hz) or IRREGULAR_RATE.
+	 * @param source_id Unique identifier of the device or source of the data, if available.
+	 */
+	stream_info(const std::string &name, const std::string &type,
+		const std::vector<channel_format_t> &channel_formats,
+		double nominal_srate = IRREGULAR_RATE, const std::string &source_id = std::string())
+		: obj(nullptr, &lsl_destroy_streaminfo) {
+		std::vector<lsl_channel_format_t> formats(channel_formats.size());
+		for (std::size_t k = 0; k < formats.size(); k++)
+			formats[k] = static_cast<lsl_channel_format_t>(channel_formats[k]);
+		obj.reset(lsl_create_record_streaminfo(name.c_str(), type.c_str(),
+					  static_cast<int32_t>(formats.size()), nominal_srate, formats.data(),
+					  source_id.c_str()),
+			&lsl_destroy_streaminfo);
+		if (obj == nullptr) throw std::invalid_argument(lsl_last_error());
+	}
+
 	/// Default contructor.
 	stream_info(): stream_info("untitled", "", 0, 0, cf_undefined, ""){}
 
@@ -247,13 +291,18 @@ public:
 	/**
 	 * Channel format of the stream.
 	 *
-	 * All channels in a stream have the same format. However, a device might offer multiple
-	 * time-synched streams each with its own format.
+	 * All channels in a stream have the same format, unless it's cf_record. However, a device
+	 * might offer multiple time-synched streams each with its own format.
 	 */
 	channel_format_t channel_format() const {
 		return static_cast<channel_format_t>(lsl_get_channel_format(obj.get()));
 	}
 
+	/// Format of a single channel, which differs between the channels of a record stream.
+	channel_format_t channel_format(int32_t channel) const {
+		return static_cast<channel_format_t>(lsl_get_channel_format_at(obj.get(), channel));
+	}
+
 	/**
 	 * Unique identifier of the stream's source, if available.
 	 *
@@ -356,6 +405,11 @@ public:
 	/// Number of bytes occupied by a sample (0 for string-typed channels).
 	int32_t sample_bytes() const { return lsl_get_sample_bytes(obj.get()); }
 
+	/// Byte offset of a channel within a sample (-1 for string-typed channels).
+	int32_t channel_offset(int32_t channel) const {
+		return lsl_get_channel_offset(obj.get(), channel);
+	}
+
 	/// Get the implementation handle.
 	std::shared_ptr<lsl_streaminfo_struct_> handle() const { return obj; }
 
@@ -599,6 +653,52 @@ public:
 		if (!samples.empty()) push_numeric_struct(samples.back(), timestamps.back(), pushthrough);
 	}
 
+	/** Push a chunk of samples whose channel values are spread over a buffer, e.g. an array of
+	 * device records that also hold status words or padding.
+	 *
+	 * The values are gathered and converted without an intermediate packed copy, e.g.
+	 * `outlet.push_chunk_strided(&records[0].channels[0], records.size(), sizeof(record));`
+	 * @param first The first channel value of the first sample.
+	 * @param num_samples The number of samples to push.
+	 * @param sample_stride The distance between the starts of two samples in bytes.
+	 * @param channel_stride The distance between two consecutive channel values in bytes.
+	 * @param timestamp Optionally the capture time of the most recent sample, in agreement with
+	 * local_clock(); if omitted, the current time is used. The time stamps of other samples are
+	 * automatically derived according to the sampling rate of the stream.
+	 * @param pushthrough Whether to push the chunk through to the receivers instead of buffering it
+	 * with subsequent samples.
+	 */
+	template <class T>
+	void push_chunk_strided(const T *first, std::size_t num_samples, std::size_t sample_stride,
+		std::size_t channel_stride = sizeof(T), double timestamp = 0.0, bool pushthrough = true) {
+		check_error(lsl_push_chunk_strided(obj.get(), first,
+			static_cast<lsl_channel_format_t>(channel_format_of(first)),
+			static_cast<unsigned long>(num_samples), static_cast<int32_t>(sample_stride),
+			static_cast<int32_t>(channel_stride), nullptr, timestamp, pushthrough));
+	}
+
+	/** Push a chunk of samples whose channel values (of type T) are at the given byte offsets of
+	 * each sample, e.g. `outlet.push_chunk_strided<float>(records.data(), n, sizeof(record),
+	 * {offsetof(record, x), offsetof(record, y)});`
+	 * @param data The start of the first sample.
+	 * @param num_samples The number of samples to push.
+	 * @param sample_stride The distance between the starts of two samples in bytes.
+	 * @param channel_offsets The byte offset of each channel from the start of a sample.
+	 * @param timestamp Optionally the capture time of the most recent sample.
+	 * @param pushthrough Whether to push the chunk through to the receivers.
+	 */
+	template <class T>
+	void push_chunk_strided(const void *data, std::size_t num_samples, std::size_t sample_stride,
+		const std::vector<int32_t> &channel_offsets, double timestamp = 0.0,
+		bool pushthrough = true) {
+		if (channel_offsets.size() != static_cast<std::size_t>(channel_count))
+			throw std::invalid_argument("There must be one offset per channel.");
+		check_error(lsl_push_chunk_strided(obj.get(), data,
+			static_cast<lsl_channel_format_t>(channel_format_of(static_cast<const T *>(nullptr))),
+			static_cast<unsigned long>(num_samples), static_cast<int32_t>(sample_stride), 0,
+			channel_offsets.data(), timestamp, pushthrough));
+	}
+
 	/** Push a chunk of multiplexed data into the outlet.
 	 * @name Push functions
 	 * @param buffer A buffer of channel values holding the data for zero or more successive samples
@@ -767,6 +867,13 @@ public:
 	 */
 	stream_info info() const { return stream_info(lsl_get_info(obj.get())); }
 
+	/// Retrieve the outlet's runtime statistics (samples sent, queue depths, drops, latency).
+	outlet_stats get_stats() const {
+		outlet_stats stats;
+		check_error(lsl_outlet_get_stats(obj.get(), &stats));
+		return stats;
+	}
+
 	/// Return a shared pointer to pass to C-API functions that aren't wrapped yet
 	///
 	/// Example: @code lsl_push_chunk_buft(outlet.handle().get(), data, …); @endcode
@@ -869,6 +976,34 @@ inline std::vector<stream_info> resolve_stream(
 	return std::vector<stream_info>(&buffer[0], &buffer[nres]);
 }
 
+/** Resolve the streams that match any of several predicates at once.
+ *
+ * This has the same effect as calling resolve_stream(pred) for each predicate, but all queries are
+ * sent in the same discovery waves, so e.g. a recorder can resolve all of its streams within
+ * a single resolve interval. The results of all predicates are returned together, once every
+ * predicate has at least `minimum` results or the timeout has expired.
+ * @param preds The predicate strings (see resolve_stream(pred)).
+ * @param minimum Return at least this number of streams for each predicate.
+ * @param timeout Optionally a timeout of the operation, in seconds (default: no timeout).
+ * @return A vector of matching stream info objects for each predicate.
+ */
+inline std::vector<std::vector<stream_info>> resolve_streams(
+	const std::vector<std::string> &preds, int32_t minimum = 1, double timeout = FOREVER) {
+	std::vector<const char *> cpreds;
+	for (const auto &pred : preds) cpreds.push_back(pred.c_str());
+	std::vector<lsl_streaminfo> buffer(1024 + preds.size());
+	std::vector<int32_t> counts(preds.size());
+	check_error(lsl_resolve_bypreds(buffer.data(), static_cast<uint32_t>(buffer.size()),
+		counts.data(), cpreds.data(), static_cast<uint32_t>(cpreds.size()), minimum, timeout));
+	std::vector<std::vector<stream_info>> result;
+	auto *next = buffer.data();
+	for (int32_t count : counts) {
+		result.emplace_back(next, next + count);
+		next += count;
+	}
+	return result;
+}
+
 
 // ======================
 // ==== Stream Inlet ====
@@ -1429,6 +1564,60 @@ public:
 		return result;
 	}
 
+	/**
+	 * Pull a chunk of samples into a buffer with a custom layout, e.g. an array of records that
+	 * hold other fields besides the channel values.
+	 *
+	 * Only the channel values are written; all other bytes of the buffer are left untouched.
+	 * @param first The first channel value of the first sample.
+	 * @param max_samples The number of samples the buffer can hold.
+	 * @param sample_stride The distance between the starts of two samples in bytes.
+	 * @param channel_stride The distance between two consecutive channel values in bytes.
+	 * @param timestamps Optionally a buffer for max_samples time stamps.
+	 * @param timeout The timeout for this operation; the default of 0.0 only retrieves samples
+	 * available for immediate pickup.
+	 * @return The number of samples written to the buffer.
+	 * @throws lost_error (if the stream source has been lost)
+	 */
+	template <class T>
+	std::size_t pull_chunk_strided(T *first, std::size_t max_samples, std::size_t sample_stride,
+		std::size_t channel_stride = sizeof(T), double *timestamps = nullptr,
+		double timeout = 0.0) {
+		int32_t ec = 0;
+		std::size_t res = lsl_pull_chunk_strided(obj.get(), first,
+			static_cast<lsl_channel_format_t>(channel_format_of(first)),
+			static_cast<unsigned long>(max_samples), static_cast<int32_t>(sample_stride),
+			static_cast<int32_t>(channel_stride), nullptr, timestamps, timeout, &ec);
+		check_error(ec);
+		return res;
+	}
+
+	/**
+	 * Pull a chunk of samples whose channel values (of type T) go to the given byte offsets of
+	 * each sample in the buffer.
+	 * @param data The start of the first sample.
+	 * @param max_samples The number of samples the buffer can hold.
+	 * @param sample_stride The distance between the starts of two samples in bytes.
+	 * @param channel_offsets The byte offset of each channel from the start of a sample.
+	 * @param timestamps Optionally a buffer for max_samples time stamps.
+	 * @param timeout The timeout for this operation.
+	 * @return The number of samples written to the buffer.
+	 */
+	template <class T>
+	std::size_t pull_chunk_strided(void *data, std::size_t max_samples, std::size_t sample_stride,
+		const std::vector<int32_t> &channel_offsets, double *timestamps = nullptr,
+		double timeout = 0.0) {
+		if (channel_offsets.size() != static_cast<std::size_t>(channel_count))
+			throw std::invalid_argument("There must be one offset per channel.");
+		int32_t ec = 0;
+		std::size_t res = lsl_pull_chunk_strided(obj.get(), data,
+			static_cast<lsl_channel_format_t>(channel_format_of(static_cast<T *>(nullptr))),
+			static_cast<unsigned long>(max_samples), static_cast<int32_t>(sample_stride), 0,
+			channel_offsets.data(), timestamps, timeout, &ec);
+		check_error(ec);
+		return res;
+	}
+
 	/**
 	 * Query whether samples are currently available for immediate pickup.
 	 *
@@ -1462,6 +1651,51 @@ public:
 	 */
 	void smoothing_halftime(float value) { check_error(lsl_smoothing_halftime(obj.get(), value)); }
 
+	/** Only receive the samples that match a filter expression, e.g. `ch0 ^= 'Stim'`.
+	 *
+	 * The outlet drops non-matching samples before sending them; see lsl_set_sample_filter()
+	 * for the syntax. Set the filter before opening the stream.
+	 * @param filter The filter expression or an empty string to receive all samples.
+	 * @throws std::invalid_argument if the filter is invalid for this stream.
+	 */
+	void set_sample_filter(const std::string &filter) {
+		check_error(lsl_set_sample_filter(obj.get(), filter.c_str()));
+	}
+
+	/** Save the time correction and smoothing state, e.g. before the application exits.
+	 *
+	 * See lsl_inlet_export_state() for details.
+	 * @return The state as XML string, to be passed to import_state() of a later inlet.
+	 */
+	std::string export_state() {
+		int32_t ec = 0;
+		char *state = lsl_inlet_export_state(obj.get(), &ec);
+		check_error(ec);
+		std::string result(state);
+		lsl_destroy_string(state);
+		return result;
+	}
+
+	/** Resume with a state saved by export_state() to get converged estimates right away.
+	 *
+	 * Call this after set_postprocessing() and before pulling samples.
+	 * @return False if the state belongs to another stream or either host was restarted.
+	 * @throws std::invalid_argument if the state can't be parsed.
+	 */
+	bool import_state(const std::string &state) {
+		int32_t ec = 0;
+		bool result = lsl_inlet_import_state(obj.get(), state.c_str(), &ec) != 0;
+		check_error(ec);
+		return result;
+	}
+
+	/// Retrieve the inlet's runtime statistics (samples received, drops, reconnects, time sync).
+	inlet_stats get_stats() const {
+		inlet_stats stats;
+		check_error(lsl_inlet_get_stats(obj.get(), &stats));
+		return stats;
+	}
+
 	int get_channel_count() const { return channel_count; }
 
 private:
@@ -1681,6 +1915,173 @@ private:
 };
 
 
+// =======================
+// ==== Outlet Groups ====
+// =======================
+
+/**
+ * Pushes one sample into each of several outlets (e.g. the EEG, accelerometer and trigger streams
+ * of one device) with a shared time stamp.
+ *
+ * This is cheaper than pushing into each outlet separately: the clock is read once per frame and
+ * each outlet's samples are published at once, waking up its senders only once per batch.
+ */
+class outlet_group {
+public:
+	/**
+	 * Create a group of outlets. The outlets are kept alive until the group is destroyed.
+	 * @throws std::invalid_argument if an outlet is given twice.
+	 */
+	explicit outlet_group(const std::vector<stream_outlet *> &outlets)
+		: obj(nullptr, &lsl_destroy_outlet_group) {
+		std::vector<lsl_outlet> handles;
+		for (stream_outlet *out : outlets) {
+			members.push_back(out->handle());
+			handles.push_back(members.back().get());
+		}
+		obj.reset(lsl_create_outlet_group(handles.data(), static_cast<int32_t>(handles.size())));
+		if (!obj) throw std::invalid_argument(lsl_last_error());
+	}
+
+	/**
+	 * Push one sample into each outlet.
+	 * @param buffers One pointer per outlet to the sample's values in the outlet's channel format
+	 * (for string streams, an array of `const char *`), or nullptr to skip an outlet.
+	 * @param timestamp The capture time of all samples; if omitted, the current time is used.
+	 * @param pushthrough Whether to push the samples through to the receivers. If not, they may be
+	 * kept back and published with the next frame that is pushed through.
+	 */
+	void push(const std::vector<const void *> &buffers, double timestamp = 0.0,
+		bool pushthrough = true) {
+		if (buffers.size() != members.size())
+			throw std::invalid_argument("The number of buffers doesn't match the group size.");
+		check_error(lsl_outlet_group_push(obj.get(), buffers.data(), timestamp, pushthrough));
+	}
+
+	/// Publish the samples that were kept back and push them through.
+	void flush() { check_error(lsl_outlet_group_flush(obj.get())); }
+
+	outlet_group(outlet_group &&rhs) noexcept = default;
+	outlet_group &operator=(outlet_group &&rhs) noexcept {
+		// destroy the old group before its outlets
+		obj = std::move(rhs.obj);
+		members = std::move(rhs.members);
+		return *this;
+	}
+
+private:
+	/// the outlets, destroyed after the group
+	std::vector<std::shared_ptr<lsl_outlet_struct_>> members;
+	std::unique_ptr<lsl_outlet_group_struct_, void (*)(lsl_outlet_group_struct_ *)> obj;
+};
+
+
+// ==================
+// ==== Recorder ====
+// ==================
+
+/**
+ * Records the samples of inlets and of outlets in this process to XDF files.
+ *
+ * Each stream is captured in its own thread and a single writer thread writes the data to disk, so
+ * the samples don't have to be pulled into the application. Clock offsets of inlets are recorded
+ * every few seconds. The recording can be split into several files of a maximum size, each of them
+ * a complete XDF file whose stream footers include a time index of the stream's sample chunks.
+ */
+class recorder {
+public:
+	/**
+	 * Create a recorder and its (first) file.
+	 * @param filename The name of the XDF file to write. If the recording is split, the further
+	 * files get a numbered suffix before the extension, e.g. `rec_1.xdf`, `rec_2.xdf`, ...
+	 * @param max_file_mb Start a new file once the current file exceeds this size in MiB (0: write
+	 * a single file).
+	 * @throws std::runtime_error if the file can't be created.
+	 */
+	recorder(const std::string &filename, int32_t max_file_mb = 0)
+		: obj(lsl_create_recorder(filename.c_str(), max_file_mb), &lsl_destroy_recorder) {
+		if (!obj) throw std::runtime_error(lsl_last_error());
+	}
+
+	/**
+	 * Record all samples received by an inlet.
+	 *
+	 * The recorder consumes the inlet's samples, so they can't be pulled by the application as
+	 * well. The inlet is kept alive until the recorder is destroyed.
+	 */
+	void add_inlet(stream_inlet &in) {
+		check_error(lsl_recorder_add_inlet(obj.get(), in.handle().get()));
+		sources.push_back(in.handle());
+	}
+
+	/// Record all samples pushed into an outlet of this process from now on.
+	void add_outlet(stream_outlet &out) {
+		check_error(lsl_recorder_add_outlet(obj.get(), out.handle().get()));
+	}
+
+	/// The number of bytes written to the recorder's files so far.
+	int64_t bytes_written() const { return lsl_recorder_bytes_written(obj.get()); }
+
+	recorder(recorder &&rhs) noexcept = default;
+	recorder &operator=(recorder &&rhs) noexcept {
+		// stop the old recording before releasing its inlets
+		obj = std::move(rhs.obj);
+		sources = std::move(rhs.sources);
+		return *this;
+	}
+
+private:
+	/// the recorded inlets, destroyed after the recorder
+	std::vector<std::shared_ptr<void>> sources;
+	std::unique_ptr<lsl_recorder_struct_, void (*)(lsl_recorder_struct_ *)> obj;
+};
+
+/**
+ * A replayer pushes the streams of an XDF file through outlets with their original timing.
+ *
+ * Each stream gets an outlet when the replayer is created, so inlets can connect before the
+ * replay is started.
+ */
+class replayer {
+public:
+	/**
+	 * Open a recording and create an outlet for each of its streams.
+	 * @param filename The name of the XDF file to replay.
+	 * @param speed The replay speed relative to the recording, e.g. 2 to replay twice as fast.
+	 * @param original_timestamps Push the recorded time stamps (mapped to the recording host's
+	 * clock with the recorded clock offsets) instead of shifting (and scaling) them to the time of
+	 * the replay.
+	 * @throws std::runtime_error if the file can't be read.
+	 */
+	replayer(const std::string &filename, double speed = 1.0, bool original_timestamps = false)
+		: obj(lsl_create_replayer(filename.c_str(), speed, original_timestamps),
+			  &lsl_destroy_replayer) {
+		if (!obj) throw std::runtime_error(lsl_last_error());
+	}
+
+	/// The number of replayed streams.
+	int32_t num_streams() const { return lsl_replayer_num_streams(obj.get()); }
+
+	/// The stream info of a replayed stream's outlet.
+	stream_info info(int32_t stream) const {
+		lsl_streaminfo info = lsl_replayer_get_info(obj.get(), stream);
+		if (!info) throw std::invalid_argument("No such stream.");
+		return stream_info(info);
+	}
+
+	/// Start pushing the samples.
+	void start() { lsl_replayer_start(obj.get()); }
+
+	/**
+	 * Wait until all samples have been pushed.
+	 * @return false if the timeout expired first.
+	 */
+	bool wait(double timeout = FOREVER) { return lsl_replayer_wait(obj.get(), timeout) != 0; }
+
+private:
+	std::unique_ptr<lsl_replayer_struct_, void (*)(lsl_replayer_struct_ *)> obj;
+};
+
 // ===============================
 // ==== Exception Definitions ====
 // ===============================
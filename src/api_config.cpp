@@ -1,5 +1,6 @@
 #include "api_config.h"
 #include "common.h"
+#include "logging.h"
 #include "util/cast.hpp"
 #include "util/strfuns.hpp"
 #include <algorithm>
@@ -25,8 +26,9 @@ std::string expand_tilde(const std::string &filename) {
 		else if ((home = getenv("HOMEDRIVE")) && (path = getenv("HOMEPATH")))
 			homedir = std::string(home) + path;
 		else {
-			LOG_F(WARNING, "Cannot determine the user's home directory; config files in the home "
-						   "directory will not be discovered.");
+			LSL_LOG_F(WARNING,
+				"Cannot determine the user's home directory; config files in the home "
+				"directory will not be discovered.");
 			return filename;
 		}
 		return homedir + filename.substr(1);
@@ -62,7 +64,8 @@ api_config::api_config() {
 			// config loaded successfully, so return
 			return;
 		} catch (std::exception &e) {
-			LOG_F(ERROR, "Error parsing config content: '%s', rolling back to defaults", e.what());
+			LSL_LOG_F(ERROR, "Error parsing config content: '%s', rolling back to defaults",
+				e.what());
 			// clear the content, it was invalid anyway
 			api_config_content_.clear();
 		}
@@ -78,7 +81,7 @@ api_config::api_config() {
 		if (file_is_readable(api_config_filename_)) {
 			filenames.insert(filenames.begin(), api_config_filename_);
 		} else {
-			LOG_F(ERROR, "Config file %s not found", api_config_filename_.c_str());
+			LSL_LOG_F(ERROR, "Config file %s not found", api_config_filename_.c_str());
 		}
 	}
 
@@ -86,7 +89,7 @@ api_config::api_config() {
 	if (auto *cfgpath = getenv("LSLAPICFG")) {
 		std::string envcfg(cfgpath);
 		if (!file_is_readable(envcfg))
-			LOG_F(ERROR, "LSLAPICFG file %s not found", envcfg.c_str());
+			LSL_LOG_F(ERROR, "LSLAPICFG file %s not found", envcfg.c_str());
 		else
 			filenames.insert(filenames.begin(), envcfg);
 	}
@@ -102,7 +105,7 @@ api_config::api_config() {
 				return;
 			}
 		} catch (std::exception &e) {
-			LOG_F(ERROR, "Error trying to load config file %s: %s", filename.c_str(), e.what());
+			LSL_LOG_F(ERROR, "Error trying to load config file %s: %s", filename.c_str(), e.what());
 		}
 	}
 	// unsuccessful: load default settings
@@ -121,12 +124,12 @@ void api_config::load_from_file(const std::string &filename) {
 		api_config::load(pt);
 		// log config filename only after setting the verbosity level and all config has been read
 		if (!filename.empty())
-			LOG_F(INFO, "Configuration loaded from %s", filename.c_str());
+			LSL_LOG_F(INFO, "Configuration loaded from %s", filename.c_str());
 		else
-			LOG_F(INFO, "Loaded default config");
+			LSL_LOG_F(INFO, "Loaded default config");
 
 	} catch (std::exception &e) {
-		LOG_F(ERROR, "Error parsing config file '%s': '%s', rolling back to defaults",
+		LSL_LOG_F(ERROR, "Error parsing config file '%s': '%s', rolling back to defaults",
 			filename.c_str(), e.what());
 		// any error: assign defaults
 		load_from_file();
@@ -143,7 +146,7 @@ void api_config::load_from_content(const std::string &content) {
 		pt.load(content_stream);
 	}
 	api_config::load(pt);
-	LOG_F(INFO, "Configuration loaded from content");
+	LSL_LOG_F(INFO, "Configuration loaded from content");
 }
 
 void api_config::load(INI &pt) {
@@ -162,6 +165,7 @@ void api_config::load(INI &pt) {
 
 		// read out the [ports] parameters
 		multicast_port_ = pt.get("ports.MulticastPort", 16571);
+		time_beacon_port_ = pt.get("ports.TimeBeaconPort", 16570);
 		base_port_ = pt.get("ports.BasePort", 16572);
 		port_range_ = pt.get("ports.PortRange", 32);
 		allow_random_ports_ = pt.get("ports.AllowRandomPorts", true);
@@ -274,7 +278,7 @@ void api_config::load(INI &pt) {
 
 		// Otherwise, let the OS select an appropriate network interface
 		if (multicast_interfaces.empty()) {
-			LOG_F(ERROR,
+			LSL_LOG_F(ERROR,
 				"No local network interface addresses found, resolving streams will likely "
 				"only work for devices connected to the main network adapter\n");
 			// Add dummy interface with default settings
@@ -304,11 +308,14 @@ void api_config::load(INI &pt) {
 		continuous_resolve_interval_ = pt.get("tuning.ContinuousResolveInterval", 0.5);
 		timer_resolution_ = pt.get("tuning.TimerResolution", 1);
 		max_cached_queries_ = pt.get("tuning.MaxCachedQueries", 100);
+		discovery_cache_ttl_ = pt.get("tuning.DiscoveryCacheTTL", 0.0);
 		time_update_interval_ = pt.get("tuning.TimeUpdateInterval", 2.0);
 		time_update_minprobes_ = pt.get("tuning.TimeUpdateMinProbes", 6);
 		time_probe_count_ = pt.get("tuning.TimeProbeCount", 8);
 		time_probe_interval_ = pt.get("tuning.TimeProbeInterval", 0.064);
 		time_probe_max_rtt_ = pt.get("tuning.TimeProbeMaxRTT", 0.128);
+		time_beacon_interval_ = pt.get("tuning.TimeBeaconInterval", 0.0);
+		time_beacon_probe_interval_ = pt.get("tuning.TimeBeaconProbeInterval", 30.0);
 		outlet_buffer_reserve_ms_ = pt.get("tuning.OutletBufferReserveMs", 5000);
 		outlet_buffer_reserve_samples_ = pt.get("tuning.OutletBufferReserveSamples", 128);
 		socket_send_buffer_size_ = pt.get("tuning.SendSocketBufferSize", 0);
@@ -317,6 +324,11 @@ void api_config::load(INI &pt) {
 		socket_receive_buffer_size_ = pt.get("tuning.ReceiveSocketBufferSize", 0);
 		smoothing_halftime_ = pt.get("tuning.SmoothingHalftime", 90.0F);
 		force_default_timestamps_ = pt.get("tuning.ForceDefaultTimestamps", false);
+		inlet_decode_thread_threshold_ = pt.get("tuning.InletDecodeThreadThreshold", 0.0);
+		session_encode_threads_ = pt.get("tuning.SessionEncodeThreads", 0);
+		session_encode_min_bytes_ = pt.get("tuning.SessionEncodeMinBytes", 1 << 18);
+		change_mask_encoding_ = pt.get("tuning.ChangeMaskEncoding", true);
+		adaptive_buffer_min_ = pt.get("tuning.AdaptiveBufferMin", 1.0);
 
 		
 }
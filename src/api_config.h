@@ -70,6 +70,13 @@ public:
 	 */
 	uint16_t multicast_port() const { return multicast_port_; }
 
+	/**
+	 * Port to which outlet hosts multicast their time beacons (see time_beacon).
+	 * This is separate from the multicast port so the beacon listeners of inlets don't receive
+	 * unicast discovery queries meant for outlets on the same host.
+	 */
+	uint16_t time_beacon_port() const { return time_beacon_port_; }
+
 	/**
 	 * @brief How the IPv4 / IPv6 protocols should be handled.
 	 *
@@ -202,6 +209,10 @@ public:
 	int timer_resolution() const { return timer_resolution_; }
 	/// The maximum number of most-recently-used queries that is cached.
 	int max_cached_queries() const { return max_cached_queries_; }
+	/// Lifetime of entries in the process-wide discovery cache that serves oneshot resolves, i.e.
+	/// how long a stream stays cached after it last answered the background resolver (0: no cache).
+	/// A stream that has been closed can still be resolved from the cache during this time.
+	double discovery_cache_ttl() const { return discovery_cache_ttl_; }
 	/// Interval between background time correction updates.
 	double time_update_interval() const { return time_update_interval_; }
 	/// Minimum number of probes that must have been successful to perform a time update.
@@ -212,6 +223,12 @@ public:
 	double time_probe_interval() const { return time_probe_interval_; }
 	/// Maximum assumed RTT of a time probe (= extra waiting time).
 	double time_probe_max_rtt() const { return time_probe_max_rtt_; }
+	/// Interval between the time beacons multicast by hosts with outlets (0 disables beacons).
+	/// Inlets only listen for beacons if this is set.
+	double time_beacon_interval() const { return time_beacon_interval_; }
+	/// Interval between the active time probe waves that calibrate the beacons of an outlet host;
+	/// the time correction is updated from the beacons in between.
+	double time_beacon_probe_interval() const { return time_beacon_probe_interval_; }
 	/// Default pre-allocated buffer size for the outlet, in ms (regular streams).
 	int outlet_buffer_reserve_ms() const { return outlet_buffer_reserve_ms_; }
 	/// Default pre-allocated buffer size for the outlet, in samples (irregular streams).
@@ -228,6 +245,19 @@ public:
 	float smoothing_halftime() const { return smoothing_halftime_; }
 	/// Override timestamps with lsl clock if True
 	bool force_default_timestamps() const { return force_default_timestamps_; }
+	/// Nominal data rate (in bytes per second) from which an inlet decodes received data in a
+	/// separate thread, so that one thread can keep draining the socket (0 disables this).
+	double inlet_decode_thread_threshold() const { return inlet_decode_thread_threshold_; }
+	/// Number of additional threads per outlet session that help serializing large chunks of
+	/// numeric samples (0 serializes everything in the session's transfer thread).
+	int session_encode_threads() const { return session_encode_threads_; }
+	/// Minimum size (in bytes) of a serialized chunk before it's split across the encode threads.
+	int session_encode_min_bytes() const { return session_encode_min_bytes_; }
+	/// Whether numeric samples may be sent as only the channels that changed since the previous
+	/// sample. Inlets offer this to outlets, which use it unless they have session encode threads.
+	bool change_mask_encoding() const { return change_mask_encoding_; }
+	/// Smallest buffer length (in seconds) an inlet with an adaptive buffer shrinks to.
+	double adaptive_buffer_min() const { return adaptive_buffer_min_; }
 
 	/// Deleted copy constructor (noncopyable).
 	api_config(const api_config &rhs) = delete;
@@ -273,6 +303,7 @@ private:
 	uint16_t port_range_;
 	bool allow_random_ports_;
 	uint16_t multicast_port_;
+	uint16_t time_beacon_port_;
 	std::string resolve_scope_;
 	std::vector<ip::address> multicast_addresses_;
 	int multicast_ttl_;
@@ -290,11 +321,14 @@ private:
 	double continuous_resolve_interval_;
 	int timer_resolution_;
 	int max_cached_queries_;
+	double discovery_cache_ttl_;
 	double time_update_interval_;
 	int time_update_minprobes_;
 	int time_probe_count_;
 	double time_probe_interval_;
 	double time_probe_max_rtt_;
+	double time_beacon_interval_;
+	double time_beacon_probe_interval_;
 	int outlet_buffer_reserve_ms_;
 	int outlet_buffer_reserve_samples_;
 	int socket_send_buffer_size_;
@@ -303,6 +337,11 @@ private:
 	int socket_receive_buffer_size_;
 	float smoothing_halftime_;
 	bool force_default_timestamps_;
+	double inlet_decode_thread_threshold_;
+	int session_encode_threads_;
+	int session_encode_min_bytes_;
+	bool change_mask_encoding_;
+	double adaptive_buffer_min_;
 };
 
 // initialize configuration file name
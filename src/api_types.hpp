@@ -12,6 +12,9 @@
 
 namespace lsl {
 class continuous_resolver_impl;
+class outlet_group;
+class recorder;
+class replayer;
 class resolver_impl;
 class stream_info_impl;
 class stream_inlet_impl;
@@ -25,4 +28,7 @@ using lsl_continuous_resolver = lsl::resolver_impl *;
 using lsl_streaminfo = lsl::stream_info_impl *;
 using lsl_outlet = lsl::stream_outlet_impl *;
 using lsl_inlet = lsl::stream_inlet_impl *;
+using lsl_outlet_group = lsl::outlet_group *;
+using lsl_recorder = lsl::recorder *;
+using lsl_replayer = lsl::replayer *;
 using lsl_xml_ptr = pugi::xml_node_struct *;
@@ -15,11 +15,17 @@
 
 #define BOOST_ASIO_NO_DEPRECATED
 #include "cancellation.h"
+#include <algorithm>
 #include <asio/basic_stream_socket.hpp>
 #include <asio/io_context.hpp>
 #include <asio/ip/tcp.hpp>
+#include <asio/steady_timer.hpp>
+#include <chrono>
+#include <cstring>
 #include <exception>
+#include <functional>
 #include <streambuf>
+#include <vector>
 
 using asio::io_context;
 
@@ -81,6 +87,87 @@ public:
 		return !ec_ ? this : nullptr;
 	}
 
+	/**
+	 * Establish a connection to the first of several endpoints that accepts it.
+	 *
+	 * The endpoints are tried in order, but instead of waiting for a connection attempt to time
+	 * out, the next attempt is started after `attempt_delay` seconds while the earlier ones are
+	 * still pending (similar to "Happy Eyeballs", RFC 8305). The first established connection
+	 * wins, so a preferred but unreachable (or slow) route doesn't delay the connection much.
+	 *
+	 * @return \c this if a connection was successfully established, a null
+	 * pointer otherwise.
+	 */
+	cancellable_streambuf *connect(
+		const std::vector<Protocol::endpoint> &endpoints, double attempt_delay = 0.1) {
+		if (endpoints.size() == 1) return connect(endpoints.front());
+		const std::size_t none = endpoints.size();
+		std::vector<Socket> attempts;
+		attempts.reserve(endpoints.size());
+		asio::steady_timer next_attempt(as_context());
+		std::size_t pending = 0, winner = none;
+		// the timer is re-armed for each attempt, so several of its waits can be outstanding;
+		// only the most recent one starts the next attempt
+		std::size_t waits = 0, wait_id = 0;
+		std::function<void()> start_next = [&]() {
+			if (winner != none || attempts.size() == endpoints.size()) return;
+			const std::size_t i = attempts.size();
+			attempts.emplace_back(as_context());
+			++pending;
+			attempts[i].async_connect(endpoints[i], [&, i](const asio::error_code &ec) {
+				--pending;
+				if (winner != none) return;
+				if (!ec) {
+					winner = i;
+					next_attempt.cancel();
+				} else if (attempts.size() < endpoints.size())
+					// this attempt failed early (e.g. refused), so don't wait for the timer
+					start_next();
+				else if (!pending)
+					this->ec_ = ec;
+			});
+			// expires_after() cancels the outstanding wait, if any
+			next_attempt.expires_after(std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::duration<double>(attempt_delay)));
+			++waits;
+			next_attempt.async_wait([&, id = ++wait_id](const asio::error_code &ec) {
+				--waits;
+				if (!ec && id == wait_id) start_next();
+			});
+		};
+		{
+			std::lock_guard<std::recursive_mutex> lock(cancel_mut_);
+			if (cancel_issued_)
+				throw std::runtime_error(
+					"Attempt to connect() a cancellable_streambuf after it has been cancelled.");
+
+			init_buffers();
+			socket().close(ec_);
+			ec_ = asio::error::would_block;
+			if (endpoints.empty()) ec_ = asio::error::host_not_found;
+			start_next();
+			this->as_context().restart();
+		}
+		while (!cancel_issued_ && winner == none && ec_ == asio::error::would_block)
+			as_context().run_one();
+		if (winner != none) {
+			socket() = std::move(attempts[winner]);
+			ec_ = asio::error_code();
+		} else if (ec_ == asio::error::would_block)
+			ec_ = asio::error::operation_aborted;
+		// abort the other attempts; their handlers refer to this stack frame, so wait for them
+		next_attempt.cancel();
+		for (auto &attempt : attempts) attempt.close();
+		while (pending || waits) as_context().run_one();
+		return winner != none ? this : nullptr;
+	}
+
+	/// Get the remote endpoint of the connection (or a default endpoint if not connected).
+	Protocol::endpoint remote_endpoint() {
+		asio::error_code ec;
+		return socket().remote_endpoint(ec);
+	}
+
 	/// Close the connection.
 	/**
 	 * @return \c this if a connection was successfully established, a null
@@ -99,6 +186,24 @@ public:
 	 */
 	const asio::error_code &error() const { return ec_; }
 
+	/**
+	 * Read up to `len` bytes into `dst`, blocking until at least one byte is available.
+	 *
+	 * Bytes that are still buffered (e.g. after the header was parsed with an iostream) are
+	 * returned first, afterwards the socket is read directly into `dst` without any copies.
+	 * @return The number of bytes read or 0 if the connection was closed, an error occurred
+	 * (see error()) or the stream buffer was cancelled.
+	 */
+	std::size_t read_some(char *dst, std::size_t len) {
+		if (gptr() != egptr()) {
+			const auto n = std::min<std::size_t>(len, egptr() - gptr());
+			std::memcpy(dst, gptr(), n);
+			gbump(static_cast<int>(n));
+			return n;
+		}
+		return receive(asio::buffer(dst, len));
+	}
+
 protected:
 	/// Close the socket if it's open.
 	void close_if_open() {
@@ -125,21 +230,28 @@ protected:
 		// will be processed by the run_one
 	}
 
+	/// Receive some bytes into the given buffer, return the number of bytes or 0 on error
+	std::size_t receive(asio::mutable_buffer buffer) {
+		std::size_t bytes_transferred_ = 0;
+		socket().async_receive(buffer,
+			[this, &bytes_transferred_](
+				const asio::error_code &ec, std::size_t bytes_transferred = 0) {
+				this->ec_ = ec;
+				bytes_transferred_ = bytes_transferred;
+			});
+
+		ec_ = asio::error::would_block;
+		protected_reset(); // line changed for lsl
+		do as_context().run_one();
+		while (!cancel_issued_ && ec_ == asio::error::would_block);
+		return ec_ ? 0 : bytes_transferred_;
+	}
+
 	int_type underflow() override {
 		if (gptr() == egptr()) {
-			std::size_t bytes_transferred_;
-			socket().async_receive(asio::buffer(asio::buffer(get_buffer_) + putback_max),
-				[this, &bytes_transferred_](
-					const asio::error_code &ec, std::size_t bytes_transferred = 0) {
-					this->ec_ = ec;
-					bytes_transferred_ = bytes_transferred;
-				});
-
-			ec_ = asio::error::would_block;
-			protected_reset(); // line changed for lsl
-			do as_context().run_one();
-			while (!cancel_issued_ && ec_ == asio::error::would_block);
-			if (ec_) return traits_type::eof();
+			std::size_t bytes_transferred_ =
+				receive(asio::buffer(asio::buffer(get_buffer_) + putback_max));
+			if (!bytes_transferred_) return traits_type::eof();
 
 			setg(&get_buffer_[0], &get_buffer_[0] + putback_max,
 				&get_buffer_[0] + putback_max + bytes_transferred_);
@@ -1,6 +1,6 @@
 #include "cancellation.h"
+#include "logging.h"
 #include <exception>
-#include <loguru.hpp>
 
 lsl::cancellable_registry::~cancellable_registry() = default;
 
@@ -11,7 +11,7 @@ void lsl::cancellable_obj::unregister_from_all() {
 		for (auto *obj : registered_at_) obj->unregister_cancellable(this);
 		registered_at_.clear();
 	} catch (std::exception &e) {
-		LOG_F(ERROR,
+		LSL_LOG_F(ERROR,
 			"Unexpected error trying to unregister a cancellable object from its registry: %s",
 			e.what());
 	}
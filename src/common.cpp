@@ -1,10 +1,13 @@
 #include "common.h"
 #include "api_config.h"
+#include "logging.h"
 #include <algorithm>
 #include <cctype>
 #include <chrono>
 #include <cstdlib>
+#include <fstream>
 #include <loguru.hpp>
+#include <string>
 
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -14,6 +17,9 @@
 #include <windows.h>
 // include mmsystem.h after windows.h
 #include <mmsystem.h>
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#include <sys/time.h>
 #endif
 
 int64_t lsl::lsl_local_clock_ns() {
@@ -62,6 +68,24 @@ LIBLSL_C_API const char *lsl_last_error(void) {
 
 // === implementation of misc functions ===
 
+const std::string &lsl::boot_id() {
+	static const std::string id = []() {
+		std::string result;
+#if defined(__linux__)
+		std::ifstream("/proc/sys/kernel/random/boot_id") >> result;
+#elif defined(__APPLE__)
+		// the boot time is unique enough to tell the boots of a host apart
+		timeval boottime{};
+		std::size_t size = sizeof(boottime);
+		int mib[2] = {CTL_KERN, KERN_BOOTTIME};
+		if (sysctl(mib, 2, &boottime, &size, nullptr, 0) == 0)
+			result = std::to_string(boottime.tv_sec) + '.' + std::to_string(boottime.tv_usec);
+#endif
+		return result;
+	}();
+	return id;
+}
+
 void lsl::ensure_lsl_initialized() {
 	static bool is_initialized = false;
 
@@ -75,7 +99,7 @@ void lsl::ensure_lsl_initialized() {
 		loguru::init(argc, const_cast<char **>(argv));
 #else
 #endif
-		LOG_F(INFO, "%s", lsl_library_info());
+		LSL_LOG_F(INFO, "%s", lsl_library_info());
 
 #ifdef _WIN32
 		// if a timer resolution other than 0 is requested (0 means don't override)...
@@ -67,6 +67,13 @@ int64_t lsl_local_clock_ns();
 /// Obtain a local system time stamp in seconds.
 inline double lsl_clock() { return lsl_local_clock(); }
 
+/**
+ * An identifier of the current boot of this host, i.e. of the epoch of lsl_clock().
+ *
+ * It's empty if the platform doesn't provide one.
+ */
+const std::string &boot_id();
+
 /// Ensure that LSL is initialized.
 void ensure_lsl_initialized();
 
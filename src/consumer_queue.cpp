@@ -1,8 +1,9 @@
 #include "consumer_queue.h"
 #include "common.h"
+#include "logging.h"
 #include "send_buffer.h"
+#include "util/memstats.hpp"
 #include <chrono>
-#include <loguru.hpp>
 #include <utility>
 
 using namespace lsl;
@@ -17,17 +18,19 @@ consumer_queue::consumer_queue(std::size_t size, send_buffer_p registry)
 	for (std::size_t i = 0; i < size_; ++i)
 		buffer_[i].seq_state.store(i, std::memory_order_release);
 	if (registry_) registry_->register_consumer(this);
+	memstats::add(memstats::component::consumer_queue, size_ * sizeof(item_t), 1);
 }
 
 consumer_queue::~consumer_queue() {
 	try {
 		if (registry_) registry_->unregister_consumer(this);
 	} catch (std::exception &e) {
-		LOG_F(ERROR,
+		LSL_LOG_F(ERROR,
 			"Unexpected error while trying to unregister a consumer queue from its registry: %s",
 			e.what());
 	}
 	delete[] buffer_;
+	memstats::add(memstats::component::consumer_queue, -int64_t(size_ * sizeof(item_t)), -1);
 }
 
 uint32_t consumer_queue::flush() noexcept {
@@ -44,6 +47,14 @@ std::size_t consumer_queue::read_available() const {
 	return ret;
 }
 
+void consumer_queue::close() {
+	{
+		std::lock_guard<std::mutex> lk(mut_);
+		closed_.store(true, std::memory_order_release);
+	}
+	cv_.notify_all();
+}
+
 bool consumer_queue::empty() const {
 	return write_idx_.load(std::memory_order_acquire) == read_idx_.load(std::memory_order_relaxed);
 }
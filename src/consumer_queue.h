@@ -56,20 +56,24 @@ public:
 	 * This deletes the oldest sample if the max capacity is exceeded.
 	 */
 	template <class T> void push_sample(T &&sample) {
-		while (!try_push(std::forward<T>(sample))) {
-			// buffer full, drop oldest sample
-			if (!done_sync_.load(std::memory_order_acquire)) {
-				// synchronizes-with store to done_sync_ in ctor
-				std::atomic_thread_fence(std::memory_order_acquire);
-				done_sync_.store(true, std::memory_order_release);
-			}
-			try_pop();
-		}
-		{
-			// ensure that notify_one doesn't happen in between try_pop and wait_for
-			std::lock_guard<std::mutex> lk(mut_);
-			cv_.notify_one();
-		}
+		push_or_drop(std::forward<T>(sample));
+		notify();
+	}
+
+	/**
+	 * Move a batch of samples onto the queue and wake up waiting consumers only once.
+	 * Same restrictions as push_sample().
+	 */
+	void push_samples(sample_p *samples, std::size_t n) {
+		for (std::size_t i = 0; i < n; ++i) push_or_drop(std::move(samples[i]));
+		// there might be enough samples for several waiting consumers
+		notify(n > 1);
+	}
+
+	/// Copy a batch of samples onto the queue, see above.
+	void push_samples(const sample_p *samples, std::size_t n) {
+		for (std::size_t i = 0; i < n; ++i) push_or_drop(samples[i]);
+		notify(n > 1);
 	}
 
 	/**
@@ -84,11 +88,24 @@ public:
 			// only acquire mutex if we have to do a blocking wait with timeout
 			std::chrono::duration<double> sec(timeout);
 			std::unique_lock<std::mutex> lk(mut_);
-			if (!try_pop(result)) cv_.wait_for(lk, sec, [&] { return this->try_pop(result); });
+			if (!try_pop(result))
+				cv_.wait_for(lk, sec, [&] { return this->try_pop(result) || closed_; });
 		}
 		return result;
 	}
 
+	/**
+	 * Block until a sample can be popped or the queue was closed, without popping it.
+	 * @param timeout Timeout for the blocking, in seconds.
+	 * @return False if the timeout expired first.
+	 */
+	bool wait_for_sample(double timeout) {
+		std::unique_lock<std::mutex> lk(mut_);
+		const auto ready = [this] { return !empty() || closed(); };
+		if (timeout <= 0.0) return ready();
+		return cv_.wait_for(lk, std::chrono::duration<double>(timeout), ready);
+	}
+
 	/// Number of available samples. This is approximate unless called by the thread calling the
 	/// pop_sample().
 	std::size_t read_available() const;
@@ -100,12 +117,49 @@ public:
 	/// the pop_sample().
 	bool empty() const;
 
+	/// Number of samples that were dropped because the queue was full.
+	uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+	/**
+	 * Wake up all waiting consumers and let pop_sample() return immediately once the queue is
+	 * empty, e.g. because the queue was replaced by a differently sized one.
+	 */
+	void close();
+
+	/// Whether close() was called.
+	bool closed() const { return closed_.load(std::memory_order_acquire); }
+
 	consumer_queue(const consumer_queue&) = delete;
 	consumer_queue(consumer_queue &&) = delete;
 	consumer_queue& operator=(const consumer_queue&) = delete;
 	consumer_queue &operator=(consumer_queue &&) = delete;
 
 private:
+	friend class send_buffer;
+
+	/// Push a sample, dropping the oldest samples if the queue is full
+	template <class T> void push_or_drop(T &&sample) {
+		while (!try_push(std::forward<T>(sample))) {
+			// buffer full, drop oldest sample
+			if (!done_sync_.load(std::memory_order_acquire)) {
+				// synchronizes-with store to done_sync_ in ctor
+				std::atomic_thread_fence(std::memory_order_acquire);
+				done_sync_.store(true, std::memory_order_release);
+			}
+			if (try_pop()) dropped_.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	/// Wake up one (or all) consumers that might be waiting in pop_sample()
+	void notify(bool all = false) {
+		// ensure that notify_one doesn't happen in between try_pop and wait_for
+		std::lock_guard<std::mutex> lk(mut_);
+		if (all)
+			cv_.notify_all();
+		else
+			cv_.notify_one();
+	}
+
 	// an item stored in the queue
 	struct item_t {
 		std::atomic<std::size_t> seq_state;
@@ -157,7 +211,7 @@ private:
 	inline static void copy_or_move(sample_p &dst, const sample_p &src) { dst = src; }
 	inline static void copy_or_move(sample_p &dst, sample_p &&src) { dst = std::move(src); }
 	// helper to either move or drop a value, depending on whether a dst argument is given
-	inline static void move_or_drop(sample_p &src) { src.~sample_p(); }
+	inline static void move_or_drop(sample_p &src) { src.reset(); }
 	inline static void move_or_drop(sample_p &src, sample_p &dst) { dst = std::move(src); }
 
 	/// helper to add a delta to the given index and wrap correctly
@@ -200,6 +254,10 @@ private:
 
 	/// whether we have performed a sync on the data stored by the constructor
 	std::atomic<bool> done_sync_{false};
+	/// number of samples dropped due to overflow (only written by the producer)
+	std::atomic<uint64_t> dropped_{0};
+	/// whether waiting consumers should give up (set under mut_)
+	std::atomic<bool> closed_{false};
 };
 
 } // namespace lsl
@@ -2,17 +2,26 @@
 #include "api_config.h"
 #include "cancellable_streambuf.h"
 #include "inlet_connection.h"
+#include "logging.h"
 #include "sample.h"
+#include "sample_codec.h"
+#include "sample_filter.h"
 #include "socket_utils.h"
+#include "trace.h"
 #include "util/cast.hpp"
 #include "util/endian.hpp"
 #include "util/strfuns.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <deque>
 #include <exception>
 #include <iostream>
 #include <loguru.hpp>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 // a convention that applies when including portable_oarchive.h in multiple .cpp files.
@@ -23,20 +32,34 @@
 
 namespace lsl {
 
-data_receiver::data_receiver(inlet_connection &conn, int max_buflen, int max_chunklen)
+data_receiver::data_receiver(
+	inlet_connection &conn, int max_buflen, int max_chunklen, bool adaptive_buffer)
 	: conn_(conn),
 	  sample_factory_(
 		  new factory(conn.type_info().channel_format(), conn.type_info().channel_count(),
 			  conn.type_info().nominal_srate()
 				  ? static_cast<int>(conn.type_info().nominal_srate() *
 									 api_config::get_instance()->inlet_buffer_reserve_ms() / 1000)
-				  : api_config::get_instance()->inlet_buffer_reserve_samples())),
+				  : api_config::get_instance()->inlet_buffer_reserve_samples(),
+			  conn.type_info().record_layout())),
 	  check_thread_start_(true), closing_stream_(false), connected_(false),
-	  sample_queue_(max_buflen), max_buflen_(max_buflen), max_chunklen_(max_chunklen) {
+	  max_buflen_(max_buflen), max_chunklen_(max_chunklen),
+	  adaptive_(adaptive_buffer && max_buflen > 2), min_capacity_(max_buflen),
+	  capacity_(max_buflen), window_start_(lsl_clock()) {
 	if (max_buflen < 0)
 		throw std::invalid_argument("The max_buflen argument must not be smaller than 0.");
 	if (max_chunklen < 0)
 		throw std::invalid_argument("The max_chunklen argument must not be smaller than 0.");
+	if (adaptive_) {
+		// irregular streams are assumed to have 100 samples per second, as for fixed buffers
+		const double srate = conn.type_info().nominal_srate();
+		const double min_samples =
+			(srate > 0 ? srate : 100.) * api_config::get_instance()->adaptive_buffer_min();
+		min_capacity_ = std::min<std::size_t>(
+			max_buflen, std::max<std::size_t>(2, static_cast<std::size_t>(min_samples)));
+		capacity_ = min_capacity_;
+	}
+	sample_queue_ = std::make_shared<consumer_queue>(capacity_);
 	conn_.register_onlost(this, &connected_upd_);
 }
 
@@ -45,8 +68,8 @@ data_receiver::~data_receiver() {
 		conn_.unregister_onlost(this);
 		if (data_thread_.joinable()) data_thread_.join();
 	} catch (std::exception &e) {
-		LOG_F(ERROR, "Unexpected error during destruction of a data_receiver: %s", e.what());
-	} catch (...) { LOG_F(ERROR, "Severe error during data receiver shutdown."); }
+		LSL_LOG_F(ERROR, "Unexpected error during destruction of a data_receiver: %s", e.what());
+	} catch (...) { LSL_LOG_F(ERROR, "Severe error during data receiver shutdown."); }
 }
 
 
@@ -80,6 +103,85 @@ void data_receiver::close_stream() {
 	cancel_all_registered();
 }
 
+void data_receiver::get_stats(lsl_inlet_stats &stats) const {
+	stats.samples_received =
+		static_cast<int64_t>(counters_.samples_received.load(std::memory_order_relaxed));
+	const auto queue = this->queue();
+	stats.samples_dropped = static_cast<int64_t>(retired_dropped_ + queue->dropped());
+	stats.queue_depth = static_cast<int32_t>(queue->read_available());
+	stats.queue_capacity = static_cast<int32_t>(capacity_.load());
+	stats.reconnects = static_cast<int32_t>(counters_.reconnects.load(std::memory_order_relaxed));
+	stats.handshake_time = counters_.handshake_time.load(std::memory_order_relaxed);
+}
+
+void data_receiver::set_sample_filter(const std::string &expression) {
+	std::shared_ptr<const sample_filter> filter;
+	if (!expression.empty())
+		filter = std::make_shared<sample_filter>(
+			expression, conn_.type_info().channel_format(), conn_.type_info().channel_count());
+	std::lock_guard<std::mutex> lock(connected_mut_);
+	filter_ = std::move(filter);
+}
+
+std::shared_ptr<consumer_queue> data_receiver::queue() const {
+	if (!adaptive_) return sample_queue_;
+	std::lock_guard<std::mutex> lock(queue_mut_);
+	return sample_queue_;
+}
+
+void data_receiver::enqueue(sample_p *samples, std::size_t n) {
+	if (adaptive_) adapt_capacity(n);
+	sample_queue_->push_samples(samples, n);
+}
+
+void data_receiver::adapt_capacity(std::size_t incoming) {
+	// length of the windows in which the consumption is observed before shrinking
+	const double window = 10.0;
+	const std::size_t capacity = capacity_, queued = sample_queue_->read_available(),
+					  depth = queued + incoming;
+	window_peak_ = std::max(window_peak_, depth);
+	// grow before samples have to be dropped
+	if (depth > capacity / 4 * 3 && capacity < static_cast<std::size_t>(max_buflen_))
+		resize_queue(std::min<std::size_t>(max_buflen_, std::max(2 * capacity, 2 * depth)));
+
+	const double now = lsl_clock();
+	if (now >= window_start_ + window) {
+		// keep twice the peak, but at least the minimum length at the rate samples were pulled
+		const double drained = static_cast<double>(window_received_ + window_start_depth_) -
+							   static_cast<double>(queued);
+		const double drain_rate = std::max(0.0, drained) / (now - window_start_);
+		const auto drained_per_period =
+			static_cast<std::size_t>(drain_rate * api_config::get_instance()->adaptive_buffer_min());
+		const auto target = std::max({min_capacity_, 2 * window_peak_, drained_per_period});
+		if (2 * target <= capacity_) resize_queue(target);
+		window_start_ = now;
+		window_peak_ = depth;
+		window_start_depth_ = queued;
+		window_received_ = 0;
+	}
+	window_received_ += incoming;
+}
+
+void data_receiver::resize_queue(std::size_t capacity) {
+	auto resized = std::make_shared<consumer_queue>(capacity);
+	// consumers pop under the same lock, so none of them can take a later sample from the old
+	// queue while the earlier ones are moved
+	{
+		std::lock_guard<std::mutex> lock(queue_mut_);
+		std::vector<sample_p> waiting;
+		waiting.reserve(sample_queue_->read_available());
+		while (sample_p s = sample_queue_->pop_sample(0.0)) waiting.push_back(std::move(s));
+		resized->push_samples(waiting.data(), waiting.size());
+		retired_dropped_ += sample_queue_->dropped();
+		sample_queue_->close();
+		sample_queue_ = std::move(resized);
+	}
+	capacity_ = capacity;
+	outlet_buflen_update_ = static_cast<int>(capacity);
+	LSL_DLOG_F(
+		1, "Resized the buffer of %s to %zu samples", conn_.type_info().name().c_str(), capacity);
+}
+
 sample_p lsl::data_receiver::try_get_next_sample(double timeout) {
 	if (conn_.lost())
 		throw lost_error("The stream read by this outlet has been lost. To recover, you need to "
@@ -90,8 +192,24 @@ sample_p lsl::data_receiver::try_get_next_sample(double timeout) {
 		check_thread_start_ = false;
 	}
 	// get the sample with timeout
-	if (sample_p s = sample_queue_.pop_sample(timeout))
-		return s;
+	sample_p s;
+	if (!adaptive_)
+		s = sample_queue_->pop_sample(timeout);
+	else {
+		// pop without blocking while no resize can interfere and wait for samples outside the
+		// lock; a replaced queue wakes up its consumers, who continue with the new queue
+		const double deadline = lsl_clock() + timeout;
+		for (;;) {
+			std::shared_ptr<consumer_queue> queue;
+			{
+				std::lock_guard<std::mutex> lock(queue_mut_);
+				queue = sample_queue_;
+				s = queue->pop_sample(0.0);
+			}
+			if (s || !queue->wait_for_sample(deadline - lsl_clock())) break;
+		}
+	}
+	if (s) return s;
 	if (conn_.lost())
 		throw lost_error("The stream read by this inlet has been lost. To recover, you need to "
 						 "re-resolve the source and re-create the inlet.");
@@ -101,12 +219,14 @@ sample_p lsl::data_receiver::try_get_next_sample(double timeout) {
 
 template <class T>
 double data_receiver::pull_sample_typed(T *buffer, uint32_t buffer_elements, double timeout) {
+	const int64_t pull_start = trace::start();
 	if(sample_p s = try_get_next_sample(timeout))
 	{
 		if (buffer_elements != conn_.type_info().channel_count())
 			throw std::range_error("The number of buffer elements provided does not match the "
 								   "number of channels in the sample.");
 		s->retrieve_typed(buffer);
+		trace::span("pull", pull_start, s->timestamp());
 		return s->timestamp();
 	}
 	return 0.0;
@@ -120,12 +240,33 @@ template double data_receiver::pull_sample_typed<float>(float *, uint32_t, doubl
 template double data_receiver::pull_sample_typed<double>(double *, uint32_t, double);
 template double data_receiver::pull_sample_typed<std::string>(std::string *, uint32_t, double);
 
+template <class T>
+double data_receiver::pull_sample_strided(
+	char *buffer, const channel_layout &layout, double timeout) {
+	const int64_t pull_start = trace::start();
+	if (sample_p s = try_get_next_sample(timeout)) {
+		s->retrieve_strided<T>(buffer, layout);
+		trace::span("pull", pull_start, s->timestamp());
+		return s->timestamp();
+	}
+	return 0.0;
+}
+
+template double data_receiver::pull_sample_strided<char>(char *, const channel_layout &, double);
+template double data_receiver::pull_sample_strided<int16_t>(char *, const channel_layout &, double);
+template double data_receiver::pull_sample_strided<int32_t>(char *, const channel_layout &, double);
+template double data_receiver::pull_sample_strided<int64_t>(char *, const channel_layout &, double);
+template double data_receiver::pull_sample_strided<float>(char *, const channel_layout &, double);
+template double data_receiver::pull_sample_strided<double>(char *, const channel_layout &, double);
+
 double data_receiver::pull_sample_untyped(void *buffer, int buffer_bytes, double timeout) {
+	const int64_t pull_start = trace::start();
 	if(sample_p s = try_get_next_sample(timeout)) {
 		if (buffer_bytes != conn_.type_info().sample_bytes())
 			throw std::range_error("The size of the provided buffer does not match the number of "
 								   "bytes in the sample.");
 		s->retrieve_untyped(buffer);
+		trace::span("pull", pull_start, s->timestamp());
 		return s->timestamp();
 	}
 	return 0.0;
@@ -139,10 +280,12 @@ void data_receiver::data_thread() {
 	loguru::set_thread_name((std::string("R_") += conn_.type_info().name().substr(0, 12)).c_str());
 	// ensure that the sample factory persists for the lifetime of this thread
 	factory_p factory(sample_factory_);
+	bool first_connection = true;
 	try {
 		while (!conn_.lost() && !conn_.shutdown() && !closing_stream_) {
 			try {
 				// --- connection setup ---
+				const double handshake_start = lsl_clock();
 
 				// make a new stream buffer and a stream on top of it
 				cancellable_streambuf buffer;
@@ -151,8 +294,9 @@ void data_receiver::data_thread() {
 				std::iostream server_stream(&buffer);
 				std::unique_ptr<eos::portable_iarchive> inarch;
 				// connect to endpoint
-				buffer.connect(conn_.get_tcp_endpoint());
+				buffer.connect(conn_.get_tcp_endpoints());
 				if (buffer.error()) throw buffer.error();
+				conn_.endpoint_connected(buffer.remote_endpoint());
 
 				// --- protocol negotiation ---
 
@@ -160,6 +304,14 @@ void data_receiver::data_thread() {
 				int data_protocol_version = 100;  // which protocol version we shall use for data
 												  // transmission (100=version 1.00)
 				bool suppress_subnormals = false; // whether we shall suppress subnormal numbers
+				bool filtered_by_outlet = false;  // whether the outlet applies the sample filter
+				bool change_masks = false; // whether samples only contain the changed channels
+				bool renegotiation = false; // whether the outlet accepts buffer length updates
+				std::shared_ptr<const sample_filter> filter;
+				{
+					std::lock_guard<std::mutex> lock(connected_mut_);
+					filter = filter_;
+				}
 
 				// propose to use the highest protocol version supported by both parties
 				int proposed_protocol_version =
@@ -182,11 +334,19 @@ void data_receiver::data_thread() {
 								  << "\r\n"; // 0 for strings
 					server_stream << "Data-Protocol-Version: " << proposed_protocol_version
 								  << "\r\n";
-					server_stream << "Max-Buffer-Length: " << max_buflen_ << "\r\n";
+					// the handshake includes the current length of an adaptive buffer
+					outlet_buflen_update_ = 0;
+					server_stream << "Max-Buffer-Length: " << capacity_.load() << "\r\n";
 					server_stream << "Max-Chunk-Length: " << max_chunklen_ << "\r\n";
 					server_stream << "Hostname: " << conn_.type_info().hostname() << "\r\n";
 					server_stream << "Source-Id: " << conn_.type_info().source_id() << "\r\n";
 					server_stream << "Session-Id: " << conn_.type_info().session_id() << "\r\n";
+					if (filter)
+						server_stream << "Sample-Filter: " << filter->expression() << "\r\n";
+					if (api_config::get_instance()->change_mask_encoding() &&
+						conn_.type_info().channel_format() != cft_string)
+						server_stream << "Change-Mask: 1\r\n";
+					if (adaptive_) server_stream << "Buffer-Renegotiation: 1\r\n";
 					server_stream << "\r\n" << std::flush;
 
 					// check server response line (LSL/[Version] [StatusCode] [Message])
@@ -238,6 +398,10 @@ void data_receiver::data_thread() {
 							}
 							if (type == "suppress-subnormals")
 								suppress_subnormals = lsl::from_string<bool>(rest);
+							if (type == "sample-filter") filtered_by_outlet = true;
+							if (type == "change-mask") change_masks = lsl::from_string<bool>(rest);
+							if (type == "buffer-renegotiation")
+								renegotiation = lsl::from_string<bool>(rest);
 							if (type == "uid" && rest != conn_.current_uid())
 								throw lost_error("The received UID does not match the current "
 												 "connection's UID.");
@@ -255,7 +419,7 @@ void data_receiver::data_thread() {
 				} else {
 					// version 1.00: send request line and feed parameters
 					server_stream << "LSL:streamfeed\r\n";
-					server_stream << max_buflen_ << " " << max_chunklen_ << "\r\n" << std::flush;
+					server_stream << capacity_.load() << " " << max_chunklen_ << "\r\n" << std::flush;
 				}
 
 				if (data_protocol_version == 100) {
@@ -276,8 +440,8 @@ void data_receiver::data_thread() {
 				{
 					// receive and parse two subsequent test-pattern samples and check if they are
 					// formatted as expected
-					lsl::factory fac(
-						conn_.type_info().channel_format(), conn_.type_info().channel_count(), 4);
+					lsl::factory fac(conn_.type_info().channel_format(),
+						conn_.type_info().channel_count(), 4, conn_.type_info().record_layout());
 
 					for (int test_pattern : {4, 2}) {
 						lsl::sample_p expected(fac.new_sample(0.0, false)),
@@ -296,6 +460,11 @@ void data_receiver::data_thread() {
 					}
 				}
 
+				counters_.handshake_time.store(
+					lsl_clock() - handshake_start, std::memory_order_relaxed);
+				if (!first_connection) counters_.reconnects.fetch_add(1, std::memory_order_relaxed);
+				first_connection = false;
+
 				// signal to accessor functions on other threads that the protocol negotiation has
 				// been successful, so we're now connected (and remain to be even if we later
 				// recover silently)
@@ -307,26 +476,37 @@ void data_receiver::data_thread() {
 
 				// --- transmission loop ---
 
-				double last_timestamp = 0.0;
-				double srate = conn_.current_srate();
-				for (int k = 0; !conn_.lost() && !conn_.shutdown() && !closing_stream_; k++) {
-					// allocate and fetch a new sample
-					sample_p samp(factory->new_sample(0.0, false));
-					if (data_protocol_version >= 110)
-						samp->load_streambuf(
-							buffer, data_protocol_version, reverse_byte_order, suppress_subnormals);
-					else
+				// outlets that don't understand the filter send everything, so filter here
+				const sample_filter *local_filter = filtered_by_outlet ? nullptr : filter.get();
+				if (data_protocol_version >= 110)
+					receive_bulk(buffer, *factory, reverse_byte_order, suppress_subnormals,
+						change_masks, renegotiation, local_filter);
+				else {
+					// protocol 1.00: decode samples one by one from the archive
+					double last_timestamp = 0.0;
+					double srate = conn_.current_srate();
+					for (int k = 0; !conn_.lost() && !conn_.shutdown() && !closing_stream_; k++) {
+						// allocate and fetch a new sample
+						const int64_t receive_start = trace::start();
+						sample_p samp(factory->new_sample(0.0, false));
 						*inarch >> *samp;
-					// deduce timestamp if necessary
-					if (samp->timestamp() == DEDUCED_TIMESTAMP) {
-						samp->timestamp() = last_timestamp;
-						if (srate != IRREGULAR_RATE) samp->timestamp() += 1.0 / srate;
+						// deduce timestamp if necessary
+						if (samp->timestamp() == DEDUCED_TIMESTAMP) {
+							samp->timestamp() = last_timestamp;
+							if (srate != IRREGULAR_RATE) samp->timestamp() += 1.0 / srate;
+						}
+						last_timestamp = samp->timestamp();
+						trace::span("receive_decode", receive_start, samp->timestamp());
+						// push it into the sample queue
+						if (!local_filter || local_filter->matches(*samp)) {
+							const int64_t enqueue_start = trace::start();
+							counters_.samples_received.fetch_add(1, std::memory_order_relaxed);
+							enqueue(&samp, 1);
+							trace::span("inlet_enqueue", enqueue_start, last_timestamp);
+						}
+						// periodically update the last receive time to keep the watchdog happy
+						if (srate <= 16 || (k & 0xF) == 0) conn_.update_receive_time(lsl_clock());
 					}
-					last_timestamp = samp->timestamp();
-					// push it into the sample queue
-					sample_queue_.push_sample(samp);
-					// periodically update the last receive time to keep the watchdog happy
-					if (srate <= 16 || (k & 0xF) == 0) conn_.update_receive_time(lsl_clock());
 				}
 			} catch (err_t) {
 				// connection-level error: closed, reset, refused, etc.
@@ -341,7 +521,8 @@ void data_receiver::data_thread() {
 				// some perhaps more serious transmission or parsing error (could be indicative of a
 				// protocol issue)
 				if (!conn_.shutdown())
-					LOG_F(ERROR, "Stream transmission broke off (%s); re-connecting...", e.what());
+					LSL_LOG_F(
+						ERROR, "Stream transmission broke off (%s); re-connecting...", e.what());
 				conn_.try_recover_from_error();
 			}
 			// wait for a few msec so as to not spam the provider with reconnects
@@ -350,9 +531,242 @@ void data_receiver::data_thread() {
 	} catch (lost_error &) {
 		// the connection was irrecoverably lost: since the pull_sample() function may
 		// be waiting for the next sample we need to wake it up by passing a sentinel
-		sample_queue_.push_sample(sample_p());
+		sample_queue_->push_sample(sample_p());
 	}
 	conn_.release_watchdog();
 }
 
+namespace {
+/**
+ * Decodes samples from consecutive blocks of received bytes.
+ *
+ * Samples are parsed directly from the blocks; only a sample that straddles two blocks is
+ * assembled in a small carry-over buffer.
+ */
+class sample_decoder {
+public:
+	sample_decoder(factory &fac, const stream_info_impl &info, double srate,
+		bool reverse_byte_order, bool suppress_subnormals, bool change_masks,
+		const sample_filter *filter)
+		: fac_(fac), srate_(srate), reverse_byte_order_(reverse_byte_order),
+		  suppress_subnormals_(suppress_subnormals), change_masks_(change_masks), filter_(filter),
+		  codec_(select_codec(info.channel_format(), static_cast<uint32_t>(info.channel_count()),
+			  reverse_byte_order, suppress_subnormals)),
+		  // strings have no upper bound, so incomplete string samples take the whole next block
+		  max_sample_size_(info.channel_format() == cft_string ? 0 : 9 + info.sample_bytes()) {}
+
+	/// Decode all complete samples in the block (and the carry-over) and append them to `out`
+	void decode(const char *pos, const char *end, std::vector<sample_p> &out) {
+		const int64_t receive_start = trace::start();
+		if (!tail_.empty()) {
+			// complete the sample that started in an earlier block
+			const std::size_t prev = tail_.size();
+			std::size_t take = end - pos;
+			if (max_sample_size_) take = std::min(take, max_sample_size_ - prev);
+			tail_.insert(tail_.end(), pos, pos + take);
+			const char *next = parse(tail_.data(), tail_.data() + tail_.size(), out, receive_start);
+			if (!next) return; // still incomplete, all bytes were taken
+			pos += (next - tail_.data()) - prev;
+			tail_.clear();
+		}
+		while (const char *next = parse(pos, end, out, receive_start)) pos = next;
+		tail_.assign(pos, end);
+	}
+
+private:
+	/// Decode one sample and append it to `out`, return nullptr if the range is incomplete
+	const char *parse(
+		const char *pos, const char *end, std::vector<sample_p> &out, int64_t receive_start) {
+		// an incomplete sample is reused for the next attempt
+		if (!samp_) samp_ = fac_.new_sample(0.0, false);
+		const char *next = codec_ ? samp_->load_buffer(pos, end, *codec_, previous_.get())
+								  : samp_->load_buffer(pos, end, reverse_byte_order_,
+										suppress_subnormals_, previous_.get());
+		if (!next) return nullptr;
+		// the next sample's unchanged channels are taken from this one, even if it's dropped
+		if (change_masks_) previous_ = samp_;
+		// deduce timestamp if necessary
+		if (samp_->timestamp() == DEDUCED_TIMESTAMP) {
+			samp_->timestamp() = last_timestamp_;
+			if (srate_ != IRREGULAR_RATE) samp_->timestamp() += 1.0 / srate_;
+		}
+		last_timestamp_ = samp_->timestamp();
+		trace::span("receive_decode", receive_start, last_timestamp_);
+		// a dropped sample is reused for the next one
+		if (!filter_ || filter_->matches(*samp_)) out.push_back(std::move(samp_));
+		return next;
+	}
+
+	factory &fac_;
+	const double srate_;
+	const bool reverse_byte_order_, suppress_subnormals_, change_masks_;
+	/// samples that don't match are dropped (if set)
+	const sample_filter *filter_;
+	/// the sample decoders for the connection's settings (numeric streams only)
+	const sample_codec *codec_;
+	/// the maximum size of a sample on the wire, 0 if unbounded
+	const std::size_t max_sample_size_;
+	double last_timestamp_{0.0};
+	sample_p samp_;
+	/// the last decoded sample (only with change masks)
+	sample_p previous_;
+	/// bytes of an incomplete sample at the end of the last block
+	std::vector<char> tail_;
+};
+
+/// A fixed set of byte blocks that are passed from a reader thread to a decoding thread
+class block_ring {
+public:
+	block_ring(std::size_t count, std::size_t block_size) : blocks_(count) {
+		for (std::size_t i = 0; i < count; ++i) {
+			blocks_[i].resize(block_size);
+			free_.push_back(i);
+		}
+	}
+
+	/// Get a free block to read into (blocks until one is available), -1 if stopped
+	int acquire() {
+		std::unique_lock<std::mutex> lock(mut_);
+		cv_.wait(lock, [this]() { return !free_.empty() || stopped_; });
+		if (stopped_) return -1;
+		const int idx = static_cast<int>(free_.front());
+		free_.pop_front();
+		return idx;
+	}
+
+	/// Pass a block with `len` bytes to the decoder
+	void submit(int idx, std::size_t len) {
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			full_.emplace_back(idx, len);
+		}
+		cv_.notify_all();
+	}
+
+	/// Get the next filled block (blocks until one is available), false if stopped and drained
+	bool next(int &idx, std::size_t &len) {
+		std::unique_lock<std::mutex> lock(mut_);
+		cv_.wait(lock, [this]() { return !full_.empty() || stopped_; });
+		if (full_.empty()) return false;
+		std::tie(idx, len) = full_.front();
+		full_.pop_front();
+		return true;
+	}
+
+	/// Return a decoded block
+	void release(int idx) {
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			free_.push_back(idx);
+		}
+		cv_.notify_all();
+	}
+
+	/// Wake up both sides and let them finish
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			stopped_ = true;
+		}
+		cv_.notify_all();
+	}
+
+	char *data(int idx) { return blocks_[idx].data(); }
+	std::size_t block_size() const { return blocks_.front().size(); }
+
+private:
+	std::vector<std::vector<char>> blocks_;
+	std::deque<std::size_t> free_;
+	std::deque<std::pair<int, std::size_t>> full_;
+	std::mutex mut_;
+	std::condition_variable cv_;
+	bool stopped_{false};
+};
+} // namespace
+
+void data_receiver::receive_bulk(cancellable_streambuf &buffer, factory &fac,
+	bool reverse_byte_order, bool suppress_subnormals, bool change_masks, bool renegotiation,
+	const sample_filter *filter) {
+	const stream_info_impl &info = conn_.type_info();
+	const double srate = conn_.current_srate();
+	sample_decoder decoder(
+		fac, info, srate, reverse_byte_order, suppress_subnormals, change_masks, filter);
+	// large enough for several samples so that each read returns a sizeable batch
+	const std::size_t block_size =
+		std::max<std::size_t>(1 << 16, 4 * (9 + static_cast<std::size_t>(info.sample_bytes())));
+	std::vector<sample_p> batch;
+
+	auto read_block = [&](char *dst) {
+		// tell the outlet about a resized buffer before waiting for more data
+		if (const int update = renegotiation ? outlet_buflen_update_.exchange(0) : 0)
+			std::ostream(&buffer) << "Max-Buffer-Length: " << update << "\r\n" << std::flush;
+		const std::size_t len = buffer.read_some(dst, block_size);
+		if (!len) {
+			if (buffer.error() && buffer.error() != asio::error::would_block) throw buffer.error();
+			throw std::runtime_error("Input stream error.");
+		}
+		return len;
+	};
+	auto publish = [&]() {
+		if (batch.empty()) return;
+		const int64_t enqueue_start = trace::start();
+		const double first_timestamp = batch.front()->timestamp();
+		counters_.samples_received.fetch_add(batch.size(), std::memory_order_relaxed);
+		enqueue(batch.data(), batch.size());
+		trace::span("inlet_enqueue", enqueue_start, first_timestamp,
+			static_cast<uint32_t>(batch.size()));
+		batch.clear();
+		// keep the watchdog happy
+		conn_.update_receive_time(lsl_clock());
+	};
+
+	const double threshold = api_config::get_instance()->inlet_decode_thread_threshold();
+	if (threshold <= 0 || srate == IRREGULAR_RATE || srate * info.sample_bytes() < threshold) {
+		// read and decode in this thread
+		std::vector<char> block(block_size);
+		while (!conn_.lost() && !conn_.shutdown() && !closing_stream_) {
+			const std::size_t len = read_block(block.data());
+			decoder.decode(block.data(), block.data() + len, batch);
+			publish();
+		}
+		return;
+	}
+
+	// this thread only drains the socket, a second thread decodes the blocks in order
+	block_ring ring(16, block_size);
+	std::exception_ptr decode_error;
+	std::thread decode_thread([&]() {
+		loguru::set_thread_name((std::string("D_") += info.name().substr(0, 12)).c_str());
+		try {
+			int idx;
+			std::size_t len;
+			while (ring.next(idx, len)) {
+				decoder.decode(ring.data(idx), ring.data(idx) + len, batch);
+				ring.release(idx);
+				publish();
+			}
+		} catch (std::exception &) {
+			decode_error = std::current_exception();
+			ring.stop();
+		}
+	});
+	{
+		// on exit, let the decoder finish the blocks already received
+		struct join_guard {
+			block_ring &ring;
+			std::thread &thread;
+			~join_guard() {
+				ring.stop();
+				thread.join();
+			}
+		} guard{ring, decode_thread};
+		while (!conn_.lost() && !conn_.shutdown() && !closing_stream_) {
+			const int idx = ring.acquire();
+			if (idx < 0) break; // the decoder failed
+			ring.submit(idx, read_block(ring.data(idx)));
+		}
+	}
+	if (decode_error) std::rethrow_exception(decode_error);
+}
+
 } // namespace lsl
@@ -5,15 +5,20 @@
 #include "common.h"
 #include "consumer_queue.h"
 #include "forward.h"
+#include "stats.h"
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
 
 namespace lsl {
 
 class inlet_connection; // Forward declaration
+class cancellable_streambuf;
+class sample_filter;
 
 /** Internal class of an inlet that's retrieving the data (the samples) of the inlet.
  *
@@ -36,8 +41,13 @@ public:
 	 * (the default corresponds to the chunk sizes used by the sender). Recording applications can
 	 * use a generous size here (leaving it to the network how to pack things), while real-time
 	 * applications may want a finer (perhaps 1-sample) granularity.
+	 * @param adaptive_buffer Whether max_buflen is only an upper bound. The buffer then starts small
+	 * (see api_config::adaptive_buffer_min()), grows before it overflows and shrinks if the
+	 * samples waiting to be pulled only take up a fraction of it; each new length is also
+	 * requested from the outlet for its buffer.
 	 */
-	data_receiver(inlet_connection &conn, int max_buflen = 360, int max_chunklen = 0);
+	data_receiver(inlet_connection &conn, int max_buflen = 360, int max_chunklen = 0,
+		bool adaptive_buffer = false);
 
 	/// Destructor. Stops the background activities.
 	~data_receiver() final;
@@ -66,22 +76,70 @@ public:
 	template <class T>
 	double pull_sample_typed(T *buffer, uint32_t buffer_elements, double timeout = FOREVER);
 
+	/// Retrieve a sample and scatter its values (converted to T) into an application buffer.
+	template <class T>
+	double pull_sample_strided(char *buffer, const channel_layout &layout, double timeout = FOREVER);
+
 	/// Read sample from the inlet and read it into a pointer to raw data.
 	double pull_sample_untyped(void *buffer, int buffer_bytes, double timeout = FOREVER);
 
 	/// Check whether the underlying buffer is empty. This value may be inaccurate.
-	bool empty() { return sample_queue_.empty(); }
+	bool empty() { return queue()->empty(); }
 
-	std::size_t samples_available() { return sample_queue_.read_available(); }
+	std::size_t samples_available() { return queue()->read_available(); }
 
 	/// Flush the queue, return the number of dropped samples
-	uint32_t flush() noexcept { return sample_queue_.flush(); }
+	uint32_t flush() noexcept { return queue()->flush(); }
+
+	/// Fill in the data-related fields of the inlet statistics.
+	void get_stats(lsl_inlet_stats &stats) const;
+
+	/**
+	 * Only receive samples that match a filter expression (see sample_filter), or all samples if
+	 * the expression is empty.
+	 *
+	 * The outlet drops non-matching samples before sending them; outlets that don't support
+	 * filtering send all samples and the inlet drops them instead. The filter applies to
+	 * connections established afterwards, so it should be set before the stream is opened.
+	 * @throws std::invalid_argument if the expression is invalid for this stream.
+	 */
+	void set_sample_filter(const std::string &expression);
+
+	/**
+	 * Get the next sample as received (with resolved time stamps, but no post-processing).
+	 * @return The sample or nullptr if the timeout expired.
+	 * @throws lost_error if the stream source has been lost.
+	 */
+	sample_p try_get_next_sample(double timeout);
 
 private:
 	/// The data reader thread.
 	void data_thread();
 
-	sample_p try_get_next_sample(double timeout);
+	/**
+	 * Receive samples (protocol 1.10) until the stream is closed or the connection breaks.
+	 *
+	 * Reads large blocks from the socket into a reusable buffer, decodes all complete samples in
+	 * it and publishes them to the sample queue as one batch. Incomplete samples at the end of a
+	 * block are carried over to the next read.
+	 * With `change_masks`, samples may only contain the channels that changed since the previous
+	 * sample (see sample::save_changes()).
+	 */
+	void receive_bulk(cancellable_streambuf &buffer, factory &fac, bool reverse_byte_order,
+		bool suppress_subnormals, bool change_masks, bool renegotiation,
+		const sample_filter *filter);
+
+	/// The current sample queue (only replaced with an adaptive buffer)
+	std::shared_ptr<consumer_queue> queue() const;
+
+	/// Push received samples into the sample queue (data thread only)
+	void enqueue(sample_p *samples, std::size_t n);
+
+	/// Grow or shrink an adaptive buffer before `incoming` samples are pushed
+	void adapt_capacity(std::size_t incoming);
+
+	/// Replace the sample queue with one of a different capacity, keeping the queued samples
+	void resize_queue(std::size_t capacity);
 
 	/// the underlying connection
 	inlet_connection &conn_;
@@ -97,8 +155,15 @@ private:
 	std::atomic<bool> closing_stream_;
 	/// whether the stream has been connected / opened
 	bool connected_;
-	/// queue of samples ready to be picked up (populated by the data thread)
-	consumer_queue sample_queue_;
+	/// queue of samples ready to be picked up (populated and, if adaptive, replaced by the data
+	/// thread)
+	std::shared_ptr<consumer_queue> sample_queue_;
+	/// protects replacing the sample queue, held by adaptive consumers while they pop
+	mutable std::mutex queue_mut_;
+	/// number of samples dropped by replaced sample queues
+	std::atomic<uint64_t> retired_dropped_{0};
+	/// runtime statistics (updated by the data thread)
+	inlet_counters counters_;
 	/// mutex to protect the connected state
 	std::mutex connected_mut_;
 	/// condition variable to indicate that an update for the connected state is available
@@ -109,6 +174,22 @@ private:
 	int max_buflen_;
 	// the desired maximum chunklen for received samples
 	int max_chunklen_;
+
+	// adaptive buffer state (only used by the data thread, except for the capacity)
+	const bool adaptive_;
+	/// the smallest capacity an adaptive buffer shrinks to
+	std::size_t min_capacity_;
+	/// the current capacity of the sample queue
+	std::atomic<std::size_t> capacity_;
+	/// start of the current observation window, the most samples waiting in it, the samples
+	/// waiting at its start and the samples received during it
+	double window_start_;
+	std::size_t window_peak_{0}, window_start_depth_{0};
+	uint64_t window_received_{0};
+	/// a buffer length the outlet hasn't been told about yet (0: none)
+	std::atomic<int> outlet_buflen_update_{0};
+	/// the sample filter requested from the outlet (if any); protected by connected_mut_
+	std::shared_ptr<const sample_filter> filter_;
 };
 
 } // namespace lsl
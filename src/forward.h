@@ -24,7 +24,9 @@ using sample_p = lslboost::intrusive_ptr<class sample>;
 using send_buffer_p = std::shared_ptr<class send_buffer>;
 using stream_info_impl_p = std::shared_ptr<class stream_info_impl>;
 using io_context_p = std::shared_ptr<asio::io_context>;
+using record_layout_p = std::shared_ptr<const class record_layout>;
 using string_p = std::shared_ptr<std::string>;
 using tcp_server_p = std::shared_ptr<class tcp_server>;
 using udp_server_p = std::shared_ptr<class udp_server>;
+struct sample_codec;
 } // namespace lsl
@@ -1,6 +1,7 @@
 #include "info_receiver.h"
 #include "cancellable_streambuf.h"
 #include "inlet_connection.h"
+#include "logging.h"
 #include "stream_info_impl.h"
 #include <chrono>
 #include <exception>
@@ -19,8 +20,8 @@ lsl::info_receiver::~info_receiver() {
 		conn_.unregister_onlost(this);
 		if (info_thread_.joinable()) info_thread_.join();
 	} catch (std::exception &e) {
-		LOG_F(ERROR, "Unexpected error during destruction of an info_receiver: %s", e.what());
-	} catch (...) { LOG_F(ERROR, "Severe error during info receiver shutdown."); }
+		LSL_LOG_F(ERROR, "Unexpected error during destruction of an info_receiver: %s", e.what());
+	} catch (...) { LSL_LOG_F(ERROR, "Severe error during info receiver shutdown."); }
 }
 
 const lsl::stream_info_impl &lsl::info_receiver::info(double timeout) {
@@ -52,10 +53,11 @@ void lsl::info_receiver::info_thread() {
 				buffer.register_at(&conn_);
 				std::iostream server_stream(&buffer);
 				// connect...
-				if (nullptr == buffer.connect(conn_.get_tcp_endpoint()))
+				if (nullptr == buffer.connect(conn_.get_tcp_endpoints()))
 				{
 					throw asio::system_error(buffer.error());
 				}
+				conn_.endpoint_connected(buffer.remote_endpoint());
 				// send the query
 				server_stream << "LSL:fullinfo\r\n" << std::flush;
 				// receive and parse the response
@@ -78,7 +80,8 @@ void lsl::info_receiver::info_thread() {
 				conn_.try_recover_from_error();
 			} catch (std::exception &e) {
 				// parsing-level error: intermittent disconnect or invalid protocol
-				LOG_F(ERROR, "Error while receiving the stream info (%s); retrying...", e.what());
+				LSL_LOG_F(
+					ERROR, "Error while receiving the stream info (%s); retrying...", e.what());
 				conn_.try_recover_from_error();
 			}
 		}
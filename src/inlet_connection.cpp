@@ -1,6 +1,8 @@
 #include "inlet_connection.h"
 #include "api_config.h"
+#include "logging.h"
 #include "resolver_impl.h"
+#include <algorithm>
 #include <asio/io_context.hpp>
 #include <asio/ip/address.hpp>
 #include <asio/ip/basic_resolver.hpp>
@@ -37,7 +39,7 @@ inlet_connection::inlet_connection(const stream_info_impl &info, bool recover)
 
 		if (recovery_enabled_ && type_info_.source_id().empty()) {
 			// we cannot correctly recover streams which don't have a unique source id
-			LOG_F(WARNING,
+			LSL_LOG_F(WARNING,
 				"The stream named '%s' can't be recovered automatically if its provider crashes "
 				"because it doesn't have a unique source ID",
 				host_info_.name().c_str());
@@ -123,8 +125,45 @@ tcp::endpoint inlet_connection::get_tcp_endpoint() {
 	return {resolve_v6_addr(addr), port};
 }
 
+std::vector<tcp::endpoint> inlet_connection::get_tcp_endpoints() {
+	std::vector<tcp::endpoint> endpoints{get_tcp_endpoint()};
+	const auto *cfg = api_config::get_instance();
+	shared_lock_t lock(host_info_mut_);
+	std::vector<std::string> candidates{preferred_address_};
+	candidates.insert(
+		candidates.end(), host_info_.addresses().begin(), host_info_.addresses().end());
+	for (const auto &candidate : candidates) {
+		asio::error_code ec;
+		auto addr = ip::make_address(candidate, ec);
+		if (ec || (addr.is_v4() && !cfg->allow_ipv4()) || (addr.is_v6() && !cfg->allow_ipv6()))
+			continue;
+		tcp::endpoint endpoint(
+			addr, addr.is_v4() ? host_info_.v4data_port() : host_info_.v6data_port());
+		if (endpoint.port() == 0 ||
+			std::find(endpoints.begin(), endpoints.end(), endpoint) != endpoints.end())
+			continue;
+		if (candidate == preferred_address_)
+			endpoints.insert(endpoints.begin(), endpoint);
+		else
+			endpoints.push_back(endpoint);
+	}
+	return endpoints;
+}
+
+void inlet_connection::endpoint_connected(const tcp::endpoint &endpoint) {
+	unique_lock_t lock(host_info_mut_);
+	preferred_address_ = endpoint.address().to_string();
+}
+
 udp::endpoint inlet_connection::get_udp_endpoint() {
 	shared_lock_t lock(host_info_mut_);
+	if (!preferred_address_.empty()) {
+		// use the address the data connection was established to if it has the right IP version
+		asio::error_code ec;
+		auto addr = ip::make_address(preferred_address_, ec);
+		if (!ec && addr.is_v4() == (udp_protocol_ == udp::v4()))
+			return {addr, addr.is_v4() ? host_info_.v4service_port() : host_info_.v6service_port()};
+	}
 	if (udp_protocol_ == udp::v4())
 		return {ip::make_address(host_info_.v4address()), host_info_.v4service_port()};
 
@@ -139,6 +178,16 @@ std::string inlet_connection::current_uid() {
 	return host_info_.uid();
 }
 
+std::string inlet_connection::current_hostname() {
+	shared_lock_t lock(host_info_mut_);
+	return host_info_.hostname();
+}
+
+std::string inlet_connection::current_boot_id() {
+	shared_lock_t lock(host_info_mut_);
+	return host_info_.boot_id();
+}
+
 double inlet_connection::current_srate() {
 	shared_lock_t lock(host_info_mut_);
 	return host_info_.nominal_srate();
@@ -196,6 +245,7 @@ void inlet_connection::try_recover() {
 							throw std::logic_error("No suitable protocol found in discovery");
 						// update the endpoint
 						host_info_ = infos[0];
+						preferred_address_.clear();
 						// cancel all cancellable operations registered with this connection
 						cancel_all_registered();
 						// invoke any callbacks associated with a connection recovery
@@ -211,7 +261,7 @@ void inlet_connection::try_recover() {
 						// user code and make its source_id unique, or remove the source_id
 						// altogether if that's not possible (therefore disabling the ability to
 						// recover)
-						LOG_F(WARNING,
+						LSL_LOG_F(WARNING,
 							"Found multiple streams with name='%s' and source_id='%s'. "
 							"Cannot recover unless all but one are closed.",
 							host_info_.name().c_str(), host_info_.source_id().c_str());
@@ -223,7 +273,7 @@ void inlet_connection::try_recover() {
 				break;
 			}
 		} catch (std::exception &e) {
-			LOG_F(ERROR, "A recovery attempt encountered an unexpected error: %s", e.what());
+			LSL_LOG_F(ERROR, "A recovery attempt encountered an unexpected error: %s", e.what());
 		}
 	}
 }
@@ -271,7 +321,7 @@ void inlet_connection::watchdog_thread() {
 					[this]() { return shutdown(); });
 			}
 		} catch (std::exception &e) {
-			LOG_F(ERROR, "Unexpected hiccup in the watchdog thread: %s", e.what());
+			LSL_LOG_F(ERROR, "Unexpected hiccup in the watchdog thread: %s", e.what());
 		}
 	}
 }
@@ -286,7 +336,7 @@ void inlet_connection::try_recover_from_error() {
 				std::lock_guard<std::mutex> lock(client_status_mut_);
 				for (auto &pair : onlost_) pair.second->notify_all();
 			} catch (std::exception &e) {
-				LOG_F(ERROR,
+				LSL_LOG_F(ERROR,
 					"Unexpected problem while trying to issue a connection loss notification: %s",
 					e.what());
 			}
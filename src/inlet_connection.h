@@ -81,6 +81,18 @@ public:
 	/// Get the current UDP endpoint from the info (according to our configured protocol).
 	udp::endpoint get_udp_endpoint();
 
+	/**
+	 * Get all TCP endpoints the outlet might be reachable at, most promising first.
+	 *
+	 * The address that was last connected to successfully comes first, then the endpoint
+	 * returned by get_tcp_endpoint() and then all other addresses the outlet replied from during
+	 * discovery (in the order of their replies) for all allowed IP versions.
+	 */
+	std::vector<tcp::endpoint> get_tcp_endpoints();
+
+	/// Remember the endpoint a connection was established to so it's tried first next time.
+	void endpoint_connected(const tcp::endpoint &endpoint);
+
 	/// Get the UDP protocol type.
 	udp udp_protocol() const { return udp_protocol_; }
 
@@ -143,6 +155,12 @@ public:
 	/// the data source).
 	std::string current_uid();
 
+	/// Get the current host name of the stream (might change if the connection is rehosted)
+	std::string current_hostname();
+
+	/// Get the boot id of the current host of the stream (empty if the host doesn't send it)
+	std::string current_boot_id();
+
 	/// Get the nominal srate of the endpoint; we assume that this might possibly change between
 	/// crashes/restarts of the data source under some circumstances (although such behavior would
 	/// be strongly discouraged).
@@ -166,6 +184,8 @@ private:
 	stream_info_impl host_info_;
 	/// a mutex to protect the state of the host_info (single-write/multiple-reader)
 	shared_mutex_t host_info_mut_;
+	/// the address of the last successful connection (if any); protected by host_info_mut_
+	std::string preferred_address_;
 	/// the TCP protocol used (according to api_config)
 	tcp tcp_protocol_;
 	/// the UDP protocol used (according to api_config)
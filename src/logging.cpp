@@ -0,0 +1,226 @@
+#include "logging.h"
+#include "common.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lsl {
+namespace logging {
+
+bool rate_limit::admit(uint32_t &suppressed) noexcept {
+	const int64_t now = lsl_local_clock_ns();
+	int64_t start = window_start_.load(std::memory_order_relaxed);
+	// the first thread to see that the window has ended starts the next one
+	if (now - start >= window_ns &&
+		window_start_.compare_exchange_strong(start, now, std::memory_order_relaxed))
+		count_.store(0, std::memory_order_relaxed);
+	if (count_.fetch_add(1, std::memory_order_relaxed) >= burst) {
+		suppressed_.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+	return true;
+}
+
+namespace {
+
+struct message {
+	loguru::Verbosity verbosity;
+	unsigned line;
+	const char *file;
+	uint32_t suppressed;
+	char thread[20];
+	char text[472];
+};
+
+/// number of messages per thread, must be a power of two
+constexpr uint32_t ring_size = 32;
+
+/// The writer's polling interval right after it has written messages
+constexpr std::chrono::milliseconds min_interval{10};
+/// The writer's polling interval when no messages have arrived for a while
+constexpr std::chrono::milliseconds max_interval{500};
+
+/// A single-producer, single-consumer ring buffer of messages, written by one thread
+struct thread_ring {
+	void push(loguru::Verbosity verbosity, const char *file, unsigned line, uint32_t suppressed,
+		const char *format, va_list args) noexcept {
+		const uint32_t h = head.load(std::memory_order_relaxed);
+		if (h - tail.load(std::memory_order_acquire) == ring_size) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		message &m = messages[h & (ring_size - 1)];
+		m.verbosity = verbosity;
+		m.file = file;
+		m.line = line;
+		m.suppressed = suppressed;
+		loguru::get_thread_name(m.thread, sizeof(m.thread), false);
+		if (std::vsnprintf(m.text, sizeof(m.text), format, args) >= int(sizeof(m.text)))
+			std::memcpy(m.text + sizeof(m.text) - 4, "...", 4);
+		head.store(h + 1, std::memory_order_release);
+	}
+
+	/// Hand the queued messages to loguru, returns whether there were any
+	bool drain() {
+		uint32_t t = tail.load(std::memory_order_relaxed);
+		const uint32_t h = head.load(std::memory_order_acquire);
+		bool any = t != h;
+		// the slot is handed back to the producer after each message, so its name is copied
+		char thread[sizeof(message::thread)] = "?";
+		for (; t != h; ++t) {
+			const message &m = messages[t & (ring_size - 1)];
+			std::memcpy(thread, m.thread, sizeof(thread));
+			if (m.suppressed)
+				loguru::log(m.verbosity, m.file, m.line, "[%s] %s (%u similar messages suppressed)",
+					m.thread, m.text, m.suppressed);
+			else
+				loguru::log(m.verbosity, m.file, m.line, "[%s] %s", m.thread, m.text);
+			tail.store(t + 1, std::memory_order_release);
+		}
+		if (const uint32_t n = dropped.exchange(0, std::memory_order_relaxed)) {
+			loguru::log(loguru::Verbosity_WARNING, __FILE__, __LINE__,
+				"[%s] %u messages were dropped because the log buffer was full", thread, n);
+			any = true;
+		}
+		return any;
+	}
+
+	std::atomic<uint32_t> head{0}, tail{0}, dropped{0};
+	std::atomic<bool> alive{true};
+	message messages[ring_size];
+};
+
+/// State shared by all logging threads and the writer
+struct log_state {
+	/// guards `rings`, only locked once per thread and briefly by the writer
+	std::mutex registry_mut;
+	std::vector<std::shared_ptr<thread_ring>> rings;
+	bool writer_started{false};
+
+	/// held by whoever takes messages out of the rings
+	std::mutex drain_mut;
+	std::condition_variable writer_cv;
+	std::vector<std::shared_ptr<thread_ring>> draining;
+	/// set when the program exits, afterwards messages are written synchronously
+	std::atomic<bool> stopped{false};
+};
+
+/// Never destroyed, because threads may still log while the program exits
+log_state &state() {
+	static auto *s = new log_state();
+	return *s;
+}
+
+/// Write the queued messages of all threads, returns whether there were any (needs drain_mut)
+bool drain(log_state &s) {
+	{
+		std::lock_guard<std::mutex> lock(s.registry_mut);
+		// rings of exited threads aren't written to anymore and can be released once empty
+		s.rings.erase(std::remove_if(s.rings.begin(), s.rings.end(),
+						  [](const std::shared_ptr<thread_ring> &ring) {
+							  return !ring->alive.load(std::memory_order_acquire) &&
+									 ring->head.load(std::memory_order_acquire) ==
+										 ring->tail.load(std::memory_order_relaxed);
+						  }),
+			s.rings.end());
+		s.draining = s.rings;
+	}
+	bool any = false;
+	for (auto &ring : s.draining) any |= ring->drain();
+	return any;
+}
+
+void writer_loop(log_state &s) {
+	loguru::set_thread_name("lsl_log");
+	auto interval = min_interval;
+	std::unique_lock<std::mutex> lock(s.drain_mut);
+	while (true) {
+		s.writer_cv.wait_for(lock, interval);
+		if (s.stopped.load(std::memory_order_relaxed)) break;
+		interval = drain(s) ? min_interval : std::min(interval * 2, max_interval);
+	}
+}
+
+/// Writes the remaining messages when the program exits
+struct flush_at_exit {
+	~flush_at_exit() {
+		auto &s = state();
+		std::lock_guard<std::mutex> lock(s.drain_mut);
+		s.stopped.store(true, std::memory_order_relaxed);
+		drain(s);
+		s.writer_cv.notify_all();
+	}
+};
+
+/// Start the writer with the first thread that logs something (needs registry_mut)
+void start_writer(log_state &s) {
+	if (s.writer_started) return;
+	s.writer_started = true;
+	// constructed after loguru's state, so it's destroyed (and flushes) before it
+	static flush_at_exit at_exit;
+	try {
+		// the writer only touches the never destroyed state, so it doesn't have to be joined
+		std::thread(writer_loop, std::ref(s)).detach();
+	} catch (std::exception &) { s.stopped.store(true, std::memory_order_relaxed); }
+}
+
+/// Per-thread handle that marks its ring as orphaned when the thread exits
+struct ring_handle {
+	std::shared_ptr<thread_ring> ring;
+	~ring_handle() {
+		if (ring) ring->alive.store(false, std::memory_order_release);
+	}
+};
+
+thread_ring *this_thread_ring() noexcept {
+	thread_local ring_handle handle;
+	if (handle.ring) return handle.ring.get();
+	try {
+		auto &s = state();
+		auto ring = std::make_shared<thread_ring>();
+		std::lock_guard<std::mutex> lock(s.registry_mut);
+		s.rings.push_back(ring);
+		start_writer(s);
+		handle.ring = std::move(ring);
+		return handle.ring.get();
+	} catch (std::exception &) {
+		// allocating the ring failed, try again with the next message
+		return nullptr;
+	}
+}
+
+} // namespace
+
+void write(rate_limit &limit, loguru::Verbosity verbosity, const char *file, unsigned line,
+	const char *format, ...) noexcept {
+	va_list args;
+	va_start(args, format);
+	uint32_t suppressed = 0;
+	// fatal messages abort the program, so they are written right away
+	if (verbosity <= loguru::Verbosity_FATAL || state().stopped.load(std::memory_order_relaxed))
+		loguru::vlog(verbosity, file, line, format, args);
+	else if (limit.admit(suppressed)) {
+		if (thread_ring *ring = this_thread_ring())
+			ring->push(verbosity, file, line, suppressed, format, args);
+	}
+	va_end(args);
+}
+
+void flush() noexcept {
+	auto &s = state();
+	try {
+		std::lock_guard<std::mutex> lock(s.drain_mut);
+		drain(s);
+	} catch (std::exception &) {}
+}
+
+} // namespace logging
+} // namespace lsl
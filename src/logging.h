@@ -0,0 +1,88 @@
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <atomic>
+#include <cstdint>
+#include <loguru.hpp>
+
+/**
+ * @file logging.h
+ * Asynchronous logging for the library's threads.
+ *
+ * LSL_LOG_F() takes the same arguments as loguru's LOG_F(), but the calling thread only formats
+ * the message into its own fixed-size ring buffer. A background thread takes the messages from
+ * all rings and hands them to loguru, so file and console I/O never stall a data thread.
+ * Messages of one thread keep their order, but messages of different threads may be
+ * interleaved differently than they were logged. The thread names are prepended to the messages,
+ * as loguru's preamble shows the background thread. If a thread's ring is full, its messages are
+ * dropped and the number of dropped messages is logged later on.
+ *
+ * Each call site logs at most `rate_limit::burst` messages per second; the number of
+ * suppressed messages is appended to the next message from the same call site.
+ *
+ * Messages more verbose than LSL_LOG_MAX_VERBOSITY aren't compiled in at all.
+ */
+
+/// The most verbose level that's compiled into the library (see loguru::Verbosity)
+#ifndef LSL_LOG_MAX_VERBOSITY
+#define LSL_LOG_MAX_VERBOSITY 9
+#endif
+
+namespace lsl {
+namespace logging {
+
+/// Rate limit for the messages from one call site, shared by all threads
+class rate_limit {
+public:
+	/// The number of messages per window
+	static constexpr uint32_t burst = 10;
+	/// The window length in ns
+	static constexpr int64_t window_ns = 1000000000;
+
+	constexpr rate_limit() noexcept = default;
+
+	/**
+	 * Check whether another message may be logged.
+	 * @param[out] suppressed The number of messages that were suppressed since the last one.
+	 */
+	bool admit(uint32_t &suppressed) noexcept;
+
+private:
+	std::atomic<int64_t> window_start_{0};
+	std::atomic<uint32_t> count_{0}, suppressed_{0};
+};
+
+/// Queue a message for the background writer (use LSL_LOG_F() instead)
+void write(rate_limit &limit, loguru::Verbosity verbosity, const char *file, unsigned line,
+	const char *format, ...) noexcept LOGURU_PRINTF_LIKE(5, 6);
+
+/// Write all queued messages before returning
+void flush() noexcept;
+
+} // namespace logging
+} // namespace lsl
+
+/// Log a message asynchronously; the verbosity has to be a constant expression
+#define LSL_VLOG_F(verbosity, ...)                                                                 \
+	do {                                                                                           \
+		if constexpr ((verbosity) <= LSL_LOG_MAX_VERBOSITY) {                                      \
+			if ((verbosity) <= loguru::current_verbosity_cutoff()) {                               \
+				static lsl::logging::rate_limit lsl_log_limit_;                                    \
+				lsl::logging::write(lsl_log_limit_, verbosity, __FILE__, __LINE__, __VA_ARGS__);   \
+			}                                                                                      \
+		}                                                                                          \
+	} while (false)
+
+/// Log a message asynchronously, e.g. LSL_LOG_F(WARNING, "Lost connection to %s", name)
+#define LSL_LOG_F(verbosity_name, ...) LSL_VLOG_F(loguru::Verbosity_##verbosity_name, __VA_ARGS__)
+
+/// Log a message asynchronously in debug builds (see LSL_DEBUGLOG) only
+#if LOGURU_DEBUG_LOGGING
+#define LSL_DLOG_F(verbosity_name, ...) LSL_LOG_F(verbosity_name, __VA_ARGS__)
+#else
+#define LSL_DLOG_F(verbosity_name, ...)                                                            \
+	do {                                                                                           \
+	} while (false)
+#endif
+
+#endif
@@ -1,8 +1,9 @@
+#include "logging.h"
 #include "lsl_c_api_helpers.hpp"
 #include "stream_inlet_impl.h"
 #include <cstdlib>
 #include <exception>
-#include <loguru.hpp>
+#include <new>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -18,8 +19,8 @@ LIBLSL_C_API lsl_inlet lsl_create_inlet_ex(lsl_streaminfo info, int32_t max_bufl
 	int32_t max_chunklen, int32_t recover, lsl_transport_options_t flags) {
 	try {
 		int32_t buf_samples = info->calc_transport_buf_samples(max_buflen, flags);
-		return create_object_noexcept<stream_inlet_impl>(
-			*info, buf_samples, max_chunklen, recover != 0);
+		return create_object_noexcept<stream_inlet_impl>(*info, buf_samples, max_chunklen,
+			recover != 0, (flags & transp_adaptive_buffer) != 0);
 	}
 	LSLCATCHANDSTORE(nullptr, std::invalid_argument, lsl_argument_error);
 	return nullptr;
@@ -32,7 +33,9 @@ LIBLSL_C_API lsl_inlet lsl_create_inlet(
 LIBLSL_C_API void lsl_destroy_inlet(lsl_inlet in) {
 	try {
 		delete in;
-	} catch (std::exception &e) { LOG_F(ERROR, "Unexpected error in %s: %s", __func__, e.what()); }
+	} catch (std::exception &e) {
+		LSL_LOG_F(ERROR, "Unexpected error in %s: %s", __func__, e.what());
+	}
 }
 
 LIBLSL_C_API lsl_streaminfo lsl_get_fullinfo(lsl_inlet in, double timeout, int32_t *ec) {
@@ -53,7 +56,9 @@ LIBLSL_C_API void lsl_open_stream(lsl_inlet in, double timeout, int32_t *ec) {
 LIBLSL_C_API void lsl_close_stream(lsl_inlet in) {
 	try {
 		in->close_stream();
-	} catch (std::exception &e) { LOG_F(ERROR, "Unexpected error in %s: %s", __func__, e.what()); }
+	} catch (std::exception &e) {
+		LSL_LOG_F(ERROR, "Unexpected error in %s: %s", __func__, e.what());
+	}
 }
 
 LIBLSL_C_API double lsl_time_correction(lsl_inlet in, double timeout, int32_t *ec) {
@@ -278,6 +283,41 @@ LIBLSL_C_API unsigned long lsl_pull_chunk_buf(lsl_inlet in, char **data_buffer,
 	return 0;
 }
 
+LIBLSL_C_API unsigned long lsl_pull_chunk_strided(lsl_inlet in, void *data,
+	lsl_channel_format_t data_format, unsigned long max_samples, int32_t sample_stride,
+	int32_t channel_stride, const int32_t *channel_offsets, double *timestamp_buffer,
+	double timeout, int32_t *ec) {
+	if (ec) *ec = lsl_no_error;
+	try {
+		if (data_format == cft_string || data_format <= cft_undefined || data_format > cft_int64)
+			throw std::invalid_argument("Strided data must have a numeric format.");
+		const channel_layout layout{
+			channel_stride ? channel_stride : format_sizes[data_format], channel_offsets};
+		switch (data_format) {
+		case cft_float32:
+			return in->pull_chunk_strided<float>(
+				data, max_samples, sample_stride, layout, timestamp_buffer, timeout);
+		case cft_double64:
+			return in->pull_chunk_strided<double>(
+				data, max_samples, sample_stride, layout, timestamp_buffer, timeout);
+		case cft_int8:
+			return in->pull_chunk_strided<char>(
+				data, max_samples, sample_stride, layout, timestamp_buffer, timeout);
+		case cft_int16:
+			return in->pull_chunk_strided<int16_t>(
+				data, max_samples, sample_stride, layout, timestamp_buffer, timeout);
+		case cft_int32:
+			return in->pull_chunk_strided<int32_t>(
+				data, max_samples, sample_stride, layout, timestamp_buffer, timeout);
+		default:
+			return in->pull_chunk_strided<int64_t>(
+				data, max_samples, sample_stride, layout, timestamp_buffer, timeout);
+		}
+	}
+	LSL_STORE_EXCEPTION_IN(ec)
+	return 0;
+}
+
 LIBLSL_C_API uint32_t lsl_samples_available(lsl_inlet in) {
 	try {
 		return (uint32_t)in->samples_available();
@@ -294,6 +334,35 @@ LIBLSL_C_API uint32_t lsl_was_clock_reset(lsl_inlet in) {
 	} catch (std::exception &) { return 0; }
 }
 
+LIBLSL_C_API int32_t lsl_inlet_get_stats(lsl_inlet in, lsl_inlet_stats *stats) {
+	if (!stats) return lsl_argument_error;
+	try {
+		*stats = in->get_stats();
+		return lsl_no_error;
+	} catch (std::exception &) { return lsl_internal_error; }
+}
+
+LIBLSL_C_API char *lsl_inlet_export_state(lsl_inlet in, int32_t *ec) {
+	if (ec) *ec = lsl_no_error;
+	try {
+		std::string state = in->export_state();
+		char *result = (char *)malloc(state.size() + 1);
+		if (result == nullptr) throw std::bad_alloc();
+		memcpy(result, state.c_str(), state.size() + 1);
+		return result;
+	} LSL_STORE_EXCEPTION_IN(ec)
+	return nullptr;
+}
+
+LIBLSL_C_API int32_t lsl_inlet_import_state(lsl_inlet in, const char *state, int32_t *ec) {
+	if (ec) *ec = lsl_no_error;
+	try {
+		if (!state) throw std::invalid_argument("No inlet state given.");
+		return in->import_state(state) ? 1 : 0;
+	} LSL_STORE_EXCEPTION_IN(ec)
+	return 0;
+}
+
 LIBLSL_C_API int32_t lsl_smoothing_halftime(lsl_inlet in, float value) {
 	try {
 		in->smoothing_halftime(value);
@@ -302,4 +371,11 @@ LIBLSL_C_API int32_t lsl_smoothing_halftime(lsl_inlet in, float value) {
 		return lsl_internal_error;
 	}
 }
+
+LIBLSL_C_API int32_t lsl_set_sample_filter(lsl_inlet in, const char *filter) {
+	try {
+		in->set_sample_filter(filter ? filter : "");
+	}
+	LSL_RETURN_CAUGHT_EC;
+}
 }
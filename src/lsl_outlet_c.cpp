@@ -1,6 +1,7 @@
+#include "logging.h"
 #include "lsl_c_api_helpers.hpp"
+#include "sample.h"
 #include "stream_outlet_impl.h"
-#include <loguru.hpp>
 #include <cstdint>
 #include <exception>
 #include <stdexcept>
@@ -29,7 +30,7 @@ LIBLSL_C_API void lsl_destroy_outlet(lsl_outlet out) {
 	try {
 		delete out;
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error during deletion of stream outlet: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected error during deletion of stream outlet: %s", e.what());
 	}
 }
 
@@ -143,7 +144,7 @@ LIBLSL_C_API int32_t lsl_push_sample_strtp(
 			tmp.emplace_back(data[k]);
 		return outimpl->push_sample_noexcept(tmp.data(), timestamp, pushthrough != 0);
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error during push_sample: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected error during push_sample: %s", e.what());
 		return lsl_internal_error;
 	}
 }
@@ -167,7 +168,7 @@ LIBLSL_C_API int32_t lsl_push_sample_buftp(lsl_outlet out, const char **data,
 			tmp.emplace_back(data[k], lengths[k]);
 		return outimpl->push_sample_noexcept(tmp.data(), timestamp, pushthrough);
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error during push_sample: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected error during push_sample: %s", e.what());
 		return lsl_internal_error;
 	}
 }
@@ -401,11 +402,49 @@ LIBLSL_C_API int32_t lsl_push_chunk_buftnp(lsl_outlet out, const char **data,
 	LSL_RETURN_CAUGHT_EC;
 }
 
+LIBLSL_C_API int32_t lsl_push_chunk_strided(lsl_outlet out, const void *data,
+	lsl_channel_format_t data_format, unsigned long num_samples, int32_t sample_stride,
+	int32_t channel_stride, const int32_t *channel_offsets, double timestamp, int32_t pushthrough) {
+	try {
+		if (data_format == cft_string || data_format <= cft_undefined || data_format > cft_int64)
+			throw std::invalid_argument("Strided data must have a numeric format.");
+		const channel_layout layout{
+			channel_stride ? channel_stride : format_sizes[data_format], channel_offsets};
+		const bool push = pushthrough != 0;
+		switch (data_format) {
+		case cft_float32:
+			out->push_chunk_strided<float>(
+				data, num_samples, sample_stride, layout, timestamp, push);
+			break;
+		case cft_double64:
+			out->push_chunk_strided<double>(
+				data, num_samples, sample_stride, layout, timestamp, push);
+			break;
+		case cft_int8:
+			out->push_chunk_strided<char>(
+				data, num_samples, sample_stride, layout, timestamp, push);
+			break;
+		case cft_int16:
+			out->push_chunk_strided<int16_t>(
+				data, num_samples, sample_stride, layout, timestamp, push);
+			break;
+		case cft_int32:
+			out->push_chunk_strided<int32_t>(
+				data, num_samples, sample_stride, layout, timestamp, push);
+			break;
+		default:
+			out->push_chunk_strided<int64_t>(
+				data, num_samples, sample_stride, layout, timestamp, push);
+		}
+	}
+	LSL_RETURN_CAUGHT_EC;
+}
+
 LIBLSL_C_API int32_t lsl_have_consumers(lsl_outlet out) {
 	try {
 		return out->have_consumers();
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error in have_consumers: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected error in have_consumers: %s", e.what());
 		return 1;
 	}
 }
@@ -414,7 +453,7 @@ LIBLSL_C_API int32_t lsl_wait_for_consumers(lsl_outlet out, double timeout) {
 	try {
 		return out->wait_for_consumers(timeout);
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error in wait_for_consumers: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected error in wait_for_consumers: %s", e.what());
 		return 1;
 	}
 }
@@ -422,4 +461,12 @@ LIBLSL_C_API int32_t lsl_wait_for_consumers(lsl_outlet out, double timeout) {
 LIBLSL_C_API lsl_streaminfo lsl_get_info(lsl_outlet out) {
 	return create_object_noexcept<stream_info_impl>(out->info());
 }
+
+LIBLSL_C_API int32_t lsl_outlet_get_stats(lsl_outlet out, lsl_outlet_stats *stats) {
+	if (!stats) return lsl_argument_error;
+	try {
+		*stats = out->get_stats();
+		return lsl_no_error;
+	} catch (std::exception &) { return lsl_internal_error; }
+}
 }
@@ -0,0 +1,49 @@
+#include "logging.h"
+#include "lsl_c_api_helpers.hpp"
+#include "outlet_group.h"
+#include <exception>
+#include <stdexcept>
+#include <vector>
+
+extern "C" {
+#include "api_types.hpp"
+// include api_types before public API header
+#include "../include/lsl/outlet_group.h"
+
+using namespace lsl;
+
+LIBLSL_C_API lsl_outlet_group lsl_create_outlet_group(
+	const lsl_outlet *outlets, int32_t num_outlets) {
+	try {
+		if (!outlets || num_outlets <= 0)
+			throw std::invalid_argument("An outlet group needs at least one outlet.");
+		return new outlet_group(std::vector<stream_outlet_impl *>(outlets, outlets + num_outlets));
+	}
+	LSL_STORE_EXCEPTION
+	return nullptr;
+}
+
+LIBLSL_C_API void lsl_destroy_outlet_group(lsl_outlet_group group) {
+	try {
+		delete group;
+	} catch (std::exception &e) {
+		LSL_LOG_F(ERROR, "Unexpected error in %s: %s", __func__, e.what());
+	}
+}
+
+LIBLSL_C_API int32_t lsl_outlet_group_push(
+	lsl_outlet_group group, const void *const *buffers, double timestamp, int32_t pushthrough) {
+	try {
+		if (!buffers) throw std::invalid_argument("No sample buffers given.");
+		group->push(buffers, timestamp, pushthrough != 0);
+	}
+	LSL_RETURN_CAUGHT_EC;
+}
+
+LIBLSL_C_API int32_t lsl_outlet_group_flush(lsl_outlet_group group) {
+	try {
+		group->flush();
+	}
+	LSL_RETURN_CAUGHT_EC;
+}
+}
@@ -0,0 +1,49 @@
+#include "logging.h"
+#include "lsl_c_api_helpers.hpp"
+#include "recorder.h"
+#include <exception>
+#include <stdexcept>
+
+extern "C" {
+#include "api_types.hpp"
+// include api_types before public API header
+#include "../include/lsl/recorder.h"
+
+using namespace lsl;
+
+LIBLSL_C_API lsl_recorder lsl_create_recorder(const char *filename, int32_t max_file_mb) {
+	try {
+		if (!filename || max_file_mb < 0)
+			throw std::invalid_argument("A recorder needs a file name and a non-negative size.");
+		return new recorder(filename, static_cast<uint64_t>(max_file_mb) << 20);
+	}
+	LSL_STORE_EXCEPTION
+	return nullptr;
+}
+
+LIBLSL_C_API void lsl_destroy_recorder(lsl_recorder rec) {
+	try {
+		delete rec;
+	} catch (std::exception &e) {
+		LSL_LOG_F(ERROR, "Unexpected error in %s: %s", __func__, e.what());
+	}
+}
+
+LIBLSL_C_API int32_t lsl_recorder_add_inlet(lsl_recorder rec, lsl_inlet in) {
+	try {
+		rec->add_inlet(*in);
+	}
+	LSL_RETURN_CAUGHT_EC;
+}
+
+LIBLSL_C_API int32_t lsl_recorder_add_outlet(lsl_recorder rec, lsl_outlet out) {
+	try {
+		rec->add_outlet(*out);
+	}
+	LSL_RETURN_CAUGHT_EC;
+}
+
+LIBLSL_C_API int64_t lsl_recorder_bytes_written(lsl_recorder rec) {
+	return static_cast<int64_t>(rec->bytes_written());
+}
+}
@@ -0,0 +1,47 @@
+#include "logging.h"
+#include "lsl_c_api_helpers.hpp"
+#include "replayer.h"
+#include "stream_info_impl.h"
+#include <exception>
+#include <stdexcept>
+
+extern "C" {
+#include "api_types.hpp"
+// include api_types before public API header
+#include "../include/lsl/replayer.h"
+
+using namespace lsl;
+
+LIBLSL_C_API lsl_replayer lsl_create_replayer(
+	const char *filename, double speed, int32_t original_timestamps) {
+	try {
+		if (!filename) throw std::invalid_argument("A replayer needs a file name.");
+		return new replayer(filename, speed, original_timestamps != 0);
+	}
+	LSL_STORE_EXCEPTION
+	return nullptr;
+}
+
+LIBLSL_C_API void lsl_destroy_replayer(lsl_replayer rep) {
+	try {
+		delete rep;
+	} catch (std::exception &e) {
+		LSL_LOG_F(ERROR, "Unexpected error in %s: %s", __func__, e.what());
+	}
+}
+
+LIBLSL_C_API int32_t lsl_replayer_num_streams(lsl_replayer rep) {
+	return static_cast<int32_t>(rep->num_streams());
+}
+
+LIBLSL_C_API lsl_streaminfo lsl_replayer_get_info(lsl_replayer rep, int32_t stream) {
+	if (stream < 0 || static_cast<std::size_t>(stream) >= rep->num_streams()) return nullptr;
+	return create_object_noexcept<stream_info_impl>(rep->info(static_cast<std::size_t>(stream)));
+}
+
+LIBLSL_C_API void lsl_replayer_start(lsl_replayer rep) { rep->start(); }
+
+LIBLSL_C_API int32_t lsl_replayer_wait(lsl_replayer rep, double timeout) {
+	return rep->wait(timeout) ? 1 : 0;
+}
+}
@@ -1,9 +1,9 @@
 #include "api_config.h"
+#include "logging.h"
 #include "lsl_c_api_helpers.hpp"
 #include "resolver_impl.h"
 #include <cstdint>
 #include <exception>
-#include <loguru.hpp>
 #include <string>
 #include <vector>
 
@@ -43,7 +43,7 @@ LIBLSL_C_API void lsl_destroy_continuous_resolver(lsl_continuous_resolver res) {
 	try {
 		delete res;
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected during destruction of a continuous_resolver: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected during destruction of a continuous_resolver: %s", e.what());
 	}
 }
 
@@ -68,7 +68,9 @@ LIBLSL_C_API int32_t lsl_resolve_byprop(lsl_streaminfo *buffer, uint32_t buffer_
 	const char *prop, const char *value, int32_t minimum, double timeout) {
 	try {
 		std::string query{resolver_impl::build_query(prop, value)};
-		auto tmp = resolver_impl().resolve_oneshot(query, minimum, timeout);
+		std::vector<stream_info_impl> tmp;
+		if (!resolver_impl::resolve_cached(query, minimum, tmp))
+			tmp = resolver_impl().resolve_oneshot(query, minimum, timeout);
 		// allocate new stream_info_impl's and assign to the buffer
 		uint32_t result = buffer_elements < tmp.size() ? buffer_elements : (uint32_t)tmp.size();
 		for (uint32_t k = 0; k < result; k++) buffer[k] = new stream_info_impl(tmp[k]);
@@ -81,7 +83,9 @@ LIBLSL_C_API int32_t lsl_resolve_bypred(lsl_streaminfo *buffer, uint32_t buffer_
 	const char *pred, int32_t minimum, double timeout) {
 	try {
 		std::string query{resolver_impl::build_query(pred)};
-		auto tmp = resolver_impl().resolve_oneshot(query, minimum, timeout);
+		std::vector<stream_info_impl> tmp;
+		if (!resolver_impl::resolve_cached(query, minimum, tmp))
+			tmp = resolver_impl().resolve_oneshot(query, minimum, timeout);
 		// allocate new stream_info_impl's and assign to the buffer
 		uint32_t result = buffer_elements < tmp.size() ? buffer_elements : (uint32_t)tmp.size();
 		for (uint32_t k = 0; k < result; k++) buffer[k] = new stream_info_impl(tmp[k]);
@@ -89,4 +93,36 @@ LIBLSL_C_API int32_t lsl_resolve_bypred(lsl_streaminfo *buffer, uint32_t buffer_
 	}
 	LSL_RETURN_CAUGHT_EC;
 }
+
+LIBLSL_C_API int32_t lsl_resolve_bypreds(lsl_streaminfo *buffer, uint32_t buffer_elements,
+	int32_t *counts, const char **preds, uint32_t num_preds, int32_t minimum, double timeout) {
+	try {
+		if (num_preds == 0) return 0;
+		if (!preds || !counts || (buffer_elements && !buffer)) return lsl_argument_error;
+		std::vector<std::string> queries;
+		for (uint32_t q = 0; q < num_preds; q++) {
+			if (!preds[q]) return lsl_argument_error;
+			queries.push_back(resolver_impl::build_query(preds[q]));
+		}
+		// resolve on the network unless the cache has enough results for every query
+		std::vector<std::vector<stream_info_impl>> tmp(queries.size());
+		for (uint32_t q = 0; q < num_preds; q++)
+			if (!resolver_impl::resolve_cached(queries[q], minimum, tmp[q])) {
+				tmp = resolver_impl().resolve_oneshot(queries, minimum, timeout);
+				break;
+			}
+		// allocate new stream_info_impl's and assign them to the buffer, query by query
+		uint32_t result = 0;
+		for (uint32_t q = 0; q < num_preds; q++) {
+			counts[q] = 0;
+			for (const auto &info : tmp[q]) {
+				if (result == buffer_elements) break;
+				buffer[result++] = new stream_info_impl(info);
+				counts[q]++;
+			}
+		}
+		return static_cast<int32_t>(result);
+	}
+	LSL_RETURN_CAUGHT_EC;
+}
 }
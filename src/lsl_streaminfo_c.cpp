@@ -1,13 +1,14 @@
 #include "lsl_c_api_helpers.hpp"
 #include "common.h"
+#include "logging.h"
 #include "stream_info_impl.h"
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <exception>
-#include <loguru.hpp>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 extern "C" {
 #include "api_types.hpp"
@@ -24,6 +25,20 @@ LIBLSL_C_API lsl_streaminfo lsl_create_streaminfo(const char *name, const char *
 		name, type, channel_count, nominal_srate, channel_format, source_id);
 }
 
+LIBLSL_C_API lsl_streaminfo lsl_create_record_streaminfo(const char *name, const char *type,
+	int32_t channel_count, double nominal_srate, const lsl_channel_format_t *channel_formats,
+	const char *source_id) {
+	try {
+		if (!channel_formats || channel_count <= 0)
+			throw std::invalid_argument("A record stream needs the format of each channel.");
+		return new stream_info_impl(name, type,
+			std::vector<lsl_channel_format_t>(channel_formats, channel_formats + channel_count),
+			nominal_srate, source_id);
+	}
+	LSL_STORE_EXCEPTION
+	return nullptr;
+}
+
 LIBLSL_C_API lsl_streaminfo lsl_copy_streaminfo(lsl_streaminfo info) {
 	return create_object_noexcept<stream_info_impl>(*info);
 }
@@ -32,7 +47,7 @@ LIBLSL_C_API void lsl_destroy_streaminfo(lsl_streaminfo info) {
 	try {
 		delete info;
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error while destroying a streaminfo: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected error while destroying a streaminfo: %s", e.what());
 	}
 }
 
@@ -43,6 +58,10 @@ LIBLSL_C_API double lsl_get_nominal_srate(lsl_streaminfo info) { return info->no
 LIBLSL_C_API lsl_channel_format_t lsl_get_channel_format(lsl_streaminfo info) {
 	return info->channel_format();
 }
+LIBLSL_C_API lsl_channel_format_t lsl_get_channel_format_at(lsl_streaminfo info, int32_t channel) {
+	if (channel < 0 || channel >= static_cast<int32_t>(info->channel_count())) return cft_undefined;
+	return info->channel_format(static_cast<uint32_t>(channel));
+}
 LIBLSL_C_API const char *lsl_get_source_id(lsl_streaminfo info) {
 	return info->source_id().c_str();
 }
@@ -62,19 +81,25 @@ LIBLSL_C_API char *lsl_get_xml(lsl_streaminfo info) {
 		std::string tmp = info->to_fullinfo_message();
 		char *result = (char *)malloc(tmp.size() + 1);
 		if (result == nullptr) {
-			LOG_F(ERROR, "Error allocating memory for xmlinfo");
+			LSL_LOG_F(ERROR, "Error allocating memory for xmlinfo");
 			return nullptr;
 		}
 		memcpy(result, tmp.data(), tmp.size());
 		result[tmp.size()] = '\0';
 		return result;
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error in lsl_get_xml: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected error in lsl_get_xml: %s", e.what());
 		return nullptr;
 	}
 }
 LIBLSL_C_API int32_t lsl_get_channel_bytes(lsl_streaminfo info) { return info->channel_bytes(); }
 LIBLSL_C_API int32_t lsl_get_sample_bytes(lsl_streaminfo info) { return info->sample_bytes(); }
+LIBLSL_C_API int32_t lsl_get_channel_offset(lsl_streaminfo info, int32_t channel) {
+	if (channel < 0 || channel >= static_cast<int32_t>(info->channel_count()) ||
+		info->channel_format() == cft_string)
+		return -1;
+	return info->channel_offset(static_cast<uint32_t>(channel));
+}
 
 LIBLSL_C_API int32_t lsl_stream_info_matches_query(lsl_streaminfo info, const char *query) {
 	return info->matches_query(query);
@@ -86,7 +111,7 @@ LIBLSL_C_API lsl_streaminfo lsl_streaminfo_from_xml(const char *xml) {
 		impl->from_fullinfo_message(xml);
 		return impl;
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error during streaminfo construction: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected error during streaminfo construction: %s", e.what());
 		return nullptr;
 	}
 }
@@ -1,6 +1,6 @@
 #include "netinterfaces.h"
+#include "logging.h"
 #include <cstring>
-#include <loguru.hpp>
 
 asio::ip::address_v6 sinaddr_to_asio(sockaddr_in6 *addr) {
 	asio::ip::address_v6::bytes_type buf;
@@ -32,7 +32,7 @@ std::vector<lsl::netif> lsl::get_local_interfaces() {
 	if (res == NO_ERROR) {
 		for (AddrList addr = ifaddrs; addr != 0; addr = addr->Next) {
 			// Interface isn't up or doesn't support multicast? Skip it.
-			LOG_F(INFO, "netif '%s' (status: %d, multicast: %d", addr->AdapterName,
+			LSL_LOG_F(INFO, "netif '%s' (status: %d, multicast: %d", addr->AdapterName,
 				addr->OperStatus, !addr->NoMulticast);
 			if (addr->OperStatus != IfOperStatusUp) continue;
 			if (addr->NoMulticast) continue;
@@ -55,7 +55,7 @@ std::vector<lsl::netif> lsl::get_local_interfaces() {
 			}
 
 			if (addr->Ipv6Enabled) {
-				LOG_F(INFO, "\tIPv6 ifindex %d", if_.ifindex);
+				LSL_LOG_F(INFO, "\tIPv6 ifindex %d", if_.ifindex);
 				for (Addr *uaddr = addr->FirstUnicastAddress; uaddr != 0; uaddr = uaddr->Next) {
 					if (uaddr->Address.lpSockaddr->sa_family != AF_INET6) continue;
 
@@ -67,7 +67,7 @@ std::vector<lsl::netif> lsl::get_local_interfaces() {
 			}
 		}
 	} else {
-		LOG_F(ERROR, "Couldn't enumerate network interfaces: %d", res);
+		LSL_LOG_F(ERROR, "Couldn't enumerate network interfaces: %d", res);
 	}
 	delete[]((char *)ifaddrs);
 	return ret;
@@ -80,13 +80,13 @@ std::vector<lsl::netif> lsl::get_local_interfaces() {
 	std::vector<lsl::netif> res;
 	ifaddrs *ifs;
 	if (getifaddrs(&ifs)) {
-		LOG_F(ERROR, "Couldn't enumerate network interfaces: %d", errno);
+		LSL_LOG_F(ERROR, "Couldn't enumerate network interfaces: %d", errno);
 		return res;
 	}
 	for (auto *addr = ifs; addr != nullptr; addr = addr->ifa_next) {
 		// No address? Skip.
 		if (addr->ifa_addr == nullptr) continue;
-		LOG_F(INFO, "netif '%s' (status: %d, multicast: %d, broadcast: %d)", addr->ifa_name,
+		LSL_LOG_F(INFO, "netif '%s' (status: %d, multicast: %d, broadcast: %d)", addr->ifa_name,
 			addr->ifa_flags & IFF_UP, addr->ifa_flags & IFF_MULTICAST,
 			addr->ifa_flags & IFF_BROADCAST);
 		// Interface doesn't support multicast? Skip.
@@ -99,10 +99,10 @@ std::vector<lsl::netif> lsl::get_local_interfaces() {
 		if (addr->ifa_addr->sa_family == AF_INET) {
 			if_.addr = asio::ip::make_address_v4(
 				ntohl(reinterpret_cast<sockaddr_in *>(addr->ifa_addr)->sin_addr.s_addr));
-			LOG_F(INFO, "\tIPv4 addr: %x", if_.addr.to_v4().to_uint());
+			LSL_LOG_F(INFO, "\tIPv4 addr: %x", if_.addr.to_v4().to_uint());
 		} else if (addr->ifa_addr->sa_family == AF_INET6) {
 			if_.addr = sinaddr_to_asio(reinterpret_cast<sockaddr_in6 *>(addr->ifa_addr));
-			LOG_F(INFO, "\tIPv6 addr: %s", if_.addr.to_string().c_str());
+			LSL_LOG_F(INFO, "\tIPv6 addr: %s", if_.addr.to_string().c_str());
 		} else
 			continue;
 
@@ -115,7 +115,7 @@ std::vector<lsl::netif> lsl::get_local_interfaces() {
 #else
 
 std::vector<lsl::netif> lsl::get_local_interfaces() {
-	LOG_F(WARNING, "No implementation to enumerate network interfaces found.");
+	LSL_LOG_F(WARNING, "No implementation to enumerate network interfaces found.");
 	return std::vector<lsl::netif>();
 }
 #endif
@@ -0,0 +1,59 @@
+#include "outlet_group.h"
+#include "api_config.h"
+#include "logging.h"
+#include "sample.h"
+#include "stream_outlet_impl.h"
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+using namespace lsl;
+
+outlet_group::outlet_group(std::vector<stream_outlet_impl *> outlets) {
+	for (stream_outlet_impl *outlet : outlets) {
+		if (!outlet) throw std::invalid_argument("An outlet group can't contain null outlets.");
+		if (std::any_of(members_.begin(), members_.end(),
+				[outlet](const member &m) { return m.outlet == outlet; }))
+			throw std::invalid_argument("An outlet can only be added to a group once.");
+		members_.push_back(member{outlet, {}});
+		members_.back().pending.reserve(max_batch);
+	}
+}
+
+outlet_group::~outlet_group() {
+	try {
+		flush();
+	} catch (std::exception &e) {
+		LSL_LOG_F(ERROR, "Unexpected error while destroying an outlet group: %s", e.what());
+	}
+}
+
+void outlet_group::push(const void *const *buffers, double timestamp, bool pushthrough) {
+	// all samples of a frame get the same time stamp
+	if (timestamp == 0.0 || api_config::get_instance()->force_default_timestamps())
+		timestamp = lsl_clock();
+	std::lock_guard<std::mutex> lock(mut_);
+	for (std::size_t i = 0; i < members_.size(); ++i) {
+		if (!buffers[i]) continue;
+		member &m = members_[i];
+		m.pending.push_back(m.outlet->make_sample(buffers[i], timestamp, pushthrough));
+		if (pushthrough || m.pending.size() >= max_batch) publish(i, pushthrough);
+	}
+	// outlets that were skipped in this frame send their kept back samples, too
+	if (pushthrough)
+		for (std::size_t i = 0; i < members_.size(); ++i) publish(i, true);
+}
+
+void outlet_group::flush() {
+	std::lock_guard<std::mutex> lock(mut_);
+	for (std::size_t i = 0; i < members_.size(); ++i) publish(i, true);
+}
+
+void outlet_group::publish(std::size_t i, bool pushthrough) {
+	member &m = members_[i];
+	if (m.pending.empty()) return;
+	// the sessions keep buffering until a sample is pushed through
+	if (pushthrough) m.pending.back()->pushthrough = true;
+	m.outlet->publish(m.pending.data(), m.pending.size());
+	m.pending.clear();
+}
@@ -0,0 +1,67 @@
+#ifndef OUTLET_GROUP_H
+#define OUTLET_GROUP_H
+
+#include "common.h"
+#include "forward.h"
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace lsl {
+class stream_outlet_impl;
+
+/**
+ * Pushes one frame of several outlets (e.g. EEG, accelerometer and triggers of one device) at a
+ * time, with a single time stamp for all of them.
+ *
+ * The clock is read once per frame and each outlet's samples are published with one lock of its
+ * send buffer and one wakeup of each session. Frames that aren't pushed through are kept back and
+ * published together with the next frame that is (or once max_batch frames have accumulated), so
+ * the sessions wake up once per batch instead of once per sample.
+ *
+ * The outlets have to outlive the group.
+ */
+class outlet_group {
+public:
+	/// The maximum number of samples per outlet that are kept back.
+	static const std::size_t max_batch = 64;
+
+	/// Create a group of outlets. The same outlet must not be added twice.
+	explicit outlet_group(std::vector<stream_outlet_impl *> outlets);
+
+	/// Publish the samples that were kept back.
+	~outlet_group();
+
+	/// The number of outlets in the group.
+	std::size_t size() const { return members_.size(); }
+
+	/**
+	 * Push one sample into each outlet.
+	 * @param buffers One pointer per outlet to the raw channel values (for string streams, an
+	 * array of C strings), or nullptr to skip the outlet in this frame.
+	 * @param timestamp The capture time of all samples (0: the current time).
+	 * @param pushthrough Whether to push the samples through to the receivers.
+	 */
+	void push(const void *const *buffers, double timestamp = 0.0, bool pushthrough = true);
+
+	/// Publish the samples that were kept back and push them through.
+	void flush();
+
+private:
+	/// Publish the samples kept back for one outlet (with mut_ held), optionally pushing them
+	/// through to the receivers.
+	void publish(std::size_t i, bool pushthrough);
+
+	struct member {
+		stream_outlet_impl *outlet;
+		/// samples that weren't pushed through yet
+		std::vector<sample_p> pending;
+	};
+	std::vector<member> members_;
+	/// protects the pending samples
+	std::mutex mut_;
+};
+
+} // namespace lsl
+
+#endif
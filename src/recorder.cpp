@@ -0,0 +1,386 @@
+#include "recorder.h"
+#include "consumer_queue.h"
+#include "logging.h"
+#include "sample.h"
+#include "stream_info_impl.h"
+#include "stream_inlet_impl.h"
+#include "stream_outlet_impl.h"
+#include "util/endian.hpp"
+#include <cstring>
+#include <exception>
+#include <loguru.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+using namespace lsl;
+
+namespace {
+// XDF chunk tags
+const uint16_t tag_file_header = 1, tag_stream_header = 2, tag_samples = 3, tag_clock_offset = 4,
+			   tag_stream_footer = 6;
+
+/// Samples are collected into chunks of about this size...
+const std::size_t chunk_bytes = 1 << 20;
+/// ...or for at most this long (in seconds)
+const double chunk_duration = 0.5;
+/// Interval between two clock offset measurements for an inlet
+const double clock_offset_interval = 5.0;
+/// Buffer size for writing to the file
+const std::size_t write_buffer_bytes = 4 << 20;
+
+/// Append an unsigned integer in little endian byte order
+template <typename T> void put_le(std::vector<char> &buf, T v) {
+	for (std::size_t i = 0; i < sizeof(T); ++i)
+		buf.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+void put_le(std::vector<char> &buf, double v) {
+	uint64_t bits;
+	memcpy(&bits, &v, sizeof(v));
+	put_le(buf, bits);
+}
+
+double get_le_double(const char *pos) {
+	uint64_t bits = 0;
+	for (std::size_t i = 0; i < sizeof(bits); ++i)
+		bits |= static_cast<uint64_t>(static_cast<uint8_t>(pos[i])) << (8 * i);
+	double v;
+	memcpy(&v, &bits, sizeof(v));
+	return v;
+}
+
+/// Append an XDF variable-length integer (the number of bytes followed by the value)
+void put_varlen(std::vector<char> &buf, uint64_t v) {
+	if (v <= 0xFF) {
+		buf.push_back(1);
+		put_le(buf, static_cast<uint8_t>(v));
+	} else if (v <= 0xFFFFFFFF) {
+		buf.push_back(4);
+		put_le(buf, static_cast<uint32_t>(v));
+	} else {
+		buf.push_back(8);
+		put_le(buf, v);
+	}
+}
+
+/// Append a sample with an explicit time stamp to the content of an XDF samples chunk
+void put_sample(std::vector<char> &buf, sample &s, double timestamp, lsl_channel_format_t fmt) {
+	buf.push_back(sizeof(double));
+	put_le(buf, timestamp);
+	if (fmt == cft_string) {
+		for (uint32_t ch = 0; ch < s.num_channels(); ++ch) {
+			const std::string &str = s.string_value(ch);
+			put_varlen(buf, str.size());
+			buf.insert(buf.end(), str.begin(), str.end());
+		}
+		return;
+	}
+	const std::size_t pos = buf.size();
+	buf.resize(pos + s.datasize());
+	s.retrieve_untyped(&buf[pos]);
+	if (LSL_BYTE_ORDER != LSL_LITTLE_ENDIAN) s.reverse_channels(&buf[pos]);
+}
+
+std::string segment_name(const std::string &filename, int segment) {
+	if (segment == 0) return filename;
+	std::size_t ext = filename.find_last_of('.');
+	const std::size_t dir = filename.find_last_of("/\\");
+	if (ext == std::string::npos || (dir != std::string::npos && ext < dir)) ext = filename.size();
+	return filename.substr(0, ext) + '_' + std::to_string(segment) + filename.substr(ext);
+}
+} // namespace
+
+recorder::recorder(std::string filename, uint64_t max_file_bytes, std::size_t max_pending_bytes)
+	: filename_(std::move(filename)), max_file_bytes_(max_file_bytes),
+	  max_pending_bytes_(max_pending_bytes) {
+	open_segment();
+	writer_ = std::thread(&recorder::write_chunks, this);
+}
+
+recorder::~recorder() {
+	stop_capture_ = true;
+	for (auto &thread : capture_threads_) thread.join();
+	{
+		std::lock_guard<std::mutex> lock(mut_);
+		stop_ = true;
+	}
+	cv_.notify_all();
+	writer_.join();
+}
+
+void recorder::add_inlet(stream_inlet_impl &inlet) {
+	std::lock_guard<std::mutex> lock(mut_);
+	capture_threads_.emplace_back(
+		&recorder::capture, this, next_stream_++, nullptr, &inlet, std::string(), 0.0);
+}
+
+void recorder::add_outlet(stream_outlet_impl &outlet) {
+	stream_info_impl info(outlet.info());
+	// buffer as much as an inlet would by default
+	auto queue = outlet.new_consumer(
+		static_cast<int>(info.calc_transport_buf_samples(360, transp_default)));
+	std::lock_guard<std::mutex> lock(mut_);
+	capture_threads_.emplace_back(&recorder::capture, this, next_stream_++, std::move(queue),
+		nullptr, info.to_fullinfo_message(), info.nominal_srate());
+}
+
+void recorder::capture(uint32_t stream, std::shared_ptr<consumer_queue> queue,
+	stream_inlet_impl *inlet, std::string header, double srate) {
+	loguru::set_thread_name(("Rec_" + std::to_string(stream)).c_str());
+	chunk samples{stream, tag_samples, {}, 0.0, 0.0, 0};
+	double chunk_start = 0.0, last_timestamp = 0.0, last_remote_time = 0.0;
+	double next_clock_offset = lsl_clock();
+	lsl_channel_format_t fmt = cft_undefined;
+	auto flush = [&]() {
+		if (!samples.samples) return;
+		// the sample count at the start of the content was reserved as an 8-byte varlen
+		for (std::size_t i = 0; i < sizeof(uint64_t); ++i)
+			samples.content[1 + i] = static_cast<char>((samples.samples >> (8 * i)) & 0xFF);
+		submit(std::move(samples));
+		samples = chunk{stream, tag_samples, {}, 0.0, 0.0, 0};
+	};
+	auto append = [&](sample &s, double timestamp) {
+		if (!samples.samples) {
+			samples.content = get_buffer();
+			samples.content.push_back(sizeof(uint64_t));
+			samples.content.resize(1 + sizeof(uint64_t));
+			samples.first_timestamp = timestamp;
+			chunk_start = lsl_clock();
+		}
+		put_sample(samples.content, s, timestamp, fmt);
+		samples.last_timestamp = timestamp;
+		++samples.samples;
+		if (samples.content.size() >= chunk_bytes) flush();
+	};
+	// samples pushed into an outlet can have deduced time stamps, but an outlet may have been
+	// pushed to before it was added, so deduced samples before the first explicit time stamp are
+	// held back and timed backwards from it (inlets resolve deduced time stamps themselves)
+	bool have_timestamp = inlet != nullptr;
+	std::vector<sample_p> leading;
+	double leading_since = 0.0;
+	auto release_leading = [&](double timestamp) {
+		const double n = static_cast<double>(leading.size());
+		for (std::size_t k = 0; k < leading.size(); ++k) {
+			last_timestamp = timestamp;
+			if (srate != IRREGULAR_RATE) last_timestamp -= (n - static_cast<double>(k)) / srate;
+			append(*leading[k], last_timestamp);
+		}
+		leading.clear();
+		have_timestamp = true;
+	};
+	auto record = [&](sample_p s) {
+		double timestamp = s->timestamp();
+		if (timestamp == DEDUCED_TIMESTAMP) {
+			if (!have_timestamp) {
+				if (leading.empty()) leading_since = lsl_clock();
+				leading.push_back(std::move(s));
+				return;
+			}
+			timestamp = last_timestamp;
+			if (srate != IRREGULAR_RATE) timestamp += 1.0 / srate;
+		} else if (!have_timestamp)
+			release_leading(timestamp);
+		last_timestamp = timestamp;
+		append(*s, timestamp);
+	};
+	try {
+		// inlets have to wait for the stream's full info
+		while (header.empty() && !stop_capture_) try {
+				stream_info_impl info(inlet->info(0.5));
+				header = info.to_fullinfo_message();
+			} catch (timeout_error &) {}
+		if (header.empty()) return;
+		{
+			stream_info_impl info;
+			info.from_fullinfo_message(header);
+			fmt = info.channel_format();
+		}
+		chunk hdr{stream, tag_stream_header, get_buffer(), 0.0, 0.0, 0};
+		hdr.content.assign(header.begin(), header.end());
+		submit(std::move(hdr));
+
+		while (!stop_capture_) {
+			const double now = lsl_clock();
+			if (inlet && now >= next_clock_offset) {
+				next_clock_offset = now + clock_offset_interval;
+				try {
+					double remote_time, uncertainty;
+					const double offset = inlet->time_correction(&remote_time, &uncertainty, 0.0);
+					if (remote_time != last_remote_time) {
+						last_remote_time = remote_time;
+						chunk c{
+							stream, tag_clock_offset, get_buffer(), remote_time, remote_time, 0};
+						put_le(c.content, remote_time);
+						put_le(c.content, offset);
+						submit(std::move(c));
+					}
+				} catch (timeout_error &) {
+					// the first estimate isn't available yet
+					next_clock_offset = now + chunk_duration;
+				}
+			}
+
+			if (sample_p s = inlet ? inlet->pull_raw_sample(0.1) : queue->pop_sample(0.1))
+				record(std::move(s));
+			// without an explicit time stamp in sight, the samples are timed from their arrival
+			if (!leading.empty() && lsl_clock() >= leading_since + chunk_duration)
+				release_leading(lsl_clock());
+			if (samples.samples && lsl_clock() >= chunk_start + chunk_duration) flush();
+		}
+		// record the samples that were already queued when the recorder was stopped
+		for (std::size_t n = inlet ? inlet->samples_available() : queue->read_available(); n; --n) {
+			sample_p s = inlet ? inlet->pull_raw_sample(0.0) : queue->pop_sample(0.0);
+			if (!s) break;
+			record(std::move(s));
+		}
+	} catch (lost_error &) {
+		LSL_LOG_F(WARNING, "Stream %u was lost, stopped recording it.", stream);
+	} catch (std::exception &e) {
+		LSL_LOG_F(ERROR, "Error while recording stream %u: %s", stream, e.what());
+	}
+	if (!leading.empty()) release_leading(lsl_clock());
+	flush();
+}
+
+std::vector<char> recorder::get_buffer() {
+	std::lock_guard<std::mutex> lock(mut_);
+	if (free_buffers_.empty()) {
+		std::vector<char> buf;
+		buf.reserve(chunk_bytes);
+		return buf;
+	}
+	std::vector<char> buf(std::move(free_buffers_.back()));
+	free_buffers_.pop_back();
+	return buf;
+}
+
+void recorder::submit(chunk &&c) {
+	const std::size_t size = c.content.size();
+	{
+		std::unique_lock<std::mutex> lock(mut_);
+		// a chunk can always be added to an empty queue, so large chunks don't block forever
+		cv_.wait(lock, [&]() {
+			return stop_ || pending_.empty() || pending_bytes_ + size <= max_pending_bytes_;
+		});
+		pending_bytes_ += size;
+		pending_.push_back(std::move(c));
+	}
+	cv_.notify_all();
+}
+
+void recorder::write_chunks() {
+	loguru::set_thread_name("RecWriter");
+	while (true) {
+		chunk c;
+		{
+			std::unique_lock<std::mutex> lock(mut_);
+			cv_.wait(lock, [this]() { return stop_ || !pending_.empty(); });
+			if (pending_.empty()) break;
+			c = std::move(pending_.front());
+			pending_.pop_front();
+			pending_bytes_ -= c.content.size();
+		}
+		cv_.notify_all();
+
+		try {
+			if (file_ && max_file_bytes_ && file_bytes_ >= max_file_bytes_) {
+				close_segment();
+				open_segment();
+			}
+			stream_state &state = streams_[c.stream];
+			if (c.tag == tag_stream_header) state.header.assign(c.content.begin(), c.content.end());
+			const uint64_t offset = file_bytes_;
+			write_chunk(c.stream, c.tag, c.content.data(), c.content.size());
+			if (c.tag == tag_samples) {
+				if (!state.samples) state.first_timestamp = c.first_timestamp;
+				state.last_timestamp = c.last_timestamp;
+				state.samples += c.samples;
+				std::ostringstream entry;
+				entry.precision(17);
+				entry << "<chunk><offset>" << offset << "</offset><first_timestamp>"
+					  << c.first_timestamp << "</first_timestamp><last_timestamp>"
+					  << c.last_timestamp << "</last_timestamp><sample_count>" << c.samples
+					  << "</sample_count></chunk>";
+				state.time_index += entry.str();
+			} else if (c.tag == tag_clock_offset) {
+				std::ostringstream entry;
+				entry.precision(17);
+				entry << "<offset><time>" << get_le_double(c.content.data()) << "</time><value>"
+					  << get_le_double(c.content.data() + sizeof(double)) << "</value></offset>";
+				state.clock_offsets += entry.str();
+			}
+		} catch (std::exception &e) {
+			LSL_LOG_F(ERROR, "Error writing recording %s, dropping further data: %s",
+				segment_name(filename_, segment_).c_str(), e.what());
+			if (file_) std::fclose(file_);
+			file_ = nullptr;
+		}
+
+		// keep the buffer for the next chunk
+		c.content.clear();
+		std::lock_guard<std::mutex> lock(mut_);
+		if (free_buffers_.size() < max_pending_bytes_ / chunk_bytes + 4)
+			free_buffers_.push_back(std::move(c.content));
+	}
+	try {
+		close_segment();
+	} catch (std::exception &e) { LSL_LOG_F(ERROR, "Error closing recording: %s", e.what()); }
+}
+
+void recorder::write_chunk(uint32_t stream, uint16_t tag, const char *content, std::size_t len) {
+	std::vector<char> head;
+	put_varlen(head, sizeof(tag) + (stream ? sizeof(stream) : 0) + len);
+	put_le(head, tag);
+	if (stream) put_le(head, stream);
+	write(head.data(), head.size());
+	write(content, len);
+}
+
+void recorder::open_segment() {
+	const std::string name = segment_name(filename_, segment_);
+	file_ = std::fopen(name.c_str(), "wb");
+	if (!file_) throw std::runtime_error("Could not create the recording file " + name);
+	std::setvbuf(file_, nullptr, _IOFBF, write_buffer_bytes);
+	file_bytes_ = 0;
+	write("XDF:", 4);
+	const std::string header("<?xml version=\"1.0\"?><info><version>1.0</version></info>");
+	write_chunk(0, tag_file_header, header.data(), header.size());
+	for (auto &stream : streams_) {
+		std::string header(std::move(stream.second.header));
+		stream.second = stream_state();
+		stream.second.header = std::move(header);
+		if (!stream.second.header.empty())
+			write_chunk(stream.first, tag_stream_header, stream.second.header.data(),
+				stream.second.header.size());
+	}
+}
+
+void recorder::close_segment() {
+	if (!file_) return;
+	for (const auto &stream : streams_) {
+		const stream_state &state = stream.second;
+		if (state.header.empty()) continue;
+		std::ostringstream footer;
+		footer.precision(17);
+		footer << "<?xml version=\"1.0\"?><info><first_timestamp>" << state.first_timestamp
+			   << "</first_timestamp><last_timestamp>" << state.last_timestamp
+			   << "</last_timestamp><sample_count>" << state.samples
+			   << "</sample_count><clock_offsets>" << state.clock_offsets
+			   << "</clock_offsets><time_index>" << state.time_index << "</time_index></info>";
+		const std::string content = footer.str();
+		write_chunk(stream.first, tag_stream_footer, content.data(), content.size());
+	}
+	const bool ok = std::fclose(file_) == 0;
+	file_ = nullptr;
+	++segment_;
+	if (!ok) throw std::runtime_error("Could not close the recording file.");
+}
+
+void recorder::write(const void *data, std::size_t len) {
+	if (!file_) return;
+	if (std::fwrite(data, 1, len, file_) != len)
+		throw std::runtime_error("Could not write to the recording file.");
+	file_bytes_ += len;
+	bytes_written_.fetch_add(len, std::memory_order_relaxed);
+}
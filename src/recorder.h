@@ -0,0 +1,139 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include "common.h"
+#include "forward.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lsl {
+class consumer_queue;
+class stream_inlet_impl;
+class stream_outlet_impl;
+
+/**
+ * Records the samples of inlets and in-process outlets to XDF files.
+ *
+ * Each source gets a capture thread that serializes its samples into XDF sample chunks (and, for
+ * inlets, records the clock offsets). A single writer thread appends the chunks to the file with
+ * large buffered writes. The memory held by chunks waiting for the writer is bounded; if the disk
+ * can't keep up, the capture threads wait and the samples queue up in the sources' buffers.
+ *
+ * Files are split into segments of a maximum size. Each segment is a complete XDF file with the
+ * stream headers and a footer per stream that holds its first and last time stamp, sample count,
+ * clock offsets and a time index, i.e. the file offset, time range and sample count of each of the
+ * stream's sample chunks in that segment.
+ */
+class recorder {
+public:
+	/**
+	 * Create a recorder and open its first file.
+	 * @param filename The first segment's file name. Further segments get a `_1`, `_2`, ... suffix
+	 * before the extension.
+	 * @param max_file_bytes Start a new segment once a file exceeds this size (0: no limit).
+	 * @param max_pending_bytes Maximum size of the chunks waiting to be written.
+	 * @throws std::runtime_error if the file can't be created.
+	 */
+	recorder(std::string filename, uint64_t max_file_bytes = 0,
+		std::size_t max_pending_bytes = 64 << 20);
+
+	/// Stop recording, write out all pending data and close the file.
+	~recorder();
+
+	/**
+	 * Record the samples received by an inlet.
+	 *
+	 * The recorder consumes the inlet's samples, so they shouldn't be pulled by anyone else. The
+	 * inlet has to outlive the recorder.
+	 */
+	void add_inlet(stream_inlet_impl &inlet);
+
+	/// Record all samples pushed into an outlet from now on, before they're sent to inlets.
+	void add_outlet(stream_outlet_impl &outlet);
+
+	/// Number of bytes written to all segments so far.
+	uint64_t bytes_written() const { return bytes_written_.load(std::memory_order_relaxed); }
+
+	recorder(const recorder &) = delete;
+	recorder &operator=(const recorder &) = delete;
+
+private:
+	/// A serialized XDF chunk on its way to the writer
+	struct chunk {
+		uint32_t stream;
+		uint16_t tag;
+		/// the chunk's content after the stream id
+		std::vector<char> content;
+		double first_timestamp, last_timestamp;
+		uint64_t samples;
+	};
+
+	/// Per-segment bookkeeping of a stream for its footer
+	struct stream_state {
+		std::string header;
+		double first_timestamp{0.0}, last_timestamp{0.0};
+		uint64_t samples{0};
+		std::string clock_offsets, time_index;
+	};
+
+	/// Capture the samples of a source until the recorder stops
+	void capture(uint32_t stream, std::shared_ptr<consumer_queue> queue, stream_inlet_impl *inlet,
+		std::string header, double srate);
+
+	/// Get a recycled buffer for a chunk's content
+	std::vector<char> get_buffer();
+
+	/// Pass a chunk to the writer, blocks while too much data is pending
+	void submit(chunk &&c);
+
+	/// The writer thread
+	void write_chunks();
+
+	/// Write a chunk to the current segment and update the stream's footer data
+	void write_chunk(uint32_t stream, uint16_t tag, const char *content, std::size_t len);
+
+	/// Open the next segment and write the file and stream headers
+	void open_segment();
+
+	/// Write the stream footers and close the current segment
+	void close_segment();
+
+	void write(const void *data, std::size_t len);
+
+	const std::string filename_;
+	const uint64_t max_file_bytes_;
+	const std::size_t max_pending_bytes_;
+
+	// writer state (only accessed by the writer thread after construction)
+	std::FILE *file_{nullptr};
+	int segment_{0};
+	uint64_t file_bytes_{0};
+	std::map<uint32_t, stream_state> streams_;
+
+	// data shared between the capture threads and the writer
+	std::mutex mut_;
+	std::condition_variable cv_;
+	std::deque<chunk> pending_;
+	std::size_t pending_bytes_{0};
+	std::vector<std::vector<char>> free_buffers_;
+	bool stop_{false};
+	uint32_t next_stream_{1};
+
+	std::atomic<bool> stop_capture_{false};
+	std::atomic<uint64_t> bytes_written_{0};
+	std::vector<std::thread> capture_threads_;
+	std::thread writer_;
+};
+
+} // namespace lsl
+
+#endif
@@ -0,0 +1,262 @@
+#include "replayer.h"
+#include "logging.h"
+#include "sample.h"
+#include "stream_info_impl.h"
+#include "stream_outlet_impl.h"
+#include "util/endian.hpp"
+#include <algorithm>
+#include <asio/post.hpp>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <loguru.hpp>
+#include <map>
+#include <stdexcept>
+
+using namespace lsl;
+
+namespace {
+// XDF chunk tags
+const uint16_t tag_stream_header = 2, tag_samples = 3, tag_clock_offset = 4;
+
+/// Read an unsigned integer in little endian byte order
+uint64_t get_le(const char *pos, std::size_t bytes) {
+	uint64_t v = 0;
+	for (std::size_t i = 0; i < bytes; ++i)
+		v |= static_cast<uint64_t>(static_cast<uint8_t>(pos[i])) << (8 * i);
+	return v;
+}
+
+double get_le_double(const char *pos) {
+	const uint64_t bits = get_le(pos, sizeof(bits));
+	double v;
+	memcpy(&v, &bits, sizeof(v));
+	return v;
+}
+
+/// Read an XDF variable-length integer, returns false if it's malformed or truncated
+bool get_varlen(const char *&pos, const char *end, uint64_t &v) {
+	if (pos >= end) return false;
+	const auto bytes = static_cast<std::size_t>(static_cast<uint8_t>(*pos));
+	if ((bytes != 1 && bytes != 4 && bytes != 8) || static_cast<std::size_t>(end - pos) <= bytes)
+		return false;
+	v = get_le(pos + 1, bytes);
+	pos += 1 + bytes;
+	return true;
+}
+
+/**
+ * The clock offset at `time`, interpolated between the recorded offsets around it.
+ * @param next The index of the first offset that was measured after `time`.
+ */
+double offset_at(const std::vector<std::pair<double, double>> &offsets, std::size_t next,
+	double time) {
+	if (offsets.empty()) return 0.0;
+	if (next == 0) return offsets.front().second;
+	if (next == offsets.size()) return offsets.back().second;
+	const auto &before = offsets[next - 1], &after = offsets[next];
+	// offsets measured at the same time can't be interpolated
+	if (after.first == before.first) return before.second;
+	return before.second +
+		   (after.second - before.second) * (time - before.first) / (after.first - before.first);
+}
+} // namespace
+
+replayer::replayer(const std::string &filename, double speed, bool original_timestamps)
+	: file_(filename), speed_(speed), original_timestamps_(original_timestamps) {
+	if (!(speed > 0)) throw std::invalid_argument("The replay speed must be positive.");
+	parse();
+	if (streams_.empty()) throw std::runtime_error(filename + " doesn't hold any streams.");
+	first_timestamp_ = std::numeric_limits<double>::max();
+	for (auto &s : streams_) {
+		advance(*s);
+		if (!s->done) first_timestamp_ = std::min(first_timestamp_, s->corrected);
+	}
+}
+
+replayer::~replayer() {
+	io_.stop();
+	if (thread_.joinable()) thread_.join();
+}
+
+const stream_info_impl &replayer::info(std::size_t stream) const {
+	return streams_.at(stream)->outlet->info();
+}
+
+void replayer::parse() {
+	const char *pos = file_.data(), *end = pos + file_.size();
+	if (file_.size() < 4 || memcmp(pos, "XDF:", 4) != 0)
+		throw std::runtime_error("The replayed file isn't an XDF file.");
+	pos += 4;
+	std::map<uint32_t, stream *> ids;
+	while (pos < end) {
+		uint64_t len;
+		if (!get_varlen(pos, end, len) || len < sizeof(uint16_t) ||
+			len > static_cast<uint64_t>(end - pos)) {
+			LSL_LOG_F(WARNING, "The replayed file is truncated, ignoring its last %zu bytes",
+				static_cast<std::size_t>(end - pos));
+			break;
+		}
+		const char *next = pos + len;
+		const auto tag = static_cast<uint16_t>(get_le(pos, sizeof(uint16_t)));
+		const std::size_t header = sizeof(uint16_t) + sizeof(uint32_t);
+		if ((tag == tag_stream_header || tag == tag_samples || tag == tag_clock_offset) &&
+			len >= header) {
+			const auto id = static_cast<uint32_t>(get_le(pos + sizeof(uint16_t), sizeof(uint32_t)));
+			const char *content = pos + header;
+			auto it = ids.find(id);
+			if (tag == tag_stream_header && it == ids.end()) {
+				stream_info_impl info;
+				info.from_fullinfo_message(std::string(content, next));
+				if (info.channel_count() <= 0 || info.channel_format() <= cft_undefined ||
+					(info.channel_format() > cft_int64 && !info.record_layout()))
+					LSL_LOG_F(WARNING, "Can't replay stream %u with an invalid header", id);
+				else {
+					std::unique_ptr<stream> s(new stream());
+					s->outlet.reset(new stream_outlet_impl(info));
+					s->format = info.channel_format();
+					s->channels = static_cast<uint32_t>(info.channel_count());
+					s->srate = info.nominal_srate();
+					s->sample_bytes = static_cast<std::size_t>(info.sample_bytes());
+					s->layout = info.record_layout();
+					if (s->format == cft_string) {
+						s->strings.resize(s->channels);
+						s->pushed_strings.resize(s->channels);
+					}
+					ids[id] = s.get();
+					streams_.push_back(std::move(s));
+				}
+			} else if (tag == tag_samples && it != ids.end())
+				it->second->chunks.push_back(chunk_ref{content, next});
+			else if (tag == tag_clock_offset && it != ids.end() && next - content >= 16)
+				it->second->clock_offsets.emplace_back(
+					get_le_double(content), get_le_double(content + sizeof(double)));
+		}
+		pos = next;
+	}
+}
+
+void replayer::advance(stream &s) {
+	while (!s.left_in_chunk) {
+		if (s.next_chunk == s.chunks.size()) {
+			s.done = true;
+			return;
+		}
+		const chunk_ref &c = s.chunks[s.next_chunk++];
+		s.pos = c.begin;
+		s.chunk_end = c.end;
+		if (!get_varlen(s.pos, s.chunk_end, s.left_in_chunk)) s.left_in_chunk = 0;
+	}
+	--s.left_in_chunk;
+
+	const char *pos = s.pos, *end = s.chunk_end;
+	bool valid = pos < end;
+	if (valid) {
+		const int timestamp_bytes = *pos++;
+		if (timestamp_bytes == sizeof(double) && end - pos >= 8) {
+			s.timestamp = get_le_double(pos);
+			pos += sizeof(double);
+		} else if (timestamp_bytes == 0)
+			s.timestamp += s.srate > 0 ? 1.0 / s.srate : 0.0;
+		else
+			valid = false;
+	}
+	s.values = pos;
+	if (valid && s.format == cft_string) {
+		for (auto &str : s.strings) {
+			uint64_t len;
+			if (!get_varlen(pos, end, len) || len > static_cast<uint64_t>(end - pos)) {
+				valid = false;
+				break;
+			}
+			str.assign(pos, len);
+			pos += len;
+		}
+	} else if (valid) {
+		valid = static_cast<std::size_t>(end - pos) >= s.sample_bytes;
+		pos += valid ? s.sample_bytes : 0;
+	}
+	if (!valid) {
+		LSL_LOG_F(WARNING, "Malformed samples in stream %s, stopped replaying it",
+			s.outlet->info().name().c_str());
+		s.done = true;
+		return;
+	}
+	s.pos = pos;
+
+	// map the time stamp to the recorder's clock with the clock offsets measured around it
+	while (s.next_offset < s.clock_offsets.size() &&
+		   s.clock_offsets[s.next_offset].first <= s.timestamp)
+		++s.next_offset;
+	s.corrected = s.timestamp + offset_at(s.clock_offsets, s.next_offset, s.timestamp);
+}
+
+void replayer::start() {
+	std::lock_guard<std::mutex> lock(mut_);
+	if (started_) return;
+	started_ = true;
+	start_time_ = lsl_clock();
+	for (auto &s : streams_) {
+		if (s->done) continue;
+		++active_;
+		s->timer.reset(new steady_timer(io_));
+		stream *ptr = s.get();
+		asio::post(io_, [this, ptr]() { replay(*ptr); });
+	}
+	thread_ = std::thread([this]() {
+		loguru::set_thread_name("Replay");
+		io_.run();
+	});
+}
+
+bool replayer::wait(double timeout) {
+	std::unique_lock<std::mutex> lock(mut_);
+	return cv_.wait_for(lock, std::chrono::duration<double>(timeout),
+		[this]() { return started_ && active_ == 0; });
+}
+
+void replayer::replay(stream &s) {
+	const double now = lsl_clock();
+	double due = 0.0;
+	try {
+		while (!s.done && (due = start_time_ + (s.corrected - first_timestamp_) / speed_) <= now) {
+			const double timestamp = original_timestamps_ ? s.corrected : due;
+			const char *values = s.values;
+			std::swap(s.strings, s.pushed_strings);
+			advance(s);
+			// send the samples that are due together
+			const bool pushthrough =
+				s.done || start_time_ + (s.corrected - first_timestamp_) / speed_ > now;
+			if (s.format == cft_string)
+				s.outlet->push_sample(s.pushed_strings.data(), timestamp, pushthrough);
+			else if (LSL_BYTE_ORDER == LSL_LITTLE_ENDIAN || s.sample_bytes == s.channels)
+				s.outlet->push_numeric_raw(values, timestamp, pushthrough);
+			else {
+				// XDF stores little endian values
+				s.converted.assign(values, values + s.sample_bytes);
+				if (s.layout)
+					for (uint32_t ch = 0; ch < s.channels; ++ch)
+						sample::convert_endian(&s.converted[s.layout->offset(ch)], 1,
+							format_sizes[s.layout->format(ch)]);
+				else
+					sample::convert_endian(s.converted.data(), s.channels, format_sizes[s.format]);
+				s.outlet->push_numeric_raw(s.converted.data(), timestamp, pushthrough);
+			}
+		}
+	} catch (std::exception &e) {
+		LSL_LOG_F(ERROR, "Error while replaying stream %s: %s", s.outlet->info().name().c_str(),
+			e.what());
+		s.done = true;
+	}
+	if (s.done) {
+		std::lock_guard<std::mutex> lock(mut_);
+		if (--active_ == 0) cv_.notify_all();
+		return;
+	}
+	s.timer->expires_after(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::duration<double>(due - lsl_clock())));
+	s.timer->async_wait([this, &s](const asio::error_code &err) {
+		if (!err) replay(s);
+	});
+}
@@ -0,0 +1,126 @@
+#ifndef REPLAYER_H
+#define REPLAYER_H
+
+#include "common.h"
+#include "forward.h"
+#include "util/mapped_file.hpp"
+#include <asio/io_context.hpp>
+#include <asio/steady_timer.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace lsl {
+class stream_info_impl;
+class stream_outlet_impl;
+
+/**
+ * Replays the streams of an XDF file through outlets with their original (or scaled) timing.
+ *
+ * The file is memory-mapped and each stream gets an outlet when the replayer is created, so
+ * inlets can connect before the replay is started. A single thread serves a timer per stream that
+ * pushes the samples once they're due; numeric values are pushed straight from the mapped file.
+ * Time stamps are corrected with the recorded clock offsets so the streams stay aligned.
+ */
+class replayer {
+public:
+	/**
+	 * Open a recording and create an outlet for each of its streams.
+	 * @param filename An XDF file, e.g. written by a recorder.
+	 * @param speed Replay speed relative to the recording, e.g. 2 to replay twice as fast.
+	 * @param original_timestamps Push the recorded time stamps (mapped to the recording host's
+	 * clock with the recorded clock offsets) instead of shifting (and scaling) them to the time of
+	 * the replay.
+	 * @throws std::runtime_error if the file can't be mapped or holds no streams.
+	 */
+	replayer(const std::string &filename, double speed = 1.0, bool original_timestamps = false);
+
+	/// Stop the replay and destroy the outlets
+	~replayer();
+
+	/// The number of replayed streams
+	std::size_t num_streams() const { return streams_.size(); }
+
+	/// The info of a replayed stream's outlet
+	const stream_info_impl &info(std::size_t stream) const;
+
+	/// Start pushing the samples, has no effect if the replay was already started
+	void start();
+
+	/**
+	 * Wait until all samples have been pushed.
+	 * @return false if the timeout expired first (or the replay wasn't started).
+	 */
+	bool wait(double timeout);
+
+	replayer(const replayer &) = delete;
+	replayer &operator=(const replayer &) = delete;
+
+private:
+	using steady_timer = asio::basic_waitable_timer<asio::chrono::steady_clock,
+		asio::wait_traits<asio::chrono::steady_clock>, asio::io_context::executor_type>;
+
+	/// The content of an XDF samples chunk
+	struct chunk_ref {
+		const char *begin, *end;
+	};
+
+	struct stream {
+		std::unique_ptr<stream_outlet_impl> outlet;
+		lsl_channel_format_t format;
+		uint32_t channels;
+		double srate;
+		/// the size of a numeric sample's values and the channel layout of record streams
+		std::size_t sample_bytes;
+		record_layout_p layout;
+		std::vector<chunk_ref> chunks;
+		/// (time, offset) pairs of the recorded clock offsets
+		std::vector<std::pair<double, double>> clock_offsets;
+
+		// replay position: the next sample's values and (corrected) time stamp
+		std::size_t next_chunk{0}, next_offset{0};
+		const char *pos{nullptr}, *chunk_end{nullptr};
+		uint64_t left_in_chunk{0};
+		const char *values{nullptr};
+		double timestamp{0.0}, corrected{0.0};
+		bool done{false};
+		/// the next and the currently pushed sample's string values
+		std::vector<std::string> strings, pushed_strings;
+		/// scratch space for byte order conversions
+		std::vector<char> converted;
+		std::unique_ptr<steady_timer> timer;
+	};
+
+	/// Index the chunks of the mapped file
+	void parse();
+
+	/// Move a stream to its next sample, mark it as done after the last one
+	void advance(stream &s);
+
+	/// Push the stream's samples that are due and schedule the next ones
+	void replay(stream &s);
+
+	mapped_file file_;
+	const double speed_;
+	const bool original_timestamps_;
+	/// time stamp of the first sample in the recording and the time the replay started
+	double first_timestamp_{0.0}, start_time_{0.0};
+
+	asio::io_context io_;
+	std::vector<std::unique_ptr<stream>> streams_;
+	std::thread thread_;
+
+	std::mutex mut_;
+	std::condition_variable cv_;
+	std::size_t active_{0};
+	bool started_{false};
+};
+
+} // namespace lsl
+
+#endif
@@ -1,5 +1,6 @@
 #include "resolve_attempt_udp.h"
 #include "api_config.h"
+#include "logging.h"
 #include "netinterfaces.h"
 #include "resolver_impl.h"
 #include "socket_utils.h"
@@ -8,7 +9,6 @@
 #include <asio/ip/address.hpp>
 #include <asio/ip/multicast.hpp>
 #include <exception>
-#include <loguru.hpp>
 #include <sstream>
 
 using namespace lsl;
@@ -16,10 +16,10 @@ using err_t = const asio::error_code &;
 using asio::ip::multicast::outbound_interface;
 
 resolve_attempt_udp::resolve_attempt_udp(asio::io_context &io, const udp &protocol,
-	const std::vector<udp::endpoint> &targets, const std::string &query, resolver_impl &resolver,
-	double cancel_after)
+	const std::vector<udp::endpoint> &targets, const std::vector<std::string> &queries,
+	resolver_impl &resolver, double cancel_after)
 	: io_(io), resolver_(resolver), cancel_after_(cancel_after), cancelled_(false),
-	  targets_(targets), query_(query), unicast_socket_(io), broadcast_socket_(io),
+	  targets_(targets), unicast_socket_(io), broadcast_socket_(io),
 	  multicast_socket_(io), multicast_interfaces(api_config::get_instance()->multicast_interfaces),
 	  recv_socket_(io), cancel_timer_(io) {
 	// open the sockets that we might need
@@ -27,7 +27,7 @@ resolve_attempt_udp::resolve_attempt_udp(asio::io_context &io, const udp &protoc
 	try {
 		bind_port_in_range(recv_socket_, protocol);
 	} catch (std::exception &e) {
-		LOG_F(WARNING,
+		LSL_LOG_F(WARNING,
 			"Could not bind to a port in the configured port range; using a randomly assigned one: "
 			"%s",
 			e.what());
@@ -37,28 +37,31 @@ resolve_attempt_udp::resolve_attempt_udp(asio::io_context &io, const udp &protoc
 		broadcast_socket_.open(protocol);
 		broadcast_socket_.set_option(asio::socket_base::broadcast(true));
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Cannot open UDP broadcast socket for resolves: %s", e.what());
+		LSL_LOG_F(WARNING, "Cannot open UDP broadcast socket for resolves: %s", e.what());
 	}
 	try {
 		multicast_socket_.open(protocol);
 		multicast_socket_.set_option(
 			asio::ip::multicast::hops(api_config::get_instance()->multicast_ttl()));
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Cannot open UDP multicast socket for resolves: %s", e.what());
+		LSL_LOG_F(WARNING, "Cannot open UDP multicast socket for resolves: %s", e.what());
 	}
 
-	// precalc the query id (hash of the query string, as string)
-	query_id_ = std::to_string(std::hash<std::string>()(query));
-	// precalc the query message
-	std::ostringstream os;
-	os.precision(16);
-	os << "LSL:shortinfo\r\n";
-	os << query_ << "\r\n";
-	os << recv_socket_.local_endpoint().port() << " " << query_id_ << "\r\n";
-	query_msg_ = os.str();
-
-	DLOG_F(2, "Waiting for query results (port %d) for %s", recv_socket_.local_endpoint().port(),
-		query_msg_.c_str());
+	for (const auto &query : queries) {
+		// precalc the query id (hash of the query string, as string)
+		query_ids_.push_back(std::to_string(std::hash<std::string>()(query)));
+		// precalc the query message
+		std::ostringstream os;
+		os.precision(16);
+		os << "LSL:shortinfo\r\n";
+		os << query << "\r\n";
+		os << recv_socket_.local_endpoint().port() << " " << query_ids_.back() << " "
+		   << stream_info_impl::binary_shortinfo_capability << "\r\n";
+		query_msgs_.push_back(os.str());
+
+		LSL_DLOG_F(2, "Waiting for query results (port %d) for %s",
+			recv_socket_.local_endpoint().port(), query_msgs_.back().c_str());
+	}
 
 	// register ourselves as a candidate for cancellation
 	register_at(&resolver);
@@ -113,32 +116,37 @@ void resolve_attempt_udp::handle_receive_outcome(err_t err, std::size_t len) {
 			while (newlinepos != bufend && *newlinepos != '\n') ++newlinepos;
 			std::string returned_id(resultbuf_, trim_end(resultbuf_, newlinepos));
 
-			if (returned_id == query_id_ && newlinepos != bufend) {
+			std::vector<std::size_t> queries;
+			for (std::size_t q = 0; q < query_ids_.size(); ++q)
+				if (query_ids_[q] == returned_id) queries.push_back(q);
+
+			if (!queries.empty() && newlinepos != bufend) {
 				// parse the rest of the query into a stream_info
 				stream_info_impl info;
-				info.from_shortinfo_message(std::string(newlinepos, bufend));
+				info.from_shortinfo_message(std::string(newlinepos + 1, bufend));
 				std::string uid = info.uid();
-				{
+				for (std::size_t q : queries) {
 					// update the results
 					std::lock_guard<std::mutex> lock(resolver_.results_mut_);
-					auto it = resolver_.results_.find(uid);
-					if (it == resolver_.results_.end())
+					auto &results = resolver_.results_[q];
+					auto it = results.find(uid);
+					if (it == results.end())
 						// insert new result, store iterator in it
-						it = resolver_.results_.emplace(uid, std::make_pair(info, lsl_clock()))
-								 .first;
+						it = results.emplace(uid, std::make_pair(info, lsl_clock())).first;
 					else
 						it->second.second = lsl_clock(); // update only the receive time
 					auto &stored_info = it->second.first;
 					// ... also update the address associated with the result (but don't
 					// override the address of an earlier record for this stream since this
 					// would be the faster route)
+					const std::string addr = remote_endpoint_.address().to_string();
 					if (remote_endpoint_.address().is_v4()) {
-						if (stored_info.v4address().empty())
-							stored_info.v4address(remote_endpoint_.address().to_string());
+						if (stored_info.v4address().empty()) stored_info.v4address(addr);
 					} else {
-						if (stored_info.v6address().empty())
-							stored_info.v6address(remote_endpoint_.address().to_string());
+						if (stored_info.v6address().empty()) stored_info.v6address(addr);
 					}
+					// remember all other routes as fallbacks, in the order of their replies
+					stored_info.add_address(addr);
 				}
 				// prepone the next cancellation check, i.e. when all needed streams are found,
 				// cancel immediately rather than when a wave timer is due half a second later
@@ -146,7 +154,7 @@ void resolve_attempt_udp::handle_receive_outcome(err_t err, std::size_t len) {
 					resolver_.cancel_ongoing_resolve();
 			}
 		} catch (std::exception &e) {
-			LOG_F(WARNING, "resolve_attempt_udp: hiccup while processing the received data: %s",
+			LSL_LOG_F(WARNING, "resolve_attempt_udp: hiccup while processing the received data: %s",
 				e.what());
 		}
 	}
@@ -157,11 +165,11 @@ void resolve_attempt_udp::handle_receive_outcome(err_t err, std::size_t len) {
 
 // === send loop ===
 
-void resolve_attempt_udp::send_next_query(
-	endpoint_list::const_iterator next, mcast_interface_list::const_iterator mcit) {
+void resolve_attempt_udp::send_next_query(endpoint_list::const_iterator next,
+	mcast_interface_list::const_iterator mcit, std::size_t query) {
 	if (cancelled_ || mcit == multicast_interfaces.end()) return;
 	auto proto = recv_socket_.local_endpoint().protocol();
-	if (next == targets_.begin()) {
+	if (next == targets_.begin() && query == 0) {
 		// Mismatching protocols? Skip this round
 		if (mcit->addr.is_v4() != (proto == asio::ip::udp::v4()))
 			next = targets_.end();
@@ -170,7 +178,13 @@ void resolve_attempt_udp::send_next_query(
 															: outbound_interface(mcit->ifindex));
 	}
 	if (next != targets_.end()) {
-		udp::endpoint ep(*next++);
+		udp::endpoint ep(*next);
+		// send all queries to an endpoint before moving on to the next one
+		std::size_t next_query = query + 1;
+		if (next_query == query_msgs_.size()) {
+			++next;
+			next_query = 0;
+		}
 		// endpoint matches our active protocol?
 		if (ep.protocol() == recv_socket_.local_endpoint().protocol()) {
 			// select socket to use
@@ -180,15 +194,16 @@ void resolve_attempt_udp::send_next_query(
 					: (ep.address().is_multicast() ? multicast_socket_ : unicast_socket_);
 			// and send the query over it
 			auto keepalive(shared_from_this());
-			sock.async_send_to(asio::buffer(query_msg_), ep,
-				[shared_this = shared_from_this(), next, mcit](err_t err, size_t /*unused*/) {
+			sock.async_send_to(asio::buffer(query_msgs_[query]), ep,
+				[shared_this = shared_from_this(), next, mcit, next_query](
+					err_t err, size_t /*unused*/) {
 					if (!shared_this->cancelled_ && err != asio::error::operation_aborted &&
 						err != asio::error::not_connected && err != asio::error::not_socket)
-						shared_this->send_next_query(next, mcit);
+						shared_this->send_next_query(next, mcit, next_query);
 				});
 		} else
 			// otherwise just go directly to the next query
-			send_next_query(next, mcit);
+			send_next_query(next, mcit, next_query);
 	} else
 		// Restart from the next interface
 		send_next_query(targets_.begin(), ++mcit);
@@ -203,7 +218,7 @@ void resolve_attempt_udp::do_cancel() {
 		if (recv_socket_.is_open()) recv_socket_.close();
 		cancel_timer_.cancel();
 	} catch (std::exception &e) {
-		LOG_F(WARNING,
+		LSL_LOG_F(WARNING,
 			"Unexpected error while trying to cancel operations of resolve_attempt_udp: %s",
 			e.what());
 	}
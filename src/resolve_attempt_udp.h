@@ -26,12 +26,13 @@ using result_container = std::map<std::string, std::pair<stream_info_impl, doubl
 using mcast_interface_list = std::vector<class netif>;
 
 /**
- * An asynchronous resolve attempt for a single query targeted at a set of endpoints, via UDP.
+ * An asynchronous resolve attempt for one or more queries targeted at a set of endpoints, via UDP.
  *
  * A resolve attempt is an asynchronous operation submitted to an IO object, which amounts to a
- * sequence of query packet sends (one for each endpoint in the list) and a sequence of result
- * packet receives. The operation will wait for return packets until either a particular timeout has
- * been reached or until it is cancelled via the cancel() method.
+ * sequence of query packet sends (one for each query and endpoint in the list) and a sequence of
+ * result packet receives. Results are assigned to their query by the returned query id. The
+ * operation will wait for return packets until either a particular timeout has been reached or
+ * until it is cancelled via the cancel() method.
  */
 class resolve_attempt_udp final : public cancellable_obj,
 								  public std::enable_shared_from_this<resolve_attempt_udp> {
@@ -45,8 +46,8 @@ public:
 	 * @param protocol The protocol (either udp::v4() or udp::v6()) to use for communications;
 	 * only the subset of target addresses matching this protocol will be considered.
 	 * @param targets A list of udp::endpoint that should be targeted by this query.
-	 * @param query The query string to send (usually a set of conditions on the properties of the
-	 * stream info that should be searched, for example `name='BioSemi' and type='EEG'`.
+	 * @param queries The query strings to send (usually a set of conditions on the properties of
+	 * the stream info that should be searched, for example `name='BioSemi' and type='EEG'`.
 	 * See lsl_stream_info_matches_query for the definition of a query.
 	 * @param results Reference to a container into which results are stored; potentially shared
 	 * with other parallel resolve operations. Since this is not thread-safe all operations
@@ -58,7 +59,7 @@ public:
 	 * cancelled during shutdown.
 	 */
 	resolve_attempt_udp(asio::io_context &io, const udp &protocol,
-		const std::vector<udp::endpoint> &targets, const std::string &query,
+		const std::vector<udp::endpoint> &targets, const std::vector<std::string> &queries,
 		resolver_impl &resolver, double cancel_after = 5.0);
 
 	/// Destructor
@@ -80,9 +81,9 @@ private:
 	/// This function asks to receive the next result packet.
 	void receive_next_result();
 
-	/// Thos function starts an async send operation for the given current endpoint.
-	void send_next_query(
-		endpoint_list::const_iterator next, mcast_interface_list::const_iterator mcit);
+	/// Thos function starts an async send operation for the given current endpoint and query.
+	void send_next_query(endpoint_list::const_iterator next,
+		mcast_interface_list::const_iterator mcit, std::size_t query = 0);
 
 	/// Handler that gets called when a receive has completed.
 	void handle_receive_outcome(err_t err, std::size_t len);
@@ -106,12 +107,10 @@ private:
 	bool cancelled_;
 	/// list of endpoints that should receive the query
 	std::vector<udp::endpoint> targets_;
-	/// the query string
-	std::string query_;
-	/// the query message that we're sending
-	std::string query_msg_;
-	/// the (more or less) unique id for this query
-	std::string query_id_;
+	/// the query messages that we're sending, one per query
+	std::vector<std::string> query_msgs_;
+	/// the (more or less) unique ids for the queries
+	std::vector<std::string> query_ids_;
 
 	// data maintained/modified across handler invocations
 	/// the endpoint from which we received the last result
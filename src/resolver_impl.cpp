@@ -1,13 +1,14 @@
 #include "resolver_impl.h"
 #include "api_config.h"
+#include "logging.h"
 #include "resolve_attempt_udp.h"
 #include "socket_utils.h"
 #include "stream_info_impl.h"
+#include <algorithm>
 #include <asio/io_context.hpp>
 #include <asio/ip/basic_resolver.hpp>
 #include <asio/ip/udp.hpp>
 #include <exception>
-#include <loguru.hpp>
 #include <memory>
 #include <pugixml.hpp>
 #include <stdexcept>
@@ -79,25 +80,49 @@ resolver_impl *resolver_impl::create_resolver(
 		resolver->resolve_continuous(build_query(pred_or_prop, value), forget_after);
 		return resolver;
 	} catch (std::exception &e) {
-		LOG_F(ERROR, "Error while creating a continuous_resolver: %s", e.what());
+		LSL_LOG_F(ERROR, "Error while creating a continuous_resolver: %s", e.what());
 		return nullptr;
 	}
 }
 
+bool resolver_impl::resolve_cached(
+	const std::string &query, int minimum, std::vector<stream_info_impl> &result) {
+	const double ttl = api_config::get_instance()->discovery_cache_ttl();
+	if (ttl <= 0 || minimum <= 0) return false;
+	// constructed after (and thus destroyed before) the api_config used by its background thread
+	static const std::unique_ptr<resolver_impl> cache(create_resolver(ttl));
+	return cache && resolve_cached(*cache, query, minimum, result);
+}
+
+bool resolver_impl::resolve_cached(resolver_impl &cache, const std::string &query, int minimum,
+	std::vector<stream_info_impl> &result) {
+	result.clear();
+	for (auto &info : cache.results())
+		if (info.matches_query(query, true)) result.push_back(std::move(info));
+	return result.size() >= static_cast<std::size_t>(minimum);
+}
+
 // === resolve functions ===
 
 std::vector<stream_info_impl> resolver_impl::resolve_oneshot(
 	const std::string &query, int minimum, double timeout, double minimum_time) {
+	return resolve_oneshot(std::vector<std::string>{query}, minimum, timeout, minimum_time)
+		.front();
+}
+
+std::vector<std::vector<stream_info_impl>> resolver_impl::resolve_oneshot(
+	const std::vector<std::string> &queries, int minimum, double timeout, double minimum_time) {
 	if(status == resolver_status::running_continuous)
 		throw std::logic_error("resolve_oneshot called during continuous operation");
+	if (queries.empty()) throw std::invalid_argument("resolve_oneshot called without a query");
 
-	check_query(query);
+	for (const auto &query : queries) check_query(query);
 	// reset the IO service & set up the query parameters
 	io_->restart();
-	query_ = query;
+	queries_ = queries;
 	minimum_ = minimum;
 	wait_until_ = lsl_clock() + minimum_time;
-	results_.clear();
+	results_.assign(queries.size(), result_container());
 	forget_after_ = FOREVER;
 	fast_mode_ = true;
 	expired_ = false;
@@ -117,14 +142,14 @@ std::vector<stream_info_impl> resolver_impl::resolve_oneshot(
 	status = resolver_status::started_oneshot;
 
 	// run the IO operations until finished
+	std::vector<std::vector<stream_info_impl>> output(queries.size());
 	if (!cancelled_) {
 		io_->run();
 		// collect output
-		std::vector<stream_info_impl> output;
-		for (auto &result : results_) output.push_back(result.second.first);
-		return output;
+		for (std::size_t q = 0; q < queries.size(); ++q)
+			for (auto &result : results_[q]) output[q].push_back(result.second.first);
 	}
-	return {};
+	return output;
 }
 
 void resolver_impl::resolve_continuous(const std::string &query, double forget_after) {
@@ -134,10 +159,10 @@ void resolver_impl::resolve_continuous(const std::string &query, double forget_a
 	check_query(query);
 	// reset the IO service & set up the query parameters
 	io_->restart();
-	query_ = query;
+	queries_ = {query};
 	minimum_ = 0;
 	wait_until_ = 0;
-	results_.clear();
+	results_.assign(1, result_container());
 	forget_after_ = forget_after;
 	fast_mode_ = false;
 	expired_ = false;
@@ -156,9 +181,10 @@ std::vector<stream_info_impl> resolver_impl::results(uint32_t max_results) {
 	std::lock_guard<std::mutex> lock(results_mut_);
 	double expired_before = lsl_clock() - forget_after_;
 
-	for (auto it = results_.begin(); it != results_.end();) {
+	auto &results = results_.front();
+	for (auto it = results.begin(); it != results.end();) {
 		if (it->second.second < expired_before)
-			it = results_.erase(it);
+			it = results.erase(it);
 		else {
 			if (output.size() < max_results) output.push_back(it->second.first);
 			it++;
@@ -199,11 +225,11 @@ void resolver_impl::udp_multicast_burst() {
 	for (auto protocol: udp_protocols_) {
 		try {
 			std::make_shared<resolve_attempt_udp>(
-				*io_, protocol, mcast_endpoints_, query_, *this, cfg_->multicast_max_rtt())
+				*io_, protocol, mcast_endpoints_, queries_, *this, cfg_->multicast_max_rtt())
 				->begin();
 		} catch (std::exception &e) {
 			if (++failures == udp_protocols_.size())
-				LOG_F(ERROR,
+				LSL_LOG_F(ERROR,
 					"Could not start a multicast resolve attempt for any of the allowed "
 					"protocol stacks: %s",
 					e.what());
@@ -219,11 +245,11 @@ void resolver_impl::udp_unicast_burst(err_t err) {
 	for (auto protocol: udp_protocols_) {
 		try {
 			std::make_shared<resolve_attempt_udp>(
-				*io_, protocol, ucast_endpoints_, query_, *this, cfg_->unicast_max_rtt())
+				*io_, protocol, ucast_endpoints_, queries_, *this, cfg_->unicast_max_rtt())
 				->begin();
 		} catch (std::exception &e) {
 			if (++failures == udp_protocols_.size())
-				LOG_F(WARNING,
+				LSL_LOG_F(WARNING,
 					"Could not start a unicast resolve attempt for any of the allowed protocol "
 					"stacks: %s",
 					e.what());
@@ -240,10 +266,12 @@ void resolver_impl::cancel() {
 
 bool resolver_impl::check_cancellation_criteria()
 {
+	// the fewest results of any query
 	std::size_t num_results = 0;
 	{
 		std::lock_guard<std::mutex> lock(results_mut_);
-		num_results = results_.size();
+		if (!results_.empty()) num_results = results_.front().size();
+		for (const auto &results : results_) num_results = std::min(num_results, results.size());
 	}
 	if (cancelled_ || expired_) return true;
 	if (minimum_ && (num_results >= (std::size_t)minimum_) && lsl_clock() >= wait_until_)
@@ -270,6 +298,6 @@ resolver_impl::~resolver_impl() {
 			background_io_->join();
 		}
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Error during destruction of a resolver_impl: %s", e.what());
-	} catch (...) { LOG_F(ERROR, "Severe error during destruction of a resolver_impl."); }
+		LSL_LOG_F(WARNING, "Error during destruction of a resolver_impl: %s", e.what());
+	} catch (...) { LSL_LOG_F(ERROR, "Severe error during destruction of a resolver_impl."); }
 }
@@ -78,6 +78,24 @@ public:
 	static resolver_impl *create_resolver(double forget_after, const char *pred_or_prop = nullptr,
 		const char *value = nullptr) noexcept;
 
+	/**
+	 * Look up the streams matching a query in the process-wide discovery cache.
+	 *
+	 * The cache is enabled by setting `tuning.DiscoveryCacheTTL`. The first lookup starts a
+	 * continuous resolver for all streams in the session that keeps refreshing the cache, so
+	 * streams that disappeared are forgotten after the TTL.
+	 * @param query The query string, see resolve_oneshot().
+	 * @param minimum The minimum number of matching streams for the lookup to succeed (>0).
+	 * @param[out] result The matching cached streams.
+	 * @return Whether enough streams were found, otherwise the query should be resolved normally.
+	 */
+	static bool resolve_cached(
+		const std::string &query, int minimum, std::vector<stream_info_impl> &result);
+
+	/// Look up the streams matching a query in the results of a continuous resolver, see above.
+	static bool resolve_cached(resolver_impl &cache, const std::string &query, int minimum,
+		std::vector<stream_info_impl> &result);
+
 	/// Destructor. Cancels any ongoing processes and waits until they finish.
 	~resolver_impl() final;
 
@@ -101,6 +119,21 @@ public:
 	std::vector<stream_info_impl> resolve_oneshot(const std::string &query, int minimum = 0,
 		double timeout = FOREVER, double minimum_time = 0.0);
 
+	/**
+	 * Resolve several query strings at once.
+	 *
+	 * All queries are sent in the same resolve waves and the results are assigned to their query
+	 * by the query id in the responses, so this takes about as long as resolving a single query.
+	 * Blocks until at least the minimum number of streams has been resolved for each query, or the
+	 * timeout fires, or the resolve has been cancelled.
+	 * @return The matching streams for each query, in the order of the queries. A stream that
+	 * matches several queries is returned for each of them.
+	 * @see resolve_oneshot(const std::string&,int,double,double)
+	 */
+	std::vector<std::vector<stream_info_impl>> resolve_oneshot(
+		const std::vector<std::string> &queries, int minimum = 0, double timeout = FOREVER,
+		double minimum_time = 0.0);
+
 	/**
 	 * Starts a background thread that resolves a query string and periodically updates the list of
 	 * present streams.
@@ -167,9 +200,9 @@ private:
 
 	// reinitialized for each query
 	resolver_status status{resolver_status::empty};
-	/// our current query string
-	std::string query_;
-	/// the minimum number of results that we want
+	/// our current query strings
+	std::vector<std::string> queries_;
+	/// the minimum number of results that we want for each query
 	int minimum_{0};
 	/// forget results that are older than this (continuous operation only)
 	double forget_after_;
@@ -178,8 +211,8 @@ private:
 	double wait_until_{0};
 	/// whether this is a fast resolve: determines the rate at which the query is repeated
 	bool fast_mode_;
-	/// results are stored here
-	result_container results_;
+	/// results are stored here, one container per query
+	std::vector<result_container> results_;
 	/// a mutex that protects the results map
 	std::mutex results_mut_;
 
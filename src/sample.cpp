@@ -2,9 +2,11 @@
 #define BOOST_MATH_DISABLE_STD_FPCLASSIFY
 #include "sample.h"
 #include "common.h"
+#include "sample_codec.h"
 #include "portable_archive/portable_iarchive.hpp"
 #include "portable_archive/portable_oarchive.hpp"
 #include "util/cast.hpp"
+#include "util/memstats.hpp"
 #include <boost/endian/conversion.hpp>
 
 using namespace lsl;
@@ -64,6 +66,74 @@ inline void copyconvert_array(const std::string *src, std::string *dst, std::siz
 	std::copy_n(src, n, dst);
 }
 
+/// Convert a value into a (possibly unaligned) record channel of type F
+template <typename F, typename T> inline void store_as(char *field, const T &value) {
+	F v;
+	copyconvert_array(&value, &v, 1);
+	memcpy(field, &v, sizeof(F));
+}
+
+/// Convert a (possibly unaligned) record channel of type F into a value
+template <typename F, typename T> inline void load_as(const char *field, T &value) {
+	F v;
+	memcpy(&v, field, sizeof(F));
+	copyconvert_array(&v, &value, 1);
+}
+
+/// Convert a value into a record channel of the given format
+template <typename T> void store_field(char *field, lsl_channel_format_t fmt, const T &value) {
+	switch (fmt) {
+	case cft_float32: store_as<float>(field, value); break;
+	case cft_double64: store_as<double>(field, value); break;
+	case cft_int8: store_as<int8_t>(field, value); break;
+	case cft_int16: store_as<int16_t>(field, value); break;
+	case cft_int32: store_as<int32_t>(field, value); break;
+	case cft_int64: store_as<int64_t>(field, value); break;
+	default: throw std::invalid_argument("Unsupported record channel format.");
+	}
+}
+
+/// Convert a record channel of the given format into a value
+template <typename T> void load_field(const char *field, lsl_channel_format_t fmt, T &value) {
+	switch (fmt) {
+	case cft_float32: load_as<float>(field, value); break;
+	case cft_double64: load_as<double>(field, value); break;
+	case cft_int8: load_as<int8_t>(field, value); break;
+	case cft_int16: load_as<int16_t>(field, value); break;
+	case cft_int32: load_as<int32_t>(field, value); break;
+	case cft_int64: load_as<int64_t>(field, value); break;
+	default: throw std::invalid_argument("Unsupported record channel format.");
+	}
+}
+
+/// Flush a (possibly unaligned) subnormal float32 or double64 value to zero
+void suppress_subnormal(char *val, lsl_channel_format_t fmt) {
+	if (fmt == cft_float32) {
+		uint32_t v;
+		memcpy(&v, val, sizeof(v));
+		if (v && ((v & UINT32_C(0x7fffffff)) <= UINT32_C(0x007fffff))) v &= UINT32_C(0x80000000);
+		memcpy(val, &v, sizeof(v));
+	} else if (fmt == cft_double64) {
+		uint64_t v;
+		memcpy(&v, val, sizeof(v));
+		if (v && ((v & UINT64_C(0x7fffffffffffffff)) <= UINT64_C(0x000fffffffffffff)))
+			v &= UINT64_C(0x8000000000000000);
+		memcpy(val, &v, sizeof(v));
+	}
+}
+
+lsl::record_layout::record_layout(std::vector<lsl_channel_format_t> formats)
+	: formats_(std::move(formats)) {
+	offsets_.reserve(formats_.size() + 1);
+	offsets_.push_back(0);
+	for (auto fmt : formats_) {
+		if (fmt < cft_float32 || fmt > cft_int64 || fmt == cft_string)
+			throw std::invalid_argument("The channels of a record must have numeric formats.");
+		has_floats_ = has_floats_ || format_float[fmt];
+		offsets_.push_back(offsets_.back() + format_sizes[fmt]);
+	}
+}
+
 template <typename T, typename U> void lsl::sample::conv_from(const U *src) {
 	copyconvert_array(src, reinterpret_cast<T *>(&data_), num_channels_);
 }
@@ -72,14 +142,43 @@ template <typename T, typename U> void lsl::sample::conv_into(U *dst) {
 	copyconvert_array(reinterpret_cast<const T *>(&data_), dst, num_channels_);
 }
 
+// The strided variants load / store each value with memcpy (the application's values don't have
+// to be aligned) and convert it in the same pass, so there's no packed intermediate copy
+template <typename T, typename U>
+void lsl::sample::gather_from(const char *src, const channel_layout &layout) {
+	for (uint32_t k = 0; k < num_channels_; ++k) {
+		U value;
+		memcpy(&value, src + layout.offset(k), sizeof(U));
+		if constexpr (std::is_same<T, std::string>::value)
+			copyconvert_array(&value, reinterpret_cast<T *>(&data_) + k, 1);
+		else {
+			T converted;
+			copyconvert_array(&value, &converted, 1);
+			memcpy(data_bytes() + k * sizeof(T), &converted, sizeof(T));
+		}
+	}
+}
+
+template <typename T, typename U>
+void lsl::sample::scatter_into(char *dst, const channel_layout &layout) {
+	const auto *src = reinterpret_cast<const T *>(&data_);
+	for (uint32_t k = 0; k < num_channels_; ++k) {
+		U value;
+		copyconvert_array(src + k, &value, 1);
+		memcpy(dst + layout.offset(k), &value, sizeof(U));
+	}
+}
+
 void sample::operator delete(void *x) noexcept {
 	if (x == nullptr) return;
 
 	lsl::factory *factory = reinterpret_cast<sample *>(x)->factory_;
 
 	// delete the underlying memory only if it wasn't allocated in the factory's storage area
-	if (x < factory->storage_ || x >= factory->storage_ + factory->storage_size_)
+	if (x < factory->storage_ || x >= factory->storage_ + factory->storage_size_) {
 		delete[] (char *)x;
+		memstats::add(memstats::component::factory, -int64_t(factory->sample_size_));
+	}
 }
 
 /// ensure that a given value is a multiple of some base, round up if necessary
@@ -116,6 +215,12 @@ template <class T> void lsl::sample::assign_typed(const T *src) {
 	case cft_int64: conv_from<int64_t>(src); break;
 #endif
 	case cft_string: conv_from<std::string>(src); break;
+	case cft_record: {
+		auto *data = reinterpret_cast<char *>(&data_);
+		for (uint32_t k = 0; k < num_channels_; ++k)
+			store_field(data + channel_offset(k), channel_format(k), src[k]);
+		break;
+	}
 	default: throw std::invalid_argument("Unsupported channel format.");
 	}
 }
@@ -131,6 +236,60 @@ template <class T> void lsl::sample::retrieve_typed(T *dst) {
 	case cft_int64: conv_into<int64_t>(dst); break;
 #endif
 	case cft_string: conv_into<std::string>(dst); break;
+	case cft_record: {
+		const auto *data = reinterpret_cast<const char *>(&data_);
+		for (uint32_t k = 0; k < num_channels_; ++k)
+			load_field(data + channel_offset(k), channel_format(k), dst[k]);
+		break;
+	}
+	default: throw std::invalid_argument("Unsupported channel format.");
+	}
+}
+
+template <class T> void lsl::sample::assign_strided(const char *src, const channel_layout &layout) {
+	switch (format_) {
+	case cft_float32: gather_from<float, T>(src, layout); break;
+	case cft_double64: gather_from<double, T>(src, layout); break;
+	case cft_int8: gather_from<int8_t, T>(src, layout); break;
+	case cft_int16: gather_from<int16_t, T>(src, layout); break;
+	case cft_int32: gather_from<int32_t, T>(src, layout); break;
+#ifndef BOOST_NO_INT64_T
+	case cft_int64: gather_from<int64_t, T>(src, layout); break;
+#endif
+	case cft_string: gather_from<std::string, T>(src, layout); break;
+	case cft_record: {
+		auto *data = reinterpret_cast<char *>(&data_);
+		for (uint32_t k = 0; k < num_channels_; ++k) {
+			T value;
+			memcpy(&value, src + layout.offset(k), sizeof(T));
+			store_field(data + channel_offset(k), channel_format(k), value);
+		}
+		break;
+	}
+	default: throw std::invalid_argument("Unsupported channel format.");
+	}
+}
+
+template <class T> void lsl::sample::retrieve_strided(char *dst, const channel_layout &layout) {
+	switch (format_) {
+	case cft_float32: scatter_into<float, T>(dst, layout); break;
+	case cft_double64: scatter_into<double, T>(dst, layout); break;
+	case cft_int8: scatter_into<int8_t, T>(dst, layout); break;
+	case cft_int16: scatter_into<int16_t, T>(dst, layout); break;
+	case cft_int32: scatter_into<int32_t, T>(dst, layout); break;
+#ifndef BOOST_NO_INT64_T
+	case cft_int64: scatter_into<int64_t, T>(dst, layout); break;
+#endif
+	case cft_string: scatter_into<std::string, T>(dst, layout); break;
+	case cft_record: {
+		const auto *data = reinterpret_cast<const char *>(&data_);
+		for (uint32_t k = 0; k < num_channels_; ++k) {
+			T value;
+			load_field(data + channel_offset(k), channel_format(k), value);
+			memcpy(dst + layout.offset(k), &value, sizeof(T));
+		}
+		break;
+	}
 	default: throw std::invalid_argument("Unsupported channel format.");
 	}
 }
@@ -149,6 +308,40 @@ void lsl::sample::retrieve_untyped(void *newdata) {
 		throw std::invalid_argument("Cannot retrieve untyped data from a string-formatted sample.");
 }
 
+void lsl::sample::assign_channels(const sample &src) {
+	if (format_ != src.format_ || num_channels_ != src.num_channels_)
+		throw std::invalid_argument("Cannot copy channels between samples of different formats.");
+	if (format_ == cft_string)
+		std::copy(samplevals<std::string>(src).begin(), samplevals<std::string>(src).end(),
+			samplevals<std::string>(*this).begin());
+	else
+		memcpy(&data_, &src.data_, datasize());
+}
+
+double lsl::sample::numeric_value(uint32_t channel) const {
+	switch (format_) {
+	case cft_float32: return samplevals<float>(*this).begin()[channel];
+	case cft_double64: return samplevals<double>(*this).begin()[channel];
+	case cft_int8: return samplevals<int8_t>(*this).begin()[channel];
+	case cft_int16: return samplevals<int16_t>(*this).begin()[channel];
+	case cft_int32: return samplevals<int32_t>(*this).begin()[channel];
+	case cft_int64: return static_cast<double>(samplevals<int64_t>(*this).begin()[channel]);
+	case cft_record: {
+		double value;
+		load_field(reinterpret_cast<const char *>(&data_) + channel_offset(channel),
+			channel_format(channel), value);
+		return value;
+	}
+	default: throw std::invalid_argument("Cannot get a numeric value of a string sample.");
+	}
+}
+
+const std::string &lsl::sample::string_value(uint32_t channel) const {
+	if (format_ != cft_string)
+		throw std::invalid_argument("Cannot get a string value of a numeric sample.");
+	return samplevals<std::string>(*this).begin()[channel];
+}
+
 /// Helper function to save raw binary data to a stream buffer.
 void save_raw(std::streambuf &sb, const void *address, std::size_t count) {
 	if ((std::size_t)sb.sputn((const char *)address, (std::streamsize)count) != count)
@@ -186,15 +379,26 @@ template <typename T> void save_value(std::streambuf &sb, T v, bool reverse_byte
 	save_raw(sb, &v, sizeof(T));
 }
 
+std::size_t sample::save_header(char *dst, bool changes, bool reverse_byte_order) const {
+	if (timestamp_ == DEDUCED_TIMESTAMP) {
+		*dst = static_cast<char>(changes ? TAG_DEDUCED_TIMESTAMP_CHANGES : TAG_DEDUCED_TIMESTAMP);
+		return 1;
+	}
+	double ts = timestamp_;
+	if (reverse_byte_order) endian_reverse_inplace(ts);
+	*dst = static_cast<char>(
+		changes ? TAG_TRANSMITTED_TIMESTAMP_CHANGES : TAG_TRANSMITTED_TIMESTAMP);
+	memcpy(dst + 1, &ts, sizeof(ts));
+	return 1 + sizeof(ts);
+}
+
 void sample::save_streambuf(
 	std::streambuf &sb, int /*protocol_version*/, bool reverse_byte_order, void *scratchpad) const {
+	if (const sample_codec *codec = select_codec(format_, num_channels_, reverse_byte_order, false))
+		return save_streambuf(sb, *codec, scratchpad);
 	// write sample header
-	if (timestamp_ == DEDUCED_TIMESTAMP) {
-		save_byte(sb, TAG_DEDUCED_TIMESTAMP);
-	} else {
-		save_byte(sb, TAG_TRANSMITTED_TIMESTAMP);
-		save_value(sb, timestamp_, reverse_byte_order);
-	}
+	char header[1 + sizeof(double)];
+	save_raw(sb, header, save_header(header, false, reverse_byte_order));
 	// write channel data
 	if (format_ == cft_string) {
 		for (const auto &str : samplevals<std::string>(*this)) {
@@ -215,17 +419,143 @@ void sample::save_streambuf(
 			if (!str.empty()) save_raw(sb, str.data(), str.size());
 		}
 	} else {
-		// write numeric data in binary
-		if (!reverse_byte_order || format_sizes[format_] == 1) {
+		// write record data in binary
+		if (!reverse_byte_order) {
 			save_raw(sb, &data_, datasize());
 		} else {
 			memcpy(scratchpad, &data_, datasize());
-			convert_endian(scratchpad, num_channels_, format_sizes[format_]);
+			reverse_channels(static_cast<char *>(scratchpad));
 			save_raw(sb, scratchpad, datasize());
 		}
 	}
 }
 
+void sample::save_streambuf(std::streambuf &sb, const sample_codec &codec, void *scratchpad) const {
+	char header[1 + sizeof(double)];
+	save_raw(sb, header, save_header(header, false, codec.reverse_byte_order));
+	if (codec.verbatim) {
+		save_raw(sb, &data_, datasize());
+		return;
+	}
+	codec.encode(static_cast<char *>(scratchpad), reinterpret_cast<const char *>(&data_),
+		num_channels_);
+	save_raw(sb, scratchpad, datasize());
+}
+
+/// Copy n values of type T with reversed byte order between possibly unaligned buffers
+template <typename T> void save_reversed(char *dst, const char *src, std::size_t n) {
+	for (std::size_t i = 0; i < n; ++i, src += sizeof(T), dst += sizeof(T)) {
+		T v;
+		memcpy(&v, src, sizeof(T));
+		endian_reverse_inplace(v);
+		memcpy(dst, &v, sizeof(T));
+	}
+}
+
+/// Copy n values of the given width, optionally with reversed byte order
+void copy_values(char *dst, const char *src, std::size_t n, std::size_t width, bool reverse) {
+	if (!reverse || width == 1) {
+		memcpy(dst, src, n * width);
+		return;
+	}
+	switch (width) {
+	case sizeof(int16_t): save_reversed<int16_t>(dst, src, n); break;
+	case sizeof(int32_t): save_reversed<int32_t>(dst, src, n); break;
+	case sizeof(int64_t): save_reversed<int64_t>(dst, src, n); break;
+	default: throw std::runtime_error("Unsupported channel format for endian conversion.");
+	}
+}
+
+void sample::save_buffer(char *dst, bool reverse_byte_order, uint32_t begin, uint32_t end) const {
+	if (const sample_codec *codec = select_codec(format_, num_channels_, reverse_byte_order, false))
+		return save_buffer(dst, *codec, begin, end);
+	if (format_ == cft_string)
+		throw std::invalid_argument("Cannot serialize a string-formatted sample to a buffer.");
+	// write the sample header along with the first channel
+	if (begin == 0) save_header(dst, false, reverse_byte_order);
+	dst += serialized_size() - datasize();
+	// write record data in binary; the destination isn't necessarily aligned
+	const auto *src = reinterpret_cast<const char *>(&data_);
+	if (!reverse_byte_order) {
+		const std::size_t first = channel_offset(begin);
+		memcpy(dst + first, src + first, channel_offset(end) - first);
+		return;
+	}
+	for (uint32_t ch = begin; ch < end; ++ch)
+		copy_values(dst + channel_offset(ch), src + channel_offset(ch), 1,
+			format_sizes[channel_format(ch)], true);
+}
+
+void sample::save_buffer(char *dst, const sample_codec &codec, uint32_t begin, uint32_t end) const {
+	if (begin == 0) save_header(dst, false, codec.reverse_byte_order);
+	dst += serialized_size() - datasize();
+	const auto *src = reinterpret_cast<const char *>(&data_);
+	if (begin == 0 && end == num_channels_) {
+		codec.encode(dst, src, num_channels_);
+		return;
+	}
+	const std::size_t first = codec.value_size * static_cast<std::size_t>(begin);
+	codec.encode_values(dst + first, src + first, end - begin);
+}
+
+bool sample::save_changes(std::streambuf &sb, const sample *reference, bool reverse_byte_order,
+	void *scratchpad) const {
+	if (const sample_codec *codec = select_codec(format_, num_channels_, reverse_byte_order, false))
+		return save_changes(sb, reference, *codec, scratchpad);
+	auto save_all = [&]() {
+		save_streambuf(sb, 110, reverse_byte_order, scratchpad);
+		return false;
+	};
+	if (!reference || format_ == cft_string) return save_all();
+	// collect the bitmap of changed channels and their values in the scratchpad, and give up as
+	// soon as that's no shorter than all values
+	const std::size_t mask_bytes = (num_channels_ + 7) / 8;
+	char *out = static_cast<char *>(scratchpad);
+	memset(out, 0, mask_bytes);
+	std::size_t len = mask_bytes;
+	const char *cur = reinterpret_cast<const char *>(&data_),
+			   *prev = reinterpret_cast<const char *>(&reference->data_);
+	for (uint32_t ch = 0; ch < num_channels_; ++ch) {
+		const std::size_t offset = channel_offset(ch), width = format_sizes[channel_format(ch)];
+		// compare the bits, so e.g. a NaN that stays NaN is unchanged
+		if (memcmp(cur + offset, prev + offset, width) == 0) continue;
+		if (len + width >= datasize()) return save_all();
+		out[ch / 8] = static_cast<char>(out[ch / 8] | (1 << (ch % 8)));
+		copy_values(out + len, cur + offset, 1, width, reverse_byte_order);
+		len += width;
+	}
+	char header[1 + sizeof(double)];
+	save_raw(sb, header, save_header(header, true, reverse_byte_order));
+	save_raw(sb, out, len);
+	return true;
+}
+
+bool sample::save_changes(std::streambuf &sb, const sample *reference, const sample_codec &codec,
+	void *scratchpad) const {
+	auto save_all = [&]() {
+		save_streambuf(sb, codec, scratchpad);
+		return false;
+	};
+	if (!reference) return save_all();
+	const std::size_t mask_bytes = (num_channels_ + 7) / 8, width = codec.value_size;
+	char *out = static_cast<char *>(scratchpad);
+	memset(out, 0, mask_bytes);
+	std::size_t len = mask_bytes;
+	const char *cur = reinterpret_cast<const char *>(&data_),
+			   *prev = reinterpret_cast<const char *>(&reference->data_);
+	for (uint32_t ch = 0; ch < num_channels_; ++ch, cur += width, prev += width) {
+		if (memcmp(cur, prev, width) == 0) continue;
+		if (len + width >= datasize()) return save_all();
+		out[ch / 8] = static_cast<char>(out[ch / 8] | (1 << (ch % 8)));
+		codec.encode_values(out + len, cur, 1);
+		len += width;
+	}
+	char header[1 + sizeof(double)];
+	save_raw(sb, header, save_header(header, true, codec.reverse_byte_order));
+	save_raw(sb, out, len);
+	return true;
+}
+
 void sample::load_streambuf(
 	std::streambuf &sb, int /*unused*/, bool reverse_byte_order, bool suppress_subnormals) {
 	// read sample header
@@ -262,21 +592,178 @@ void sample::load_streambuf(
 	} else {
 		// read numeric channel data
 		load_raw(sb, &data_, datasize());
-		if (reverse_byte_order && format_sizes[format_] > 1)
-			convert_endian(&data_, num_channels(), format_sizes[format_]);
-		if (suppress_subnormals && format_float[format_]) {
-			if (format_ == cft_float32) {
-				for (auto &val : samplevals<uint32_t>(*this))
-					if (val && ((val & UINT32_C(0x7fffffff)) <= UINT32_C(0x007fffff)))
-						val &= UINT32_C(0x80000000);
-			} else {
+		convert_loaded_data(reverse_byte_order, suppress_subnormals);
+	}
+}
+
+/// Load a value from a memory buffer with correct endian treatment, return false if incomplete
+template <typename T>
+inline bool load_value(const char *&pos, const char *end, T &v, bool reverse_byte_order) {
+	if (static_cast<std::size_t>(end - pos) < sizeof(T)) return false;
+	memcpy(&v, pos, sizeof(T));
+	pos += sizeof(T);
+	if (sizeof(T) > 1 && reverse_byte_order) endian_reverse_inplace(v);
+	return true;
+}
+
+const char *sample::load_header(
+	const char *pos, const char *end, bool reverse_byte_order, bool &changes) {
+	if (pos == end) return nullptr;
+	const auto tag = static_cast<uint8_t>(*pos++);
+	changes = tag == TAG_DEDUCED_TIMESTAMP_CHANGES || tag == TAG_TRANSMITTED_TIMESTAMP_CHANGES;
+	if (tag == TAG_DEDUCED_TIMESTAMP || tag == TAG_DEDUCED_TIMESTAMP_CHANGES)
+		timestamp_ = DEDUCED_TIMESTAMP;
+	else if (!load_value(pos, end, timestamp_, reverse_byte_order))
+		return nullptr;
+	return pos;
+}
+
+const char *sample::load_buffer(const char *begin, const char *end, bool reverse_byte_order,
+	bool suppress_subnormals, const sample *reference) {
+	if (const sample_codec *codec =
+			select_codec(format_, num_channels_, reverse_byte_order, suppress_subnormals))
+		return load_buffer(begin, end, *codec, reference);
+	// read sample header
+	bool changes;
+	const char *pos = load_header(begin, end, reverse_byte_order, changes);
+	if (!pos) return nullptr;
+	if (changes) return load_changes(pos, end, reverse_byte_order, suppress_subnormals, reference);
+
+	// read channel data
+	if (format_ == cft_string) {
+		for (auto &str : samplevals<std::string>(*this)) {
+			// read string length as variable-length integer
+			if (pos == end) return nullptr;
+			const auto lenbytes = static_cast<uint8_t>(*pos++);
+			if (sizeof(std::size_t) < 8 && lenbytes > sizeof(std::size_t))
+				throw std::runtime_error(
+					"This platform does not support strings of 64-bit length.");
+			std::size_t len = 0;
+			const auto load_len = [&](auto l) {
+				if (!load_value(pos, end, l, reverse_byte_order)) return false;
+				len = static_cast<std::size_t>(l);
+				return true;
+			};
+			bool complete;
+			switch (lenbytes) {
+			case sizeof(uint8_t): complete = load_len(uint8_t(0)); break;
+			case sizeof(uint16_t): complete = load_len(uint16_t(0)); break;
+			case sizeof(uint32_t): complete = load_len(uint32_t(0)); break;
 #ifndef BOOST_NO_INT64_T
-				for (auto &val : samplevals<uint64_t>(*this))
-					if (val &&
-						((val & UINT64_C(0x7fffffffffffffff)) <= UINT64_C(0x000fffffffffffff)))
-						val &= UINT64_C(0x8000000000000000);
+			case sizeof(uint64_t): complete = load_len(uint64_t(0)); break;
 #endif
+			default: throw std::runtime_error("Stream contents corrupted (invalid varlen int).");
 			}
+			// read string contents
+			if (!complete || static_cast<std::size_t>(end - pos) < len) return nullptr;
+			str.assign(pos, len);
+			pos += len;
+		}
+	} else {
+		// read record data
+		const std::size_t size = datasize();
+		if (static_cast<std::size_t>(end - pos) < size) return nullptr;
+		memcpy(&data_, pos, size);
+		pos += size;
+		convert_loaded_data(reverse_byte_order, suppress_subnormals);
+	}
+	return pos;
+}
+
+const char *sample::load_buffer(
+	const char *begin, const char *end, const sample_codec &codec, const sample *reference) {
+	bool changes;
+	const char *pos = load_header(begin, end, codec.reverse_byte_order, changes);
+	if (!pos) return nullptr;
+	if (changes) return load_changes(pos, end, codec, reference);
+	const std::size_t size = datasize();
+	if (static_cast<std::size_t>(end - pos) < size) return nullptr;
+	codec.decode(reinterpret_cast<char *>(&data_), pos, num_channels_);
+	return pos + size;
+}
+
+const char *sample::load_changes(const char *pos, const char *end, bool reverse_byte_order,
+	bool suppress_subnormals, const sample *reference) {
+	if (!reference || format_ == cft_string)
+		throw std::runtime_error("Stream contents corrupted (unexpected change mask).");
+	const std::size_t mask_bytes = (num_channels_ + 7) / 8;
+	if (static_cast<std::size_t>(end - pos) < mask_bytes) return nullptr;
+	const auto *mask = reinterpret_cast<const uint8_t *>(pos);
+	auto changed = [mask](uint32_t ch) { return (mask[ch / 8] >> (ch % 8)) & 1; };
+	std::size_t changed_bytes = 0;
+	for (uint32_t ch = 0; ch < num_channels_; ++ch)
+		if (changed(ch)) changed_bytes += format_sizes[channel_format(ch)];
+	pos += mask_bytes;
+	// the sample (which may be the reference) is only modified once it's complete
+	if (static_cast<std::size_t>(end - pos) < changed_bytes) return nullptr;
+	if (reference != this) memcpy(&data_, &reference->data_, datasize());
+	char *dst = data_bytes();
+	for (uint32_t ch = 0; ch < num_channels_; ++ch) {
+		if (!changed(ch)) continue;
+		const lsl_channel_format_t fmt = channel_format(ch);
+		char *val = dst + channel_offset(ch);
+		copy_values(val, pos, 1, format_sizes[fmt], reverse_byte_order);
+		pos += format_sizes[fmt];
+		// the unchanged values have already been fixed up when the reference was loaded
+		if (suppress_subnormals) suppress_subnormal(val, fmt);
+	}
+	return pos;
+}
+
+const char *sample::load_changes(
+	const char *pos, const char *end, const sample_codec &codec, const sample *reference) {
+	if (!reference) throw std::runtime_error("Stream contents corrupted (unexpected change mask).");
+	const std::size_t mask_bytes = (num_channels_ + 7) / 8, width = codec.value_size;
+	if (static_cast<std::size_t>(end - pos) < mask_bytes) return nullptr;
+	const auto *mask = reinterpret_cast<const uint8_t *>(pos);
+	auto changed = [mask](uint32_t ch) { return (mask[ch / 8] >> (ch % 8)) & 1; };
+	std::size_t changed_bytes = 0;
+	for (uint32_t ch = 0; ch < num_channels_; ++ch) changed_bytes += changed(ch) * width;
+	pos += mask_bytes;
+	// the sample (which may be the reference) is only modified once it's complete
+	if (static_cast<std::size_t>(end - pos) < changed_bytes) return nullptr;
+	if (reference != this) memcpy(&data_, &reference->data_, datasize());
+	char *dst = reinterpret_cast<char *>(&data_);
+	for (uint32_t ch = 0; ch < num_channels_; ++ch) {
+		if (!changed(ch)) continue;
+		codec.decode_values(dst + ch * width, pos, 1);
+		pos += width;
+	}
+	return pos;
+}
+
+void sample::reverse_channels(char *data) const {
+	if (format_ != cft_record) {
+		convert_endian(data, num_channels_, format_sizes[format_]);
+		return;
+	}
+	for (uint32_t ch = 0; ch < num_channels_; ++ch) {
+		char *val = data + channel_offset(ch);
+		copy_values(val, val, 1, format_sizes[channel_format(ch)], true);
+	}
+}
+
+void sample::convert_loaded_data(bool reverse_byte_order, bool suppress_subnormals) {
+	if (format_ == cft_record) {
+		if (reverse_byte_order) reverse_channels(reinterpret_cast<char *>(&data_));
+		if (suppress_subnormals && factory_->layout_->has_floats())
+			for (uint32_t ch = 0; ch < num_channels_; ++ch)
+				suppress_subnormal(data_bytes() + channel_offset(ch), channel_format(ch));
+		return;
+	}
+	if (reverse_byte_order && format_sizes[format_] > 1)
+		convert_endian(&data_, num_channels(), format_sizes[format_]);
+	if (suppress_subnormals && format_float[format_]) {
+		if (format_ == cft_float32) {
+			for (auto &val : samplevals<uint32_t>(*this))
+				if (val && ((val & UINT32_C(0x7fffffff)) <= UINT32_C(0x007fffff)))
+					val &= UINT32_C(0x80000000);
+		} else {
+#ifndef BOOST_NO_INT64_T
+			for (auto &val : samplevals<uint64_t>(*this))
+				if (val && ((val & UINT64_C(0x7fffffffffffffff)) <= UINT64_C(0x000fffffffffffff)))
+					val &= UINT64_C(0x8000000000000000);
+#endif
 		}
 	}
 }
@@ -398,6 +885,15 @@ sample &sample::assign_test_pattern(int offset) {
 		break;
 	}
 #endif
+	case cft_record: {
+		auto *data = reinterpret_cast<char *>(&data_);
+		for (uint32_t k = 0; k < num_channels_; k++) {
+			// spans several bytes, so a wrong byte order or channel offset is noticed
+			int32_t val = static_cast<int32_t>((k + offset) * 65537 % 0x7fffffff);
+			store_field(data + channel_offset(k), channel_format(k), k % 2 ? -val : val);
+		}
+		break;
+	}
 	default: throw std::invalid_argument("Unsupported channel format used to construct a sample.");
 	}
 
@@ -411,10 +907,21 @@ lsl::sample::sample(lsl_channel_format_t fmt, uint32_t num_channels, factory *fa
 		for (auto &val : samplevals<std::string>(*this)) new (&val) std::string();
 }
 
-factory::factory(lsl_channel_format_t fmt, uint32_t num_chans, uint32_t num_reserve)
-	: fmt_(fmt), num_chans_(num_chans),
-	  sample_size_(ensure_multiple(
-		  sizeof(sample) - sizeof(sample::data_) + format_sizes[fmt] * num_chans, 16)),
+/// The number of bytes of a sample's channel data
+static uint32_t data_bytes(
+	lsl_channel_format_t fmt, uint32_t num_chans, const record_layout_p &layout) {
+	if (fmt != cft_record) return format_sizes[fmt] * num_chans;
+	if (!layout || layout->num_channels() != num_chans)
+		throw std::invalid_argument("Record samples need a layout with a format per channel.");
+	return layout->size();
+}
+
+factory::factory(lsl_channel_format_t fmt, uint32_t num_chans, uint32_t num_reserve,
+	record_layout_p layout)
+	: fmt_(fmt), num_chans_(num_chans), layout_(std::move(layout)),
+	  sample_size_(ensure_multiple(sizeof(sample) - sizeof(sample::data_) +
+									   data_bytes(fmt, num_chans, layout_),
+		  16)),
 	  storage_size_(sample_size_ * std::max(2U, num_reserve + 1)),
 	  storage_(new char[storage_size_]), head_(sentinel()), tail_(sentinel()) {
 	// pre-construct an array of samples in the storage area and chain into a freelist
@@ -427,13 +934,16 @@ factory::factory(lsl_channel_format_t fmt, uint32_t num_chans, uint32_t num_rese
 	}
 	s->next_ = nullptr;
 	head_.store(s);
+	memstats::add(memstats::component::factory, storage_size_, 1);
 }
 
 sample_p factory::new_sample(double timestamp, bool pushthrough) {
 	sample *result;
 	// try to retrieve a free sample, adding fresh samples until it succeeds
-	while ((result = pop_freelist()) == nullptr)
+	while ((result = pop_freelist()) == nullptr) {
 		reclaim_sample(new (new char[sample_size_]) sample(fmt_, num_chans_, this));
+		memstats::add(memstats::component::factory, sample_size_);
+	}
 
 	result->timestamp_ = timestamp;
 	result->pushthrough = pushthrough;
@@ -471,6 +981,7 @@ factory::~factory() {
 		if (!next) break;
 	}
 	delete[] storage_;
+	memstats::add(memstats::component::factory, -int64_t(storage_size_), -1);
 }
 
 void factory::reclaim_sample(sample *s) {
@@ -494,3 +1005,15 @@ template void lsl::sample::retrieve_typed(int16_t *);
 template void lsl::sample::retrieve_typed(int32_t *);
 template void lsl::sample::retrieve_typed(int64_t *);
 template void lsl::sample::retrieve_typed(std::string *);
+template void lsl::sample::assign_strided<float>(const char *, const channel_layout &);
+template void lsl::sample::assign_strided<double>(const char *, const channel_layout &);
+template void lsl::sample::assign_strided<char>(const char *, const channel_layout &);
+template void lsl::sample::assign_strided<int16_t>(const char *, const channel_layout &);
+template void lsl::sample::assign_strided<int32_t>(const char *, const channel_layout &);
+template void lsl::sample::assign_strided<int64_t>(const char *, const channel_layout &);
+template void lsl::sample::retrieve_strided<float>(char *, const channel_layout &);
+template void lsl::sample::retrieve_strided<double>(char *, const channel_layout &);
+template void lsl::sample::retrieve_strided<char>(char *, const channel_layout &);
+template void lsl::sample::retrieve_strided<int16_t>(char *, const channel_layout &);
+template void lsl::sample::retrieve_strided<int32_t>(char *, const channel_layout &);
+template void lsl::sample::retrieve_strided<int64_t>(char *, const channel_layout &);
@@ -3,12 +3,14 @@
 #include "common.h"
 #include "forward.h"
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <iosfwd>
 #include <limits>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 
 namespace lsl {
@@ -18,18 +20,58 @@ static_assert(sizeof(double) == 8, "Target arch has unexpected double size (!=8)
 // constants used in the network protocol
 const uint8_t TAG_DEDUCED_TIMESTAMP = 1;
 const uint8_t TAG_TRANSMITTED_TIMESTAMP = 2;
+// samples that only contain the channels that changed since the previous sample (change masks)
+const uint8_t TAG_DEDUCED_TIMESTAMP_CHANGES = 3;
+const uint8_t TAG_TRANSMITTED_TIMESTAMP_CHANGES = 4;
 
-/// channel format properties
+/// channel format properties; records are handled as bytes with per-channel formats
 const uint8_t format_sizes[] = {0, sizeof(float), sizeof(double), sizeof(std::string),
-	sizeof(int32_t), sizeof(int16_t), sizeof(int8_t), 8};
+	sizeof(int32_t), sizeof(int16_t), sizeof(int8_t), 8, 1};
 const bool format_ieee754[] = {false, std::numeric_limits<float>::is_iec559,
-	std::numeric_limits<double>::is_iec559, false, false, false, false, false};
+	std::numeric_limits<double>::is_iec559, false, false, false, false, false, false};
 const bool format_subnormal[] = {false,
 	std::numeric_limits<float>::has_denorm != std::denorm_absent,
 	std::numeric_limits<double>::has_denorm != std::denorm_absent, false, false, false, false,
-	false};
-const bool format_integral[] = {false, false, false, false, true, true, true, true};
-const bool format_float[] = {false, true, true, false, false, false, false, false};
+	false, std::numeric_limits<float>::has_denorm != std::denorm_absent};
+const bool format_integral[] = {false, false, false, false, true, true, true, true, false};
+const bool format_float[] = {false, true, true, false, false, false, false, false, false};
+
+/// The position of a sample's channel values in an application buffer, e.g. a device record
+struct channel_layout {
+	/// The distance between two consecutive channels in bytes
+	std::ptrdiff_t channel_stride;
+	/// Optionally each channel's byte offset from the start of the sample (overrides the stride)
+	const int32_t *channel_offsets;
+
+	std::ptrdiff_t offset(uint32_t channel) const {
+		return channel_offsets ? channel_offsets[channel] : channel * channel_stride;
+	}
+};
+
+/**
+ * The formats and byte offsets of the channels of a record (cft_record) sample.
+ *
+ * The channels are packed without padding, so the values are not necessarily aligned.
+ */
+class record_layout {
+public:
+	/// @throws std::invalid_argument if a channel format isn't numeric
+	explicit record_layout(std::vector<lsl_channel_format_t> formats);
+
+	uint32_t num_channels() const { return static_cast<uint32_t>(formats_.size()); }
+	const std::vector<lsl_channel_format_t> &formats() const { return formats_; }
+	lsl_channel_format_t format(uint32_t channel) const { return formats_[channel]; }
+	/// The offset of a channel in bytes; offset(num_channels()) is the size of the record
+	uint32_t offset(uint32_t channel) const { return offsets_[channel]; }
+	uint32_t size() const { return offsets_.back(); }
+	/// Whether any channel holds floating point values
+	bool has_floats() const { return has_floats_; }
+
+private:
+	std::vector<lsl_channel_format_t> formats_;
+	std::vector<uint32_t> offsets_;
+	bool has_floats_{false};
+};
 
 /// A factory to create samples of a given format/size. Must outlive all of its created samples.
 class factory {
@@ -39,8 +81,10 @@ public:
 	 * @param fmt Sample format
 	 * @param num_chans nr of channels
 	 * @param num_reserve nr of samples to pre-allocate in the storage pool
+	 * @param layout The channel layout of record (cft_record) samples
 	 */
-	factory(lsl_channel_format_t fmt, uint32_t num_chans, uint32_t num_reserve);
+	factory(lsl_channel_format_t fmt, uint32_t num_chans, uint32_t num_reserve,
+		record_layout_p layout = nullptr);
 
 	/// Destroy the factory and delete all of its samples.
 	~factory();
@@ -69,6 +113,8 @@ private:
 	const lsl_channel_format_t fmt_;
 	/// the number of channels to construct samples with
 	const uint32_t num_chans_;
+	/// the channel layout of record samples
+	const record_layout_p layout_;
 	/// size of a sample, in bytes
 	const uint32_t sample_size_;
 	/// size of the allocated storage, in bytes
@@ -108,6 +154,17 @@ private:
 	/// the data payload begins here
 	alignas(8) int32_t data_{0};
 
+	/**
+	 * The payload as bytes, addressed from the start of the sample.
+	 *
+	 * The payload extends beyond data_, so wide values are written through this pointer: the
+	 * compiler would take data_'s declared size as the bound of a pointer derived from &data_.
+	 */
+	char *data_bytes() noexcept {
+		return reinterpret_cast<char *>(this) +
+			   (reinterpret_cast<char *>(&data_) - reinterpret_cast<char *>(this));
+	}
+
 public:
 	// === Construction ===
 
@@ -124,9 +181,16 @@ public:
 	bool operator!=(const sample &rhs) const noexcept { return !(*this == rhs); }
 
 	std::size_t datasize() const {
+		if (format_ == cft_record) return factory_->layout_->size();
 		return format_sizes[format_] * static_cast<std::size_t>(num_channels_);
 	}
 
+	/// The byte offset of a channel's value; channel_offset(num_channels()) is the datasize().
+	std::size_t channel_offset(uint32_t channel) const {
+		if (format_ == cft_record) return factory_->layout_->offset(channel);
+		return format_sizes[format_] * static_cast<std::size_t>(channel);
+	}
+
 	uint32_t num_channels() const { return num_channels_; }
 
 	// === type-safe accessors ===
@@ -137,6 +201,17 @@ public:
 	/// Retrieve an array of numeric values (with type conversions).
 	template <class T> void retrieve_typed(T *d);
 
+	/**
+	 * Gather numeric values of type T from a sample in an application buffer (with type
+	 * conversions), e.g. the channels of a device record interleaved with status words.
+	 * @param s The start of the sample in the buffer.
+	 * @param layout The channels' positions relative to `s`.
+	 */
+	template <class T> void assign_strided(const char *s, const channel_layout &layout);
+
+	/// Scatter the values into a sample in an application buffer (with type conversions).
+	template <class T> void retrieve_strided(char *d, const channel_layout &layout);
+
 	// === untyped accessors ===
 
 	/// Assign numeric data to the sample.
@@ -145,19 +220,80 @@ public:
 	/// Retrieve numeric data from the sample.
 	void retrieve_untyped(void *newdata);
 
+	/// Copy the channel data of another sample with the same format and channel count.
+	void assign_channels(const sample &src);
+
+	/// Get the value of a channel of a numeric sample.
+	double numeric_value(uint32_t channel) const;
+
+	/// Get the value of a channel of a string sample.
+	const std::string &string_value(uint32_t channel) const;
+
 	// === serialization functions ===
 
 	/// Serialize a sample to a stream buffer (protocol 1.10).
 	void save_streambuf(std::streambuf &sb, int protocol_version, bool reverse_byte_order,
 		void *scratchpad = nullptr) const;
 
+	/**
+	 * Serialize a numeric sample to a stream buffer (protocol 1.10) with a codec that was
+	 * selected for the connection (see select_codec()).
+	 * @param scratchpad Memory for at least datasize() bytes.
+	 */
+	void save_streambuf(std::streambuf &sb, const sample_codec &codec, void *scratchpad) const;
+
+	/// Number of bytes save_buffer() writes for a numeric sample.
+	std::size_t serialized_size() const {
+		return 1 + (timestamp_ == DEDUCED_TIMESTAMP ? 0 : sizeof(double)) + datasize();
+	}
+
+	/**
+	 * Serialize the channels [begin, end) of a numeric sample into a memory buffer (protocol 1.10).
+	 *
+	 * Several threads can serialize disjoint channel ranges of the same sample at once; the sample
+	 * header is written along with the first channel.
+	 * @param dst The start of the sample's serialized_size() bytes long destination.
+	 */
+	void save_buffer(char *dst, bool reverse_byte_order, uint32_t begin, uint32_t end) const;
+	void save_buffer(char *dst, const sample_codec &codec, uint32_t begin, uint32_t end) const;
+
+	/**
+	 * Serialize a numeric sample relative to the previously sent sample (protocol 1.10 with
+	 * change masks).
+	 *
+	 * If that's shorter, only a bitmap of the channels that differ from `reference` and their
+	 * values are written, so an encoded sample is never larger than with save_streambuf().
+	 * Without a reference, the sample is saved as by save_streambuf().
+	 * @param scratchpad Memory for at least datasize() bytes.
+	 * @return Whether the sample was encoded with a change mask.
+	 */
+	bool save_changes(std::streambuf &sb, const sample *reference, bool reverse_byte_order,
+		void *scratchpad) const;
+	bool save_changes(std::streambuf &sb, const sample *reference, const sample_codec &codec,
+		void *scratchpad) const;
+
 	/// Deserialize a sample from a stream buffer (protocol 1.10).
 	void load_streambuf(std::streambuf &sb, int protocol_version, bool reverse_byte_order,
 		bool suppress_subnormals);
 
+	/**
+	 * Deserialize a sample from a contiguous memory buffer (protocol 1.10).
+	 * @return A pointer to the first byte after the sample, or nullptr if the buffer ends before
+	 * the sample is complete. In this case, the sample's contents are unspecified.
+	 * @param reference The previously received sample that samples encoded with change masks
+	 * (see save_changes()) are relative to. It may be this sample.
+	 */
+	const char *load_buffer(const char *begin, const char *end, bool reverse_byte_order,
+		bool suppress_subnormals, const sample *reference = nullptr);
+	const char *load_buffer(const char *begin, const char *end, const sample_codec &codec,
+		const sample *reference = nullptr);
+
 	/// Convert the endianness of channel data in-place.
 	static void convert_endian(void *data, uint32_t n, uint32_t width);
 
+	/// Reverse the byte order of each value in a copy of this sample's numeric channel data.
+	void reverse_channels(char *data) const;
+
 	/// Serialize a sample into a portable archive (protocol 1.00).
 	void serialize(eos::portable_oarchive &ar, uint32_t archive_version) const;
 
@@ -171,6 +307,30 @@ public:
 	sample &assign_test_pattern(int offset = 1);
 
 private:
+	/// The format of a channel's value (which differs between the channels of records)
+	lsl_channel_format_t channel_format(uint32_t channel) const {
+		return format_ == cft_record ? factory_->layout_->format(channel) : format_;
+	}
+
+	/// Fix up freshly received numeric channel data (byte order, subnormals)
+	void convert_loaded_data(bool reverse_byte_order, bool suppress_subnormals);
+
+	/// Write the tag and (unless deduced) the time stamp, return the number of bytes written
+	std::size_t save_header(char *dst, bool changes, bool reverse_byte_order) const;
+
+	/**
+	 * Read the tag and time stamp of a serialized sample.
+	 * @return The position after the header or nullptr if it's incomplete.
+	 */
+	const char *load_header(
+		const char *pos, const char *end, bool reverse_byte_order, bool &changes);
+
+	/// Load the changed channels after the header of a change mask sample, see load_buffer()
+	const char *load_changes(const char *pos, const char *end, bool reverse_byte_order,
+		bool suppress_subnormals, const sample *reference);
+	const char *load_changes(
+		const char *pos, const char *end, const sample_codec &codec, const sample *reference);
+
 	/// Construct a new sample for a given channel format/count combination.
 	sample(lsl_channel_format_t fmt, uint32_t num_channels, factory *fact);
 
@@ -194,6 +354,9 @@ private:
 
 	template <typename T, typename U> void conv_from(const U *src);
 	template <typename T, typename U> void conv_into(U *dst);
+	template <typename T, typename U>
+	void gather_from(const char *src, const channel_layout &layout);
+	template <typename T, typename U> void scatter_into(char *dst, const channel_layout &layout);
 };
 
 } // namespace lsl
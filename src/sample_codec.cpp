@@ -0,0 +1,80 @@
+#include "sample_codec.h"
+#include <array>
+#include <boost/endian/conversion.hpp>
+#include <cstring>
+#include <utility>
+
+using namespace lsl;
+using lslboost::endian::endian_reverse_inplace;
+
+/// Flush a subnormal float32 value (given by its bits) to zero, keeping the sign
+inline uint32_t flush_subnormal(uint32_t v) {
+	return (v & UINT32_C(0x7fffffff)) <= UINT32_C(0x007fffff) ? v & UINT32_C(0x80000000) : v;
+}
+
+/// Flush a subnormal double64 value (given by its bits) to zero, keeping the sign
+inline uint64_t flush_subnormal(uint64_t v) {
+	return (v & UINT64_C(0x7fffffffffffffff)) <= UINT64_C(0x000fffffffffffff)
+			   ? v & UINT64_C(0x8000000000000000)
+			   : v;
+}
+
+/**
+ * Convert channel values of the unsigned type U with the same width as the channel format.
+ * @tparam N The number of values if it's known at compile time (0: given by `n`).
+ */
+template <typename U, bool Reverse, bool Suppress, uint32_t N>
+void convert(char *dst, const char *src, std::size_t n) {
+	constexpr bool swap = Reverse && sizeof(U) > 1;
+	if (N) n = N;
+	if constexpr (!swap && !Suppress) {
+		memcpy(dst, src, n * sizeof(U));
+		return;
+	}
+	for (std::size_t i = 0; i < n; ++i, src += sizeof(U), dst += sizeof(U)) {
+		U v;
+		memcpy(&v, src, sizeof(U));
+		if constexpr (swap) endian_reverse_inplace(v);
+		if constexpr (Suppress) v = flush_subnormal(v);
+		memcpy(dst, &v, sizeof(U));
+	}
+}
+
+/// The codecs for all channel counts up to max_unrolled_channels (and the generic one at index 0)
+template <typename U, bool Reverse, bool Suppress, std::size_t... N>
+constexpr std::array<sample_codec, sizeof...(N)> codecs_by_count(std::index_sequence<N...>) {
+	return {{sample_codec{&convert<U, Reverse, false, N>, &convert<U, Reverse, Suppress, N>,
+		&convert<U, Reverse, false, 0>, &convert<U, Reverse, Suppress, 0>,
+		static_cast<uint8_t>(sizeof(U)), Reverse, !Reverse || sizeof(U) == 1}...}};
+}
+
+/// Look up the codec for a channel format stored as U
+template <typename U, bool Float>
+const sample_codec &lookup(uint32_t num_channels, bool reverse_byte_order, bool suppress) {
+	using counts = std::make_index_sequence<max_unrolled_channels + 1>;
+	// indexed by byte order and subnormal policy; integer formats have nothing to suppress
+	static constexpr std::array<std::array<sample_codec, max_unrolled_channels + 1>, 4> table{
+		{codecs_by_count<U, false, false>(counts{}), codecs_by_count<U, false, Float>(counts{}),
+			codecs_by_count<U, true, false>(counts{}), codecs_by_count<U, true, Float>(counts{})}};
+	return table[2 * reverse_byte_order + suppress]
+				[num_channels <= max_unrolled_channels ? num_channels : 0];
+}
+
+const sample_codec *lsl::select_codec(lsl_channel_format_t fmt, uint32_t num_channels,
+	bool reverse_byte_order, bool suppress_subnormals) {
+	switch (fmt) {
+	case cft_float32:
+		return &lookup<uint32_t, true>(num_channels, reverse_byte_order, suppress_subnormals);
+	case cft_double64:
+		return &lookup<uint64_t, true>(num_channels, reverse_byte_order, suppress_subnormals);
+	case cft_int8:
+		return &lookup<uint8_t, false>(num_channels, reverse_byte_order, suppress_subnormals);
+	case cft_int16:
+		return &lookup<uint16_t, false>(num_channels, reverse_byte_order, suppress_subnormals);
+	case cft_int32:
+		return &lookup<uint32_t, false>(num_channels, reverse_byte_order, suppress_subnormals);
+	case cft_int64:
+		return &lookup<uint64_t, false>(num_channels, reverse_byte_order, suppress_subnormals);
+	default: return nullptr;
+	}
+}
@@ -0,0 +1,50 @@
+#ifndef SAMPLE_CODEC_H
+#define SAMPLE_CODEC_H
+
+#include "common.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace lsl {
+
+/// Converts n channel values between a sample's data and a (possibly unaligned) wire buffer
+using convert_fn = void (*)(char *dst, const char *src, std::size_t n);
+
+/**
+ * Encoders and decoders of numeric channel data, specialized for a channel format, byte order,
+ * subnormal policy and (for small samples) the channel count.
+ *
+ * A connection selects its codec once after the handshake (see select_codec()), so the
+ * serialization of each sample doesn't have to check these settings again.
+ */
+struct sample_codec {
+	/// Encode the channels of a sample (channel count as given to select_codec()) for the wire
+	convert_fn encode;
+	/// Decode the channels of a sample from the wire
+	convert_fn decode;
+	/// Encode/decode any number of values, e.g. parts of a sample or the changed channels
+	convert_fn encode_values, decode_values;
+	/// Size of a channel value in bytes
+	uint8_t value_size;
+	/// Whether the timestamps are sent in reversed byte order
+	bool reverse_byte_order;
+	/// Whether the encoded values have the same bytes as the sample data, so they can be copied
+	bool verbatim;
+};
+
+/// The number of channels up to which the codecs' loops have a fixed trip count
+const uint32_t max_unrolled_channels = 8;
+
+/**
+ * Get the codec for numeric samples with the given properties.
+ *
+ * Subnormal suppression only applies to decoding float32 and double64 values.
+ * @return A codec with static lifetime or nullptr for string and record samples, which are
+ * handled by the generic serialization code.
+ */
+const sample_codec *select_codec(lsl_channel_format_t fmt, uint32_t num_channels,
+	bool reverse_byte_order, bool suppress_subnormals);
+
+} // namespace lsl
+
+#endif
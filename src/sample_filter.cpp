@@ -0,0 +1,126 @@
+#include "sample_filter.h"
+#include "sample.h"
+#include "util/strfuns.hpp"
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace lsl;
+
+sample_filter::sample_filter(
+	const std::string &expression, lsl_channel_format_t format, uint32_t channels)
+	: expression_(trim(expression)), string_format_(format == cft_string) {
+	const std::string &expr = expression_;
+	if (expr.find_first_of("\r\n") != std::string::npos)
+		throw std::invalid_argument("A sample filter must not contain line breaks.");
+	auto fail = [&expr](const std::string &msg, std::size_t pos) {
+		throw std::invalid_argument(
+			"Invalid sample filter '" + expr + "' at position " + std::to_string(pos) + ": " + msg);
+	};
+	std::size_t pos = 0;
+	auto skip_space = [&]() {
+		while (pos < expr.size() && isspace(static_cast<unsigned char>(expr[pos]))) ++pos;
+	};
+	auto consume = [&](const char *token) {
+		const std::size_t len = std::char_traits<char>::length(token);
+		if (expr.compare(pos, len, token) != 0) return false;
+		pos += len;
+		return true;
+	};
+
+	alternatives_.emplace_back();
+	while (true) {
+		comparison cmp{0, op::eq, 0., std::string()};
+		skip_space();
+		if (consume("ch")) {
+			const std::size_t start = pos;
+			while (pos < expr.size() && expr[pos] >= '0' && expr[pos] <= '9') ++pos;
+			if (start == pos) fail("expected a channel number", pos);
+			cmp.channel = static_cast<uint32_t>(std::strtoul(expr.c_str() + start, nullptr, 10));
+			if (cmp.channel >= channels) fail("no such channel", start);
+			skip_space();
+		}
+
+		const std::size_t op_pos = pos;
+		if (consume("=="))
+			cmp.oper = op::eq;
+		else if (consume("!="))
+			cmp.oper = op::ne;
+		else if (consume("<="))
+			cmp.oper = op::le;
+		else if (consume(">="))
+			cmp.oper = op::ge;
+		else if (consume("^="))
+			cmp.oper = op::prefix;
+		else if (consume("<"))
+			cmp.oper = op::lt;
+		else if (consume(">"))
+			cmp.oper = op::gt;
+		else
+			fail("expected a comparison operator", pos);
+		const bool ordering = cmp.oper != op::eq && cmp.oper != op::ne && cmp.oper != op::prefix;
+		if (string_format_ && ordering)
+			fail("strings can only be compared with ==, != or ^=", op_pos);
+		if (!string_format_ && cmp.oper == op::prefix) fail("^= only applies to strings", op_pos);
+
+		skip_space();
+		const std::size_t value_pos = pos;
+		if (pos < expr.size() && (expr[pos] == '\'' || expr[pos] == '"')) {
+			const std::size_t close = expr.find(expr[pos], pos + 1);
+			if (close == std::string::npos) fail("unterminated string", pos);
+			cmp.text = expr.substr(pos + 1, close - pos - 1);
+			pos = close + 1;
+		} else {
+			while (pos < expr.size() && !isspace(static_cast<unsigned char>(expr[pos])) &&
+				   expr[pos] != '&' && expr[pos] != '|')
+				++pos;
+			if (pos == value_pos) fail("expected a value", pos);
+			cmp.text = expr.substr(value_pos, pos - value_pos);
+		}
+		if (!string_format_) {
+			char *end = nullptr;
+			cmp.number = std::strtod(cmp.text.c_str(), &end);
+			if (cmp.text.empty() || *end != '\0') fail("expected a number", value_pos);
+		}
+		alternatives_.back().push_back(std::move(cmp));
+
+		skip_space();
+		if (pos == expr.size()) break;
+		if (consume("|"))
+			alternatives_.emplace_back();
+		else if (!consume("&"))
+			fail("expected & or |", pos);
+	}
+}
+
+bool sample_filter::matches(const sample &s) const {
+	for (const auto &alternative : alternatives_) {
+		bool all = true;
+		for (const auto &cmp : alternative)
+			if (!matches(s, cmp)) {
+				all = false;
+				break;
+			}
+		if (all) return true;
+	}
+	return false;
+}
+
+bool sample_filter::matches(const sample &s, const comparison &cmp) const {
+	if (string_format_) {
+		const std::string &val = s.string_value(cmp.channel);
+		switch (cmp.oper) {
+		case op::eq: return val == cmp.text;
+		case op::ne: return val != cmp.text;
+		default: return val.compare(0, cmp.text.size(), cmp.text) == 0;
+		}
+	}
+	const double val = s.numeric_value(cmp.channel);
+	switch (cmp.oper) {
+	case op::eq: return val == cmp.number;
+	case op::ne: return val != cmp.number;
+	case op::lt: return val < cmp.number;
+	case op::le: return val <= cmp.number;
+	case op::gt: return val > cmp.number;
+	default: return val >= cmp.number;
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef SAMPLE_FILTER_H
+#define SAMPLE_FILTER_H
+
+#include "common.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lsl {
+class sample;
+
+/**
+ * A predicate on the channel values of a sample, e.g. to forward only some markers.
+ *
+ * Inlets send the filter expression as a feed parameter so the outlet's session can drop
+ * non-matching samples before they are serialized.
+ *
+ * An expression is a list of alternatives separated by `|`, each a list of comparisons separated
+ * by `&` that all have to match, e.g. `ch0 == 'Stim' | ch0 ^= 'Resp'` or `ch2 > 0.5 & ch2 < 1`.
+ * A comparison is an optional channel (`chN`, default: channel 0), an operator and a value:
+ * - numeric streams: `==`, `!=`, `<`, `<=`, `>`, `>=` and a number
+ * - string streams: `==`, `!=` and `^=` (prefix match) and a string, optionally enclosed in single
+ *   or double quotes (e.g. to include spaces or operator characters)
+ */
+class sample_filter {
+public:
+	/**
+	 * Parse a filter expression for samples of the given format.
+	 * @throws std::invalid_argument if the expression is malformed or refers to channels or
+	 * operators not available for this format.
+	 */
+	sample_filter(const std::string &expression, lsl_channel_format_t format, uint32_t channels);
+
+	/// Whether a sample passes the filter.
+	bool matches(const sample &s) const;
+
+	/// The expression the filter was parsed from.
+	const std::string &expression() const { return expression_; }
+
+private:
+	enum class op { eq, ne, lt, le, gt, ge, prefix };
+
+	struct comparison {
+		uint32_t channel;
+		op oper;
+		double number;
+		std::string text;
+	};
+
+	bool matches(const sample &s, const comparison &cmp) const;
+
+	std::string expression_;
+	bool string_format_;
+	/// the alternatives, each a list of comparisons that all have to match
+	std::vector<std::vector<comparison>> alternatives_;
+};
+
+} // namespace lsl
+
+#endif
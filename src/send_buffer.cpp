@@ -1,8 +1,8 @@
 #include "send_buffer.h"
 #include "consumer_queue.h"
+#include "logging.h"
 #include <algorithm>
 #include <chrono>
-#include <loguru.hpp>
 #include <memory>
 
 using namespace lsl;
@@ -12,6 +12,24 @@ std::shared_ptr<consumer_queue> send_buffer::new_consumer(int max_buffered) {
 	return std::make_shared<consumer_queue>(max_buffered, shared_from_this());
 }
 
+void send_buffer::resize_consumer(std::shared_ptr<consumer_queue> &queue, int max_buffered) {
+	std::size_t size = max_buffered ? std::min(max_buffered, max_capacity_) : max_capacity_;
+	size = std::max<std::size_t>({size, 2 * queue->read_available(), 2});
+	if (size == queue->size_) return;
+	auto resized = std::make_shared<consumer_queue>(size);
+	{
+		// the producer pushes with the lock held, so it can't add samples in between
+		std::lock_guard<std::mutex> lock(consumers_mut_);
+		auto pos = std::find(consumers_.begin(), consumers_.end(), queue.get());
+		if (pos == consumers_.end()) return;
+		while (!queue->empty()) resized->push_sample(queue->pop_sample(0.0));
+		retired_dropped_ += queue->dropped();
+		*pos = resized.get();
+		resized->registry_ = shared_from_this();
+		queue->registry_.reset();
+	}
+	queue = std::move(resized);
+}
 
 /**
  * Push a sample onto the send buffer.
@@ -22,13 +40,18 @@ void send_buffer::push_sample(const sample_p &s) {
 	for (auto &consumer : consumers_) consumer->push_sample(s);
 }
 
+void send_buffer::push_samples(const sample_p *samples, std::size_t n) {
+	std::lock_guard<std::mutex> lock(consumers_mut_);
+	for (auto &consumer : consumers_) consumer->push_samples(samples, n);
+}
+
 
 /// Registered a new consumer.
 void send_buffer::register_consumer(consumer_queue *q) {
 	{
 		std::lock_guard<std::mutex> lock(consumers_mut_);
 		if (std::find(consumers_.begin(), consumers_.end(), q) != consumers_.end())
-			LOG_F(WARNING, "Duplicate consumer queue in send buffer");
+			LSL_LOG_F(WARNING, "Duplicate consumer queue in send buffer");
 		else
 			consumers_.push_back(q);
 	}
@@ -39,7 +62,9 @@ void send_buffer::register_consumer(consumer_queue *q) {
 void send_buffer::unregister_consumer(consumer_queue *q) {
 	std::lock_guard<std::mutex> lock(consumers_mut_);
 	auto pos = std::find(consumers_.begin(), consumers_.end(), q);
-	if (pos == consumers_.end()) LOG_F(ERROR, "Trying to remove consumer queue not in send buffer");
+	if (pos == consumers_.end())
+		LSL_LOG_F(ERROR, "Trying to remove consumer queue not in send buffer");
+	retired_dropped_ += q->dropped();
 
 	// Put the element to be removed at the end (if it isn't there already) and
 	// remove the last element
@@ -53,6 +78,17 @@ bool send_buffer::have_consumers() {
 	return some_registered();
 }
 
+void send_buffer::consumer_stats(int32_t &num_consumers, int32_t &max_depth, uint64_t &dropped) {
+	std::lock_guard<std::mutex> lock(consumers_mut_);
+	num_consumers = static_cast<int32_t>(consumers_.size());
+	max_depth = 0;
+	dropped = retired_dropped_;
+	for (auto *consumer : consumers_) {
+		max_depth = std::max(max_depth, static_cast<int32_t>(consumer->read_available()));
+		dropped += consumer->dropped();
+	}
+}
+
 /// Wait until some consumers are present.
 bool send_buffer::wait_for_consumers(double timeout) {
 	std::unique_lock<std::mutex> lock(consumers_mut_);
@@ -42,15 +42,38 @@ public:
 	 */
 	std::shared_ptr<consumer_queue> new_consumer(int max_buffered = 0);
 
+	/**
+	 * Replace a consumer queue with one of a different size, e.g. when an inlet renegotiates its
+	 * buffer length.
+	 *
+	 * The queued samples are moved to the new queue. It's never made smaller than twice the
+	 * number of queued samples, so no samples are dropped. Must only be called by the queue's
+	 * (only) consumer.
+	 * @param queue The registered queue, replaced by the new one.
+	 * @param max_buffered The new queue size (limited by the max_capacity as in new_consumer()).
+	 */
+	void resize_consumer(std::shared_ptr<consumer_queue> &queue, int max_buffered);
+
 	/// Push a sample onto the send buffer that will subsequently be received by all consumers.
 	void push_sample(const sample_p &s);
 
+	/// Push several samples at once, waking up each consumer only once.
+	void push_samples(const sample_p *samples, std::size_t n);
+
 	/// Wait until some consumers are present.
 	bool wait_for_consumers(double timeout = FOREVER);
 
 	/// Check whether any consumer is currently registered.
 	bool have_consumers();
 
+	/**
+	 * Gather statistics about the consumer queues.
+	 * @param[out] num_consumers Number of currently registered consumers.
+	 * @param[out] max_depth The largest number of samples waiting in any consumer queue.
+	 * @param[out] dropped Total number of samples dropped by all consumers, past and present.
+	 */
+	void consumer_stats(int32_t &num_consumers, int32_t &max_depth, uint64_t &dropped);
+
 private:
 	friend class consumer_queue;
 
@@ -66,6 +89,8 @@ private:
 	int max_capacity_;
 	/// a set of registered consumer queues
 	consumer_set consumers_;
+	/// number of samples dropped by consumers that have already been unregistered
+	uint64_t retired_dropped_{0};
 	/// mutex to protect the integrity of consumers_
 	std::mutex consumers_mut_;
 	/// condition variable signaling that a consumer has registered
@@ -0,0 +1,45 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "common.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace lsl {
+
+/// Raise an atomic value to at least `val` (relaxed ordering)
+template <typename T> inline void atomic_fetch_max(std::atomic<T> &cur, T val) noexcept {
+	T prev = cur.load(std::memory_order_relaxed);
+	while (prev < val && !cur.compare_exchange_weak(prev, val, std::memory_order_relaxed)) {}
+}
+
+/**
+ * Cumulative counters of an outlet and its client sessions.
+ *
+ * Shared between the outlet, its TCP server and the sessions' transfer threads (which may outlive
+ * the outlet for a short while), so it's held by shared pointer.
+ */
+struct outlet_counters {
+	std::atomic<uint64_t> samples_pushed{0};
+	std::atomic<uint64_t> bytes_pushed{0};
+	std::atomic<uint64_t> samples_sent{0};
+	std::atomic<uint64_t> bytes_sent{0};
+	std::atomic<uint64_t> chunks_written{0};
+	/// total / maximum time between issuing a chunk write and its completion, in ns
+	std::atomic<uint64_t> write_latency_ns{0};
+	std::atomic<uint64_t> max_write_latency_ns{0};
+};
+using outlet_counters_p = std::shared_ptr<outlet_counters>;
+
+/// Cumulative counters of an inlet's data receiver
+struct inlet_counters {
+	std::atomic<uint64_t> samples_received{0};
+	std::atomic<uint32_t> reconnects{0};
+	/// duration of the last successful connection handshake, in seconds
+	std::atomic<double> handshake_time{0.0};
+};
+
+} // namespace lsl
+
+#endif
@@ -1,11 +1,16 @@
 #include "stream_info_impl.h"
 #include "api_config.h"
+#include "logging.h"
+#include "sample.h"
 #include "util/cast.hpp"
+#include "util/endian.hpp"
 #include "util/uuid.hpp"
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <exception>
-#include <loguru.hpp>
+#include <iterator>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <vector>
@@ -35,6 +40,8 @@ stream_info_impl::stream_info_impl(const std::string &name, std::string type, in
 		throw std::invalid_argument("The channel_count of a stream must be nonnegative.");
 	if (nominal_srate < 0)
 		throw std::invalid_argument("The nominal sampling rate of a stream must be nonnegative.");
+	if (channel_format == cft_record)
+		throw std::invalid_argument("The channels of a record stream need individual formats.");
 	if (channel_format < 0 || channel_format > 7)
 		throw std::invalid_argument("The stream info was created with an unknown channel format " +
 									to_string(static_cast<int>(channel_format)));
@@ -42,6 +49,17 @@ stream_info_impl::stream_info_impl(const std::string &name, std::string type, in
 	write_xml(doc_);
 }
 
+stream_info_impl::stream_info_impl(const std::string &name, std::string type,
+	const std::vector<lsl_channel_format_t> &channel_formats, double nominal_srate,
+	std::string source_id)
+	: stream_info_impl(name, std::move(type), static_cast<int>(channel_formats.size()),
+		  nominal_srate, cft_undefined, std::move(source_id)) {
+	record_layout_ = std::make_shared<const lsl::record_layout>(channel_formats);
+	channel_format_ = cft_record;
+	doc_.reset();
+	write_xml(doc_);
+}
+
 template <typename T> void append_text_node(xml_node &node, const char *name, const T &value) {
 	node.append_child(name).append_child(node_pcdata).text().set(value);
 }
@@ -50,14 +68,22 @@ template <> void append_text_node(xml_node &node, const char *name, const std::s
 	node.append_child(name).append_child(node_pcdata).set_value(value.c_str());
 }
 
+static const char *const channel_format_strings[] = {
+	"undefined", "float32", "double64", "string", "int32", "int16", "int8", "int64", "record"};
+
 void stream_info_impl::write_xml(xml_document &doc) {
-	const char *channel_format_strings[] = {
-		"undefined", "float32", "double64", "string", "int32", "int16", "int8", "int64"};
 	xml_node info = doc.append_child("info");
 	append_text_node(info, "name", name_);
 	append_text_node(info, "type", type_);
 	append_text_node(info, "channel_count", channel_count_);
 	append_text_node(info, "channel_format", channel_format_strings[channel_format_]);
+	if (record_layout_) {
+		// the formats of a record's channels, e.g. "int16 int16 float32"
+		std::string formats;
+		for (auto fmt : record_layout_->formats())
+			(formats += formats.empty() ? "" : " ") += channel_format_strings[fmt];
+		append_text_node(info, "channel_formats", formats);
+	}
 	append_text_node(info, "source_id", source_id_);
 	// floating point fields: use locale independent to_string function
 	append_text_node(info, "nominal_srate", to_string(nominal_srate_));
@@ -66,6 +92,7 @@ void stream_info_impl::write_xml(xml_document &doc) {
 	append_text_node(info, "uid", uid_);
 	append_text_node(info, "session_id", session_id_);
 	append_text_node(info, "hostname", hostname_);
+	append_text_node(info, "boot_id", boot_id_);
 	append_text_node(info, "v4address", v4address_);
 	append_text_node(info, "v4data_port", v4data_port_);
 	append_text_node(info, "v4service_port", v4service_port_);
@@ -118,8 +145,25 @@ void stream_info_impl::read_xml(xml_document &doc) {
 			channel_format_ = cft_int8;
 		else if (fmt == "int64")
 			channel_format_ = cft_int64;
+		else if (fmt == "record")
+			channel_format_ = cft_record;
 		else
 			throw std::runtime_error("Invalid channel format " + fmt);
+		record_layout_.reset();
+		if (channel_format_ == cft_record) {
+			std::vector<lsl_channel_format_t> formats;
+			std::istringstream is(info.child_value("channel_formats"));
+			for (std::string name; is >> name;) {
+				const auto *const *it = std::find(std::begin(channel_format_strings),
+					std::end(channel_format_strings), name);
+				formats.push_back(static_cast<lsl_channel_format_t>(
+					std::distance(std::begin(channel_format_strings), it)));
+			}
+			if (formats.size() != channel_count_)
+				throw std::runtime_error("The channel formats don't match the channel count.");
+			// throws for unknown formats
+			record_layout_ = std::make_shared<const lsl::record_layout>(std::move(formats));
+		}
 
 		// source_id
 		source_id_ = info.child_value("source_id");
@@ -135,6 +179,8 @@ void stream_info_impl::read_xml(xml_document &doc) {
 		session_id_ = info.child_value("session_id");
 		// hostname
 		hostname_ = info.child_value("hostname");
+		// boot_id (optional, not sent by older providers)
+		boot_id_ = info.child_value("boot_id");
 		v4address_ = info.child_value("v4address");
 		get_bounded_child_val(info, "v4data_port", v4data_port_, 0, 65535);
 		get_bounded_child_val(info, "v4service_port", v4service_port_, 0, 65535);
@@ -161,11 +207,112 @@ std::string stream_info_impl::to_shortinfo_message() {
 	return os.str();
 }
 
+/*
+ * Binary short-info message, version 1. All values are little endian, strings are prefixed with
+ * their length as uint16:
+ * magic ("LSLB") | version (uint8) | channel_format (uint8) | channel_count (uint32) |
+ * nominal_srate (double) | version (int32, *100) | created_at (double) |
+ * v4data_port, v4service_port, v6data_port, v6service_port (uint16 each) |
+ * name, type, source_id, uid, session_id, hostname, v4address, v6address (strings) |
+ * boot_id (string, optional)
+ */
+const char *const stream_info_impl::binary_shortinfo_capability = "binshortinfo/1";
+static const char binary_shortinfo_magic[] = {'L', 'S', 'L', 'B'};
+static const uint8_t binary_shortinfo_version = 1;
+
+template <typename T> void put_le(std::string &out, T v) {
+	if (byteorder::native != byteorder::little) endian_reverse_inplace(v);
+	out.append(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+template <typename T> T get_le(const char *&pos, const char *end) {
+	T v;
+	if (static_cast<std::size_t>(end - pos) < sizeof(T))
+		throw std::runtime_error("Binary short-info message is truncated.");
+	memcpy(&v, pos, sizeof(T));
+	pos += sizeof(T);
+	if (byteorder::native != byteorder::little) endian_reverse_inplace(v);
+	return v;
+}
+
+std::string stream_info_impl::to_binary_shortinfo_message() {
+	// the channel formats of records are only sent in the XML message
+	if (channel_format_ == cft_record) return std::string();
+	std::string out(binary_shortinfo_magic, sizeof(binary_shortinfo_magic));
+	put_le<uint8_t>(out, binary_shortinfo_version);
+	put_le<uint8_t>(out, static_cast<uint8_t>(channel_format_));
+	put_le<uint32_t>(out, channel_count_);
+	put_le<double>(out, nominal_srate_);
+	put_le<int32_t>(out, version_);
+	put_le<double>(out, created_at_);
+	for (uint16_t port : {v4data_port_, v4service_port_, v6data_port_, v6service_port_})
+		put_le<uint16_t>(out, port);
+	for (const std::string *str : {&name_, &type_, &source_id_, &uid_, &session_id_, &hostname_,
+			 &v4address_, &v6address_}) {
+		if (str->size() > 0xFFFF) return std::string();
+		put_le<uint16_t>(out, static_cast<uint16_t>(str->size()));
+		out += *str;
+	}
+	// older readers ignore trailing fields
+	if (boot_id_.size() > 0xFFFF) return std::string();
+	put_le<uint16_t>(out, static_cast<uint16_t>(boot_id_.size()));
+	out += boot_id_;
+	return out;
+}
+
 void stream_info_impl::from_shortinfo_message(const std::string &m) {
-	// load the doc from the message string
-	doc_.load_buffer(m.c_str(), m.size());
-	// and assign all the struct fields, too...
-	read_xml(doc_);
+	if (m.size() < sizeof(binary_shortinfo_magic) ||
+		memcmp(m.data(), binary_shortinfo_magic, sizeof(binary_shortinfo_magic)) != 0) {
+		// load the doc from the message string
+		doc_.load_buffer(m.c_str(), m.size());
+		// and assign all the struct fields, too...
+		read_xml(doc_);
+		return;
+	}
+	try {
+		const char *pos = m.data() + sizeof(binary_shortinfo_magic), *end = m.data() + m.size();
+		if (get_le<uint8_t>(pos, end) != binary_shortinfo_version)
+			throw std::runtime_error("Unsupported binary short-info version.");
+		const auto fmt = get_le<uint8_t>(pos, end);
+		if (fmt > cft_int64) throw std::runtime_error("Invalid channel format.");
+		channel_format_ = static_cast<lsl_channel_format_t>(fmt);
+		record_layout_.reset();
+		channel_count_ = get_le<uint32_t>(pos, end);
+		if (channel_count_ > static_cast<uint32_t>(std::numeric_limits<int32_t>::max()))
+			throw std::runtime_error("channel_count must be >=0");
+		nominal_srate_ = get_le<double>(pos, end);
+		version_ = get_le<int32_t>(pos, end);
+		if (version_ <= 0)
+			throw std::runtime_error("The version of the given stream info is invalid.");
+		created_at_ = get_le<double>(pos, end);
+		for (uint16_t *port : {&v4data_port_, &v4service_port_, &v6data_port_, &v6service_port_})
+			*port = get_le<uint16_t>(pos, end);
+		for (std::string *str : {&name_, &type_, &source_id_, &uid_, &session_id_, &hostname_,
+				 &v4address_, &v6address_}) {
+			const auto len = get_le<uint16_t>(pos, end);
+			if (static_cast<std::size_t>(end - pos) < len)
+				throw std::runtime_error("Binary short-info message is truncated.");
+			str->assign(pos, len);
+			pos += len;
+		}
+		boot_id_.clear();
+		if (pos < end) {
+			const auto len = get_le<uint16_t>(pos, end);
+			if (static_cast<std::size_t>(end - pos) < len)
+				throw std::runtime_error("Binary short-info message is truncated.");
+			boot_id_.assign(pos, len);
+		}
+		if (name_.empty())
+			throw std::runtime_error("Received a stream info with empty <name> field.");
+		if (uid_.empty()) throw std::runtime_error("The UID of the given stream info is empty.");
+		// rebuild the XML representation (without parsing anything)
+		doc_.reset();
+		write_xml(doc_);
+	} catch (std::exception &e) {
+		// reset the stream info to blank state
+		*this = stream_info_impl();
+		name_ = (std::string("(invalid: ") += e.what()) += ')';
+	}
 }
 
 std::string stream_info_impl::to_fullinfo_message() {
@@ -230,17 +377,33 @@ bool query_cache::matches_query(const xml_document &doc, const std::string &quer
 		}
 		return matched;
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Query \"%s\" error: %s", query.c_str(), e.what());
+		LSL_LOG_F(WARNING, "Query \"%s\" error: %s", query.c_str(), e.what());
 		return false;
 	}
 }
 
 int stream_info_impl::channel_bytes() const {
 	const int channel_format_sizes[] = {0, sizeof(float), sizeof(double), sizeof(std::string),
-		sizeof(int32_t), sizeof(int16_t), sizeof(int8_t), 8};
+		sizeof(int32_t), sizeof(int16_t), sizeof(int8_t), 8, 1};
 	return channel_format_sizes[channel_format_];
 }
 
+int stream_info_impl::sample_bytes() const {
+	if (record_layout_) return static_cast<int>(record_layout_->size());
+	return channel_count_ * channel_bytes();
+}
+
+lsl_channel_format_t stream_info_impl::channel_format(uint32_t channel) const {
+	if (channel >= channel_count_) throw std::invalid_argument("Invalid channel index.");
+	return record_layout_ ? record_layout_->format(channel) : channel_format_;
+}
+
+int stream_info_impl::channel_offset(uint32_t channel) const {
+	if (channel >= channel_count_) throw std::invalid_argument("Invalid channel index.");
+	if (record_layout_) return static_cast<int>(record_layout_->offset(channel));
+	return static_cast<int>(channel) * channel_bytes();
+}
+
 xml_node stream_info_impl::desc() { return doc_.child("info").child("desc"); }
 xml_node stream_info_impl::desc() const { return doc_.child("info").child("desc"); }
 
@@ -293,6 +456,11 @@ void stream_info_impl::hostname(const std::string &v) {
 	doc_.child("info").child("hostname").first_child().set_value(hostname_.c_str());
 }
 
+void stream_info_impl::boot_id(const std::string &v) {
+	boot_id_ = v;
+	doc_.child("info").child("boot_id").first_child().set_value(boot_id_.c_str());
+}
+
 void stream_info_impl::v4address(const std::string &v) {
 	v4address_ = v;
 	doc_.child("info").child("v4address").first_child().set_value(v4address_.c_str());
@@ -323,6 +491,11 @@ void stream_info_impl::v6service_port(uint16_t v) {
 	doc_.child("info").child("v6service_port").first_child().text().set(v6service_port_);
 }
 
+void stream_info_impl::add_address(const std::string &addr) {
+	if (std::find(addresses_.begin(), addresses_.end(), addr) == addresses_.end())
+		addresses_.push_back(addr);
+}
+
 stream_info_impl &stream_info_impl::operator=(stream_info_impl const &rhs) {
 	if (this == &rhs) return *this;
 	name_ = rhs.name_;
@@ -330,6 +503,7 @@ stream_info_impl &stream_info_impl::operator=(stream_info_impl const &rhs) {
 	channel_count_ = rhs.channel_count_;
 	nominal_srate_ = rhs.nominal_srate_;
 	channel_format_ = rhs.channel_format_;
+	record_layout_ = rhs.record_layout_;
 	source_id_ = rhs.source_id_;
 	version_ = rhs.version_;
 	v4address_ = rhs.v4address_;
@@ -342,6 +516,8 @@ stream_info_impl &stream_info_impl::operator=(stream_info_impl const &rhs) {
 	created_at_ = rhs.created_at_;
 	session_id_ = rhs.session_id_;
 	hostname_ = rhs.hostname_;
+	boot_id_ = rhs.boot_id_;
+	addresses_ = rhs.addresses_;
 	doc_.reset(rhs.doc_);
 	return *this;
 }
@@ -349,11 +525,13 @@ stream_info_impl &stream_info_impl::operator=(stream_info_impl const &rhs) {
 stream_info_impl::stream_info_impl(const stream_info_impl &rhs)
 	: name_(rhs.name_), type_(rhs.type_), channel_count_(rhs.channel_count_),
 	  nominal_srate_(rhs.nominal_srate_), channel_format_(rhs.channel_format_),
-	  source_id_(rhs.source_id_), version_(rhs.version_), v4address_(rhs.v4address_),
+	  record_layout_(rhs.record_layout_), source_id_(rhs.source_id_), version_(rhs.version_),
+	  v4address_(rhs.v4address_),
 	  v4data_port_(rhs.v4data_port_), v4service_port_(rhs.v4service_port_),
 	  v6address_(rhs.v6address_), v6data_port_(rhs.v6data_port_),
 	  v6service_port_(rhs.v6service_port_), uid_(rhs.uid_), created_at_(rhs.created_at_),
-	  session_id_(rhs.session_id_), hostname_(rhs.hostname_) {
+	  session_id_(rhs.session_id_), hostname_(rhs.hostname_), boot_id_(rhs.boot_id_),
+	  addresses_(rhs.addresses_) {
 	doc_.reset(rhs.doc_);
 }
 
@@ -2,11 +2,14 @@
 #define STREAM_INFO_IMPL_H
 
 #include "common.h"
+#include "forward.h"
+#include "util/memstats.hpp"
 #include <cstdint>
 #include <mutex>
 #include <pugixml.hpp>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace lsl {
 
@@ -51,6 +54,15 @@ public:
 	stream_info_impl(const std::string &name, std::string type, int channel_count,
 		double nominal_srate, lsl_channel_format_t channel_format, std::string source_id);
 
+	/**
+	 * Construct the info of a record stream, i.e. one whose channels have individual numeric
+	 * formats and are packed into one record per sample.
+	 * @param channel_formats The format of each channel.
+	 */
+	stream_info_impl(const std::string &name, std::string type,
+		const std::vector<lsl_channel_format_t> &channel_formats, double nominal_srate,
+		std::string source_id);
+
 	/// Copy constructor. Needs special handling because xml_document is non-copyable.
 	stream_info_impl(const stream_info_impl &rhs);
 
@@ -69,7 +81,19 @@ public:
 	std::string to_shortinfo_message();
 
 	/**
-	 * Initialize a stream_info from a short-info message.
+	 * Get the compact binary short-info message according to this stream_info.
+	 *
+	 * This contains the same fields as the short-info message but can be decoded without an XML
+	 * parser. It's sent in response to queries that announce `binary_shortinfo_capability`.
+	 * @return The message or an empty string if a field is too long for the binary encoding.
+	 */
+	std::string to_binary_shortinfo_message();
+
+	/// Capability token a query appends to its return address line to get a binary short-info
+	static const char *const binary_shortinfo_capability;
+
+	/**
+	 * Initialize a stream_info from a short-info message (in either the XML or binary format).
 	 *
 	 * This functions resets all fields of the stream_info accoridng to the message. The .desc()
 	 * field will be empty.
@@ -121,11 +145,20 @@ public:
 	/// Get the unique source identifier of a stream, if any.
 	const std::string &source_id() const { return source_id_; }
 
-	/// Get the number of bytes per channel (returns 0 for string-typed channels).
+	/// Get the number of bytes per channel (returns 0 for string-typed channels and 1 for records).
 	int channel_bytes() const;
 
 	/// Get the number of bytes per sample (returns 0 for string-typed channels).
-	int sample_bytes() const { return channel_count_ * channel_bytes(); }
+	int sample_bytes() const;
+
+	/// The channel formats and offsets of a record stream (nullptr for other streams)
+	const record_layout_p &record_layout() const { return record_layout_; }
+
+	/// The format of a channel, which differs between the channels of a record stream
+	lsl_channel_format_t channel_format(uint32_t channel) const;
+
+	/// The byte offset of a channel's value in a numeric sample
+	int channel_offset(uint32_t channel) const;
 
 
 	//
@@ -172,6 +205,16 @@ public:
 	const std::string &hostname() const { return hostname_; }
 	void hostname(const std::string &v);
 
+	/**
+	 * Get/Set the boot id of the provider host.
+	 *
+	 * The boot id changes whenever the host is restarted (and with it, its clock), so state that
+	 * depends on the host's clock (e.g. time corrections) is only valid for the same boot id.
+	 * It's empty if the provider doesn't know (or send) it.
+	 */
+	const std::string &boot_id() const { return boot_id_; }
+	void boot_id(const std::string &v);
+
 	/**
 	 * Get/Set the host name or IP address where the stream is hosted.
 	 *
@@ -217,6 +260,16 @@ public:
 	uint16_t v6service_port() const { return v6service_port_; }
 	void v6service_port(uint16_t v);
 
+	/**
+	 * Get all addresses the stream has been discovered at, in the order of their first replies.
+	 *
+	 * This includes v4address() and v6address() and is filled by the resolver for multi-homed
+	 * hosts, but not transmitted as part of the stream_info.
+	 */
+	const std::vector<std::string> &addresses() const { return addresses_; }
+	/// Add an address to addresses() unless it's already known.
+	void add_address(const std::string &addr);
+
 	/// Get the (editable) XML description of a stream.
 	pugi::xml_node desc();
 	pugi::xml_node desc() const;
@@ -238,6 +291,7 @@ private:
 	uint32_t channel_count_;
 	double nominal_srate_;
 	lsl_channel_format_t channel_format_;
+	record_layout_p record_layout_;
 	std::string source_id_;
 	// auto-generated network information
 	int version_;
@@ -251,10 +305,14 @@ private:
 	double created_at_;
 	std::string session_id_;
 	std::string hostname_;
+	std::string boot_id_;
+	std::vector<std::string> addresses_;
 	// XML representation
 	pugi::xml_document doc_;
 	// cached query results
 	query_cache cached_;
+	// memory accounting
+	memstats::tracked<memstats::component::stream_info, stream_info_impl> tracked_;
 };
 
 
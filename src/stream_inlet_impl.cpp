@@ -0,0 +1,85 @@
+#include "stream_inlet_impl.h"
+#include "logging.h"
+#include "util/cast.hpp"
+#include <pugixml.hpp>
+#include <sstream>
+#include <stdexcept>
+
+using namespace lsl;
+
+static void set_double(pugi::xml_node node, const char *name, double value) {
+	node.append_attribute(name) = to_string(value).c_str();
+}
+
+static double get_double(pugi::xml_node node, const char *name) {
+	pugi::xml_attribute attr = node.attribute(name);
+	if (!attr) throw std::invalid_argument(std::string("The inlet state lacks ") + name);
+	return from_string<double>(attr.value());
+}
+
+std::string stream_inlet_impl::export_state() {
+	pugi::xml_document doc;
+	pugi::xml_node state = doc.append_child("inlet_state");
+	state.append_attribute("uid") = conn_.current_uid().c_str();
+	state.append_attribute("source_boot_id") = conn_.current_boot_id().c_str();
+	state.append_attribute("boot_id") = boot_id().c_str();
+
+	double offset, remote_time, uncertainty;
+	if (time_receiver_.last_time_correction(offset, remote_time, uncertainty)) {
+		pugi::xml_node clock = state.append_child("time_correction");
+		set_double(clock, "offset", offset);
+		set_double(clock, "remote_time", remote_time);
+		set_double(clock, "uncertainty", uncertainty);
+	}
+
+	const postproc_dejitterer dejitter = postprocessor_.get_state(offset);
+	if (dejitter.is_initialized()) {
+		pugi::xml_node node = state.append_child("dejitter");
+		node.append_attribute("t0") = to_string(dejitter.t0_).c_str();
+		node.append_attribute("samples") = to_string(dejitter.samples_since_t0_).c_str();
+		set_double(node, "w0", dejitter.w0_);
+		set_double(node, "w1", dejitter.w1_);
+		set_double(node, "P00", dejitter.P00_);
+		set_double(node, "P11", dejitter.P11_);
+		set_double(node, "P01", dejitter.P01_);
+		set_double(node, "lambda", dejitter.lam_);
+		set_double(node, "offset", offset);
+	}
+
+	std::ostringstream os;
+	doc.save(os, "", pugi::format_raw);
+	return os.str();
+}
+
+bool stream_inlet_impl::import_state(const std::string &content) {
+	pugi::xml_document doc;
+	if (!doc.load_buffer(content.data(), content.size()))
+		throw std::invalid_argument("The inlet state is not valid XML.");
+	pugi::xml_node state = doc.child("inlet_state");
+	if (!state) throw std::invalid_argument("The inlet state lacks the <inlet_state> element.");
+
+	// the estimates are only valid for the same outlet and the same clocks on both ends
+	if (conn_.current_uid() != state.attribute("uid").value() ||
+		conn_.current_boot_id() != state.attribute("source_boot_id").value() ||
+		boot_id() != state.attribute("boot_id").value())
+		return false;
+
+	if (pugi::xml_node clock = state.child("time_correction"))
+		time_receiver_.import_time_correction(get_double(clock, "offset"),
+			get_double(clock, "remote_time"), get_double(clock, "uncertainty"));
+
+	if (pugi::xml_node node = state.child("dejitter")) {
+		postproc_dejitterer dejitter;
+		dejitter.t0_ = static_cast<uint_fast32_t>(get_double(node, "t0"));
+		dejitter.samples_since_t0_ = static_cast<uint_fast32_t>(get_double(node, "samples"));
+		dejitter.w0_ = get_double(node, "w0");
+		dejitter.w1_ = get_double(node, "w1");
+		dejitter.P00_ = get_double(node, "P00");
+		dejitter.P11_ = get_double(node, "P11");
+		dejitter.P01_ = get_double(node, "P01");
+		dejitter.lam_ = get_double(node, "lambda");
+		postprocessor_.set_state(dejitter, get_double(node, "offset"));
+	}
+	LSL_DLOG_F(INFO, "Resumed the time correction state of stream %s", conn_.current_uid().c_str());
+	return true;
+}
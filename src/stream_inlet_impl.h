@@ -5,9 +5,9 @@
 #include "data_receiver.h"
 #include "info_receiver.h"
 #include "inlet_connection.h"
+#include "logging.h"
 #include "time_postprocessor.h"
 #include "time_receiver.h"
-#include <loguru.hpp>
 
 namespace lsl {
 
@@ -36,11 +36,13 @@ public:
 	 * In all other cases (recover is false or the stream is not recoverable) a lsl::lost_error
 	 * is thrown where indicated if the stream's source is lost (e.g. due to an app or computer
 	 * crash).
+	 * @param adaptive_buffer Treat max_buflen as an upper bound and adapt the buffer to the
+	 * amount of data that's actually waiting to be pulled (see data_receiver).
 	 */
 	stream_inlet_impl(const stream_info_impl &info, int32_t max_buflen = 360,
-		int32_t max_chunklen = 0, bool recover = true)
+		int32_t max_chunklen = 0, bool recover = true, bool adaptive_buffer = false)
 		: conn_(info, recover), info_receiver_(conn_), time_receiver_(conn_),
-		  data_receiver_(conn_, max_buflen, max_chunklen),
+		  data_receiver_(conn_, max_buflen, max_chunklen, adaptive_buffer),
 		  postprocessor_([this]() { return time_receiver_.time_correction(5); },
 			  [this]() { return conn_.current_srate(); },
 			  [this]() { return time_receiver_.was_reset(); }) {
@@ -53,8 +55,8 @@ public:
 		try {
 			conn_.disengage();
 		} catch (std::exception &e) {
-			LOG_F(WARNING, "Unexpected error during inlet shutdown: %s", e.what());
-		} catch (...) { LOG_F(ERROR, "Severe error during stream inlet shutdown."); }
+			LSL_LOG_F(WARNING, "Unexpected error during inlet shutdown: %s", e.what());
+		} catch (...) { LSL_LOG_F(ERROR, "Severe error during stream inlet shutdown."); }
 	}
 
 	/**
@@ -147,7 +149,7 @@ public:
 		} catch (std::invalid_argument &) { *ec = lsl_argument_error; } catch (std::range_error &) {
 			*ec = lsl_argument_error;
 		} catch (std::exception &e) {
-			LOG_F(ERROR, "Unexpected error in %s: %s", __func__, e.what());
+			LSL_LOG_F(ERROR, "Unexpected error in %s: %s", __func__, e.what());
 			*ec = lsl_internal_error;
 		}
 		return 0.0;
@@ -227,12 +229,44 @@ public:
 		} catch (std::invalid_argument &) { *ec = lsl_argument_error; } catch (std::range_error &) {
 			*ec = lsl_argument_error;
 		} catch (std::exception &e) {
-			LOG_F(ERROR, "Unexpected error in %s: %s", __func__, e.what());
+			LSL_LOG_F(ERROR, "Unexpected error in %s: %s", __func__, e.what());
 			*ec = lsl_internal_error;
 		}
 		return 0;
 	}
 
+	/**
+	 * Pull a chunk of samples into an application buffer with a custom layout, e.g. an array of
+	 * records that hold other fields besides the channel values.
+	 *
+	 * Only the channel values are written; all other bytes of the buffer are left untouched.
+	 * @param data The start of the first sample in the buffer.
+	 * @param max_samples The number of samples the buffer can hold.
+	 * @param sample_stride The distance between the starts of two samples in bytes.
+	 * @param layout The position of the channel values (of type T) relative to a sample's start.
+	 * @param timestamp_buffer Optionally a buffer for max_samples time stamps.
+	 * @param timeout The timeout for this operation, see pull_chunk_multiplexed().
+	 * @return The number of samples written to the buffer.
+	 * @throws lost_error (if the stream source has been lost).
+	 */
+	template <class T>
+	std::size_t pull_chunk_strided(void *data, std::size_t max_samples,
+		std::ptrdiff_t sample_stride, const channel_layout &layout,
+		double *timestamp_buffer = nullptr, double timeout = 0.0) {
+		if (!data) throw std::invalid_argument("The data buffer pointer must not be NULL.");
+		if (sample_stride <= 0) throw std::invalid_argument("The sample stride must be positive.");
+		char *pos = static_cast<char *>(data);
+		double end_time = timeout ? lsl_clock() + timeout : 0.0;
+		std::size_t samples_written = 0;
+		for (; samples_written < max_samples; samples_written++, pos += sample_stride) {
+			double ts = postprocess(data_receiver_.pull_sample_strided<T>(
+				pos, layout, timeout ? end_time - lsl_clock() : 0.0));
+			if (!ts) break;
+			if (timestamp_buffer) timestamp_buffer[samples_written] = ts;
+		}
+		return samples_written;
+	}
+
 	/**
 	 * Retrieve the complete information of the given stream, including the extended description.
 	 *
@@ -322,6 +356,44 @@ public:
 	/// Override the half-time (forget factor) of the time-stamp smoothing.
 	void smoothing_halftime(float value) { postprocessor_.smoothing_halftime(value); }
 
+	/// Only receive the samples that match a filter expression (empty: all samples).
+	void set_sample_filter(const std::string &expression) {
+		data_receiver_.set_sample_filter(expression);
+	}
+
+	/**
+	 * Pull the next sample as received, without time stamp post-processing (e.g., for recording).
+	 * @return The sample or nullptr if the timeout expired.
+	 */
+	sample_p pull_raw_sample(double timeout) { return data_receiver_.try_get_next_sample(timeout); }
+
+	/**
+	 * Save the time correction and dejitter state, e.g. to resume with converged estimates after
+	 * a restart (see import_state()).
+	 * @return An XML document that's keyed by the stream's UID and the boot ids of both hosts.
+	 */
+	std::string export_state();
+
+	/**
+	 * Resume with a state saved by export_state().
+	 *
+	 * Call this after set_postprocessing() and before pulling samples.
+	 * @return False if the state belongs to a different stream, or one of the hosts was restarted
+	 * in the meantime. The state is ignored in that case.
+	 * @throws std::invalid_argument if the state can't be parsed.
+	 */
+	bool import_state(const std::string &state);
+
+	/// Retrieve the current runtime statistics (non-blocking).
+	lsl_inlet_stats get_stats() {
+		lsl_inlet_stats stats{};
+		data_receiver_.get_stats(stats);
+		stats.time_correction_uncertainty = -1.;
+		time_receiver_.last_time_correction(
+			stats.time_correction, stats.time_correction_uncertainty);
+		return stats;
+	}
+
 private:
 	/// post-process a time stamp
 	double postprocess(double stamp) {
@@ -1,13 +1,17 @@
 #include "stream_outlet_impl.h"
 #include "api_config.h"
+#include "logging.h"
 #include "sample.h"
 #include "send_buffer.h"
 #include "stream_info_impl.h"
 #include "tcp_server.h"
+#include "time_beacon.h"
+#include "trace.h"
 #include "udp_server.h"
 #include <algorithm>
 #include <chrono>
 #include <memory>
+#include <type_traits>
 
 namespace lsl {
 
@@ -18,10 +22,12 @@ stream_outlet_impl::stream_outlet_impl(const stream_info_impl &info, int32_t chu
 			  info.nominal_srate()
 				  ? info.nominal_srate() * api_config::get_instance()->outlet_buffer_reserve_ms() /
 						1000
-				  : api_config::get_instance()->outlet_buffer_reserve_samples()))),
+				  : api_config::get_instance()->outlet_buffer_reserve_samples()),
+		  info.record_layout())),
 	  chunk_size_(info.calc_transport_buf_samples(requested_bufsize, flags)),
 	  info_(std::make_shared<stream_info_impl>(info)),
 	  send_buffer_(std::make_shared<send_buffer>(chunk_size_)),
+	  counters_(std::make_shared<outlet_counters>()), trace_timestamps_(info.nominal_srate()),
 	  io_ctx_data_(std::make_shared<asio::io_context>(1)),
 	  io_ctx_service_(std::make_shared<asio::io_context>(1)) {
 	ensure_lsl_initialized();
@@ -31,17 +37,17 @@ stream_outlet_impl::stream_outlet_impl(const stream_info_impl &info, int32_t chu
 	if (cfg->allow_ipv4()) try {
 			instantiate_stack(udp::v4());
 		} catch (std::exception &e) {
-			LOG_F(WARNING, "Could not instantiate IPv4 stack: %s", e.what());
+			LSL_LOG_F(WARNING, "Could not instantiate IPv4 stack: %s", e.what());
 		}
 	if (cfg->allow_ipv6()) try {
 			instantiate_stack(udp::v6());
 		} catch (std::exception &e) {
-			LOG_F(WARNING, "Could not instantiate IPv6 stack: %s", e.what());
+			LSL_LOG_F(WARNING, "Could not instantiate IPv6 stack: %s", e.what());
 		}
 
 	// create TCP data server
 	tcp_server_ = std::make_shared<tcp_server>(info_, io_ctx_data_, send_buffer_, sample_factory_,
-		chunk_size_, cfg->allow_ipv4(), cfg->allow_ipv6());
+		chunk_size_, cfg->allow_ipv4(), cfg->allow_ipv6(), counters_);
 
 	// fail if both stacks failed to instantiate
 	if (udp_servers_.empty())
@@ -51,6 +57,7 @@ stream_outlet_impl::stream_outlet_impl(const stream_info_impl &info, int32_t chu
 	tcp_server_->begin_serving();
 	for (auto &udp_server : udp_servers_) udp_server->begin_serving();
 	for (auto &responder : responders_) responder->begin_serving();
+	time_beacon_ = time_beacon::acquire();
 
 	// and start the IO threads to handle them
 	const std::string name{"IO_" + this->info().name().substr(0, 11)};
@@ -62,7 +69,7 @@ stream_outlet_impl::stream_outlet_impl(const stream_info_impl &info, int32_t chu
 					io->run();
 					return;
 				} catch (std::exception &e) {
-					LOG_F(ERROR, "Error during io_context processing: %s", e.what());
+					LSL_LOG_F(ERROR, "Error during io_context processing: %s", e.what());
 				}
 			}
 		}));
@@ -74,7 +81,8 @@ void stream_outlet_impl::instantiate_stack(udp udp_protocol) {
 	std::string listen_address = cfg->listen_address();
 	int multicast_ttl = cfg->multicast_ttl();
 	uint16_t multicast_port = cfg->multicast_port();
-	LOG_F(2, "%s: Trying to listen at address '%s'", info().name().c_str(), listen_address.c_str());
+	LSL_LOG_F(
+		2, "%s: Trying to listen at address '%s'", info().name().c_str(), listen_address.c_str());
 
 	// create UDP time server
 	udp_servers_.push_back(std::make_shared<udp_server>(info_, *io_ctx_service_, udp_protocol));
@@ -86,7 +94,7 @@ void stream_outlet_impl::instantiate_stack(udp udp_protocol) {
 				responders_.push_back(std::make_shared<udp_server>(
 					info_, *io_ctx_service_, address, multicast_port, multicast_ttl, listen_address));
 		} catch (std::exception &e) {
-			LOG_F(WARNING, "Couldn't create multicast responder for %s (%s)",
+			LSL_LOG_F(WARNING, "Couldn't create multicast responder for %s (%s)",
 				address.to_string().c_str(), e.what());
 		}
 	}
@@ -112,20 +120,20 @@ stream_outlet_impl::~stream_outlet_impl() {
 		const char *name = this->info().name().c_str();
 		for (int try_nr = 0; try_nr <= 100; ++try_nr) {
 			switch (try_nr) {
-			case 0: DLOG_F(INFO, "Trying to join IO threads for %s", name); break;
-			case 20: LOG_F(INFO, "Waiting for %s's IO threads to end", name); break;
+			case 0: LSL_DLOG_F(INFO, "Trying to join IO threads for %s", name); break;
+			case 20: LSL_LOG_F(INFO, "Waiting for %s's IO threads to end", name); break;
 			case 80:
-				LOG_F(WARNING, "Stopping io_contexts for %s", name);
+				LSL_LOG_F(WARNING, "Stopping io_contexts for %s", name);
 				io_ctx_data_->stop();
 				io_ctx_service_->stop();
 				for (std::size_t k = 0; k < io_threads_.size(); k++) {
 					if (!io_threads_[k]->joinable()) {
-						LOG_F(ERROR, "%s's io thread #%lu still running", name, k);
+						LSL_LOG_F(ERROR, "%s's io thread #%lu still running", name, k);
 					}
 				}
 				break;
 			case 100:
-				LOG_F(ERROR, "Detaching io_threads for %s", name);
+				LSL_LOG_F(ERROR, "Detaching io_threads for %s", name);
 				for (auto &thread : io_threads_) thread->detach();
 				return;
 			default: break;
@@ -135,21 +143,53 @@ stream_outlet_impl::~stream_outlet_impl() {
 			if (std::all_of(io_threads_.begin(), io_threads_.end(),
 					[](const thread_p &thread) { return thread->joinable(); })) {
 				for (auto &thread : io_threads_) thread->join();
-				DLOG_F(INFO, "All of %s's IO threads were joined succesfully", name);
+				LSL_DLOG_F(INFO, "All of %s's IO threads were joined succesfully", name);
 				break;
 			}
 		}
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error during destruction of a stream outlet: %s", e.what());
-	} catch (...) { LOG_F(ERROR, "Severe error during stream outlet shutdown."); }
+		LSL_LOG_F(WARNING, "Unexpected error during destruction of a stream outlet: %s", e.what());
+	} catch (...) { LSL_LOG_F(ERROR, "Severe error during stream outlet shutdown."); }
 }
 
 void stream_outlet_impl::push_numeric_raw(const void *data, double timestamp, bool pushthrough) {
+	const int64_t push_start = trace::start();
 	if (lsl::api_config::get_instance()->force_default_timestamps()) timestamp = 0.0;
 	sample_p smp(
 		sample_factory_->new_sample(timestamp == 0.0 ? lsl_clock() : timestamp, pushthrough));
 	smp->assign_untyped(data);
+	const double traced_timestamp = trace_timestamps_(smp->timestamp());
+	trace::span("push", push_start, traced_timestamp);
+	const int64_t fanout_start = trace::start();
 	send_buffer_->push_sample(smp);
+	trace::span("fanout", fanout_start, traced_timestamp);
+	counters_->samples_pushed.fetch_add(1, std::memory_order_relaxed);
+	counters_->bytes_pushed.fetch_add(smp->datasize(), std::memory_order_relaxed);
+}
+
+sample_p stream_outlet_impl::make_sample(const void *data, double timestamp, bool pushthrough) {
+	const int64_t push_start = trace::start();
+	sample_p smp(sample_factory_->new_sample(timestamp, pushthrough));
+	std::size_t bytes = info_->sample_bytes();
+	if (info_->channel_format() == cft_string) {
+		const auto *strings = static_cast<const char *const *>(data);
+		std::vector<std::string> tmp(strings, strings + info_->channel_count());
+		for (const auto &str : tmp) bytes += str.size();
+		smp->assign_typed(tmp.data());
+	} else
+		smp->assign_untyped(data);
+	trace::span("push", push_start, trace_timestamps_(timestamp));
+	counters_->samples_pushed.fetch_add(1, std::memory_order_relaxed);
+	counters_->bytes_pushed.fetch_add(bytes, std::memory_order_relaxed);
+	return smp;
+}
+
+void stream_outlet_impl::publish(const sample_p *samples, std::size_t n) {
+	if (!n) return;
+	const int64_t fanout_start = trace::start();
+	send_buffer_->push_samples(samples, n);
+	// the samples were resolved in order when they were made, so the last one is the newest
+	trace::span("fanout", fanout_start, trace_timestamps_.last(), static_cast<uint32_t>(n));
 }
 
 bool stream_outlet_impl::have_consumers() { return send_buffer_->have_consumers(); }
@@ -158,13 +198,45 @@ bool stream_outlet_impl::wait_for_consumers(double timeout) {
 	return send_buffer_->wait_for_consumers(timeout);
 }
 
+std::shared_ptr<consumer_queue> stream_outlet_impl::new_consumer(int max_buffered) {
+	return send_buffer_->new_consumer(max_buffered);
+}
+
+lsl_outlet_stats stream_outlet_impl::get_stats() const {
+	lsl_outlet_stats stats{};
+	uint64_t dropped;
+	send_buffer_->consumer_stats(stats.num_sessions, stats.max_queue_depth, dropped);
+	stats.samples_dropped = static_cast<int64_t>(dropped);
+	stats.samples_pushed = counters_->samples_pushed.load(std::memory_order_relaxed);
+	stats.bytes_pushed = counters_->bytes_pushed.load(std::memory_order_relaxed);
+	stats.samples_sent = counters_->samples_sent.load(std::memory_order_relaxed);
+	stats.bytes_sent = counters_->bytes_sent.load(std::memory_order_relaxed);
+	stats.chunks_written = counters_->chunks_written.load(std::memory_order_relaxed);
+	if (stats.chunks_written)
+		stats.avg_write_latency =
+			counters_->write_latency_ns.load(std::memory_order_relaxed) / 1e9 /
+			static_cast<double>(stats.chunks_written);
+	stats.max_write_latency = counters_->max_write_latency_ns.load(std::memory_order_relaxed) / 1e9;
+	return stats;
+}
+
 template <class T>
 void stream_outlet_impl::enqueue(const T *data, double timestamp, bool pushthrough) {
+	const int64_t push_start = trace::start();
 	if (lsl::api_config::get_instance()->force_default_timestamps()) timestamp = 0.0;
 	sample_p smp(
 		sample_factory_->new_sample(timestamp == 0.0 ? lsl_clock() : timestamp, pushthrough));
 	smp->assign_typed(data);
+	const double traced_timestamp = trace_timestamps_(smp->timestamp());
+	trace::span("push", push_start, traced_timestamp);
+	const int64_t fanout_start = trace::start();
 	send_buffer_->push_sample(smp);
+	trace::span("fanout", fanout_start, traced_timestamp);
+	std::size_t bytes = info_->sample_bytes();
+	if constexpr (std::is_same<T, std::string>::value)
+		for (uint32_t k = 0; k < info_->channel_count(); k++) bytes += data[k].size();
+	counters_->samples_pushed.fetch_add(1, std::memory_order_relaxed);
+	counters_->bytes_pushed.fetch_add(bytes, std::memory_order_relaxed);
 }
 
 template void stream_outlet_impl::enqueue<char>(const char *data, double, bool);
@@ -175,4 +247,51 @@ template void stream_outlet_impl::enqueue<float>(const float *data, double, bool
 template void stream_outlet_impl::enqueue<double>(const double *data, double, bool);
 template void stream_outlet_impl::enqueue<std::string>(const std::string *data, double, bool);
 
+template <class T>
+void stream_outlet_impl::push_chunk_strided(const void *data, std::size_t num_samples,
+	std::ptrdiff_t sample_stride, const channel_layout &layout, double timestamp,
+	bool pushthrough) {
+	if (!data) throw std::invalid_argument("The data buffer pointer must not be NULL.");
+	if (sample_stride <= 0) throw std::invalid_argument("The sample stride must be positive.");
+	if (!num_samples) return;
+	if (timestamp == 0.0 || api_config::get_instance()->force_default_timestamps())
+		timestamp = lsl_clock();
+	if (info().nominal_srate() != IRREGULAR_RATE)
+		timestamp = timestamp - (num_samples - 1) / info().nominal_srate();
+	// the samples are published in batches so the sessions are woken up once per batch
+	const std::size_t max_batch = 64;
+	sample_p batch[max_batch];
+	std::size_t batched = 0;
+	const char *pos = static_cast<const char *>(data);
+	for (std::size_t k = 0; k < num_samples; k++, pos += sample_stride) {
+		const int64_t push_start = trace::start();
+		sample_p &smp = batch[batched++];
+		smp = sample_factory_->new_sample(
+			k == 0 ? timestamp : DEDUCED_TIMESTAMP, pushthrough && k == num_samples - 1);
+		smp->assign_strided<T>(pos, layout);
+		trace::span("push", push_start, trace_timestamps_(smp->timestamp()));
+		if (batched == max_batch || k == num_samples - 1) {
+			publish(batch, batched);
+			for (std::size_t i = 0; i < batched; ++i) batch[i].reset();
+			batched = 0;
+		}
+	}
+	counters_->samples_pushed.fetch_add(num_samples, std::memory_order_relaxed);
+	counters_->bytes_pushed.fetch_add(
+		num_samples * info_->sample_bytes(), std::memory_order_relaxed);
+}
+
+template void stream_outlet_impl::push_chunk_strided<char>(
+	const void *, std::size_t, std::ptrdiff_t, const channel_layout &, double, bool);
+template void stream_outlet_impl::push_chunk_strided<int16_t>(
+	const void *, std::size_t, std::ptrdiff_t, const channel_layout &, double, bool);
+template void stream_outlet_impl::push_chunk_strided<int32_t>(
+	const void *, std::size_t, std::ptrdiff_t, const channel_layout &, double, bool);
+template void stream_outlet_impl::push_chunk_strided<int64_t>(
+	const void *, std::size_t, std::ptrdiff_t, const channel_layout &, double, bool);
+template void stream_outlet_impl::push_chunk_strided<float>(
+	const void *, std::size_t, std::ptrdiff_t, const channel_layout &, double, bool);
+template void stream_outlet_impl::push_chunk_strided<double>(
+	const void *, std::size_t, std::ptrdiff_t, const channel_layout &, double, bool);
+
 } // namespace lsl
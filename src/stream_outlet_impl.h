@@ -3,9 +3,11 @@
 
 #include "common.h"
 #include "forward.h"
+#include "logging.h"
+#include "stats.h"
 #include "stream_info_impl.h"
+#include "trace.h"
 #include <cstdint>
-#include <loguru.hpp>
 #include <memory>
 #include <string>
 #include <thread>
@@ -15,6 +17,8 @@ using asio::ip::tcp;
 using asio::ip::udp;
 
 namespace lsl {
+class consumer_queue;
+struct channel_layout;
 
 /// pointer to a thread
 using thread_p = std::shared_ptr<std::thread>;
@@ -145,13 +149,13 @@ public:
 			enqueue(data, timestamp, pushthrough);
 			return lsl_no_error;
 		} catch (std::range_error &e) {
-			LOG_F(WARNING, "Error during push_sample: %s", e.what());
+			LSL_LOG_F(WARNING, "Error during push_sample: %s", e.what());
 			return lsl_argument_error;
 		} catch (std::invalid_argument &e) {
-			LOG_F(WARNING, "Error during push_sample: %s", e.what());
+			LSL_LOG_F(WARNING, "Error during push_sample: %s", e.what());
 			return lsl_argument_error;
 		} catch (std::exception &e) {
-			LOG_F(WARNING, "Unexpected error during push_sample: %s", e.what());
+			LSL_LOG_F(WARNING, "Unexpected error during push_sample: %s", e.what());
 			return lsl_internal_error;
 		}
 	}
@@ -168,6 +172,18 @@ public:
 	 */
 	void push_numeric_raw(const void *data, double timestamp = 0.0, bool pushthrough = true);
 
+	/**
+	 * Allocate (and count) a sample without publishing it yet, e.g. to publish several samples at
+	 * once with publish().
+	 * @param data The raw numeric channel values or, for string streams, an array of C strings.
+	 * @param timestamp The capture time of the sample (must not be 0).
+	 * @param pushthrough Whether the sample is pushed through to the receivers.
+	 */
+	sample_p make_sample(const void *data, double timestamp, bool pushthrough);
+
+	/// Publish samples created with make_sample(), waking up each session only once.
+	void publish(const sample_p *samples, std::size_t n);
+
 	//
 	// === Pushing an chunk of samples into the outlet ===
 	//
@@ -213,13 +229,13 @@ public:
 				data_buffer, timestamp_buffer, data_buffer_elements, pushthrough);
 			return lsl_no_error;
 		} catch (std::range_error &e) {
-			LOG_F(WARNING, "Error during push_chunk: %s", e.what());
+			LSL_LOG_F(WARNING, "Error during push_chunk: %s", e.what());
 			return lsl_argument_error;
 		} catch (std::invalid_argument &e) {
-			LOG_F(WARNING, "Error during push_chunk: %s", e.what());
+			LSL_LOG_F(WARNING, "Error during push_chunk: %s", e.what());
 			return lsl_argument_error;
 		} catch (std::exception &e) {
-			LOG_F(WARNING, "Unexpected error during push_chunk: %s", e.what());
+			LSL_LOG_F(WARNING, "Unexpected error during push_chunk: %s", e.what());
 			return lsl_internal_error;
 		}
 	}
@@ -268,17 +284,35 @@ public:
 			push_chunk_multiplexed(data, data_elements, timestamp, pushthrough);
 			return lsl_no_error;
 		} catch (std::range_error &e) {
-			LOG_F(WARNING, "Error during push_chunk: %s", e.what());
+			LSL_LOG_F(WARNING, "Error during push_chunk: %s", e.what());
 			return lsl_argument_error;
 		} catch (std::invalid_argument &e) {
-			LOG_F(WARNING, "Error during push_chunk: %s", e.what());
+			LSL_LOG_F(WARNING, "Error during push_chunk: %s", e.what());
 			return lsl_argument_error;
 		} catch (std::exception &e) {
-			LOG_F(WARNING, "Unexpected error during push_chunk: %s", e.what());
+			LSL_LOG_F(WARNING, "Unexpected error during push_chunk: %s", e.what());
 			return lsl_internal_error;
 		}
 	}
 
+	/**
+	 * Push a chunk of samples whose channels are spread over an application buffer, e.g. device
+	 * records with status words or padding between the channel values.
+	 *
+	 * The values are gathered and converted directly into the samples without a packed staging
+	 * copy.
+	 * @param data The start of the first sample in the buffer.
+	 * @param num_samples The number of samples to push.
+	 * @param sample_stride The distance between the starts of two samples in bytes.
+	 * @param layout The position of the channel values (of type T) relative to a sample's start.
+	 * @param timestamp Optionally the capture time of the most recent sample; the time stamps of
+	 * the others are derived from the sampling rate as in push_chunk_multiplexed().
+	 * @param pushthrough Whether to push the chunk through to the receivers.
+	 */
+	template <class T>
+	void push_chunk_strided(const void *data, std::size_t num_samples, std::ptrdiff_t sample_stride,
+		const channel_layout &layout, double timestamp = 0.0, bool pushthrough = true);
+
 	// === Misc Features ===
 
 	/**
@@ -294,6 +328,15 @@ public:
 	/// Wait until some consumer shows up.
 	bool wait_for_consumers(double timeout = FOREVER);
 
+	/**
+	 * Add an in-process consumer (e.g., a recorder) that gets all samples pushed from now on.
+	 * @param max_buffered The maximum number of samples to queue for it (0: the outlet's buffer).
+	 */
+	std::shared_ptr<consumer_queue> new_consumer(int max_buffered = 0);
+
+	/// Retrieve the current runtime statistics.
+	lsl_outlet_stats get_stats() const;
+
 private:
 	/// Instantiate a new server stack.
 	void instantiate_stack(udp udp_protocol);
@@ -319,6 +362,10 @@ private:
 	stream_info_impl_p info_;
 	/// the single-producer, multiple-receiver send buffer
 	send_buffer_p send_buffer_;
+	/// runtime statistics, shared with the TCP server and its sessions
+	outlet_counters_p counters_;
+	/// resolves the deduced timestamps of pushed samples for the trace stages
+	trace::timestamp_resolver trace_timestamps_;
 	/// the IO service objects
 	io_context_p io_ctx_data_, io_ctx_service_;
 
@@ -331,6 +378,8 @@ private:
 	std::vector<udp_server_p> responders_;
 	/// threads that handle the I/O operations (two per stack: one for UDP and one for TCP)
 	std::vector<thread_p> io_threads_;
+	/// the process-wide time beacon, kept alive while this outlet exists (if enabled)
+	std::shared_ptr<class time_beacon> time_beacon_;
 };
 
 } // namespace lsl
@@ -1,25 +1,34 @@
 #include "tcp_server.h"
 #include "api_config.h"
 #include "consumer_queue.h"
+#include "logging.h"
 #include "sample.h"
+#include "sample_codec.h"
+#include "sample_filter.h"
 #include "send_buffer.h"
 #include "socket_utils.h"
 #include "stream_info_impl.h"
+#include "trace.h"
 #include "util/cast.hpp"
 #include "util/endian.hpp"
+#include "util/handler_memory.hpp"
 #include "util/strfuns.hpp"
+#include <algorithm>
 #include <asio/io_context.hpp>
 #include <asio/ip/host_name.hpp>
 #include <asio/ip/tcp.hpp>
 #include <asio/read_until.hpp>
 #include <asio/streambuf.hpp>
 #include <asio/write.hpp>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
+#include <cstdlib>
 #include <exception>
+#include <functional>
 #include <istream>
-#include <loguru.hpp>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <utility>
 #include <vector>
@@ -38,6 +47,71 @@
 using std::size_t;
 
 namespace lsl {
+namespace {
+/**
+ * A fixed set of worker threads that run the parts of a job together with the calling thread.
+ *
+ * Used by a session to serialize large chunks on multiple cores.
+ */
+class encode_pool {
+public:
+	explicit encode_pool(int threads) {
+		for (int i = 0; i < threads; ++i) workers_.emplace_back([this]() { work(); });
+	}
+
+	~encode_pool() {
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			stop_ = true;
+		}
+		job_cond_.notify_all();
+		for (auto &worker : workers_) worker.join();
+	}
+
+	/// Number of parts a job should be split into so that every thread gets one
+	std::size_t concurrency() const { return workers_.size() + 1; }
+
+	/// Call fn(part) for each part in [0, parts) and return after all calls have finished
+	void run(std::size_t parts, const std::function<void(std::size_t)> &fn) {
+		std::unique_lock<std::mutex> lock(mut_);
+		fn_ = &fn;
+		next_ = done_ = 0;
+		parts_ = parts;
+		job_cond_.notify_all();
+		while (next_ < parts_) run_part(lock);
+		done_cond_.wait(lock, [this]() { return done_ == parts_; });
+		parts_ = 0;
+	}
+
+private:
+	void work() {
+		std::unique_lock<std::mutex> lock(mut_);
+		while (true) {
+			job_cond_.wait(lock, [this]() { return stop_ || next_ < parts_; });
+			if (stop_) return;
+			run_part(lock);
+		}
+	}
+
+	/// Run the next part of the current job, the lock is released meanwhile
+	void run_part(std::unique_lock<std::mutex> &lock) {
+		const std::size_t part = next_++;
+		const auto &fn = *fn_;
+		lock.unlock();
+		fn(part);
+		lock.lock();
+		if (++done_ == parts_) done_cond_.notify_all();
+	}
+
+	std::vector<std::thread> workers_;
+	std::mutex mut_;
+	std::condition_variable job_cond_, done_cond_;
+	const std::function<void(std::size_t)> *fn_{nullptr};
+	std::size_t parts_{0}, next_{0}, done_{0};
+	bool stop_{false};
+};
+} // namespace
+
 /**
  * Active session with a TCP client.
  *
@@ -65,7 +139,9 @@ class client_session : public std::enable_shared_from_this<client_session> {
 public:
 	/// Instantiate a new session & its socket.
 	client_session(const tcp_server_p &serv, tcp_socket &&sock)
-		: io_(serv->io_), serv_(serv), sock_(std::move(sock)), requeststream_(&requestbuf_) {}
+		: io_(serv->io_), serv_(serv), counters_(serv->counters_), sock_(std::move(sock)),
+		  requeststream_(&requestbuf_), read_memory_(std::make_shared<handler_memory>()),
+		  write_memory_(std::make_shared<handler_memory>()) {}
 
 	/// Destructor.
 	~client_session();
@@ -101,11 +177,19 @@ private:
 	/// Handler that gets called when a sample transfer has been completed.
 	void handle_chunk_transfer_outcome(err_t err, std::size_t len);
 
+	/// Serialize a chunk of numeric samples into the feed buffer, split across the pool's threads
+	void encode_chunk(encode_pool &pool, const std::vector<sample_p> &chunk);
+
+	/// Apply the buffer lengths the inlet requested since the last call (transfer thread only)
+	void read_buffer_updates(std::shared_ptr<consumer_queue> &queue);
+
 	/// shared pointer to IO service; ensures that the IO is still around by the time the serv_ and
 	/// sock_ need to be destroyed
 	io_context_p io_;
 	/// the server that is associated with this connection
 	std::weak_ptr<tcp_server> serv_;
+	/// the outlet's statistics counters
+	outlet_counters_p counters_;
 	/// connection socket
 	tcp_socket sock_;
 
@@ -118,16 +202,30 @@ private:
 	std::unique_ptr<class eos::portable_oarchive> outarch_;
 	/// this is a stream on top of the request buffer for convenient parsing
 	std::istream requeststream_;
+	/// memory for the handlers of the (sequential) read and write operations
+	std::shared_ptr<handler_memory> read_memory_, write_memory_;
+	/// the status message that is being sent
+	std::string status_msg_;
 	/// scratchpad memory (e.g., for endianness conversion)
 	char *scratch_{nullptr};
+	/// the sample encoders for the negotiated byte order (protocol 1.10 numeric streams only)
+	const sample_codec *codec_{nullptr};
 	/// protocol version to use for transmission
 	int data_protocol_version_{100};
 	/// is the client's endianness reversed (big<->little endian)
 	bool reverse_byte_order_{false};
+	/// whether samples are sent as the channels that changed since the previous sample
+	bool change_masks_{false};
 	/// our chunk granularity
 	int chunk_granularity_{0};
 	/// maximum number of samples buffered
 	int max_buffered_{0};
+	/// whether the inlet sends updated buffer lengths during the transmission
+	bool buffer_renegotiation_{false};
+	/// incomplete buffer length updates received from the inlet
+	std::string buffer_updates_;
+	/// the inlet's sample filter, if any; samples that don't match aren't sent
+	std::unique_ptr<sample_filter> filter_;
 
 	// data exchanged between the transfer completion handler and the transfer thread
 	/// whether the current transfer has finished (possibly with an error)
@@ -143,23 +241,26 @@ private:
 };
 
 tcp_server::tcp_server(stream_info_impl_p info, io_context_p io, send_buffer_p sendbuf,
-	factory_p factory, int chunk_size, bool allow_v4, bool allow_v6)
+	factory_p factory, int chunk_size, bool allow_v4, bool allow_v6, outlet_counters_p counters)
 	: chunk_size_(chunk_size), info_(std::move(info)), io_(std::move(io)),
-	  factory_(std::move(factory)), send_buffer_(std::move(sendbuf)) {
+	  factory_(std::move(factory)), send_buffer_(std::move(sendbuf)),
+	  counters_(std::move(counters)) {
 	// assign connection-dependent fields
 	info_->session_id(api_config::get_instance()->session_id());
 	info_->reset_uid();
 	info_->created_at(lsl_clock());
 	info_->hostname(asio::ip::host_name());
+	info_->boot_id(boot_id());
 
 	if (allow_v4) {
 		try {
 			acceptor_v4_ = std::make_unique<tcp_acceptor>(*io_, asio::ip::tcp::v4());
 			auto port = bind_and_listen_to_port_in_range(*acceptor_v4_, asio::ip::tcp::v4(), 10);
 			info_->v4data_port(port);
-			LOG_F(1, "Created IPv%d TCP acceptor for %s @ port %d", 4, info_->name().c_str(), port);
+			LSL_LOG_F(
+				1, "Created IPv%d TCP acceptor for %s @ port %d", 4, info_->name().c_str(), port);
 		} catch (std::exception &e) {
-			LOG_F(WARNING, "Failed to create IPv%d acceptor: %s", 4, e.what());
+			LSL_LOG_F(WARNING, "Failed to create IPv%d acceptor: %s", 4, e.what());
 			acceptor_v4_.reset();
 		}
 	}
@@ -168,9 +269,10 @@ tcp_server::tcp_server(stream_info_impl_p info, io_context_p io, send_buffer_p s
 			acceptor_v6_ = std::make_unique<tcp_acceptor>(*io_, asio::ip::tcp::v6());
 			auto port = bind_and_listen_to_port_in_range(*acceptor_v6_, asio::ip::tcp::v6(), 10);
 			info_->v6data_port(port);
-			LOG_F(1, "Created IPv%d TCP acceptor for %s @ port %d", 6, info_->name().c_str(), port);
+			LSL_LOG_F(
+				1, "Created IPv%d TCP acceptor for %s @ port %d", 6, info_->name().c_str(), port);
 		} catch (std::exception &e) {
-			LOG_F(WARNING, "Failed to create IPv%d acceptor: %s", 6, e.what());
+			LSL_LOG_F(WARNING, "Failed to create IPv%d acceptor: %s", 6, e.what());
 			acceptor_v6_.reset();
 		}
 	}
@@ -221,13 +323,13 @@ void tcp_server::accept_next_connection(tcp_acceptor_p &acceptor) {
 			if (!err)
 				std::make_shared<client_session>(shared_this, std::move(sock))->begin_processing();
 			else
-				LOG_F(WARNING, "Unhandled accept error: %s", err.message().c_str());
+				LSL_LOG_F(WARNING, "Unhandled accept error: %s", err.message().c_str());
 
 			// and move on to the next connection
 			shared_this->accept_next_connection(acceptor);
 		});
 	} catch (std::exception &e) {
-		LOG_F(ERROR, "Error during tcp_server::accept_next_connection: %s", e.what());
+		LSL_LOG_F(ERROR, "Error during tcp_server::accept_next_connection: %s", e.what());
 	}
 }
 
@@ -257,7 +359,8 @@ void tcp_server::close_inflight_sessions() {
 			if (sock.is_open()) {
 				sock.shutdown(tcp_socket::shutdown_both, ec);
 				sock.close(ec);
-				if (ec) LOG_F(WARNING, "Error during shutdown_and_close: %s", ec.message().c_str());
+				if (ec)
+					LSL_LOG_F(WARNING, "Error during shutdown_and_close: %s", ec.message().c_str());
 			}
 		});
 	}
@@ -267,7 +370,7 @@ void tcp_server::close_inflight_sessions() {
 // === implementation of the client_session class ===
 
 client_session::~client_session() {
-	LOG_F(1, "Destructing session %p", this);
+	LSL_LOG_F(1, "Destructing session %p", this);
 	delete[] scratch_;
 	if (auto serv = serv_.lock()) serv->unregister_inflight_session(this);
 }
@@ -287,14 +390,15 @@ void client_session::begin_processing() {
 			serv->register_inflight_session(shared_from_this());
 			// read the request line
 			async_read_until(sock_, requestbuf_, "\r\n",
-				[shared_this = shared_from_this()](err_t err, std::size_t /*unused*/) {
-					shared_this->handle_read_command_outcome(err);
-				});
+				recycle_memory(*read_memory_,
+					[shared_this = shared_from_this()](err_t err, std::size_t /*unused*/) {
+						shared_this->handle_read_command_outcome(err);
+					}));
 		} else {
 			throw std::runtime_error("server disappeared before start client session");
 		}
 	} catch (std::exception &e) {
-		LOG_F(ERROR, "Error during client_session::begin_processing: %s", e.what());
+		LSL_LOG_F(ERROR, "Error during client_session::begin_processing: %s", e.what());
 	}
 }
 
@@ -308,35 +412,40 @@ void client_session::handle_read_command_outcome(err_t read_err) {
 		if (method == "LSL:shortinfo")
 			// shortinfo request: read the content query string
 			async_read_until(sock_, requestbuf_, "\r\n",
-				[shared_this = shared_from_this()](err_t err, std::size_t /*unused*/) {
-					shared_this->handle_read_query_outcome(err);
-				});
+				recycle_memory(*read_memory_,
+					[shared_this = shared_from_this()](err_t err, std::size_t /*unused*/) {
+						shared_this->handle_read_query_outcome(err);
+					}));
 		else if (method == "LSL:fullinfo") {
 			// fullinfo request: reply right away
 			auto serv = serv_.lock();
 			if (serv)
 				async_write(sock_, asio::buffer(serv->fullinfo_msg_),
-					[shared_this = shared_from_this(), serv](
-						err_t /*unused*/, std::size_t /*unused*/) {});
+					recycle_memory(*write_memory_,
+						[shared_this = shared_from_this(), serv](
+							err_t /*unused*/, std::size_t /*unused*/) {}));
 		} else if (method == "LSL:streamfeed")
 			// streamfeed request (1.00): read feed parameters
 			async_read_until(sock_, requestbuf_, "\r\n",
-				[shared_this = shared_from_this()](err_t err, std::size_t /*unused*/) {
-					shared_this->handle_read_feedparams(100, "", err);
-				});
+				recycle_memory(*read_memory_,
+					[shared_this = shared_from_this()](err_t err, std::size_t /*unused*/) {
+						shared_this->handle_read_feedparams(100, "", err);
+					}));
 		else if (method.compare(0, 15, "LSL:streamfeed/") == 0) {
 			// streamfeed request with version: read feed parameters
 			std::vector<std::string> parts = splitandtrim(method, ' ', true);
 			async_read_until(sock_, requestbuf_, "\r\n\r\n",
-				[shared_this = shared_from_this(),
-					request_protocol_version = std::stoi(parts[0].substr(15)),
-					request_uid = (parts.size() > 1) ? parts[1] : ""](
-					err_t err, std::size_t /*unused*/) {
-					shared_this->handle_read_feedparams(request_protocol_version, request_uid, err);
-				});
+				recycle_memory(*read_memory_,
+					[shared_this = shared_from_this(),
+						request_protocol_version = std::stoi(parts[0].substr(15)),
+						request_uid = (parts.size() > 1) ? parts[1] : ""](
+						err_t err, std::size_t /*unused*/) {
+						shared_this->handle_read_feedparams(
+							request_protocol_version, request_uid, err);
+					}));
 		}
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error while parsing a client command: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected error while parsing a client command: %s", e.what());
 	}
 }
 
@@ -352,29 +461,32 @@ void client_session::handle_read_query_outcome(err_t err) {
 		if (serv->info_->matches_query(query)) {
 			// matches: reply (otherwise just close the stream)
 			async_write(sock_, asio::buffer(serv->shortinfo_msg_),
-				[serv](err_t /*unused*/, std::size_t /*unused*/) {
+				recycle_memory(*write_memory_, [serv](err_t /*unused*/, std::size_t /*unused*/) {
 					/* keep the tcp_server alive until the shortinfo is sent completely*/
-				});
+				}));
 		} else {
-			DLOG_F(INFO, "%p got a shortinfo query response for the wrong query", this);
+			LSL_DLOG_F(INFO, "%p got a shortinfo query response for the wrong query", this);
 		}
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error while parsing a client request: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected error while parsing a client request: %s", e.what());
 	}
 }
 
 void client_session::send_status_message(const std::string &msg) {
-	auto buf(std::make_shared<std::string>(msg));
-	async_write(sock_, asio::buffer(*buf),
-		[buf, shared_this = shared_from_this()](err_t /*unused*/,
-			std::size_t /*unused*/) { /* keep objects alive until the message is sent */ });
+	// only one status message is sent per session
+	status_msg_ = msg;
+	async_write(sock_, asio::buffer(status_msg_),
+		recycle_memory(*write_memory_,
+			[shared_this = shared_from_this()](err_t /*unused*/, std::size_t /*unused*/) {
+				/* keep the session (and its message) alive until the message is sent */
+			}));
 }
 
 void client_session::handle_read_feedparams(
 	int request_protocol_version, const std::string &request_uid, err_t err) {
 	try {
 		if (err) return;
-		DLOG_F(2, "%p got a streamfeed request", this);
+		LSL_DLOG_F(2, "%p got a streamfeed request", this);
 		// --- protocol negotiation ---
 
 		// check request validity
@@ -382,7 +494,7 @@ void client_session::handle_read_feedparams(
 		if (request_protocol_version / 100 > cfg_proto_version / 100) {
 			send_status_message(
 				"LSL/" + std::to_string(cfg_proto_version) + " 505 Version not supported");
-			DLOG_F(WARNING, "%p Got a request for a too new protocol version", this);
+			LSL_DLOG_F(WARNING, "%p Got a request for a too new protocol version", this);
 			return;
 		}
 		auto serv = serv_.lock();
@@ -405,6 +517,9 @@ void client_session::handle_read_feedparams(
 			int client_value_size = info->channel_bytes(); // assume that the client has a standard
 														   // size for the relevant data type
 			lsl_channel_format_t format = info->channel_format();
+			std::string filter_expression; // the inlet's sample filter (none if empty)
+			bool client_change_masks = false; // whether the client can decode change masks
+			bool client_renegotiation = false; // whether the client sends buffer length updates
 
 			// read feed parameters
 			char buf[16384] = {0};
@@ -412,6 +527,13 @@ void client_session::handle_read_feedparams(
 				std::string hdrline(buf);
 				std::size_t colon = hdrline.find_first_of(':');
 				if (colon != std::string::npos) {
+					// the filter expression is case-sensitive and may contain semicolons
+					std::string key = trim(hdrline.substr(0, colon));
+					for (auto &c : key) c = ::tolower(c);
+					if (key == "sample-filter") {
+						filter_expression = trim(hdrline.substr(colon + 1));
+						continue;
+					}
 					// strip off comments
 					auto semicolon = hdrline.find_first_of(';');
 					if (semicolon != std::string::npos) hdrline.erase(semicolon);
@@ -432,12 +554,23 @@ void client_session::handle_read_feedparams(
 					if (type == "max-buffer-length") max_buffered_ = std::stoi(rest);
 					if (type == "max-chunk-length") chunk_granularity_ = std::stoi(rest);
 					if (type == "protocol-version") client_protocol_version = std::stoi(rest);
+					if (type == "change-mask") client_change_masks = from_string<bool>(rest);
+					if (type == "buffer-renegotiation")
+						client_renegotiation = from_string<bool>(rest);
 				} else {
-					DLOG_F(WARNING, "%p Request line '%s' contained no key-value pair", this,
+					LSL_DLOG_F(WARNING, "%p Request line '%s' contained no key-value pair", this,
 						hdrline.c_str());
 				}
 			}
 
+			if (!filter_expression.empty()) try {
+					filter_ = std::make_unique<sample_filter>(
+						filter_expression, format, info->channel_count());
+				} catch (std::invalid_argument &e) {
+					send_status_message("LSL/" + to_string(cfg_proto_version) + " 400 " + e.what());
+					return;
+				}
+
 			// determine the parameters for data transmission
 			bool client_suppress_subnormals = false;
 
@@ -472,6 +605,13 @@ void client_session::handle_read_feedparams(
 				// determine if subnormal suppression needs to be enabled
 				client_suppress_subnormals =
 					(format_subnormal[format] && !client_supports_subnormals);
+
+				// send only the changed channels of numeric samples unless encode threads
+				// serialize whole chunks
+				const api_config *cfg = api_config::get_instance();
+				change_masks_ = client_change_masks && format != cft_string &&
+								cfg->change_mask_encoding() && cfg->session_encode_threads() <= 0;
+				buffer_renegotiation_ = client_renegotiation;
 			}
 
 			// send the response
@@ -481,6 +621,9 @@ void client_session::handle_read_feedparams(
 			response_stream << "Byte-Order: " << use_byte_order << "\r\n";
 			response_stream << "Suppress-Subnormals: " << client_suppress_subnormals << "\r\n";
 			response_stream << "Data-Protocol-Version: " << data_protocol_version_ << "\r\n";
+			if (filter_) response_stream << "Sample-Filter: 1\r\n";
+			if (change_masks_) response_stream << "Change-Mask: 1\r\n";
+			if (buffer_renegotiation_) response_stream << "Buffer-Renegotiation: 1\r\n";
 			response_stream << "\r\n" << std::flush;
 		} else {
 			// read feed parameters
@@ -488,6 +631,12 @@ void client_session::handle_read_feedparams(
 		}
 
 		// --- validation ---
+		// the portable archive format of protocol 1.00 has no representation for record samples
+		if (data_protocol_version_ < 110 && info->channel_format() == cft_record) {
+			send_status_message("LSL/" + to_string(cfg_proto_version) +
+								" 400 Record streams require protocol version 1.10");
+			return;
+		}
 		if (data_protocol_version_ == 100) {
 			// create a portable output archive to write to
 			outarch_ = std::make_unique<eos::portable_oarchive>(feedbuf_);
@@ -495,11 +644,14 @@ void client_session::handle_read_feedparams(
 			*outarch_ << serv->shortinfo_msg_;
 		} else {
 			// allocate scratchpad memory for endian conversion, etc.
-			scratch_ = new char[format_sizes[info->channel_format()] * info->channel_count()];
+			scratch_ = new char[info->sample_bytes()];
+			codec_ = select_codec(
+				info->channel_format(), info->channel_count(), reverse_byte_order_, false);
 		}
 
 		// send test pattern samples
-		lsl::factory fac(info->channel_format(), info->channel_count(), 4);
+		lsl::factory fac(
+			info->channel_format(), info->channel_count(), 4, info->record_layout());
 
 		for (int test_pattern : {4, 2}) {
 			lsl::sample_p temp(fac.new_sample(0.0, false));
@@ -512,13 +664,14 @@ void client_session::handle_read_feedparams(
 		}
 
 		// send off the newly created feedheader
-		async_write(
-			sock_, feedbuf_.data(), [shared_this = shared_from_this()](err_t err, std::size_t len) {
-				shared_this->handle_send_feedheader_outcome(err, len);
-			});
-		DLOG_F(2, "%p sent test pattern samples", this);
+		async_write(sock_, feedbuf_.data(),
+			recycle_memory(*write_memory_,
+				[shared_this = shared_from_this()](err_t err, std::size_t len) {
+					shared_this->handle_send_feedheader_outcome(err, len);
+				}));
+		LSL_DLOG_F(2, "%p sent test pattern samples", this);
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error while serializing the feed header: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected error while serializing the feed header: %s", e.what());
 	}
 }
 
@@ -550,36 +703,117 @@ void client_session::handle_send_feedheader_outcome(err_t err, std::size_t n) {
 			std::move(queue), max_samples_per_chunk)
 			.detach();
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Unexpected error while handling the feedheader send outcome: %s", e.what());
+		LSL_LOG_F(WARNING, "Unexpected error while handling the feedheader send outcome: %s",
+			e.what());
 	}
 }
 
 void client_session::transfer_samples_thread(std::shared_ptr<client_session> /* keepalive */,
 	std::shared_ptr<consumer_queue> &&queue, int max_samples_per_chunk) {
 	int samples_in_current_chunk = 0;
+	// with a sample filter, the inlet can't deduce the time stamp of a sample after a dropped one,
+	// so such samples are sent as copies with the time stamp the inlet would have deduced
+	std::unique_ptr<factory> filter_factory;
+	bool dropped_previous = false;
+	double srate = IRREGULAR_RATE;
+	{
+		auto serv = serv_.lock();
+		if (!serv) return;
+		srate = serv->info_->nominal_srate();
+		if (filter_)
+			filter_factory = std::make_unique<factory>(serv->info_->channel_format(),
+				serv->info_->channel_count(), 16, serv->info_->record_layout());
+	}
+	// the time stamps the inlet will deduce, for the sample filter and the trace stages
+	trace::timestamp_resolver timestamps(srate);
+	auto filter_sample = [&](sample_p &samp, double timestamp) {
+		if (!filter_->matches(*samp)) {
+			dropped_previous = true;
+			return false;
+		}
+		if (dropped_previous && samp->timestamp() == DEDUCED_TIMESTAMP) {
+			sample_p copy(filter_factory->new_sample(timestamp, samp->pushthrough));
+			copy->assign_channels(*samp);
+			samp = copy;
+		}
+		dropped_previous = false;
+		return true;
+	};
+	// numeric chunks can be serialized by multiple threads once they're complete
+	std::unique_ptr<encode_pool> pool;
+	std::vector<sample_p> chunk;
+	// with change masks, samples are encoded relative to the previously sent one
+	sample_p previous;
+	// after a sample where too many channels changed, the next ones are sent completely without
+	// comparing them, so streams where all channels change don't pay for the comparisons
+	const int change_mask_retry = 16;
+	int full_samples = 0;
+	if (const int threads = api_config::get_instance()->session_encode_threads()) {
+		auto serv = serv_.lock();
+		if (serv && threads > 0 && !change_masks_ && data_protocol_version_ >= 110 &&
+			serv->info_->channel_format() != cft_string && serv->info_->channel_count() > 0)
+			pool = std::make_unique<encode_pool>(threads);
+	}
 	while (!serv_.expired()) {
 		try {
 			// get next sample from the sample queue (blocking)
+			const int64_t wait_start = trace::start();
 			sample_p samp(queue->pop_sample());
 
 			// ignore blank samples (they are basically wakeup notifiers from someone's
 			// end_serving())
 			if (!samp) continue;
+			const double timestamp = timestamps(samp->timestamp());
+			trace::span("queue_wait", wait_start, timestamp);
+			const bool keep = !filter_ || filter_sample(samp, timestamp);
+			// a dropped sample that's pushed through still sends off the samples before it
+			if (!keep && (!samp->pushthrough || samples_in_current_chunk == 0)) continue;
+			if (keep) ++samples_in_current_chunk;
+			const bool chunk_complete =
+				samples_in_current_chunk >= max_samples_per_chunk || samp->pushthrough;
 			// serialize the sample into the stream
-			if (data_protocol_version_ >= 110)
-				samp->save_streambuf(
-					feedbuf_, data_protocol_version_, reverse_byte_order_, scratch_);
-			else
-				*outarch_ << *samp;
+			const int64_t serialize_start = trace::start();
+			if (pool) {
+				if (keep) chunk.push_back(samp);
+				if (chunk_complete) {
+					encode_chunk(*pool, chunk);
+					chunk.clear();
+					trace::span(
+						"serialize", serialize_start, timestamp, samples_in_current_chunk);
+				}
+			} else if (keep) {
+				if (change_masks_) {
+					const sample *reference = full_samples > 0 ? nullptr : previous.get();
+					if (codec_ ? samp->save_changes(feedbuf_, reference, *codec_, scratch_)
+							   : samp->save_changes(
+									 feedbuf_, reference, reverse_byte_order_, scratch_))
+						full_samples = 0;
+					else if (reference)
+						full_samples = change_mask_retry;
+					else if (full_samples > 0)
+						--full_samples;
+					previous = samp;
+				} else if (codec_)
+					samp->save_streambuf(feedbuf_, *codec_, scratch_);
+				else if (data_protocol_version_ >= 110)
+					samp->save_streambuf(
+						feedbuf_, data_protocol_version_, reverse_byte_order_, scratch_);
+				else
+					*outarch_ << *samp;
+				trace::span("serialize", serialize_start, timestamp);
+			}
 			// if the sample is marked as force-push or the configured chunk size is reached
-			if (samp->pushthrough || ++samples_in_current_chunk >= max_samples_per_chunk) {
+			if (chunk_complete) {
 				// send off the chunk that we aggregated so far
 				std::unique_lock<std::mutex> lock(completion_mut_);
 				transfer_completed_ = false;
+				const auto write_start = std::chrono::steady_clock::now();
+				const int64_t trace_write_start = trace::start();
 				async_write(sock_, feedbuf_.data(),
-					[shared_this = shared_from_this()](err_t err, std::size_t len) {
-						shared_this->handle_chunk_transfer_outcome(err, len);
-					});
+					recycle_memory(*write_memory_,
+						[shared_this = shared_from_this()](err_t err, std::size_t len) {
+							shared_this->handle_chunk_transfer_outcome(err, len);
+						}));
 				// wait for the completion condition
 				completion_cond_.wait(lock, [this]() { return transfer_completed_; });
 				// handle transfer outcome
@@ -587,12 +821,91 @@ void client_session::transfer_samples_thread(std::shared_ptr<client_session> /*
 					feedbuf_.consume(transfer_amount_);
 				} else
 					break;
+				const uint64_t latency_ns =
+					std::chrono::nanoseconds(std::chrono::steady_clock::now() - write_start).count();
+				trace::span(
+					"socket_write", trace_write_start, timestamp, samples_in_current_chunk);
+				counters_->samples_sent.fetch_add(
+					samples_in_current_chunk, std::memory_order_relaxed);
+				counters_->bytes_sent.fetch_add(transfer_amount_, std::memory_order_relaxed);
+				counters_->chunks_written.fetch_add(1, std::memory_order_relaxed);
+				counters_->write_latency_ns.fetch_add(latency_ns, std::memory_order_relaxed);
+				atomic_fetch_max(counters_->max_write_latency_ns, latency_ns);
 				samples_in_current_chunk = 0;
+				if (buffer_renegotiation_) read_buffer_updates(queue);
 			}
 		} catch (std::exception &e) {
-			LOG_F(WARNING, "Unexpected glitch in transfer_samples_thread: %s", e.what());
+			LSL_LOG_F(WARNING, "Unexpected glitch in transfer_samples_thread: %s", e.what());
+		}
+	}
+}
+
+void client_session::encode_chunk(encode_pool &pool, const std::vector<sample_p> &chunk) {
+	// each sample gets its own region of the output, so they can be filled in any order
+	std::vector<std::size_t> offsets;
+	offsets.reserve(chunk.size() + 1);
+	std::size_t total = 0;
+	for (const auto &samp : chunk) {
+		offsets.push_back(total);
+		total += samp->serialized_size();
+	}
+	char *out = static_cast<char *>(feedbuf_.prepare(total).data());
+
+	// split the chunk's channels (across all samples) evenly into one part per thread, or
+	// serialize small chunks right here
+	const std::size_t nchans = chunk.front()->num_channels(), values = chunk.size() * nchans;
+	const auto min_bytes = api_config::get_instance()->session_encode_min_bytes();
+	std::size_t parts = 1;
+	if (total >= static_cast<std::size_t>(min_bytes)) parts = std::min(pool.concurrency(), values);
+	auto encode_part = [&](std::size_t part) {
+		const std::size_t end = values * (part + 1) / parts;
+		for (std::size_t pos = values * part / parts; pos < end;) {
+			const std::size_t s = pos / nchans, first = pos % nchans,
+							  last = std::min(nchans, first + end - pos);
+			const auto from = static_cast<uint32_t>(first), to = static_cast<uint32_t>(last);
+			if (codec_)
+				chunk[s]->save_buffer(out + offsets[s], *codec_, from, to);
+			else
+				chunk[s]->save_buffer(out + offsets[s], reverse_byte_order_, from, to);
+			pos += last - first;
 		}
+	};
+	if (parts > 1)
+		pool.run(parts, encode_part);
+	else
+		encode_part(0);
+	feedbuf_.commit(total);
+}
+
+void client_session::read_buffer_updates(std::shared_ptr<consumer_queue> &queue) {
+	// the inlet doesn't send anything else after the handshake, so there's no pending read
+	asio::error_code ec;
+	const std::size_t available = sock_.available(ec);
+	if (ec || !available) return;
+	const std::size_t old_size = buffer_updates_.size();
+	buffer_updates_.resize(old_size + available);
+	const std::size_t len = sock_.read_some(asio::buffer(&buffer_updates_[old_size], available), ec);
+	buffer_updates_.resize(old_size + (ec ? 0 : len));
+
+	// each update is a line 'Max-Buffer-Length: [samples]'
+	std::size_t eol;
+	while ((eol = buffer_updates_.find('\n')) != std::string::npos) {
+		std::string line = buffer_updates_.substr(0, eol);
+		buffer_updates_.erase(0, eol + 1);
+		const std::size_t colon = line.find(':');
+		if (colon == std::string::npos) continue;
+		std::string key = trim(line.substr(0, colon));
+		for (auto &c : key) c = ::tolower(c);
+		if (key != "max-buffer-length") continue;
+		const int max_buffered = std::atoi(line.c_str() + colon + 1);
+		auto serv = serv_.lock();
+		if (max_buffered <= 0 || max_buffered == max_buffered_ || !serv) continue;
+		serv->send_buffer_->resize_consumer(queue, max_buffered);
+		max_buffered_ = max_buffered;
+		LSL_DLOG_F(2, "%p resized the session's buffer to %d samples", this, max_buffered);
 	}
+	// a well-behaved inlet never sends long lines
+	if (buffer_updates_.size() > 1024) buffer_updates_.clear();
 }
 
 void client_session::handle_chunk_transfer_outcome(err_t err, std::size_t len) {
@@ -607,7 +920,7 @@ void client_session::handle_chunk_transfer_outcome(err_t err, std::size_t len) {
 		// notify the server thread
 		completion_cond_.notify_all();
 	} catch (std::exception &e) {
-		LOG_F(WARNING,
+		LSL_LOG_F(WARNING,
 			"Catastrophic error in handling the chunk transfer outcome (in tcp_server): %s",
 			e.what());
 	}
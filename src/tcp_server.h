@@ -3,6 +3,7 @@
 
 #include "forward.h"
 #include "socket_utils.h"
+#include "stats.h"
 #include <atomic>
 #include <map>
 #include <memory>
@@ -47,9 +48,11 @@ public:
 	 * @param protocol The protocol (IPv4 or IPv6) that shall be serviced by this server.
 	 * @param chunk_size The preferred chunk size, in samples. If 0, the pushthrough flag determines
 	 * the effective chunking.
+	 * @param counters Statistics counters that the client sessions update.
 	 */
 	tcp_server(stream_info_impl_p info, io_context_p io, send_buffer_p sendbuf, factory_p factory,
-		int chunk_size, bool allow_v4, bool allow_v6);
+		int chunk_size, bool allow_v4, bool allow_v6,
+		outlet_counters_p counters = std::make_shared<outlet_counters>());
 
 	/**
 	 * Begin serving TCP connections.
@@ -91,6 +94,7 @@ private:
 						// the acceptor needs to be destroyed
 	factory_p factory_; // reference to the sample factory (which owns the samples)
 	send_buffer_p send_buffer_; // the send buffer, shared with other TCP's and the outlet
+	outlet_counters_p counters_; // statistics, shared with the outlet and the sessions
 
 	// acceptor socket
 	tcp_acceptor_p acceptor_v4_, acceptor_v6_; // our server socket
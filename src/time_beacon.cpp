@@ -0,0 +1,135 @@
+#include "time_beacon.h"
+#include "api_config.h"
+#include "logging.h"
+#include "util/strfuns.hpp"
+#include <asio/ip/address.hpp>
+#include <asio/ip/host_name.hpp>
+#include <asio/ip/multicast.hpp>
+#include <asio/post.hpp>
+#include <exception>
+#include <loguru.hpp>
+#include <mutex>
+#include <sstream>
+#include <utility>
+
+namespace ip = asio::ip;
+using ip::multicast::outbound_interface;
+
+namespace lsl {
+
+const char *const time_beacon::method = "LSL:timebeacon";
+
+time_beacon::time_beacon(double interval, clock_fn clock)
+	: interval_(interval), clock_(std::move(clock)), hostname_(ip::host_name()), v4_sock_(io_),
+	  v6_sock_(io_), timer_(io_) {
+	const api_config *cfg = api_config::get_instance();
+	for (auto *sock : {&v4_sock_, &v6_sock_}) {
+		const bool v4 = sock == &v4_sock_;
+		if (!(v4 ? cfg->allow_ipv4() : cfg->allow_ipv6())) continue;
+		try {
+			sock->open(v4 ? udp::v4() : udp::v6());
+			sock->set_option(ip::multicast::hops(cfg->multicast_ttl()));
+			if (v4) sock->set_option(asio::socket_base::broadcast(true));
+		} catch (std::exception &e) {
+			LSL_LOG_F(WARNING, "Cannot open UDP socket for time beacons: %s", e.what());
+			if (sock->is_open()) sock->close();
+		}
+	}
+	asio::post(io_, [this]() { send_beacon(); });
+	thread_ = std::thread([this]() {
+		loguru::set_thread_name("timebeacon");
+		while (true) {
+			try {
+				io_.run();
+				return;
+			} catch (std::exception &e) {
+				LSL_LOG_F(ERROR, "Error during time beacon processing: %s", e.what());
+			}
+		}
+	});
+}
+
+time_beacon::~time_beacon() {
+	io_.stop();
+	thread_.join();
+}
+
+std::shared_ptr<time_beacon> time_beacon::acquire() {
+	const double interval = api_config::get_instance()->time_beacon_interval();
+	if (interval <= 0) return nullptr;
+	static std::mutex mut;
+	static std::weak_ptr<time_beacon> instance;
+	std::lock_guard<std::mutex> lock(mut);
+	auto beacon = instance.lock();
+	if (!beacon) instance = beacon = std::make_shared<time_beacon>(interval);
+	return beacon;
+}
+
+std::string time_beacon::message(
+	const std::string &hostname, double timestamp, const std::string &session_id) {
+	std::ostringstream msg;
+	msg.precision(16);
+	msg << method << "\r\n" << hostname << ' ' << timestamp << "\r\n" << session_id << "\r\n";
+	return msg.str();
+}
+
+bool time_beacon::parse(const char *buf, std::size_t len, std::string &hostname, double &timestamp,
+	std::string &session_id) {
+	std::istringstream is(std::string(buf, len));
+	std::string msg_method;
+	getline(is, msg_method);
+	if (trim(msg_method) != method) return false;
+	is >> hostname >> timestamp >> std::ws;
+	// the session id may contain spaces, so it's on a line of its own
+	if (is.fail() || !getline(is, session_id)) return false;
+	session_id = trim(session_id);
+	return true;
+}
+
+void time_beacon::listen(udp_socket &sock, udp protocol) {
+	const api_config *cfg = api_config::get_instance();
+	sock.open(protocol);
+	sock.set_option(udp::socket::reuse_address(true));
+	sock.bind(udp::endpoint(protocol, cfg->time_beacon_port()));
+	for (const auto &addr : cfg->multicast_addresses()) {
+		if (!addr.is_multicast() || addr.is_v4() != (protocol == udp::v4())) continue;
+		for (const auto &if_ : cfg->multicast_interfaces) {
+			asio::error_code err;
+			if (addr.is_v4() && if_.addr.is_v4())
+				sock.set_option(ip::multicast::join_group(addr.to_v4(), if_.addr.to_v4()), err);
+			else if (addr.is_v6() && if_.addr.is_v6())
+				sock.set_option(
+					ip::multicast::join_group(addr.to_v6(), if_.addr.to_v6().scope_id()), err);
+			if (err)
+				LSL_DLOG_F(INFO, "Could not join %s on %s for time beacons (%s)",
+					addr.to_string().c_str(), if_.addr.to_string().c_str(), err.message().c_str());
+		}
+	}
+}
+
+void time_beacon::send_beacon() {
+	const api_config *cfg = api_config::get_instance();
+	const std::string msg = message(hostname_, clock_(), cfg->session_id());
+	asio::error_code ec;
+	for (const auto &addr : cfg->multicast_addresses()) {
+		udp_socket &sock = addr.is_v4() ? v4_sock_ : v6_sock_;
+		if (!sock.is_open()) continue;
+		const udp::endpoint ep(addr, cfg->time_beacon_port());
+		// unicast addresses would only reach a single listener per host
+		if (addr == ip::address_v4::broadcast()) sock.send_to(asio::buffer(msg), ep, 0, ec);
+		if (!addr.is_multicast()) continue;
+		for (const auto &if_ : cfg->multicast_interfaces) {
+			if (if_.addr.is_v4() != addr.is_v4()) continue;
+			sock.set_option(addr.is_v4() ? outbound_interface(if_.addr.to_v4())
+										 : outbound_interface(if_.ifindex),
+				ec);
+			if (!ec) sock.send_to(asio::buffer(msg), ep, 0, ec);
+		}
+	}
+	timer_.expires_after(timeout_sec(interval_));
+	timer_.async_wait([this](const asio::error_code &err) {
+		if (!err) send_beacon();
+	});
+}
+
+} // namespace lsl
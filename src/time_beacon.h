@@ -0,0 +1,87 @@
+#ifndef TIME_BEACON_H
+#define TIME_BEACON_H
+
+#include "common.h"
+#include "socket_utils.h"
+#include <asio/io_context.hpp>
+#include <asio/ip/udp.hpp>
+#include <asio/steady_timer.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+using asio::ip::udp;
+
+namespace lsl {
+
+/**
+ * Periodically multicasts the clock of this host so inlets can track their time offsets to it
+ * passively.
+ *
+ * A beacon is a single `LSL:timebeacon` datagram with the host name, the current lsl_clock() and
+ * the session id (see api_config::session_id()) that's sent to the configured multicast
+ * addresses (see api_config::multicast_addresses()) on the time beacon port
+ * (`ports.TimeBeaconPort`, see api_config::time_beacon_port()), so it reaches the inlets of all
+ * outlets on this host at once. Inlets only use the beacons of their outlet's host and session.
+ * Inlets calibrate the one-way delay of the beacons with occasional active `LSL:timedata`
+ * probes and use the beacons in between, so the probe traffic an outlet has to answer doesn't
+ * grow with the number of inlets.
+ *
+ * There's at most one beacon per process; outlets share it via acquire().
+ */
+class time_beacon {
+public:
+	/// A clock that returns the current time in seconds
+	using clock_fn = std::function<double()>;
+
+	/**
+	 * Start sending beacons in a background thread.
+	 * @param interval Time between two beacons, in seconds.
+	 * @param clock The clock to announce, replaceable to simulate a different host in tests.
+	 */
+	explicit time_beacon(double interval, clock_fn clock = lsl_clock);
+
+	/// Stop sending beacons.
+	~time_beacon();
+
+	/**
+	 * Get the process-wide beacon or start it if `tuning.TimeBeaconInterval` is set.
+	 *
+	 * Beacons are sent as long as at least one returned pointer is alive.
+	 * @return The beacon or nullptr if beacons are disabled.
+	 */
+	static std::shared_ptr<time_beacon> acquire();
+
+	/// The method name of beacon datagrams
+	static const char *const method;
+
+	/// Format a beacon datagram
+	static std::string message(
+		const std::string &hostname, double timestamp, const std::string &session_id);
+
+	/// Parse a beacon datagram, return false if it isn't a valid beacon
+	static bool parse(const char *buf, std::size_t len, std::string &hostname, double &timestamp,
+		std::string &session_id);
+
+	/// Open and bind a socket that receives the beacons of all hosts for the given protocol.
+	static void listen(udp_socket &sock, udp protocol);
+
+private:
+	/// Send a beacon and schedule the next one
+	void send_beacon();
+
+	const double interval_;
+	clock_fn clock_;
+	const std::string hostname_;
+	asio::io_context io_;
+	udp_socket v4_sock_, v6_sock_;
+	asio::basic_waitable_timer<asio::chrono::steady_clock,
+		asio::wait_traits<asio::chrono::steady_clock>, asio::io_context::executor_type>
+		timer_;
+	std::thread thread_;
+};
+
+} // namespace lsl
+
+#endif
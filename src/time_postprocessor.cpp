@@ -34,8 +34,10 @@ void time_postprocessor::set_options(uint32_t options)
 	// dejitter option changed? -> Reset it
 	// in case it got enabled, it'll be initialized with the correct t0 when
 	// the next sample comes in
-	if(changed & proc_dejitter)
+	if(changed & proc_dejitter) {
 		dejitter = postproc_dejitterer();
+		resume_dejitter_ = false;
+	}
 
 	if(changed & proc_monotonize)
 		last_value_ = std::numeric_limits<double>::lowest();
@@ -56,6 +58,19 @@ void time_postprocessor::skip_samples(uint32_t skipped_samples) {
 		dejitter.samples_since_t0_ += skipped_samples;
 }
 
+postproc_dejitterer time_postprocessor::get_state(double &offset) {
+	std::lock_guard<std::mutex> lock(processing_mut_);
+	offset = last_offset_;
+	return dejitter;
+}
+
+void time_postprocessor::set_state(const postproc_dejitterer &state, double offset) {
+	std::lock_guard<std::mutex> lock(processing_mut_);
+	dejitter = state;
+	resume_dejitter_ = dejitter.is_initialized();
+	last_offset_ = offset;
+}
+
 double time_postprocessor::process_internal(double value) {
 	// --- clock synchronization ---
 	if (options_ & proc_clocksync) {
@@ -72,6 +87,7 @@ double time_postprocessor::process_internal(double value) {
 				// reset the dejitterer to an uninitialized state so it's
 				// initialized on the next use
 				dejitter = postproc_dejitterer();
+				resume_dejitter_ = false;
 			}
 			next_query_time_ = lsl_clock() + 0.5;
 		}
@@ -87,6 +103,9 @@ double time_postprocessor::process_internal(double value) {
 		if (!dejitter.is_initialized()) {
 			double srate = query_srate_();
 			dejitter = postproc_dejitterer(value, srate, halftime_);
+		} else if (resume_dejitter_) {
+			dejitter.resume(value);
+			resume_dejitter_ = false;
 		}
 		value = dejitter.dejitter(value);
 	}
@@ -133,3 +152,11 @@ double postproc_dejitterer::dejitter(double t) noexcept {
 void postproc_dejitterer::skip_samples(uint_fast32_t skipped_samples) noexcept {
 	samples_since_t0_ += skipped_samples;
 }
+
+void postproc_dejitterer::resume(double t) noexcept {
+	if (!smoothing_applicable() || !(w1_ > 0)) return;
+	// the index of the sample that's expected closest to t
+	const double n = std::round((t - t0_ - w0_) / w1_);
+	if (n > samples_since_t0_ && n < std::numeric_limits<uint_fast32_t>::max())
+		samples_since_t0_ = static_cast<uint_fast32_t>(n);
+}
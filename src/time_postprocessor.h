@@ -33,6 +33,9 @@ struct postproc_dejitterer {
 
 	/// adjust RLS parameters to account for samples not seen
 	void skip_samples(uint_fast32_t skipped_samples) noexcept;
+
+	/// continue a saved state with the time stamp t, skipping the samples missed in between
+	void resume(double t) noexcept;
 	bool is_initialized() const noexcept { return t0_ != 0; }
 	bool smoothing_applicable() const noexcept { return lam_ > 0; }
 };
@@ -65,6 +68,17 @@ public:
 	/// Inform the post processor some samples were skipped
 	void skip_samples(uint32_t skipped_samples);
 
+	/// Get the dejitter state and the last applied clock offset, e.g. to save them.
+	postproc_dejitterer get_state(double &offset);
+
+	/**
+	 * Continue with a saved dejitter state and clock offset instead of starting from scratch.
+	 *
+	 * The next time stamp determines how many samples were missed since the state was saved.
+	 * Changing the dejitter option afterwards (see set_options()) discards the state again.
+	 */
+	void set_state(const postproc_dejitterer &state, double offset);
+
 private:
 	/// Internal function to process a time stamp.
 	double process_internal(double value);
@@ -91,6 +105,8 @@ private:
 	double last_offset_;
 
 	postproc_dejitterer dejitter;
+	/// whether the dejitter state was restored and has to skip the samples missed in between
+	bool resume_dejitter_{false};
 
 	// runtime parameters for monotonize
 	/// last observed time-stamp value, to force monotonically increasing stamps
@@ -1,8 +1,12 @@
 #include "time_receiver.h"
 #include "api_config.h"
 #include "inlet_connection.h"
+#include "logging.h"
 #include "socket_utils.h"
+#include "time_beacon.h"
+#include <algorithm>
 #include <asio/io_context.hpp>
+#include <asio/post.hpp>
 #include <chrono>
 #include <exception>
 #include <limits>
@@ -17,19 +21,30 @@ const double NOT_ASSIGNED = std::numeric_limits<double>::max();
 using namespace lsl;
 
 time_receiver::time_receiver(inlet_connection &conn)
-	: conn_(conn), was_reset_(false), timeoffset_(std::numeric_limits<double>::max()),
+	: time_receiver(conn, api_config::get_instance()->time_beacon_interval() > 0) {}
+
+time_receiver::time_receiver(inlet_connection &conn, bool listen_for_beacons)
+	: conn_(conn), listen_for_beacons_(listen_for_beacons), was_reset_(false),
+	  timeoffset_(std::numeric_limits<double>::max()),
 	  remote_time_(std::numeric_limits<double>::max()),
 	  uncertainty_(std::numeric_limits<double>::max()), cfg_(api_config::get_instance()),
 	  time_sock_(time_io_), outlet_addr_(conn_.get_udp_endpoint()), next_estimate_(time_io_),
-	  aggregate_results_(time_io_), next_packet_(time_io_) {
+	  aggregate_results_(time_io_), next_packet_(time_io_), beacon_sock_(time_io_),
+	  beacon_delay_(NOT_ASSIGNED) {
 	conn_.register_onlost(this, &timeoffset_upd_);
 	conn_.register_onrecover(this, [this]() {
 		reset_timeoffset_on_recovery();
 		outlet_addr_ = conn_.get_udp_endpoint();
-		DLOG_F(INFO, "Set new time service address: %s", outlet_addr_.address().to_string().c_str());
+		LSL_DLOG_F(
+			INFO, "Set new time service address: %s", outlet_addr_.address().to_string().c_str());
 		// handle outlet switching between IPv4 and IPv6
 		time_sock_.close();
 		time_sock_.open(outlet_addr_.protocol());
+		// the new host's beacons need to be calibrated first
+		asio::post(time_io_, [this]() {
+			beacons_.clear();
+			beacon_delay_ = NOT_ASSIGNED;
+		});
 	});
 	time_sock_.open(outlet_addr_.protocol());
 }
@@ -41,8 +56,8 @@ time_receiver::~time_receiver() {
 		time_io_.stop();
 		if (time_thread_.joinable()) time_thread_.join();
 	} catch (std::exception &e) {
-		LOG_F(ERROR, "Unexpected error during destruction of a time_receiver: %s", e.what());
-	} catch (...) { LOG_F(ERROR, "Severe error during time receiver shutdown."); }
+		LSL_LOG_F(ERROR, "Unexpected error during destruction of a time_receiver: %s", e.what());
+	} catch (...) { LSL_LOG_F(ERROR, "Severe error during time receiver shutdown."); }
 }
 
 
@@ -76,6 +91,32 @@ double time_receiver::time_correction(double *remote_time, double *uncertainty,
 	return timeoffset_;
 }
 
+bool time_receiver::last_time_correction(double &offset, double &uncertainty) {
+	double remote_time;
+	return last_time_correction(offset, remote_time, uncertainty);
+}
+
+bool time_receiver::last_time_correction(double &offset, double &remote_time, double &uncertainty) {
+	std::lock_guard<std::mutex> lock(timeoffset_mut_);
+	if (timeoffset_ == std::numeric_limits<double>::max()) return false;
+	offset = timeoffset_;
+	remote_time = remote_time_;
+	uncertainty = uncertainty_;
+	return true;
+}
+
+void time_receiver::import_time_correction(
+	double offset, double remote_time, double uncertainty) {
+	std::lock_guard<std::mutex> lock(timeoffset_mut_);
+	if (timeoffset_ != NOT_ASSIGNED) return;
+	timeoffset_ = offset;
+	remote_time_ = remote_time;
+	uncertainty_ = uncertainty;
+	// replace the saved estimate as soon as possible
+	if (!time_thread_.joinable()) time_thread_ = std::thread(&time_receiver::time_thread, this);
+	timeoffset_upd_.notify_all();
+}
+
 bool time_receiver::was_reset() {
 	std::unique_lock<std::mutex> lock(timeoffset_mut_);
 	bool result = was_reset_;
@@ -88,8 +129,9 @@ bool time_receiver::was_reset() {
 void time_receiver::time_thread() {
 	conn_.acquire_watchdog();
 	loguru::set_thread_name((std::string("T_") += conn_.type_info().name()).c_str());
-	DLOG_F(2, "Started time receiver thread");
+	LSL_DLOG_F(2, "Started time receiver thread");
 	try {
+		if (listen_for_beacons_) start_beacon_listener();
 		// start an async time estimation
 		start_time_estimation();
 		// start the IO object (will keep running until cancelled)
@@ -98,29 +140,46 @@ void time_receiver::time_thread() {
 				time_io_.run();
 				break;
 			} catch (std::exception &e) {
-				LOG_F(WARNING, "Hiccup during time_thread io_context processing: %s", e.what());
+				LSL_LOG_F(WARNING, "Hiccup during time_thread io_context processing: %s", e.what());
 			}
 		}
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "time_thread failed unexpectedly with message: %s", e.what());
+		LSL_LOG_F(WARNING, "time_thread failed unexpectedly with message: %s", e.what());
 	}
 	conn_.release_watchdog();
 }
 
 void time_receiver::start_time_estimation() {
-	// clear the estimates buffer
-	estimates_.clear();
-	estimate_times_.clear();
-	// generate a new wave id so that we don't confuse packets from earlier (or mis-guided)
-	// estimations
-	current_wave_id_ = std::rand();
-	// start the packet exchange chains
-	send_next_packet(1);
-	receive_next_packet();
-	// schedule the aggregation of results (by the time when all replies should have been received)
-	aggregate_results_.expires_after(timeout_sec(
-		cfg_->time_probe_max_rtt() + cfg_->time_probe_interval() * cfg_->time_probe_count()));
-	aggregate_results_.async_wait([this](err_t err) { result_aggregation_scheduled(err); });
+	const double now = lsl_clock(), passive_offset = beacon_offset(now);
+	if (beacon_delay_ != NOT_ASSIGNED && passive_offset != NOT_ASSIGNED &&
+		now - last_probe_time_ < cfg_->time_beacon_probe_interval()) {
+		// the beacons are calibrated, so update the offset without probing the outlet
+		{
+			std::lock_guard<std::mutex> lock(timeoffset_mut_);
+			timeoffset_ = -(passive_offset + beacon_delay_);
+			remote_time_ = now - timeoffset_;
+			// beacons have no round trip, so their uncertainty is that of the calibrating probe
+			// wave plus how much the beacons' delay varies
+			uncertainty_ = probe_rtt_ + beacon_jitter();
+		}
+		timeoffset_upd_.notify_all();
+	} else {
+		last_probe_time_ = now;
+		// clear the estimates buffer
+		estimates_.clear();
+		estimate_times_.clear();
+		// generate a new wave id so that we don't confuse packets from earlier (or mis-guided)
+		// estimations
+		current_wave_id_ = std::rand();
+		// start the packet exchange chains
+		send_next_packet(1);
+		receive_next_packet();
+		// schedule the aggregation of results (by the time when all replies should have been
+		// received)
+		aggregate_results_.expires_after(timeout_sec(
+			cfg_->time_probe_max_rtt() + cfg_->time_probe_interval() * cfg_->time_probe_count()));
+		aggregate_results_.async_wait([this](err_t err) { result_aggregation_scheduled(err); });
+	}
 	// schedule the next estimation step
 	next_estimate_.expires_after(timeout_sec(cfg_->time_update_interval()));
 	next_estimate_.async_wait([this](err_t err) {
@@ -140,7 +199,7 @@ void time_receiver::send_next_packet(int packet_num) {
 				/* Do nothing, but keep the msg_buffer alive until async_send is completed */
 			});
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Error trying to send a time packet: %s", e.what());
+		LSL_LOG_F(WARNING, "Error trying to send a time packet: %s", e.what());
 	}
 	// schedule next packet
 	if (packet_num < cfg_->time_probe_count()) {
@@ -179,7 +238,7 @@ void time_receiver::handle_receive_outcome(err_t err, std::size_t len) {
 			}
 		}
 	} catch (std::exception &e) {
-		LOG_F(WARNING, "Error while processing a time estimation return packet: %s", e.what());
+		LSL_LOG_F(WARNING, "Error while processing a time estimation return packet: %s", e.what());
 	}
 	if (err != asio::error::operation_aborted) receive_next_packet();
 }
@@ -198,6 +257,10 @@ void time_receiver::result_aggregation_scheduled(err_t err) {
 				best_remote_time = estimate_times_[k].second;
 			}
 		}
+		// calibrate the beacons' one-way delay against the probes
+		const double passive_offset = beacon_offset(lsl_clock());
+		if (passive_offset != NOT_ASSIGNED) beacon_delay_ = best_offset - passive_offset;
+		probe_rtt_ = best_rtt;
 		// and notify that the result is available
 		{
 			std::lock_guard<std::mutex> lock(timeoffset_mut_);
@@ -209,6 +272,55 @@ void time_receiver::result_aggregation_scheduled(err_t err) {
 	}
 }
 
+void time_receiver::start_beacon_listener() {
+	try {
+		time_beacon::listen(beacon_sock_, outlet_addr_.protocol());
+		receive_next_beacon();
+	} catch (std::exception &e) {
+		LSL_LOG_F(WARNING, "Cannot listen for time beacons, probing the outlet instead: %s",
+			e.what());
+		asio::error_code ec;
+		beacon_sock_.close(ec);
+	}
+}
+
+void time_receiver::receive_next_beacon() {
+	beacon_sock_.async_receive_from(asio::buffer(beacon_buffer_), beacon_sender_,
+		[this](err_t err, std::size_t len) { handle_beacon(err, len); });
+}
+
+void time_receiver::handle_beacon(err_t err, std::size_t len) {
+	if (err == asio::error::operation_aborted) return;
+	const double now = lsl_clock();
+	std::string hostname, session_id;
+	double remote_time;
+	// host names needn't be unique, e.g. lab machines set up from the same image, so the beacons
+	// of another session are ignored
+	if (!err && time_beacon::parse(beacon_buffer_, len, hostname, remote_time, session_id) &&
+		hostname == conn_.current_hostname() && session_id == conn_.type_info().session_id()) {
+		beacons_.emplace_back(now, remote_time - now);
+		beacon_offset(now);
+	}
+	receive_next_beacon();
+}
+
+double time_receiver::beacon_offset(double now) {
+	// keep the beacons of about one update interval
+	const double window = cfg_->time_update_interval() + 2 * cfg_->time_beacon_interval();
+	while (!beacons_.empty() && beacons_.front().first < now - window) beacons_.pop_front();
+	if (beacons_.empty()) return NOT_ASSIGNED;
+	// the beacon with the shortest delay has the highest offset
+	return std::max_element(beacons_.begin(), beacons_.end(), [](const auto &a, const auto &b) {
+		return a.second < b.second;
+	})->second;
+}
+
+double time_receiver::beacon_jitter() const {
+	const auto minmax = std::minmax_element(beacons_.begin(), beacons_.end(),
+		[](const auto &a, const auto &b) { return a.second < b.second; });
+	return beacons_.empty() ? 0 : minmax.second->second - minmax.first->second;
+}
+
 void time_receiver::reset_timeoffset_on_recovery() {
 	std::lock_guard<std::mutex> lock(timeoffset_mut_);
 	if (timeoffset_ != NOT_ASSIGNED)
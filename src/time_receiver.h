@@ -6,6 +6,7 @@
 #include <asio/ip/udp.hpp>
 #include <asio/steady_timer.hpp>
 #include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -36,6 +37,13 @@ public:
 	/// Construct a new time receiver for a given connection.
 	time_receiver(inlet_connection &conn);
 
+	/**
+	 * Construct a new time receiver for a given connection.
+	 * @param listen_for_beacons Whether to track the time beacons of the outlet host instead of
+	 * following `tuning.TimeBeaconInterval`, e.g. to test them with a simulated beacon sender.
+	 */
+	time_receiver(inlet_connection &conn, bool listen_for_beacons);
+
 	/// Destructor. Stops the background activities.
 	~time_receiver();
 
@@ -54,6 +62,22 @@ public:
 	double time_correction(double timeout = 2);
 	double time_correction(double *remote_time, double *uncertainty, double timeout);
 
+	/**
+	 * Retrieve the most recent time correction estimate without blocking or starting the
+	 * background estimation.
+	 * @return False if no estimate is available yet.
+	 */
+	bool last_time_correction(double &offset, double &uncertainty);
+	bool last_time_correction(double &offset, double &remote_time, double &uncertainty);
+
+	/**
+	 * Use a previously saved estimate until the first new one is available, so time_correction()
+	 * doesn't have to wait for the first probe wave. The background estimation starts right away.
+	 *
+	 * Has no effect if there's already an estimate.
+	 */
+	void import_time_correction(double offset, double remote_time, double uncertainty);
+
 	/**
 	 * Determine whether the clock was (potentially) reset since the last call to was_reset()
 	 *
@@ -81,12 +105,32 @@ private:
 	/// Handlers that gets called once the time estimation results shall be aggregated.
 	void result_aggregation_scheduled(err_t err);
 
+	/// Start receiving the time beacons of the outlet host (see time_beacon)
+	void start_beacon_listener();
+
+	/// Request reception of the next beacon
+	void receive_next_beacon();
+
+	/// Handler that gets called once a beacon has been received
+	void handle_beacon(err_t err, std::size_t len);
+
+	/**
+	 * The remote clock minus the local clock according to the recent beacons, i.e. including the
+	 * one-way delay of the beacons (or NOT_ASSIGNED if there are no recent beacons).
+	 */
+	double beacon_offset(double now);
+
+	/// The spread of the recent beacons' offsets, i.e. how much their one-way delay varies
+	double beacon_jitter() const;
+
 	/// Ensures that the time-offset is reset when the underlying connection is recovered (e.g.,
 	/// switches to another host)
 	void reset_timeoffset_on_recovery();
 
 	/// the underlying connection
 	inlet_connection &conn_;
+	/// whether the time beacons of the outlet host are used between probe waves
+	const bool listen_for_beacons_;
 
 	// background reader thread and the data generated by it
 	/// updates time offset
@@ -130,6 +174,22 @@ private:
 	estimate_list estimate_times_;
 	/// an id for the current wave of time packets
 	int current_wave_id_{0};
+
+	// passive time beacons (if enabled)
+	/// the socket that receives the time beacons of all hosts
+	udp_socket beacon_sock_;
+	/// a buffer to hold a received beacon
+	char beacon_buffer_[256]{0};
+	/// the sender of the last beacon
+	udp::endpoint beacon_sender_;
+	/// recent beacons of the outlet host: local receive time, remote time minus local time
+	std::deque<std::pair<double, double>> beacons_;
+	/// the one-way delay of the beacons as calibrated by the last probe wave (or NOT_ASSIGNED)
+	double beacon_delay_;
+	/// the local time of the last probe wave
+	double last_probe_time_{0};
+	/// the round trip time of the last probe wave's best estimate
+	double probe_rtt_{0};
 };
 } // namespace lsl
 
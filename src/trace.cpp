@@ -0,0 +1,215 @@
+#include "trace.h"
+#include "common.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <loguru.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lsl {
+namespace trace {
+
+std::atomic<uint32_t> sample_every{0};
+
+namespace {
+
+struct event {
+	const char *name;
+	int64_t start_ns, dur_ns;
+	double timestamp;
+	uint32_t count;
+};
+
+/// number of events per thread, must be a power of two
+constexpr uint64_t ring_size = 4096;
+
+/**
+ * A ring buffer slot, guarded by a sequence lock.
+ *
+ * The sequence number is odd while the n-th event is written to the slot (2n + 1) and even once
+ * it's complete (2n + 2), so a reader can tell whether a copy is consistent and which event it
+ * holds. The fields are relaxed atomics, so that copying a slot while it's overwritten isn't a
+ * data race.
+ */
+struct slot {
+	void store(uint64_t n, const event &e) noexcept {
+		seq.store(2 * n + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		name.store(e.name, std::memory_order_relaxed);
+		start_ns.store(e.start_ns, std::memory_order_relaxed);
+		dur_ns.store(e.dur_ns, std::memory_order_relaxed);
+		timestamp.store(e.timestamp, std::memory_order_relaxed);
+		count.store(e.count, std::memory_order_relaxed);
+		seq.store(2 * n + 2, std::memory_order_release);
+	}
+
+	/// Copy the n-th event, returns false if the slot holds another one or is being overwritten
+	bool load(uint64_t n, event &e) const noexcept {
+		const uint64_t before = seq.load(std::memory_order_acquire);
+		if (before != 2 * n + 2) return false;
+		e = {name.load(std::memory_order_relaxed), start_ns.load(std::memory_order_relaxed),
+			dur_ns.load(std::memory_order_relaxed), timestamp.load(std::memory_order_relaxed),
+			count.load(std::memory_order_relaxed)};
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return seq.load(std::memory_order_relaxed) == before;
+	}
+
+	std::atomic<uint64_t> seq{0};
+	std::atomic<const char *> name{nullptr};
+	std::atomic<int64_t> start_ns{0}, dur_ns{0};
+	std::atomic<double> timestamp{0.0};
+	std::atomic<uint32_t> count{0};
+};
+
+/**
+ * A single-writer ring buffer of events, owned by one thread.
+ *
+ * The reader copies the events without blocking the writer and skips the ones that are
+ * overwritten while they're copied.
+ */
+struct thread_ring {
+	explicit thread_ring(uint32_t tid) : tid(tid) {
+		char buf[64];
+		loguru::get_thread_name(buf, sizeof(buf), false);
+		name = buf;
+	}
+
+	void push(const event &e) noexcept {
+		const uint64_t h = head.load(std::memory_order_relaxed);
+		slots[h & (ring_size - 1)].store(h, e);
+		head.store(h + 1, std::memory_order_release);
+	}
+
+	std::atomic<uint64_t> head{0};
+	/// events before this index have been discarded by clear()
+	std::atomic<uint64_t> cleared{0};
+	std::atomic<bool> alive{true};
+	const uint32_t tid;
+	std::string name;
+	slot slots[ring_size];
+};
+
+/// Registry of all rings so they can be read out from any thread
+struct registry {
+	std::mutex mut;
+	std::vector<std::shared_ptr<thread_ring>> rings;
+	uint32_t next_tid{1};
+};
+
+registry &get_registry() {
+	static registry reg;
+	return reg;
+}
+
+/// Per-thread handle that marks its ring as orphaned when the thread exits
+struct ring_handle {
+	std::shared_ptr<thread_ring> ring;
+	~ring_handle() {
+		if (ring) ring->alive.store(false, std::memory_order_relaxed);
+	}
+};
+
+thread_ring &this_thread_ring() {
+	thread_local ring_handle handle;
+	if (!handle.ring) {
+		auto &reg = get_registry();
+		std::lock_guard<std::mutex> lock(reg.mut);
+		handle.ring = std::make_shared<thread_ring>(reg.next_tid++);
+		reg.rings.push_back(handle.ring);
+	}
+	return *handle.ring;
+}
+
+void append_escaped(std::string &out, const std::string &str) {
+	for (char c : str) {
+		if (c == '"' || c == '\\') out += '\\';
+		if (static_cast<unsigned char>(c) >= 0x20) out += c;
+	}
+}
+
+} // namespace
+
+int64_t now() noexcept { return lsl_local_clock_ns(); }
+
+void record(const char *name, int64_t start_ns, double timestamp, uint32_t count) noexcept {
+	try {
+		this_thread_ring().push({name, start_ns, now() - start_ns, timestamp, count});
+	} catch (std::exception &) {
+		// allocating the ring failed, drop the event
+	}
+}
+
+void enable(uint32_t every) noexcept { sample_every.store(every, std::memory_order_relaxed); }
+
+void clear() {
+	auto &reg = get_registry();
+	std::lock_guard<std::mutex> lock(reg.mut);
+	// rings of exited threads aren't written to anymore and can be released
+	reg.rings.erase(std::remove_if(reg.rings.begin(), reg.rings.end(),
+						[](const std::shared_ptr<thread_ring> &ring) {
+							return !ring->alive.load(std::memory_order_relaxed);
+						}),
+		reg.rings.end());
+	// the owning threads may be writing concurrently, so only the read position is moved
+	for (auto &ring : reg.rings)
+		ring->cleared.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+std::string to_chrome_json() {
+	std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	bool first = true;
+	char buf[256];
+	auto &reg = get_registry();
+	std::lock_guard<std::mutex> lock(reg.mut);
+	for (auto &ring : reg.rings) {
+		// the owning thread keeps recording, so events overwritten while copying are skipped
+		const uint64_t end = ring->head.load(std::memory_order_acquire);
+		const uint64_t cleared = ring->cleared.load(std::memory_order_relaxed);
+		const uint64_t begin = std::max(end > ring_size ? end - ring_size : 0, cleared);
+		std::vector<event> events;
+		events.reserve(end - begin);
+		event e{};
+		for (uint64_t i = begin; i < end; ++i)
+			if (ring->slots[i & (ring_size - 1)].load(i, e)) events.push_back(e);
+
+		if (!first) out += ',';
+		first = false;
+		out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" +
+			   std::to_string(ring->tid) + ",\"args\":{\"name\":\"";
+		append_escaped(out, ring->name);
+		out += "\"}}";
+		for (const auto &e : events) {
+			std::snprintf(buf, sizeof(buf),
+				",{\"name\":\"%s\",\"cat\":\"lsl\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+				"\"dur\":%.3f,\"args\":{\"timestamp\":%.9f,\"samples\":%u}}",
+				e.name, ring->tid, e.start_ns / 1000., e.dur_ns / 1000., e.timestamp, e.count);
+			out += buf;
+		}
+	}
+	out += "]}";
+	return out;
+}
+
+} // namespace trace
+} // namespace lsl
+
+extern "C" {
+#include "../include/lsl/trace.h"
+
+LIBLSL_C_API void lsl_trace_enable(int32_t sample_every) {
+	lsl::trace::enable(sample_every > 0 ? static_cast<uint32_t>(sample_every) : 0);
+}
+
+LIBLSL_C_API void lsl_trace_clear(void) { lsl::trace::clear(); }
+
+LIBLSL_C_API int32_t lsl_trace_dump(const char *filename) {
+	if (!filename) return lsl_argument_error;
+	try {
+		std::ofstream out(filename, std::ios::binary);
+		out << lsl::trace::to_chrome_json();
+		return out ? lsl_no_error : lsl_internal_error;
+	} catch (std::exception &) { return lsl_internal_error; }
+}
+}
@@ -0,0 +1,107 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "common.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+/**
+ * @file trace.h
+ * Opt-in tracing of the sample pipeline.
+ *
+ * Each thread records timestamped stage events (push, fan-out, queue wait, serialization, socket
+ * write, receive/decode, pull) into its own fixed-size ring buffer. Only every n-th sample is
+ * traced; the decision is made on the sample's timestamp so that the outlet and inlet stages
+ * of a process pick the same samples without exchanging any state. Deduced timestamps (e.g. of
+ * all but the first sample of a chunk) are resolved by the outlet-side stages with a
+ * timestamp_resolver, the same way the inlet resolves them when it decodes the samples.
+ *
+ * When tracing is disabled, each instrumentation point costs a single relaxed atomic load.
+ */
+
+namespace lsl {
+namespace trace {
+
+/// The interval at which samples are traced, or 0 if tracing is disabled
+extern std::atomic<uint32_t> sample_every;
+
+/// Check whether tracing is enabled
+inline bool enabled() noexcept { return sample_every.load(std::memory_order_relaxed) != 0; }
+
+/// Get the current time for a trace event, in ns (only call if enabled())
+int64_t now() noexcept;
+
+/// The start time for a span if tracing is enabled, 0 otherwise
+inline int64_t start() noexcept { return enabled() ? now() : 0; }
+
+/// Check whether the sample with the given timestamp should be traced
+inline bool sampled(double timestamp) noexcept {
+	const uint32_t every = sample_every.load(std::memory_order_relaxed);
+	if (every <= 1) return every == 1;
+	uint64_t bits;
+	std::memcpy(&bits, &timestamp, sizeof(bits));
+	// mix the bits so that regularly spaced timestamps are sampled uniformly
+	bits ^= bits >> 33;
+	bits *= 0xff51afd7ed558ccdULL;
+	bits ^= bits >> 33;
+	return bits % every == 0;
+}
+
+/**
+ * Resolves the deduced timestamps of consecutive samples, like the inlet does.
+ *
+ * Stages that see the samples before they are decoded key the sampling decision on the resolved
+ * timestamps, so they trace the same samples as the inlet-side stages.
+ */
+class timestamp_resolver {
+public:
+	explicit timestamp_resolver(double srate) noexcept : srate_(srate) {}
+
+	/// Get the timestamp of the next sample, with a deduced one resolved from the previous one
+	double operator()(double timestamp) noexcept {
+		if (timestamp == DEDUCED_TIMESTAMP) {
+			timestamp = last_.load(std::memory_order_relaxed);
+			if (srate_ != IRREGULAR_RATE) timestamp += 1.0 / srate_;
+		}
+		last_.store(timestamp, std::memory_order_relaxed);
+		return timestamp;
+	}
+
+	/// The resolved timestamp of the most recent sample
+	double last() const noexcept { return last_.load(std::memory_order_relaxed); }
+
+private:
+	const double srate_;
+	/// samples may be pushed from several threads, the order of resolution is theirs to keep
+	std::atomic<double> last_{0.0};
+};
+
+/**
+ * Record a complete event (a span) in the calling thread's ring buffer.
+ * @param name Name of the stage; must be a string literal (or otherwise outlive the trace).
+ * @param start_ns Start time as returned by start() / now().
+ * @param timestamp The LSL timestamp of the (first) sample that the event refers to.
+ * @param count The number of samples the event covers.
+ */
+void record(const char *name, int64_t start_ns, double timestamp, uint32_t count = 1) noexcept;
+
+/// Record a span if it has been started while tracing was enabled and the sample is sampled
+inline void span(const char *name, int64_t start_ns, double timestamp, uint32_t count = 1) noexcept {
+	if (start_ns && sampled(timestamp)) record(name, start_ns, timestamp, count);
+}
+
+/// Enable tracing every n-th sample (or disable it if n is 0)
+void enable(uint32_t every) noexcept;
+
+/// Discard all recorded events
+void clear();
+
+/// Serialize all recorded events in the Chrome trace event (JSON) format
+std::string to_chrome_json();
+
+} // namespace trace
+} // namespace lsl
+
+#endif
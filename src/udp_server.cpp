@@ -1,5 +1,6 @@
 #include "udp_server.h"
 #include "api_config.h"
+#include "logging.h"
 #include "socket_utils.h"
 #include "stream_info_impl.h"
 #include "util/strfuns.hpp"
@@ -9,8 +10,10 @@
 #include <asio/ip/multicast.hpp>
 #include <asio/ip/udp.hpp>
 #include <exception>
-#include <loguru.hpp>
-#include <sstream>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <streambuf>
 #include <utility>
 
 namespace ip = asio::ip;
@@ -19,7 +22,7 @@ namespace lsl {
 
 udp_server::udp_server(stream_info_impl_p info, asio::io_context &io, udp protocol)
 	: info_(std::move(info)), io_(io), socket_(std::make_shared<udp_socket_p::element_type>(io)),
-	  time_services_enabled_(true) {
+	  time_services_enabled_(true), handler_memory_(std::make_shared<handler_memory>()) {
 	// open the socket for the specified protocol
 	socket_->open(protocol);
 
@@ -31,14 +34,14 @@ udp_server::udp_server(stream_info_impl_p info, asio::io_context &io, udp protoc
 		info_->v4service_port(port);
 	else
 		info_->v6service_port(port);
-	LOG_F(2, "%s: Started unicast udp server at port %d (addr %p)", info_->name().c_str(), port,
+	LSL_LOG_F(2, "%s: Started unicast udp server at port %d (addr %p)", info_->name().c_str(), port,
 		(void *)this);
 }
 
 udp_server::udp_server(stream_info_impl_p info, asio::io_context &io, ip::address addr,
 	uint16_t port, int ttl, const std::string &listen_address)
 	: info_(std::move(info)), io_(io), socket_(std::make_shared<udp_socket>(io)),
-	  time_services_enabled_(false) {
+	  time_services_enabled_(false), handler_memory_(std::make_shared<handler_memory>()) {
 	bool is_broadcast = addr == ip::address_v4::broadcast();
 
 	// set up the endpoint where we listen (note: this is not yet the multicast address)
@@ -70,7 +73,7 @@ udp_server::udp_server(stream_info_impl_p info, asio::io_context &io, ip::addres
 		bool joined_anywhere = false;
 		asio::error_code err;
 		for (auto &if_ : api_config::get_instance()->multicast_interfaces) {
-			DLOG_F(
+			LSL_DLOG_F(
 				INFO, "Joining %s to %s", if_.addr.to_string().c_str(), addr.to_string().c_str());
 			if (addr.is_v4() && if_.addr.is_v4())
 				socket_->set_option(ip::multicast::join_group(addr.to_v4(), if_.addr.to_v4()), err);
@@ -78,14 +81,14 @@ udp_server::udp_server(stream_info_impl_p info, asio::io_context &io, ip::addres
 				socket_->set_option(
 					ip::multicast::join_group(addr.to_v6(), if_.addr.to_v6().scope_id()), err);
 			if (err)
-				LOG_F(WARNING, "Could not bind multicast responder for %s to interface %s (%s)",
+				LSL_LOG_F(WARNING, "Could not bind multicast responder for %s to interface %s (%s)",
 					addr.to_string().c_str(), if_.addr.to_string().c_str(), err.message().c_str());
 			else
 				joined_anywhere = true;
 		}
 		if (!joined_anywhere) throw std::runtime_error("Could not join any multicast group");
 	}
-	LOG_F(2, "%s: Started multicast udp server at %s port %d (addr %p)",
+	LSL_LOG_F(2, "%s: Started multicast udp server at %s port %d (addr %p)",
 		this->info_->name().c_str(), addr.to_string().c_str(), port, (void *)this);
 }
 
@@ -94,6 +97,7 @@ udp_server::udp_server(stream_info_impl_p info, asio::io_context &io, ip::addres
 void udp_server::begin_serving() {
 	// pre-calculate the shortinfo message (now that everyone should have initialized their part).
 	shortinfo_msg_ = info_->to_shortinfo_message();
+	binary_shortinfo_msg_ = info_->to_binary_shortinfo_message();
 	// start asking for a packet
 	request_next_packet();
 }
@@ -106,45 +110,69 @@ void udp_server::end_serving() {
 	post(io_, [sock, fn]() {
 		try {
 			if (sock->is_open()) sock->close();
-		} catch (std::exception &e) { LOG_F(ERROR, "Error during %s: %s", fn, e.what()); }
+		} catch (std::exception &e) { LSL_LOG_F(ERROR, "Error during %s: %s", fn, e.what()); }
 	});
 }
 
 // === receive / reply loop ===
 
+namespace {
+/// A stream buffer on memory that it doesn't own, so parsing and formatting don't allocate
+class memory_streambuf : public std::streambuf {
+public:
+	memory_streambuf(char *begin, char *end) {
+		setg(begin, begin, end);
+		setp(begin, end);
+	}
+
+	/// The number of characters written
+	std::size_t written() const { return static_cast<std::size_t>(pptr() - pbase()); }
+};
+} // namespace
+
 void udp_server::request_next_packet() {
-	DLOG_F(5, "udp_server::request_next_packet");
+	LSL_DLOG_F(5, "udp_server::request_next_packet");
 	socket_->async_receive_from(asio::buffer(buffer_), remote_endpoint_,
-		[shared_this = shared_from_this()](
-			err_t err, std::size_t len) { shared_this->handle_receive_outcome(err, len); });
+		recycle_memory(*handler_memory_, [shared_this = shared_from_this()](err_t err,
+											 std::size_t len) {
+			shared_this->handle_receive_outcome(err, len);
+		}));
+}
+
+void udp_server::send_reply(asio::const_buffer buf, const udp::endpoint &endpoint) {
+	socket_->async_send_to(buf, endpoint,
+		recycle_memory(*handler_memory_,
+			[shared_this = shared_from_this()](err_t err_, std::size_t /*unused*/) {
+				if (err_ != asio::error::operation_aborted && err_ != asio::error::shut_down)
+					shared_this->request_next_packet();
+			}));
 }
 
 void udp_server::process_shortinfo_request(std::istream& request_stream)
 {
-	std::string query;
-	getline(request_stream, query);
-	query = trim(query);
+	getline(request_stream, query_);
+	trim_inplace(query_);
 	// parse return address, port, and query ID
 	uint16_t return_port;
 	request_stream >> return_port;
-	std::string query_id;
-	request_stream >> query_id;
-	DLOG_F(2, "%p shortinfo req from %s for %s", (void *)this,
-		remote_endpoint_.address().to_string().c_str(), query.c_str());
+	request_stream >> query_id_;
+	// newer clients announce the message formats they understand after the query id
+	bool binary = false;
+	while (request_stream >> token_)
+		if (token_ == stream_info_impl::binary_shortinfo_capability) binary = true;
+	const std::string &msg =
+		binary && !binary_shortinfo_msg_.empty() ? binary_shortinfo_msg_ : shortinfo_msg_;
+	LSL_DLOG_F(2, "%p shortinfo req from %s for %s", (void *)this,
+		remote_endpoint_.address().to_string().c_str(), query_.c_str());
 	// check query
-	if (info_->matches_query(query)) {
-		LOG_F(3, "%p query matches, replying to port %d", (void *)this, return_port);
+	if (info_->matches_query(query_)) {
+		LSL_LOG_F(3, "%p query matches, replying to port %d", (void *)this, return_port);
 		// query matches: send back reply
-		udp::endpoint return_endpoint(remote_endpoint_.address(), return_port);
-		string_p replymsg(
-			std::make_shared<std::string>((query_id += "\r\n") += shortinfo_msg_));
-		socket_->async_send_to(asio::buffer(*replymsg), return_endpoint,
-			[shared_this = shared_from_this(), replymsg](err_t err_, std::size_t /*unused*/) {
-				if (err_ != asio::error::operation_aborted && err_ != asio::error::shut_down)
-					shared_this->request_next_packet();
-			});
+		return_endpoint_ = udp::endpoint(remote_endpoint_.address(), return_port);
+		shortinfo_reply_.assign(query_id_).append("\r\n").append(msg);
+		send_reply(asio::buffer(shortinfo_reply_), return_endpoint_);
 	} else {
-		DLOG_F(2, "%p query didn't match", (void *)this);
+		LSL_DLOG_F(2, "%p query didn't match", (void *)this);
 		request_next_packet();
 	}
 }
@@ -154,21 +182,16 @@ void udp_server::process_timedata_request(std::istream &request_stream, double t
 	request_stream >> wave_id;
 	double t0;
 	request_stream >> t0;
-	// send it off (including the time of packet submission and a shared ptr to the
-	// message content owned by the handler)
-	std::ostringstream reply;
+	// send it off (including the time of packet submission)
+	memory_streambuf buf(std::begin(timedata_reply_), std::end(timedata_reply_));
+	std::ostream reply(&buf);
 	reply.precision(16);
-	reply << ' ' << wave_id << ' ' << t0 << ' ' << t1 << ' ' << lsl_clock();
-	string_p replymsg(std::make_shared<std::string>(reply.str()));
-	socket_->async_send_to(asio::buffer(*replymsg), remote_endpoint_,
-		[shared_this = shared_from_this(), replymsg](err_t err_, std::size_t /*unused*/) {
-			if (err_ != asio::error::operation_aborted && err_ != asio::error::shut_down)
-				shared_this->request_next_packet();
-		});
+	reply << ' ' << wave_id << ' ' << t0 << ' ' << t1 << ' ' << clock_();
+	send_reply(asio::buffer(timedata_reply_, buf.written()), remote_endpoint_);
 }
 
 void udp_server::handle_receive_outcome(err_t err, std::size_t len) {
-	DLOG_F(6, "udp_server::handle_receive_outcome (%lub)", len);
+	LSL_DLOG_F(6, "udp_server::handle_receive_outcome (%lub)", len);
 	if (err) {
 		// non-critical error? Wait for the next packet
 		if (err != asio::error::operation_aborted || err != asio::error::shut_down)
@@ -177,26 +200,27 @@ void udp_server::handle_receive_outcome(err_t err, std::size_t len) {
 	}
 	try {
 		// remember the time of packet reception for possible later use
-		double t1 = time_services_enabled_ ? lsl_clock() : 0.0;
+		double t1 = time_services_enabled_ ? clock_() : 0.0;
 
 		// wrap received packet into a request stream and parse the method from it
-		std::istringstream request_stream(std::string(buffer_, buffer_ + len));
-		std::string method;
-		getline(request_stream, method);
-		method = trim(method);
-		if (method == "LSL:shortinfo") {
+		memory_streambuf buf(buffer_, buffer_ + len);
+		std::istream request_stream(&buf);
+		getline(request_stream, method_);
+		trim_inplace(method_);
+		if (method_ == "LSL:shortinfo") {
 			// shortinfo request: parse content query string
 			process_shortinfo_request(request_stream);
 			return;
 		}
-		if (time_services_enabled_ && method == "LSL:timedata") {
+		if (time_services_enabled_ && method_ == "LSL:timedata") {
 			// timedata request: parse time of original transmission
 			process_timedata_request(request_stream, t1);
 			return;
 		}
-		DLOG_F(INFO, "%p Unknown method '%s' received by udp-server", (void *)this, method.c_str());
+		LSL_DLOG_F(
+			INFO, "%p Unknown method '%s' received by udp-server", (void *)this, method_.c_str());
 	} catch (std::exception &e) {
-		LOG_F(
+		LSL_LOG_F(
 			WARNING, "%p udp_server: hiccup during request processing: %s", (void *)this, e.what());
 	}
 	request_next_packet();
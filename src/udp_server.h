@@ -1,13 +1,17 @@
 #ifndef UDP_SERVER_H
 #define UDP_SERVER_H
 
+#include "common.h"
 #include "forward.h"
 #include "socket_utils.h"
+#include "util/handler_memory.hpp"
 #include <asio/ip/udp.hpp>
 #include <cstdint>
 #include <exception>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 
 using asio::ip::udp;
 using err_t = const asio::error_code &;
@@ -21,7 +25,8 @@ using udp_socket_p = std::shared_ptr<udp_socket>;
  *
  * Understands the following messages:
  *  - `LSL:shortinfo`. This is a request for the stream_info that comes with a query string (and a
- * return address). A packet is returned only if the query matches.
+ * return address). A packet is returned only if the query matches. If the return address line
+ * lists the binary short-info capability, the stream_info is sent in the binary format.
  *  - `LSL:timedata`. This is a request for time synchronization info that comes with a time stamp
  * (t0). The t0 stamp and two more time stamps (t1 and t2) are returned (similar to the NTP packet
  * exchange).
@@ -57,6 +62,17 @@ public:
 	/// Initiate teardown of UDP traffic.
 	void end_serving();
 
+	/// A clock that returns the current time in seconds
+	using clock_fn = std::function<double()>;
+
+	/**
+	 * Replace the clock that is used to timestamp time synchronization replies.
+	 *
+	 * This allows simulating an outlet host with a different clock (offset, drift, steps) in
+	 * tests. Call this only before begin_serving().
+	 */
+	void set_clock(clock_fn clock) { clock_ = std::move(clock); }
+
 private:
 	/// Initiate next packet request.
 	/// The result of the operation will eventually trigger the handle_receive_outcome() handler.
@@ -68,6 +84,9 @@ private:
 	/// Parse and process a LSL::shortinfo request
 	void process_shortinfo_request(std::istream& request_stream);
 
+	/// Send the reply in `buf` to `endpoint` and then wait for the next request
+	void send_reply(asio::const_buffer buf, const udp::endpoint &endpoint);
+
 	/// Parse and process a LSL::timedata request
 	void process_timedata_request(std::istream& request_stream, double t1);
 
@@ -80,10 +99,26 @@ private:
 	/// a buffer of data (we're receiving on it)
 	char buffer_[65536]{0};
 	bool time_services_enabled_;
+	/// the clock used for timedata replies
+	clock_fn clock_{lsl_clock};
 	/// the endpoint that we're currently talking to)
 	udp::endpoint remote_endpoint_;
 	/// pre-computed server response
 	std::string shortinfo_msg_;
+	/// pre-computed server response for clients that understand the binary short-info format
+	std::string binary_shortinfo_msg_;
+
+	// there's only one operation in flight at a time, so its buffers and handler memory are reused
+	/// handler memory for the receive / reply operations
+	std::shared_ptr<handler_memory> handler_memory_;
+	/// the shortinfo reply (query id and message)
+	std::string shortinfo_reply_;
+	/// the timedata reply
+	char timedata_reply_[128];
+	/// the endpoint a shortinfo reply is sent to
+	udp::endpoint return_endpoint_;
+	/// parts of the current request
+	std::string method_, query_, query_id_, token_;
 };
 } // namespace lsl
 
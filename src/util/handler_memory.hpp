@@ -0,0 +1,73 @@
+#pragma once
+#include <asio/bind_allocator.hpp>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace lsl {
+/**
+ * Reusable memory for the completion handler of one asynchronous operation at a time.
+ *
+ * Servers that start their operations one after another (e.g. receive, reply, receive) get the
+ * same block for each of them, so steady-state traffic doesn't allocate handler storage. A second
+ * operation in flight, or one whose handler is too large, falls back to the heap.
+ *
+ * The memory has to be owned by a std::shared_ptr. It keeps itself alive while it's handed out,
+ * because asio releases a handler's memory after the handler (and with it maybe the last
+ * reference to the memory's owner) is destroyed.
+ */
+class handler_memory : public std::enable_shared_from_this<handler_memory> {
+public:
+	handler_memory() = default;
+	handler_memory(const handler_memory &) = delete;
+	handler_memory &operator=(const handler_memory &) = delete;
+
+	void *allocate(std::size_t size) {
+		if (in_use_ || size > sizeof(storage_)) return ::operator new(size);
+		in_use_ = true;
+		keepalive_ = shared_from_this();
+		return &storage_;
+	}
+
+	void deallocate(void *p) {
+		if (p != &storage_) {
+			::operator delete(p);
+			return;
+		}
+		in_use_ = false;
+		// this may destroy the memory, so it's the last thing to do
+		auto self = std::move(keepalive_);
+	}
+
+private:
+	alignas(std::max_align_t) unsigned char storage_[1024];
+	bool in_use_{false};
+	std::shared_ptr<handler_memory> keepalive_;
+};
+
+/// An allocator that asio uses for a handler's operation state, see recycle_memory()
+template <typename T> class handler_allocator {
+public:
+	using value_type = T;
+
+	explicit handler_allocator(handler_memory &memory) noexcept : memory_(&memory) {}
+	template <typename U>
+	handler_allocator(const handler_allocator<U> &other) noexcept : memory_(other.memory_) {}
+
+	T *allocate(std::size_t n) { return static_cast<T *>(memory_->allocate(sizeof(T) * n)); }
+	void deallocate(T *p, std::size_t /*n*/) { memory_->deallocate(p); }
+
+	bool operator==(const handler_allocator &rhs) const noexcept { return memory_ == rhs.memory_; }
+	bool operator!=(const handler_allocator &rhs) const noexcept { return memory_ != rhs.memory_; }
+
+private:
+	template <typename> friend class handler_allocator;
+	handler_memory *memory_;
+};
+
+/// Let asio allocate the state of the operation that completes with `handler` from `memory`
+template <typename Handler> auto recycle_memory(handler_memory &memory, Handler &&handler) {
+	return asio::bind_allocator(handler_allocator<char>(memory), std::forward<Handler>(handler));
+}
+} // namespace lsl
@@ -0,0 +1,65 @@
+#include "mapped_file.hpp"
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+lsl::mapped_file::mapped_file(const std::string &filename) {
+	const std::runtime_error error("Could not map file " + filename);
+#ifdef _WIN32
+	file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_ == INVALID_HANDLE_VALUE) {
+		file_ = nullptr;
+		throw error;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file_, &size)) {
+		CloseHandle(file_);
+		throw error;
+	}
+	size_ = static_cast<std::size_t>(size.QuadPart);
+	if (size_ == 0) return;
+	mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping_)
+		data_ = static_cast<const char *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+	if (!data_) {
+		if (mapping_) CloseHandle(mapping_);
+		CloseHandle(file_);
+		throw error;
+	}
+#else
+	const int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) throw error;
+	struct stat st {};
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		throw error;
+	}
+	size_ = static_cast<std::size_t>(st.st_size);
+	void *addr = size_ ? mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0) : nullptr;
+	// the mapping stays valid after the file descriptor is closed
+	close(fd);
+	if (addr == MAP_FAILED) throw error;
+	data_ = static_cast<const char *>(addr);
+	// the file is mostly read front to back
+	if (data_) madvise(addr, size_, MADV_SEQUENTIAL);
+#endif
+}
+
+lsl::mapped_file::~mapped_file() {
+#ifdef _WIN32
+	if (data_) UnmapViewOfFile(data_);
+	if (mapping_) CloseHandle(mapping_);
+	if (file_) CloseHandle(file_);
+#else
+	if (data_) munmap(const_cast<char *>(data_), size_);
+#endif
+}
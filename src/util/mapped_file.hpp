@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace lsl {
+/// A read-only memory mapping of a whole file
+class mapped_file {
+public:
+	/// Map a file, throws a std::runtime_error if it can't be opened or mapped
+	explicit mapped_file(const std::string &filename);
+	~mapped_file();
+
+	mapped_file(const mapped_file &) = delete;
+	mapped_file &operator=(const mapped_file &) = delete;
+
+	/// The file's contents (nullptr for empty files)
+	const char *data() const { return data_; }
+	std::size_t size() const { return size_; }
+
+private:
+	const char *data_{nullptr};
+	std::size_t size_{0};
+#ifdef _WIN32
+	void *file_{nullptr}, *mapping_{nullptr};
+#endif
+};
+} // namespace lsl
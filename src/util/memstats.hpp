@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file memstats.hpp
+ * Lightweight accounting of the heap memory held by liblsl's larger internal components.
+ *
+ * The counters are only updated when a component allocates or releases its storage (i.e., never
+ * on the per-sample hot path of preallocated buffers), so they're always enabled.
+ */
+
+namespace lsl {
+namespace memstats {
+
+/// The components whose memory usage is accounted for
+enum class component {
+	/// sample slabs and overflow samples allocated by a sample factory
+	factory,
+	/// ring buffers of the consumer queues (per outlet session and per inlet)
+	consumer_queue,
+	/// stream_info_impl objects (without their XML DOM, which is managed by pugixml)
+	stream_info,
+	count
+};
+
+struct counter {
+	std::atomic<int64_t> bytes{0};
+	std::atomic<int64_t> objects{0};
+};
+
+inline counter counters[static_cast<int>(component::count)];
+
+/// Add (or remove, if negative) the given number of bytes / objects to a component's tally
+inline void add(component c, int64_t bytes, int64_t objects = 0) noexcept {
+	counter &ctr = counters[static_cast<int>(c)];
+	ctr.bytes.fetch_add(bytes, std::memory_order_relaxed);
+	if (objects) ctr.objects.fetch_add(objects, std::memory_order_relaxed);
+}
+
+/// The number of bytes currently held by all instances of a component
+inline int64_t bytes(component c) noexcept {
+	return counters[static_cast<int>(c)].bytes.load(std::memory_order_relaxed);
+}
+
+/// The number of currently live instances of a component
+inline int64_t objects(component c) noexcept {
+	return counters[static_cast<int>(c)].objects.load(std::memory_order_relaxed);
+}
+
+/**
+ * A member that accounts for one `Owner` object for as long as its owner lives.
+ *
+ * Copies are accounted for separately, so it can be used in classes with compiler-generated or
+ * hand-written copy constructors alike.
+ */
+template <component C, typename Owner> struct tracked {
+	tracked() noexcept { add(C, sizeof(Owner), 1); }
+	tracked(const tracked &) noexcept { add(C, sizeof(Owner), 1); }
+	tracked &operator=(const tracked &) noexcept { return *this; }
+	~tracked() { add(C, -static_cast<int64_t>(sizeof(Owner)), -1); }
+};
+
+} // namespace memstats
+} // namespace lsl
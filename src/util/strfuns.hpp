@@ -35,6 +35,14 @@ inline std::string trim(const std::string &input) {
 	return {begin, end};
 }
 
+/// remove whitespace from the beginning and end of a string in place (keeps its capacity)
+inline void trim_inplace(std::string &str) {
+	auto begin = str.begin(), end = str.end();
+	lsl::trim(begin, end);
+	str.erase(end, str.end());
+	str.erase(str.begin(), begin);
+}
+
 /// split a separated string like "this,is a,list" into its parts
 std::vector<std::string> splitandtrim(
 	const std::string &input, char separator = ',', bool keepempty = false);
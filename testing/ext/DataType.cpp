@@ -3,9 +3,14 @@
 #include <catch2/catch_approx.hpp>
 #include <catch2/catch_template_test_macros.hpp>
 #include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <lsl_cpp.h>
 #include <thread>
+#include <vector>
 
 // clazy:excludeall=non-pod-global-static
 
@@ -107,3 +112,188 @@ TEST_CASE("Flush", "[datatransfer][basic]") {
 	pusher.join();
 	//sp.in_.set_postprocessing(lsl::post_none);
 }
+
+TEST_CASE("filtered datatransfer", "[datatransfer][filter]") {
+	SECTION("markers") {
+		lsl::stream_outlet out(lsl::stream_info(
+			"FilterMarkers", "Markers", 1, lsl::IRREGULAR_RATE, lsl::cf_string, "filtermarkers"));
+		auto found = lsl::resolve_stream("name", "FilterMarkers", 1, 2.0);
+		REQUIRE(!found.empty());
+		lsl::stream_inlet in(found[0]);
+		in.set_sample_filter("== 'Stim' | ch0 ^= \"Resp_\"");
+		in.open_stream(2);
+		REQUIRE(out.wait_for_consumers(2));
+
+		for (std::string marker : {"Stim", "Other", "Resp_1", "stim", "Resp_2"})
+			out.push_sample(&marker, lsl::local_clock(), true);
+		std::string received;
+		for (const char *expected : {"Stim", "Resp_1", "Resp_2"}) {
+			REQUIRE(in.pull_sample(&received, 1, 2.) != 0.0);
+			CHECK(received == expected);
+		}
+		CHECK(in.pull_sample(&received, 1, 0.2) == 0.0);
+	}
+	SECTION("thresholds with deduced time stamps") {
+		const double srate = 100.;
+		lsl::stream_outlet out(
+			lsl::stream_info("FilterNumeric", "EEG", 2, srate, lsl::cf_int32, "filternumeric"));
+		auto found = lsl::resolve_stream("name", "FilterNumeric", 1, 2.0);
+		REQUIRE(!found.empty());
+		lsl::stream_inlet in(found[0]);
+		in.set_sample_filter("ch1 >= 5 & ch1 != 7");
+		in.open_stream(2);
+		REQUIRE(out.wait_for_consumers(2));
+
+		std::vector<int32_t> chunk;
+		for (int32_t i = 0; i < 10; ++i) chunk.insert(chunk.end(), {-i, i});
+		const double t0 = 1000.;
+		// the time stamp refers to the last sample, the others are deduced from the sampling rate
+		out.push_chunk_multiplexed(chunk, t0, true);
+		int32_t received[2];
+		for (int32_t i : {5, 6, 8, 9}) {
+			INFO(i);
+			const double ts = in.pull_sample(received, 2, 2.);
+			CHECK(received[1] == i);
+			CHECK(ts == Catch::Approx(t0 - (9 - i) / srate));
+		}
+		CHECK(in.pull_sample(received, 2, 0.2) == 0.0);
+	}
+	SECTION("invalid filters") {
+		lsl::stream_outlet out(lsl::stream_info(
+			"FilterInvalid", "EEG", 2, lsl::IRREGULAR_RATE, lsl::cf_float32, "filterinvalid"));
+		auto found = lsl::resolve_stream("name", "FilterInvalid", 1, 2.0);
+		REQUIRE(!found.empty());
+		lsl::stream_inlet in(found[0]);
+		CHECK_THROWS_AS(in.set_sample_filter("ch2 > 1"), std::invalid_argument);
+		CHECK_THROWS_AS(in.set_sample_filter("ch0 ^= 1"), std::invalid_argument);
+		CHECK_THROWS_AS(in.set_sample_filter("ch0 > one"), std::invalid_argument);
+		CHECK_THROWS_AS(in.set_sample_filter("ch0 > 1 &"), std::invalid_argument);
+		CHECK_NOTHROW(in.set_sample_filter(""));
+	}
+}
+
+TEST_CASE("slowly changing wide streams", "[datatransfer][changemask]") {
+	const int nchans = 300, n = 50;
+	auto sp = create_streampair(
+		lsl::stream_info("ChangeMask", "Status", nchans, 10., lsl::cf_float32, "changemask"));
+	std::vector<float> values(nchans, 1.f), received(nchans);
+	std::vector<std::vector<float>> sent;
+	for (int i = 0; i < n; ++i) {
+		// change a single channel per sample and keep NaNs and zeros of both signs
+		values[(i * 7) % nchans] = static_cast<float>(i);
+		values[1] = i % 2 ? -0.f : 0.f;
+		values[2] = std::numeric_limits<float>::quiet_NaN();
+		sp.out_.push_sample(values);
+		sent.push_back(values);
+	}
+	for (const auto &expected : sent) {
+		REQUIRE(sp.in_.pull_sample(received, 2.) != 0.0);
+		CHECK(std::memcmp(received.data(), expected.data(), nchans * sizeof(float)) == 0);
+	}
+	// the outlet updates its counters after the write completed
+	lsl::outlet_stats stats = sp.out_.get_stats();
+	for (int retry = 0; retry < 100 && stats.samples_sent < n; ++retry) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		stats = sp.out_.get_stats();
+	}
+	CHECK(stats.samples_sent == n);
+	CHECK(stats.bytes_sent < stats.bytes_pushed / 10);
+}
+
+TEST_CASE("strided datatransfer", "[datatransfer][strided][basic]") {
+	const int nchans = 3, n = 20;
+	auto sp = create_streampair(
+		lsl::stream_info("Strided", "EEG", nchans, 100., lsl::cf_float32, "strided"));
+
+	// device records with a status word and padding between the channel values
+	struct device_record {
+		uint32_t status;
+		int16_t channels[nchans];
+		uint16_t padding;
+	};
+	std::vector<device_record> records(n);
+	for (int i = 0; i < n; ++i) {
+		records[i].status = 0xdeadbeef;
+		for (int ch = 0; ch < nchans; ++ch)
+			records[i].channels[ch] = static_cast<int16_t>(i * nchans + ch);
+	}
+	sp.out_.push_chunk_strided(&records[0].channels[0], n, sizeof(device_record));
+	// the same values with the channels in reverse order
+	const std::vector<int32_t> reversed{static_cast<int32_t>(offsetof(device_record, channels)) + 4,
+		static_cast<int32_t>(offsetof(device_record, channels)) + 2,
+		static_cast<int32_t>(offsetof(device_record, channels))};
+	sp.out_.push_chunk_strided<int16_t>(records.data(), n, sizeof(device_record), reversed);
+
+	struct app_record {
+		uint64_t marker;
+		float channels[nchans];
+	};
+	std::vector<app_record> received(n, app_record{0x0123456789abcdef, {-1.f, -1.f, -1.f}});
+	std::vector<double> timestamps(n);
+	REQUIRE(sp.in_.pull_chunk_strided(&received[0].channels[0], n, sizeof(app_record),
+				sizeof(float), timestamps.data(), 5.) == n);
+	for (int i = 0; i < n; ++i) {
+		CHECK(received[i].marker == 0x0123456789abcdef);
+		for (int ch = 0; ch < nchans; ++ch)
+			CHECK(received[i].channels[ch] == static_cast<float>(i * nchans + ch));
+		if (i) CHECK(timestamps[i] - timestamps[i - 1] == Catch::Approx(.01));
+	}
+
+	// scatter the reversed chunk back into the original layout
+	std::vector<device_record> roundtrip(n, device_record{0xcafe, {0, 0, 0}, 0xffff});
+	REQUIRE(sp.in_.pull_chunk_strided<int16_t>(
+				roundtrip.data(), n, sizeof(device_record), reversed, nullptr, 5.) == n);
+	for (int i = 0; i < n; ++i) {
+		CHECK(roundtrip[i].status == 0xcafe);
+		CHECK(roundtrip[i].padding == 0xffff);
+		CHECK(std::memcmp(roundtrip[i].channels, records[i].channels, sizeof(records[i].channels)) ==
+			  0);
+	}
+}
+
+TEST_CASE("record datatransfer", "[datatransfer][record][basic]") {
+	const std::vector<lsl::channel_format_t> formats{lsl::cf_int16, lsl::cf_int16, lsl::cf_float32,
+		lsl::cf_int32, lsl::cf_double64, lsl::cf_int8};
+	const int nchans = static_cast<int>(formats.size());
+	auto sp = create_streampair(lsl::stream_info("Record", "Mixed", formats, 100., "record"));
+
+	// the channel formats and offsets survive the resolve and the stream info handshake
+	for (const lsl::stream_info &info : {sp.out_.info(), sp.in_.info()}) {
+		CHECK(info.channel_format() == lsl::cf_record);
+		REQUIRE(info.channel_count() == nchans);
+		CHECK(info.sample_bytes() == 21);
+		for (int ch = 0; ch < nchans; ++ch) CHECK(info.channel_format(ch) == formats[ch]);
+		CHECK(info.channel_offset(2) == 4);
+		CHECK(info.channel_offset(5) == 20);
+	}
+	CHECK(sp.out_.info().channel_format(nchans) == lsl::cf_undefined);
+	CHECK(sp.out_.info().channel_format(-1) == lsl::cf_undefined);
+	CHECK(sp.out_.info().channel_offset(nchans) == -1);
+	CHECK(sp.out_.info().channel_offset(-1) == -1);
+
+	// typed samples are converted channel by channel
+	const std::vector<double> typed{-2., 30000., 1.5, -100000., 1e100, -7.};
+	sp.out_.push_sample(typed);
+	std::vector<double> received(nchans);
+	REQUIRE(sp.in_.pull_sample(received, 2.) != 0.0);
+	CHECK(received == typed);
+
+	// packed records are transferred as is
+#pragma pack(push, 1)
+	struct packed_record {
+		int16_t a, b;
+		float c;
+		int32_t d;
+		double e;
+		int8_t f;
+	};
+#pragma pack(pop)
+	static_assert(sizeof(packed_record) == 21, "unexpected padding");
+	const packed_record sent{1, -1, 0.25f, 123456, -0.125, 42};
+	sp.out_.push_numeric_raw(&sent);
+	packed_record raw{};
+	REQUIRE(sp.in_.pull_numeric_raw(&raw, sizeof(raw), 2.) != 0.0);
+	CHECK(std::memcmp(&raw, &sent, sizeof(raw)) == 0);
+
+	CHECK_THROWS(lsl::stream_info("Record", "Mixed", {lsl::cf_float32, lsl::cf_string}));
+}
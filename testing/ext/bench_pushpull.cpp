@@ -6,6 +6,7 @@
 #include <lsl_cpp.h>
 #include <string>
 #include <thread>
+#include <vector>
 
 // clazy:excludeall=non-pod-global-static
 
@@ -53,6 +54,61 @@ TEMPLATE_TEST_CASE("pushpull", "[basic][throughput]", char, double, std::string)
 	}
 }
 
+TEST_CASE("outlet group push", "[group][throughput]") {
+	const std::size_t n_outlets = 3, nchan = 8, frames = 128;
+	std::vector<lsl::stream_outlet> outlets;
+	std::vector<lsl::stream_outlet *> members;
+	for (std::size_t i = 0; i < n_outlets; ++i) {
+		const std::string name = "GroupBench" + std::to_string(i);
+		outlets.emplace_back(lsl::stream_info(name, "Bench", (int)nchan, 1000., lsl::cf_float32));
+	}
+	std::list<lsl::stream_inlet> inlets;
+	for (auto &out : outlets) {
+		auto found = lsl::resolve_stream("name", out.info().name(), 1, 2.0);
+		REQUIRE(!found.empty());
+		inlets.emplace_back(found[0], 300, false);
+		inlets.back().open_stream(.5);
+		members.push_back(&out);
+	}
+	lsl::outlet_group group(members);
+	const std::vector<float> data(nchan, 1.f);
+	const std::vector<const void *> buffers(n_outlets, data.data());
+
+	BENCHMARK("separate_outlets") {
+		for (std::size_t f = 0; f < frames; ++f) {
+			const double now = lsl::local_clock();
+			for (auto &out : outlets) out.push_sample(data.data(), now, f == frames - 1);
+		}
+		for (auto &inlet : inlets) inlet.flush();
+	};
+
+	BENCHMARK("outlet_group") {
+		for (std::size_t f = 0; f < frames; ++f) group.push(buffers, 0.0, f == frames - 1);
+		for (auto &inlet : inlets) inlet.flush();
+	};
+}
+
+TEST_CASE("strided push", "[strided][throughput]") {
+	const std::size_t nchan = 16, chunksize = 100;
+	struct record {
+		uint32_t status;
+		float channels[nchan];
+	};
+	// without consumers, this measures only the conversion into samples
+	lsl::stream_outlet out(lsl::stream_info("StridedBench", "Bench", (int)nchan, 1000.));
+	const std::vector<record> records(chunksize, record{0, {1.f}});
+	std::vector<float> staging(chunksize * nchan);
+
+	BENCHMARK("staging_copy") {
+		for (std::size_t i = 0; i < chunksize; ++i)
+			std::copy_n(records[i].channels, nchan, &staging[i * nchan]);
+		out.push_chunk_multiplexed(staging);
+	};
+	BENCHMARK("strided") {
+		out.push_chunk_strided(&records[0].channels[0], chunksize, sizeof(record));
+	};
+}
+
 TEMPLATE_TEST_CASE("stringconversion", "[basic][throughput]", int64_t, double) {
 	const auto nchan = 16u, chunksize = 100u, nitems = chunksize * nchan;
 	Streampair sp{create_streampair(lsl::stream_info("TypeConversionBench", "int2str2int",
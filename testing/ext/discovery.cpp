@@ -1,6 +1,9 @@
 #include <catch2/catch_all.hpp>
 #include <lsl_cpp.h>
+#include <chrono>
+#include <string>
 #include <thread>
+#include <vector>
 
 // clazy:excludeall=non-pod-global-static
 
@@ -20,6 +23,39 @@ TEST_CASE("resolve multiple streams", "[resolver][basic]") {
 	REQUIRE(resolver.results().size() == n);
 }
 
+TEST_CASE("resolve several predicates at once", "[resolver][basic]") {
+	std::vector<lsl::stream_outlet> outlets;
+	std::vector<std::string> preds;
+	const int n = 4;
+	for (int i = 0; i < n; i++) {
+		const std::string name = "multiresolve_" + std::to_string(i);
+		outlets.emplace_back(lsl::stream_info(name, "MultiResolve"));
+		preds.push_back("name='" + name + "'");
+	}
+	preds.emplace_back("type='MultiResolve'");
+
+	const auto start = std::chrono::steady_clock::now();
+	auto results = lsl::resolve_streams(preds, 1, 5.0);
+	// all queries are answered by the same waves, not one resolve after the other
+	CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+	REQUIRE(results.size() == preds.size());
+	for (int i = 0; i < n; i++) {
+		REQUIRE(results[i].size() == 1);
+		CHECK(results[i][0].name() == "multiresolve_" + std::to_string(i));
+	}
+	CHECK(!results[n].empty());
+}
+
+TEST_CASE("resolve several predicates with invalid arguments", "[resolver][basic]") {
+	lsl_streaminfo buffer[2];
+	int32_t counts[2];
+	const char *preds[] = {"name='a'", nullptr};
+	CHECK(lsl_resolve_bypreds(buffer, 2, counts, nullptr, 1, 1, 0.1) == lsl_argument_error);
+	CHECK(lsl_resolve_bypreds(buffer, 2, nullptr, preds, 1, 1, 0.1) == lsl_argument_error);
+	CHECK(lsl_resolve_bypreds(nullptr, 2, counts, preds, 1, 1, 0.1) == lsl_argument_error);
+	CHECK(lsl_resolve_bypreds(buffer, 2, counts, preds, 2, 1, 0.1) == lsl_argument_error);
+}
+
 TEST_CASE("resolve from streaminfo", "[resolver][streaminfo][basic]") {
 	lsl::stream_outlet outlet(lsl::stream_info("resolvetest", "from_streaminfo"));
 	lsl::stream_inlet(outlet.info());
@@ -0,0 +1,91 @@
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <lsl_cpp.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// clazy:excludeall=non-pod-global-static
+
+namespace {
+
+lsl::stream_inlet open_inlet(const std::string &name) {
+	auto found = lsl::resolve_stream("name", name, 1, 2.0);
+	if (found.empty()) throw std::runtime_error("outlet not found");
+	lsl::stream_inlet in(found[0]);
+	in.open_stream(2);
+	return in;
+}
+
+TEST_CASE("outlet groups", "[group][basic]") {
+	const int n = 100;
+	lsl::stream_outlet eeg(lsl::stream_info("GroupEEG", "EEG", 8, 500., lsl::cf_float32, "geeg")),
+		acc(lsl::stream_info("GroupAcc", "Accelerometer", 3, 500., lsl::cf_int16, "gacc")),
+		markers(lsl::stream_info(
+			"GroupMarkers", "Markers", 1, lsl::IRREGULAR_RATE, lsl::cf_string, "gmarkers"));
+	auto eeg_in = open_inlet("GroupEEG"), acc_in = open_inlet("GroupAcc"),
+		 markers_in = open_inlet("GroupMarkers");
+	for (auto *out : {&eeg, &acc, &markers}) REQUIRE(out->wait_for_consumers(2.));
+
+	lsl::outlet_group group({&eeg, &acc, &markers});
+	for (int i = 0; i < n; ++i) {
+		std::vector<float> eeg_values(8, static_cast<float>(i));
+		int16_t acc_values[3] = {static_cast<int16_t>(i), 0, static_cast<int16_t>(-i)};
+		const std::string marker = std::to_string(i);
+		const char *marker_values[] = {marker.c_str()};
+		// a marker every 10 frames, and only those frames are pushed through
+		const bool trigger = i % 10 == 9;
+		group.push({eeg_values.data(), acc_values, trigger ? marker_values : nullptr}, 0., trigger);
+	}
+
+	std::vector<double> eeg_timestamps;
+	for (int i = 0; i < n; ++i) {
+		float eeg_values[8];
+		int16_t acc_values[3];
+		eeg_timestamps.push_back(eeg_in.pull_sample(eeg_values, 8, 2.));
+		REQUIRE(eeg_timestamps.back() != 0.);
+		CHECK(eeg_values[7] == static_cast<float>(i));
+		// all samples of a frame have the same time stamp
+		CHECK(acc_in.pull_sample(acc_values, 3, 2.) == eeg_timestamps.back());
+		CHECK(acc_values[0] == i);
+		CHECK(acc_values[2] == -i);
+	}
+	for (int i = 9; i < n; i += 10) {
+		std::string marker;
+		CHECK(markers_in.pull_sample(&marker, 1, 2.) == eeg_timestamps[i]);
+		CHECK(marker == std::to_string(i));
+	}
+	CHECK(eeg.get_stats().samples_pushed == n);
+	CHECK(markers.get_stats().samples_pushed == n / 10);
+
+	// explicit time stamps
+	std::vector<float> eeg_values(8);
+	int16_t acc_values[3]{};
+	group.push({eeg_values.data(), acc_values, nullptr}, 1234.5);
+	CHECK(eeg_in.pull_sample(eeg_values.data(), 8, 2.) == 1234.5);
+	CHECK(acc_in.pull_sample(acc_values, 3, 2.) == 1234.5);
+
+	CHECK_THROWS_AS(group.push({eeg_values.data(), acc_values}), std::invalid_argument);
+	CHECK_THROWS_AS(lsl::outlet_group({&eeg, &acc, &eeg}), std::invalid_argument);
+}
+
+TEST_CASE("outlet groups push skipped outlets through", "[group][basic]") {
+	lsl::stream_outlet eeg(lsl::stream_info("GroupSkipEEG", "EEG", 2, 500., lsl::cf_float32, "gs1")),
+		acc(lsl::stream_info("GroupSkipAcc", "Accelerometer", 3, 500., lsl::cf_int16, "gs2"));
+	auto eeg_in = open_inlet("GroupSkipEEG"), acc_in = open_inlet("GroupSkipAcc");
+	for (auto *out : {&eeg, &acc}) REQUIRE(out->wait_for_consumers(2.));
+
+	lsl::outlet_group group({&eeg, &acc});
+	float eeg_values[2] = {1.f, 2.f};
+	int16_t acc_values[3] = {1, 2, 3};
+	group.push({eeg_values, acc_values}, 0., false);
+	// the accelerometer is skipped in the pushed through frame, but its kept back sample is
+	// sent right away anyway
+	group.push({eeg_values, nullptr}, 0., true);
+	CHECK(eeg_in.pull_sample(eeg_values, 2, 1.) != 0.);
+	CHECK(eeg_in.pull_sample(eeg_values, 2, 1.) != 0.);
+	CHECK(acc_in.pull_sample(acc_values, 3, 1.) != 0.);
+	CHECK(acc_values[2] == 3);
+}
+
+} // namespace
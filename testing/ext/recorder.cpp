@@ -0,0 +1,355 @@
+#include "../common/create_streampair.hpp"
+#include <catch2/catch_all.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <lsl_cpp.h>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// clazy:excludeall=non-pod-global-static
+
+namespace {
+
+struct xdf_chunk {
+	uint16_t tag;
+	uint32_t stream;
+	std::string content;
+};
+
+template <typename T> T read_le(const char *pos) {
+	T v;
+	std::memcpy(&v, pos, sizeof(T)); // the tests only run on little endian machines
+	return v;
+}
+
+uint64_t read_varlen(const char *&pos) {
+	const int bytes = *pos++;
+	uint64_t v = bytes == 1 ? read_le<uint8_t>(pos)
+						   : bytes == 4 ? read_le<uint32_t>(pos) : read_le<uint64_t>(pos);
+	pos += bytes;
+	return v;
+}
+
+/// Read the chunks of an XDF file (without the file header)
+std::vector<xdf_chunk> read_xdf(const std::string &filename) {
+	std::stringstream contents;
+	contents << std::ifstream(filename, std::ios::binary).rdbuf();
+	const std::string data = contents.str();
+	REQUIRE(data.compare(0, 4, "XDF:") == 0);
+	std::vector<xdf_chunk> chunks;
+	for (const char *pos = data.data() + 4, *end = data.data() + data.size(); pos < end;) {
+		const uint64_t len = read_varlen(pos);
+		xdf_chunk c{read_le<uint16_t>(pos), 0, std::string()};
+		std::size_t header = sizeof(uint16_t);
+		if (c.tag != 1) {
+			c.stream = read_le<uint32_t>(pos + header);
+			header += sizeof(uint32_t);
+		}
+		c.content.assign(pos + header, pos + len);
+		pos += len;
+		if (c.tag != 1) chunks.push_back(std::move(c));
+	}
+	return chunks;
+}
+
+TEST_CASE("recording outlets and inlets", "[recorder][basic]") {
+	const char *filename = "lsl_recorder_test.xdf";
+	const int nchans = 4, n = 500;
+	const double srate = 100.;
+	lsl::stream_outlet eeg(
+		lsl::stream_info("RecEEG", "EEG", nchans, srate, lsl::cf_float32, "receeg"));
+	auto markers = create_streampair(
+		lsl::stream_info("RecMarkers", "Markers", 1, lsl::IRREGULAR_RATE, lsl::cf_string, "recm"));
+	{
+		lsl::recorder rec(filename);
+		rec.add_outlet(eeg);
+		rec.add_inlet(markers.in_);
+
+		// the time stamp of a chunk is that of its last sample, the others are deduced
+		std::vector<float> chunk;
+		for (int i = 0; i < n * nchans; ++i) chunk.push_back(static_cast<float>(i));
+		eeg.push_chunk_multiplexed(chunk, 1000. + (n - 1) / srate);
+		for (const char *marker : {"a", "bb", "ccc"}) {
+			std::string str(marker);
+			markers.out_.push_sample(&str, 2000. + str.size());
+		}
+		// give the inlet's clock offset estimate some time
+		std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+		CHECK(rec.bytes_written() > 0);
+	}
+
+	std::map<uint32_t, std::string> headers, footers;
+	std::vector<float> values;
+	std::vector<double> eeg_timestamps, marker_timestamps;
+	std::vector<std::string> strings;
+	int clock_offsets = 0;
+	for (const auto &c : read_xdf(filename)) {
+		if (c.tag == 2) headers[c.stream] = c.content;
+		if (c.tag == 4) ++clock_offsets;
+		if (c.tag == 6) footers[c.stream] = c.content;
+		if (c.tag != 3) continue;
+		const bool is_eeg = headers[c.stream].find("RecEEG") != std::string::npos;
+		const char *pos = c.content.data();
+		for (uint64_t i = 0, count = read_varlen(pos); i < count; ++i) {
+			REQUIRE(*pos++ == 8);
+			(is_eeg ? eeg_timestamps : marker_timestamps).push_back(read_le<double>(pos));
+			pos += sizeof(double);
+			if (is_eeg) {
+				for (int ch = 0; ch < nchans; ++ch, pos += sizeof(float))
+					values.push_back(read_le<float>(pos));
+			} else {
+				const uint64_t len = read_varlen(pos);
+				strings.emplace_back(pos, len);
+				pos += len;
+			}
+		}
+		CHECK(pos == c.content.data() + c.content.size());
+	}
+	std::remove(filename);
+
+	REQUIRE(headers.size() == 2);
+	CHECK(footers.size() == 2);
+	REQUIRE(values.size() == n * nchans);
+	for (int i = 0; i < n * nchans; ++i) CHECK(values[i] == static_cast<float>(i));
+	for (int i = 0; i < n; ++i) CHECK(eeg_timestamps[i] == Catch::Approx(1000. + i / srate));
+	CHECK(strings == std::vector<std::string>{"a", "bb", "ccc"});
+	CHECK(marker_timestamps == std::vector<double>{2001., 2002., 2003.});
+	CHECK(clock_offsets >= 1);
+	for (const auto &footer : footers) {
+		const bool is_eeg = headers[footer.first].find("RecEEG") != std::string::npos;
+		CHECK(footer.second.find(is_eeg ? "<sample_count>500<" : "<sample_count>3<") !=
+			  std::string::npos);
+		CHECK(footer.second.find("<time_index><chunk><offset>") != std::string::npos);
+	}
+}
+
+TEST_CASE("recording deduced time stamps of an outlet", "[recorder]") {
+	const char *filename = "lsl_recorder_deduced.xdf";
+	const double srate = 100.;
+	lsl::stream_outlet out(
+		lsl::stream_info("RecDeduced", "EEG", 1, srate, lsl::cf_float32, "recdeduced"));
+	float value = 1.f;
+	out.push_sample(&value, 50.);
+	{
+		lsl::recorder rec(filename);
+		rec.add_outlet(out);
+		// the first samples' time stamps are deduced from a sample the recorder didn't see
+		out.push_sample(&value, lsl::DEDUCED_TIMESTAMP);
+		out.push_sample(&value, lsl::DEDUCED_TIMESTAMP);
+		out.push_sample(&value, 60.);
+		out.push_sample(&value, lsl::DEDUCED_TIMESTAMP);
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	}
+	std::vector<double> timestamps;
+	for (const auto &c : read_xdf(filename)) {
+		if (c.tag != 3) continue;
+		const char *pos = c.content.data();
+		for (uint64_t i = 0, count = read_varlen(pos); i < count; ++i) {
+			REQUIRE(*pos++ == 8);
+			timestamps.push_back(read_le<double>(pos));
+			pos += sizeof(double) + sizeof(float);
+		}
+	}
+	std::remove(filename);
+	REQUIRE(timestamps.size() == 4);
+	CHECK(timestamps[0] == Catch::Approx(59.98));
+	CHECK(timestamps[1] == Catch::Approx(59.99));
+	CHECK(timestamps[2] == 60.);
+	CHECK(timestamps[3] == Catch::Approx(60.01));
+}
+
+TEST_CASE("split recordings", "[recorder]") {
+	const char *filename = "lsl_recorder_split.xdf";
+	const int nchans = 4, n = 60000;
+	lsl::stream_outlet out(
+		lsl::stream_info("RecSplit", "EEG", nchans, 1000., lsl::cf_int32, "recsplit"));
+	{
+		lsl::recorder rec(filename, 1);
+		rec.add_outlet(out);
+		std::vector<int32_t> chunk(nchans * 1000);
+		for (int i = 0; i < n; i += 1000) out.push_chunk_multiplexed(chunk);
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	}
+	uint64_t samples = 0;
+	int files = 0;
+	for (const char *name : {filename, "lsl_recorder_split_1.xdf", "lsl_recorder_split_2.xdf"}) {
+		if (!std::ifstream(name)) continue;
+		++files;
+		bool header = false;
+		for (const auto &c : read_xdf(name)) {
+			// every file starts with the stream header
+			if (c.tag == 2) header = true;
+			if (c.tag != 3) continue;
+			CHECK(header);
+			const char *pos = c.content.data();
+			samples += read_varlen(pos);
+		}
+		std::remove(name);
+	}
+	CHECK(files >= 2);
+	CHECK(samples == n);
+}
+
+void write_chunk(std::ofstream &out, uint16_t tag, uint32_t stream, const std::string &content) {
+	const auto len = static_cast<uint32_t>(sizeof(tag) + sizeof(stream) + content.size());
+	out.put(4);
+	out.write(reinterpret_cast<const char *>(&len), sizeof(len));
+	out.write(reinterpret_cast<const char *>(&tag), sizeof(tag));
+	out.write(reinterpret_cast<const char *>(&stream), sizeof(stream));
+	out << content;
+}
+
+template <typename T> void append_le(std::string &out, T v) {
+	out.append(reinterpret_cast<const char *>(&v), sizeof(v));
+}
+
+TEST_CASE("replaying the time stamps of remote streams", "[recorder][replay]") {
+	const char *filename = "lsl_replay_offsets_test.xdf";
+	{
+		std::ofstream out(filename, std::ios::binary);
+		out << "XDF:";
+		write_chunk(out, 2, 1,
+			"<?xml version=\"1.0\"?><info><name>ReplayRemote</name><type>EEG</type>"
+			"<channel_count>1</channel_count><nominal_srate>0</nominal_srate>"
+			"<channel_format>double64</channel_format><source_id>replayremote</source_id>"
+			"<version>1.1</version><created_at>0</created_at><uid>replayremote</uid>"
+			"<session_id>default</session_id>"
+			"<v4data_port>0</v4data_port><v4service_port>0</v4service_port>"
+			"<v6data_port>0</v6data_port><v6service_port>0</v6service_port></info>");
+		std::string samples;
+		samples += '\1';
+		samples += '\4';
+		for (double t : {100., 101., 102., 103.}) {
+			samples += '\10';
+			append_le(samples, t);
+			append_le(samples, t);
+		}
+		write_chunk(out, 3, 1, samples);
+		// the remote clock is 10 s behind at 100 s and 12 s behind at 102 s, with a duplicate
+		// measurement in between
+		for (auto offset : {std::make_pair(100., 10.), std::make_pair(101., 11.),
+				 std::make_pair(101., 11.), std::make_pair(102., 12.)}) {
+			std::string content;
+			append_le(content, offset.first);
+			append_le(content, offset.second);
+			write_chunk(out, 4, 1, content);
+		}
+	}
+	{
+		lsl::replayer rep(filename, 10., true);
+		auto found = lsl::resolve_stream("name", "ReplayRemote", 1, 2.0);
+		REQUIRE(!found.empty());
+		lsl::stream_inlet inlet(found[0]);
+		inlet.open_stream(2);
+		// the outlet's session only starts queueing samples after it sent the feed header
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		rep.start();
+		REQUIRE(rep.wait(10));
+		// the offsets are interpolated between the measurements and held after the last one
+		for (double expected : {110., 112., 114., 115.}) {
+			double value;
+			CHECK(inlet.pull_sample(&value, 1, 2.0) == Catch::Approx(expected));
+		}
+	}
+	std::remove(filename);
+}
+
+TEST_CASE("replaying recordings", "[recorder][replay]") {
+	const char *filename = "lsl_replay_test.xdf";
+	const int n = 200;
+	const double srate = 100., speed = 4.;
+	{
+		lsl::stream_outlet eeg(
+			lsl::stream_info("ReplayEEG", "EEG", 2, srate, lsl::cf_float32, "replayeeg"));
+		lsl::stream_outlet markers(lsl::stream_info(
+			"ReplayMarkers", "Markers", 1, lsl::IRREGULAR_RATE, lsl::cf_string, "replaym"));
+		lsl::recorder rec(filename);
+		rec.add_outlet(eeg);
+		rec.add_outlet(markers);
+		std::vector<float> chunk;
+		for (int i = 0; i < n * 2; ++i) chunk.push_back(static_cast<float>(i));
+		eeg.push_chunk_multiplexed(chunk, 1000. + (n - 1) / srate);
+		for (double t : {1000.5, 1001.25}) {
+			std::string marker = std::to_string(t);
+			markers.push_sample(&marker, t);
+		}
+	}
+	const bool original_timestamps = GENERATE(false, true);
+	INFO("original time stamps: " << original_timestamps);
+	lsl::replayer rep(filename, speed, original_timestamps);
+	REQUIRE(rep.num_streams() == 2);
+	std::vector<lsl::stream_inlet> inlets;
+	for (const char *name : {"ReplayEEG", "ReplayMarkers"}) {
+		auto found = lsl::resolve_stream("name", name, 1, 2.0);
+		REQUIRE(!found.empty());
+		inlets.emplace_back(found[0]);
+		inlets.back().open_stream(2);
+	}
+	const double start = lsl::local_clock();
+	rep.start();
+	REQUIRE(rep.wait(10));
+	// the recording lasts 1.99 s
+	CHECK(lsl::local_clock() - start > 1.9 / speed);
+
+	std::vector<double> eeg_timestamps;
+	for (int i = 0; i < n; ++i) {
+		float sample[2];
+		eeg_timestamps.push_back(inlets[0].pull_sample(sample, 2, 2.0));
+		REQUIRE(eeg_timestamps.back() != 0.0);
+		CHECK(sample[0] == static_cast<float>(2 * i));
+		CHECK(sample[1] == static_cast<float>(2 * i + 1));
+	}
+	const double scale = original_timestamps ? 1. : 1. / speed;
+	if (original_timestamps) CHECK(eeg_timestamps[0] == Catch::Approx(1000.));
+	for (int i = 0; i < n; ++i)
+		CHECK(eeg_timestamps[i] - eeg_timestamps[0] == Catch::Approx(i / srate * scale));
+	for (double t : {1000.5, 1001.25}) {
+		std::string marker;
+		const double timestamp = inlets[1].pull_sample(&marker, 1, 2.0);
+		CHECK(marker == std::to_string(t));
+		CHECK(timestamp - eeg_timestamps[0] == Catch::Approx((t - 1000.) * scale));
+	}
+	inlets.clear();
+	std::remove(filename);
+}
+
+TEST_CASE("replaying record streams", "[recorder][replay][record]") {
+	const char *filename = "lsl_replay_record.xdf";
+	const std::vector<lsl::channel_format_t> formats{
+		lsl::cf_int16, lsl::cf_float32, lsl::cf_double64, lsl::cf_int8};
+	const std::vector<std::vector<double>> samples{{-2., 1.5, 1e100, -7.}, {3., -.25, -1., 100.}};
+	{
+		lsl::stream_outlet out(lsl::stream_info("ReplayRecord", "Mixed", formats, 10., "replayrec"));
+		lsl::recorder rec(filename);
+		rec.add_outlet(out);
+		for (std::size_t i = 0; i < samples.size(); ++i) out.push_sample(samples[i], 100. + i);
+	}
+	lsl::replayer rep(filename, 10., true);
+	REQUIRE(rep.num_streams() == 1);
+	auto found = lsl::resolve_stream("name", "ReplayRecord", 1, 2.0);
+	REQUIRE(!found.empty());
+	lsl::stream_inlet in(found[0]);
+	const lsl::stream_info info = in.info(2.0);
+	CHECK(info.channel_format() == lsl::cf_record);
+	REQUIRE(info.channel_count() == static_cast<int>(formats.size()));
+	for (int ch = 0; ch < info.channel_count(); ++ch) CHECK(info.channel_format(ch) == formats[ch]);
+	in.open_stream(2);
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	rep.start();
+	REQUIRE(rep.wait(10));
+
+	for (std::size_t i = 0; i < samples.size(); ++i) {
+		std::vector<double> sample(formats.size());
+		CHECK(in.pull_sample(sample, 2.0) == Catch::Approx(100. + i));
+		CHECK(sample == samples[i]);
+	}
+	std::remove(filename);
+}
+
+} // namespace
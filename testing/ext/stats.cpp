@@ -0,0 +1,128 @@
+#include "../common/create_streampair.hpp"
+#include <catch2/catch_all.hpp>
+#include <atomic>
+#include <chrono>
+#include <lsl_cpp.h>
+#include <thread>
+#include <vector>
+
+// clazy:excludeall=non-pod-global-static
+
+namespace {
+
+TEST_CASE("runtime statistics", "[stats][basic]") {
+	auto sp = create_streampair(
+		lsl::stream_info("stats", "Test", 4, lsl::IRREGULAR_RATE, lsl::cf_int16, "stats"));
+	const int16_t data[4] = {1, 2, 3, 4};
+	int16_t buf[4];
+	const int n = 10;
+	for (int i = 0; i < n; ++i) sp.out_.push_sample(data);
+	for (int i = 0; i < n; ++i) REQUIRE(sp.in_.pull_sample(buf, 4, 2.) != 0.);
+
+	// the sender updates its counters after the write completed, so give it a moment
+	lsl::outlet_stats out = sp.out_.get_stats();
+	for (int retry = 0; retry < 100 && out.samples_sent < n; ++retry) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		out = sp.out_.get_stats();
+	}
+	CHECK(out.samples_pushed == n);
+	CHECK(out.bytes_pushed == static_cast<int64_t>(n * sizeof(data)));
+	CHECK(out.samples_sent == n);
+	CHECK(out.chunks_written >= 1);
+	// each sample takes at least a timestamp tag and the payload on the wire
+	CHECK(out.bytes_sent >= static_cast<int64_t>(n * (1 + sizeof(data))));
+	CHECK(out.num_sessions == 1);
+	CHECK(out.samples_dropped == 0);
+	CHECK(out.max_write_latency >= out.avg_write_latency);
+
+	lsl::inlet_stats in = sp.in_.get_stats();
+	CHECK(in.samples_received == n);
+	CHECK(in.samples_dropped == 0);
+	CHECK(in.queue_depth == 0);
+	CHECK(in.reconnects == 0);
+	CHECK(in.handshake_time > 0.);
+	CHECK(in.time_correction_uncertainty == -1.);
+
+	sp.in_.time_correction(2.);
+	CHECK(sp.in_.get_stats().time_correction_uncertainty >= 0.);
+}
+
+TEST_CASE("adaptive inlet buffers", "[stats]") {
+	const double srate = 1000.;
+	const int n = 5000;
+	lsl::stream_outlet out(lsl::stream_info("adaptive", "Test", 1, srate, lsl::cf_int32, "adapt"));
+	auto found = lsl::resolve_stream("name", "adaptive", 1, 2.0);
+	REQUIRE(!found.empty());
+	lsl::stream_inlet fixed(found[0]), adaptive(found[0], 360, 0, true, transp_adaptive_buffer);
+	adaptive.open_stream(2);
+	out.wait_for_consumers(2);
+	CHECK(fixed.get_stats().queue_capacity == 360 * srate);
+	// the default minimum is one second
+	CHECK(adaptive.get_stats().queue_capacity == srate);
+
+	// samples that aren't pulled make the buffer grow instead of dropping the oldest ones
+	std::vector<int32_t> chunk(500);
+	for (int i = 0; i < n; i += 500) {
+		for (int j = 0; j < 500; ++j) chunk[j] = i + j;
+		out.push_chunk_multiplexed(chunk);
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+	lsl::inlet_stats stats = adaptive.get_stats();
+	for (int retry = 0; retry < 200 && stats.samples_received < n; ++retry) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		stats = adaptive.get_stats();
+	}
+	CHECK(stats.samples_received == n);
+	CHECK(stats.samples_dropped == 0);
+	CHECK(stats.queue_depth == n);
+	CHECK(stats.queue_capacity >= n);
+	CHECK(stats.queue_capacity <= 360 * srate);
+	for (int i = 0; i < n; ++i) {
+		int32_t value = -1;
+		REQUIRE(adaptive.pull_sample(&value, 1, 1.) != 0.);
+		CHECK(value == i);
+	}
+}
+
+TEST_CASE("adaptive inlet buffers keep the order while resizing", "[stats]") {
+	lsl::stream_outlet out(
+		lsl::stream_info("adaptive_order", "Test", 1, 1000., lsl::cf_int32, "adapt_order"));
+	auto found = lsl::resolve_stream("name", "adaptive_order", 1, 2.0);
+	REQUIRE(!found.empty());
+	lsl::stream_inlet in(found[0], 360, 0, true, transp_adaptive_buffer);
+	in.open_stream(2);
+	out.wait_for_consumers(2);
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	// two consumers pull while growing chunks make the buffer grow underneath them
+	std::atomic<int> pulled{0};
+	std::atomic<bool> ordered{true};
+	auto consume = [&]() {
+		double last = -1.;
+		int32_t value;
+		while (double ts = in.pull_sample(&value, 1, 1.)) {
+			if (ts <= last) ordered = false;
+			last = ts;
+			++pulled;
+		}
+	};
+	std::thread first(consume), second(consume);
+	int n = 0;
+	for (int size = 500; size <= 32000; size *= 2) {
+		std::vector<std::vector<int32_t>> chunk(size);
+		std::vector<double> stamps(size);
+		for (int j = 0; j < size; ++j, ++n) {
+			chunk[j] = {n};
+			stamps[j] = n + 1.;
+		}
+		out.push_chunk(chunk, stamps);
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+	first.join();
+	second.join();
+	CHECK(ordered);
+	// the outlet may drop some of the larger chunks, but the inlet loses none of its samples
+	CHECK(pulled == in.get_stats().samples_received);
+}
+
+} // namespace
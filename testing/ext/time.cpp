@@ -2,6 +2,8 @@
 #include <atomic>
 #include <catch2/catch_all.hpp>
 #include <lsl_cpp.h>
+#include <stdexcept>
+#include <string>
 #include <thread>
 
 // clazy:excludeall=non-pod-global-static
@@ -21,6 +23,42 @@ TEST_CASE("simple timesync", "[timesync][basic]") {
 	CHECK(remote_time < lsl::local_clock());
 }
 
+TEST_CASE("resuming the time correction state", "[timesync]") {
+	const double srate = 100.;
+	auto sp = create_streampair(
+		lsl::stream_info("warmstart", "Test", 1, srate, lsl::cf_float32, "warmstart"));
+	sp.in_.set_postprocessing(lsl::post_ALL);
+	float value = 0.f;
+	for (int i = 0; i < 200; ++i) sp.out_.push_sample(&value, 1000. + i / srate);
+	for (int i = 0; i < 200; ++i) REQUIRE(sp.in_.pull_sample(&value, 1, 2.) != 0.);
+	const std::string state = sp.in_.export_state();
+	CHECK(state.find(sp.in_.info().uid()) != std::string::npos);
+	CHECK(state.find("<dejitter ") != std::string::npos);
+
+	// a new inlet of the same stream doesn't have to wait for the first time correction
+	auto found = lsl::resolve_stream("name", "warmstart", 1, 2.);
+	REQUIRE(!found.empty());
+	lsl::stream_inlet restarted(found[0]);
+	restarted.set_postprocessing(lsl::post_ALL);
+	CHECK(restarted.import_state(state));
+	CHECK(restarted.time_correction(0.) == Catch::Approx(sp.in_.time_correction(1.)).margin(1e-3));
+	restarted.open_stream(2.);
+	for (int retry = 0; retry < 100 && sp.out_.get_stats().num_sessions < 2; ++retry)
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	sp.out_.push_sample(&value, 1000. + 300 / srate + 0.004);
+	const double timestamp = restarted.pull_sample(&value, 1, 2.);
+	CHECK(timestamp - sp.in_.time_correction(1.) ==
+		  Catch::Approx(1000. + 300 / srate).margin(0.002));
+
+	// states of other streams or restarted hosts are ignored
+	auto other = create_streampair(lsl::stream_info("warmstart2", "Test", 1, srate));
+	CHECK(!other.in_.import_state(state));
+	std::string rebooted(state);
+	const auto pos = rebooted.find(" boot_id=\"") + 10;
+	rebooted.insert(pos, "x");
+	CHECK(!restarted.import_state(rebooted));
+	CHECK_THROWS_AS(restarted.import_state("no xml"), std::invalid_argument);
+}
 
 TEST_CASE("timeouts", "[pull][basic]") {
 	auto sp = create_streampair(
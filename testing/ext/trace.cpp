@@ -0,0 +1,79 @@
+#include "../common/create_streampair.hpp"
+#include <catch2/catch_all.hpp>
+#include <cstdio>
+#include <fstream>
+#include <lsl_cpp.h>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// clazy:excludeall=non-pod-global-static
+
+namespace {
+
+/// The `timestamp` arguments of all events of the given stage in a Chrome trace
+std::multiset<std::string> traced_timestamps(const std::string &json, const std::string &stage) {
+	std::multiset<std::string> result;
+	const std::string name = "{\"name\":\"" + stage + "\"", key = "\"timestamp\":";
+	for (auto pos = json.find(name); pos != std::string::npos; pos = json.find(name, pos + 1)) {
+		const auto begin = json.find(key, pos) + key.size();
+		result.insert(json.substr(begin, json.find(',', begin) - begin));
+	}
+	return result;
+}
+
+/// Dump the recorded events to a file and read them back
+std::string dump_trace() {
+	const char *filename = "lsl_trace_test.json";
+	REQUIRE(lsl_trace_dump(filename) == lsl_no_error);
+	std::stringstream contents;
+	contents << std::ifstream(filename).rdbuf();
+	std::remove(filename);
+	return contents.str();
+}
+
+TEST_CASE("pipeline tracing", "[trace][basic]") {
+	auto sp = create_streampair(
+		lsl::stream_info("trace", "Test", 1, lsl::IRREGULAR_RATE, lsl::cf_int32, "trace"));
+	lsl_trace_enable(1);
+	int32_t val = 1;
+	for (int i = 0; i < 5; ++i) sp.out_.push_sample(&val, i + 1.);
+	for (int i = 0; i < 5; ++i) REQUIRE(sp.in_.pull_sample(&val, 1, 2.) != 0.);
+	lsl_trace_enable(0);
+
+	const std::string json = dump_trace();
+	CHECK(json.rfind("{\"displayTimeUnit\"", 0) == 0);
+	for (const char *stage : {"\"push\"", "\"fanout\"", "\"serialize\"", "\"socket_write\"",
+			 "\"receive_decode\"", "\"pull\""})
+		CHECK(json.find(stage) != std::string::npos);
+
+	lsl_trace_clear();
+	CHECK(dump_trace().find("\"push\"") == std::string::npos);
+}
+
+TEST_CASE("tracing chunks", "[trace][basic]") {
+	auto sp = create_streampair(
+		lsl::stream_info("trace_chunk", "Test", 1, 100., lsl::cf_int32, "trace_chunk"));
+	lsl_trace_clear();
+	// all but the first sample of the chunk have deduced time stamps on the outlet side
+	lsl_trace_enable(3);
+	std::vector<int32_t> chunk(30, 1);
+	sp.out_.push_chunk_multiplexed(chunk, 10.);
+	int32_t val;
+	for (std::size_t i = 0; i < chunk.size(); ++i) REQUIRE(sp.in_.pull_sample(&val, 1, 2.) != 0.);
+	lsl_trace_enable(0);
+
+	const std::string json = dump_trace();
+	lsl_trace_clear();
+	const auto pushed = traced_timestamps(json, "push"), pulled = traced_timestamps(json, "pull");
+	INFO(json);
+	CHECK(!pushed.empty());
+	CHECK(pushed.size() < chunk.size());
+	// the outlet and the inlet trace the same samples
+	CHECK(pushed == pulled);
+	CHECK(traced_timestamps(json, "queue_wait") == pulled);
+	CHECK(traced_timestamps(json, "receive_decode") == pulled);
+}
+
+} // namespace
@@ -0,0 +1,121 @@
+#include "impairment_proxy.hpp"
+#include "stream_info_impl.h"
+#include "stream_inlet_impl.h"
+#include "stream_outlet_impl.h"
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// clazy:excludeall=non-pod-global-static
+
+namespace {
+
+struct named_profile {
+	const char *name;
+	impairment_profile profile;
+};
+
+/// Pushes chunks of samples at a fixed rate until destroyed
+class pacer {
+public:
+	pacer(lsl::stream_outlet_impl &outlet, int chunk_samples, double interval)
+		: thread_([&outlet, chunk_samples, interval, this]() {
+			  const std::size_t nchans = outlet.info().channel_count();
+			  std::vector<float> chunk(nchans * chunk_samples, 1.f);
+			  auto next = std::chrono::steady_clock::now();
+			  while (!stop_) {
+				  outlet.push_chunk_multiplexed(chunk.data(), chunk.size());
+				  next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+					  std::chrono::duration<double>(interval));
+				  std::this_thread::sleep_until(next);
+			  }
+		  }) {}
+	~pacer() {
+		stop_ = true;
+		thread_.join();
+	}
+
+private:
+	std::atomic<bool> stop_{false};
+	std::thread thread_;
+};
+
+} // namespace
+
+// Measures latency, throughput and the recovery time after a dropped connection for an inlet
+// connected to its outlet via an impairment_proxy, for several network profiles.
+TEST_CASE("network impairment", "[impairment][latency]") {
+	const named_profile profiles[] = {
+		{"clean", {}},
+		{"lan", {0.0005, 0.0002}},
+		{"wifi", {0.003, 0.005, 2e6, 0.01}},
+		{"congested", {0.05, 0.01, 2e5, 0.05}},
+	};
+	const int nchans = 32;
+	const double srate = 10000.;
+	std::printf("%-10s | %9s %9s %9s | %12s %9s | %9s %10s\n", "profile", "lat_med", "lat_p95",
+		"lat_max", "throughput", "offered", "recovery", "reconnects");
+
+	for (const auto &p : profiles) {
+		lsl::stream_info_impl info("Impaired", "Bench", nchans, srate, cft_float32, "impaired");
+		lsl::stream_outlet_impl outlet(info);
+		impairment_proxy proxy(
+			outlet.info().v4data_port(), outlet.info().v4service_port(), p.profile);
+		lsl::stream_info_impl inlet_info(outlet.info());
+		inlet_info.v4address("127.0.0.1");
+		inlet_info.v4data_port(proxy.tcp_port());
+		inlet_info.v4service_port(proxy.udp_port());
+		lsl::stream_inlet_impl inlet(inlet_info);
+		inlet.open_stream(5.);
+		REQUIRE(outlet.wait_for_consumers(5.));
+
+		std::vector<float> sample(nchans, 0.f);
+		std::vector<float> buf(nchans * 1000);
+
+		// latency: single samples at 100 Hz
+		std::vector<double> latencies;
+		for (int i = 0; i < 100; ++i) {
+			outlet.push_sample(sample.data(), lsl::lsl_clock());
+			double ts = inlet.pull_sample(buf.data(), nchans, 5.);
+			REQUIRE(ts != 0.);
+			latencies.push_back(lsl::lsl_clock() - ts);
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		std::sort(latencies.begin(), latencies.end());
+
+		// recovery: drop the connection while samples keep coming in and wait for fresh data
+		double recovery;
+		{
+			pacer push(outlet, 1, 0.01);
+			inlet.pull_sample(buf.data(), nchans, 5.);
+			const double dropped = lsl::lsl_clock();
+			proxy.disconnect();
+			double ts;
+			do { ts = inlet.pull_sample(buf.data(), nchans, 30.); } while (ts && ts <= dropped);
+			REQUIRE(ts != 0.);
+			recovery = lsl::lsl_clock() - dropped;
+		}
+
+		// throughput: offer chunks at the nominal rate and count what arrives
+		const double duration = 3., offered = srate * nchans * sizeof(float);
+		uint64_t received = 0;
+		{
+			inlet.flush();
+			pacer push(outlet, 100, 100. / srate);
+			const double start = lsl::lsl_clock();
+			while (lsl::lsl_clock() < start + duration)
+				received +=
+					inlet.pull_chunk_multiplexed<float>(buf.data(), nullptr, buf.size(), 0, 0.1);
+		}
+		const double throughput = received * sizeof(float) / duration;
+
+		std::printf("%-10s | %7.2fms %7.2fms %7.2fms | %8.1fKB/s %5.0f%% | %8.3fs %10d\n", p.name,
+			latencies[latencies.size() / 2] * 1e3, latencies[latencies.size() * 95 / 100] * 1e3,
+			latencies.back() * 1e3, throughput / 1e3, 100. * throughput / offered, recovery,
+			inlet.get_stats().reconnects);
+	}
+}
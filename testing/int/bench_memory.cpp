@@ -0,0 +1,83 @@
+#include "stream_info_impl.h"
+#include "stream_inlet_impl.h"
+#include "stream_outlet_impl.h"
+#include "util/memstats.hpp"
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <thread>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+// clazy:excludeall=non-pod-global-static
+
+using lsl::memstats::component;
+
+/// The resident set size of the current process in bytes, or 0 if unsupported on this platform
+static int64_t current_rss() {
+#ifdef __linux__
+	std::ifstream statm("/proc/self/statm");
+	int64_t size = 0, resident = 0;
+	if (statm >> size >> resident) return resident * sysconf(_SC_PAGESIZE);
+#endif
+	return 0;
+}
+
+struct memsnapshot {
+	int64_t rss{current_rss()};
+	int64_t bytes[3]{lsl::memstats::bytes(component::factory),
+		lsl::memstats::bytes(component::consumer_queue),
+		lsl::memstats::bytes(component::stream_info)};
+
+	void report(const char *stage, const memsnapshot &base) const {
+		std::printf("  %-10s rss %+9.1f KiB | factory %+9.1f KiB | queues %+9.1f KiB | "
+					"stream_info %+6.1f KiB\n",
+			stage, (rss - base.rss) / 1024., (bytes[0] - base.bytes[0]) / 1024.,
+			(bytes[1] - base.bytes[1]) / 1024., (bytes[2] - base.bytes[2]) / 1024.);
+	}
+};
+
+struct streamconfig {
+	const char *name;
+	int channels;
+	double srate;
+	lsl_channel_format_t fmt;
+};
+
+// Reports the memory held by outlets / inlets for a few representative stream configurations.
+// The inlet- and outlet-side buffers are sized via the `tuning.OutletBufferReserveMs` and
+// `tuning.InletBufferReserveMs` settings, so run this with different configurations to compare.
+TEST_CASE("memory footprint", "[basic][memory]") {
+	const streamconfig configs[] = {{"EEG64", 64, 1000., cft_float32},
+		{"EEG256", 256, 2000., cft_float32}, {"Mocap", 8, 100., cft_double64},
+		{"Markers", 1, LSL_IRREGULAR_RATE, cft_string}};
+
+	for (const auto &cfg : configs) {
+		std::printf("%s: %d x %s @ %g Hz\n", cfg.name, cfg.channels,
+			cfg.fmt == cft_string ? "string" : cfg.fmt == cft_double64 ? "double" : "float",
+			cfg.srate);
+		const memsnapshot base;
+		{
+			lsl::stream_info_impl info(cfg.name, "MemBench", cfg.channels, cfg.srate, cfg.fmt, "");
+			auto outlet = std::make_unique<lsl::stream_outlet_impl>(info);
+			const memsnapshot with_outlet;
+			with_outlet.report("outlet", base);
+
+			lsl::stream_info_impl inlet_info(outlet->info());
+			inlet_info.v4address("127.0.0.1");
+			auto inlet = std::make_unique<lsl::stream_inlet_impl>(inlet_info);
+			inlet->open_stream(2.);
+			REQUIRE(outlet->wait_for_consumers(2.));
+			const memsnapshot with_inlet;
+			with_inlet.report("+inlet", with_outlet);
+
+			// the fullinfo message is a rough lower bound for the XML DOM held by each copy
+			std::printf("  %-10s %zu bytes\n", "xml", inlet_info.to_fullinfo_message().size());
+		}
+		// memory still held after teardown, e.g. by sessions whose threads haven't exited yet
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		memsnapshot().report("residual", base);
+	}
+}
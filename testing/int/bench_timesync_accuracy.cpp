@@ -0,0 +1,164 @@
+#include "impairment_proxy.hpp"
+#include "api_config.h"
+#include "inlet_connection.h"
+#include "stream_info_impl.h"
+#include "time_beacon.h"
+#include "time_postprocessor.h"
+#include "time_receiver.h"
+#include "udp_server.h"
+#include <asio/io_context.hpp>
+#include <asio/ip/host_name.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+// clazy:excludeall=non-pod-global-static
+
+using namespace asio::ip;
+
+namespace {
+
+/// A simulated clock of the outlet host: lsl_clock() with an offset, a drift and step changes
+struct simulated_clock {
+	/// constant offset to the local clock, in seconds
+	double offset;
+	/// clock drift relative to the local clock, in parts per million
+	double drift_ppm;
+	/// step changes (e.g. an NTP adjustment): seconds after start, step size in seconds
+	std::vector<std::pair<double, double>> steps;
+	double start{lsl::lsl_clock()};
+
+	/// The time of the simulated clock at the given local time
+	double at(double local) const {
+		double t = local + offset + (local - start) * drift_ppm * 1e-6;
+		for (const auto &step : steps)
+			if (local - start >= step.first) t += step.second;
+		return t;
+	}
+
+	double operator()() const { return at(lsl::lsl_clock()); }
+
+	/// The correct time correction value (i.e. local - remote) at the given local time
+	double true_correction(double local) const { return local - at(local); }
+};
+
+struct scenario {
+	const char *name;
+	double offset, drift_ppm;
+	std::vector<std::pair<double, double>> steps;
+	impairment_profile to_outlet, to_inlet;
+};
+
+struct error_stats {
+	double sum_abs{0}, max_abs{0};
+	int n{0};
+
+	void add(double err) {
+		sum_abs += std::abs(err);
+		max_abs = std::max(max_abs, std::abs(err));
+		++n;
+	}
+	double mean_abs() const { return n ? sum_abs / n : 0.; }
+};
+
+} // namespace
+
+// Measures the error of time_correction() and of the clock-synchronized and dejittered timestamps
+// (time_postprocessor with proc_ALL) for an outlet whose clock has an offset, drifts and jumps,
+// connected via a link with configurable delay and jitter.
+// All errors are relative to the ground truth of the simulated clock and reported in ms.
+// With `tuning.TimeBeaconInterval` set, the simulated host also sends time beacons (directly, not
+// via the impaired link) and the time correction is updated from them between the probe waves.
+TEST_CASE("timesync accuracy", "[timesync][latency]") {
+	const double duration = 8., report_interval = 0.5, srate = 100.;
+	const scenario scenarios[] = {
+		{"offset", 1000., 0., {}, {0.0002, 0.}, {0.0002, 0.}},
+		{"offset+drift", -500., 100., {}, {0.0002, 0.}, {0.0002, 0.}},
+		{"step", 20., 0., {{duration / 2, 0.010}}, {0.0002, 0.}, {0.0002, 0.}},
+		{"jitter", 20., 20., {}, {0.001, 0.002}, {0.001, 0.002}},
+		{"asymmetric", 20., 20., {}, {0.001, 0.}, {0.005, 0.}},
+	};
+
+	for (const auto &sc : scenarios) {
+		simulated_clock clock{sc.offset, sc.drift_ppm, sc.steps};
+
+		auto info =
+			std::make_shared<lsl::stream_info_impl>("Sync", "sync", 1, srate, cft_float32, "sync");
+		asio::io_context ctx;
+		auto server = std::make_shared<lsl::udp_server>(info, ctx, udp::v4());
+		server->set_clock([&clock]() { return clock(); });
+		server->begin_serving();
+		std::thread iothread([&ctx]() { ctx.run(); });
+
+		const double beacon_interval = lsl::api_config::get_instance()->time_beacon_interval();
+		std::unique_ptr<lsl::time_beacon> beacon;
+		if (beacon_interval > 0)
+			beacon = std::make_unique<lsl::time_beacon>(
+				beacon_interval, [&clock]() { return clock(); });
+
+		impairment_proxy proxy(0, info->v4service_port());
+		proxy.set_profile(sc.to_outlet, sc.to_inlet);
+		lsl::stream_info_impl inlet_info(*info);
+		inlet_info.v4address("127.0.0.1");
+		inlet_info.hostname(asio::ip::host_name());
+		inlet_info.v4service_port(proxy.udp_port());
+		// only the time service is used, but the connection needs a complete endpoint
+		inlet_info.v4data_port(1);
+		lsl::inlet_connection conn(inlet_info, false);
+		lsl::time_receiver receiver(conn);
+
+		// samples are captured at regular local times and stamped by the simulated clock, with
+		// some acquisition jitter
+		std::mt19937 rng(1);
+		std::uniform_real_distribution<double> stamp_jitter(-0.001, 0.001);
+		lsl::time_postprocessor pp([&receiver]() { return receiver.time_correction(5.); },
+			[srate]() { return srate; }, [&receiver]() { return receiver.was_reset(); });
+		pp.set_options(proc_ALL);
+
+		std::printf("%s: offset %g s, drift %g ppm, link %.1f+%.1f / %.1f+%.1f ms%s\n", sc.name,
+			sc.offset, sc.drift_ppm, sc.to_outlet.latency * 1e3, sc.to_outlet.jitter * 1e3,
+			sc.to_inlet.latency * 1e3, sc.to_inlet.jitter * 1e3, beacon ? ", beacons" : "");
+		std::printf("  %6s %12s %12s %12s\n", "t", "corr_err", "uncertainty", "stamp_err");
+
+		const double start = lsl::lsl_clock();
+		// the first correction is only available after a full probe wave
+		REQUIRE_NOTHROW(receiver.time_correction(5.));
+		error_stats corr_stats, stamp_stats;
+		uint64_t k = 0;
+		for (double next = lsl::lsl_clock() + report_interval; next < start + duration;
+			 next += report_interval) {
+			std::this_thread::sleep_until(std::chrono::steady_clock::now() +
+										  std::chrono::duration<double>(next - lsl::lsl_clock()));
+			const double now = lsl::lsl_clock();
+
+			error_stats interval_stamp_stats;
+			for (double t = start + k / srate; t <= now; t = start + ++k / srate) {
+				const double remote_stamp = clock.at(t) + stamp_jitter(rng);
+				const double err = pp.process_timestamp(remote_stamp) - t;
+				interval_stamp_stats.add(err);
+				// skip the dejitterer's warmup
+				if (t - start > 2.) stamp_stats.add(err);
+			}
+
+			double remote_time, uncertainty;
+			const double correction = receiver.time_correction(&remote_time, &uncertainty, 5.);
+			const double corr_err = correction - clock.true_correction(now);
+			corr_stats.add(corr_err);
+			std::printf("  %6.2f %12.3f %12.3f %12.3f\n", now - start, corr_err * 1e3,
+				uncertainty * 1e3, interval_stamp_stats.max_abs * 1e3);
+		}
+		std::printf("  correction error: mean %.3f ms, max %.3f ms; timestamp error (after 2 s): "
+					"mean %.3f ms, max %.3f ms\n",
+			corr_stats.mean_abs() * 1e3, corr_stats.max_abs * 1e3, stamp_stats.mean_abs() * 1e3,
+			stamp_stats.max_abs * 1e3);
+
+		server->end_serving();
+		ctx.stop();
+		iothread.join();
+	}
+}
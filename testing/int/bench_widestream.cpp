@@ -0,0 +1,65 @@
+#include "api_config.h"
+#include "stream_info_impl.h"
+#include "stream_inlet_impl.h"
+#include "stream_outlet_impl.h"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// clazy:excludeall=non-pod-global-static
+
+// Measures the end-to-end throughput of a single very wide, high-rate stream.
+// The inlet decodes in a separate thread if the stream's data rate exceeds
+// `tuning.InletDecodeThreadThreshold` and the outlet serializes chunks with
+// `tuning.SessionEncodeThreads` additional threads, so run this with different configurations to
+// compare.
+TEST_CASE("wide stream throughput", "[widestream][throughput]") {
+	const int nchans = 4096, chunk_samples = 30;
+	const double srate = 30000., duration = 3.;
+	const auto *cfg = lsl::api_config::get_instance();
+	const double threshold = cfg->inlet_decode_thread_threshold();
+	std::printf("%d channels @ %g Hz, decode thread %s, %d encode threads\n", nchans, srate,
+		threshold > 0 && srate * nchans * sizeof(float) >= threshold ? "on" : "off",
+		cfg->session_encode_threads());
+
+	lsl::stream_info_impl info("Wide", "Bench", nchans, srate, cft_float32, "widestream");
+	lsl::stream_outlet_impl outlet(info, 0, 10);
+	lsl::stream_info_impl inlet_info(outlet.info());
+	inlet_info.v4address("127.0.0.1");
+	lsl::stream_inlet_impl inlet(inlet_info, 10);
+	inlet.open_stream(5.);
+	REQUIRE(outlet.wait_for_consumers(5.));
+
+	std::atomic<bool> stop{false};
+	std::atomic<uint64_t> pushed{0};
+	std::thread pusher([&]() {
+		std::vector<float> chunk(static_cast<std::size_t>(nchans) * chunk_samples);
+		while (!stop) {
+			// all channels change in every sample, so change masks can't shrink the data
+			for (std::size_t i = 0; i < chunk.size(); ++i)
+				chunk[i] = static_cast<float>(i + pushed);
+			outlet.push_chunk_multiplexed(chunk.data(), chunk.size());
+			pushed += chunk_samples;
+		}
+	});
+
+	// the samples are only counted and discarded, so pulling doesn't limit the throughput
+	const int64_t received_before = inlet.get_stats().samples_received;
+	const double start = lsl::lsl_clock();
+	while (lsl::lsl_clock() < start + duration) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		inlet.flush();
+	}
+	const double elapsed = lsl::lsl_clock() - start;
+	const int64_t received = inlet.get_stats().samples_received - received_before;
+	stop = true;
+	pusher.join();
+
+	const double mbytes = received * nchans * sizeof(float) / elapsed / 1e6;
+	std::printf("  received %.0f samples/s (%.1f MB/s, %.1fx real time), pushed %.0f samples/s\n",
+		received / elapsed, mbytes, received / elapsed / srate, pushed / elapsed);
+	CHECK(received > 0);
+}
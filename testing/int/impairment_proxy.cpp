@@ -0,0 +1,228 @@
+#include "impairment_proxy.hpp"
+#include <algorithm>
+#include <asio/post.hpp>
+#include <asio/steady_timer.hpp>
+#include <asio/write.hpp>
+#include <deque>
+#include <vector>
+
+using namespace asio::ip;
+using err_t = const asio::error_code &;
+
+namespace {
+/// Maximum number of bytes buffered per TCP direction, similar to a TCP window
+const std::size_t max_in_flight = 1 << 20;
+
+std::chrono::steady_clock::duration to_duration(double seconds) {
+	return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::duration<double>(seconds));
+}
+} // namespace
+
+/// A proxied TCP connection, kept alive by its two pipes
+class impairment_proxy::tcp_connection {
+public:
+	explicit tcp_connection(asio::io_context &ctx) : client(ctx), server(ctx) {}
+
+	void close() {
+		asio::error_code ec;
+		client.close(ec);
+		server.close(ec);
+	}
+
+	tcp::socket client, server;
+};
+
+/// One direction of a proxied TCP connection
+class impairment_proxy::pipe : public std::enable_shared_from_this<impairment_proxy::pipe> {
+public:
+	pipe(impairment_proxy &proxy, std::shared_ptr<tcp_connection> conn, bool from_target)
+		: proxy_(proxy), conn_(std::move(conn)), from_target_(from_target),
+		  from_(from_target ? conn_->server : conn_->client),
+		  to_(from_target ? conn_->client : conn_->server), timer_(proxy.ctx_),
+		  link_free_(std::chrono::steady_clock::now()), last_due_(link_free_) {}
+
+	void read() {
+		from_.async_read_some(
+			asio::buffer(buf_), [self = shared_from_this()](err_t err, std::size_t len) {
+				self->handle_read(err, len);
+			});
+	}
+
+private:
+	struct packet {
+		std::vector<char> data;
+		time_point due;
+	};
+
+	void handle_read(err_t err, std::size_t len) {
+		if (err) {
+			eof_ = true;
+			if (!writing_) finish();
+			return;
+		}
+		// TCP delivers in order, so a packet can't overtake (e.g. a retransmitted) predecessor
+		last_due_ = std::max(last_due_, proxy_.due_time(from_target_, len, link_free_, true));
+		queue_.push_back({std::vector<char>(buf_, buf_ + len), last_due_});
+		queued_ += len;
+		if (!writing_) write();
+		if (queued_ < max_in_flight)
+			read();
+		else
+			paused_ = true;
+	}
+
+	void write() {
+		if (queue_.empty()) {
+			writing_ = false;
+			if (eof_) finish();
+			return;
+		}
+		writing_ = true;
+		timer_.expires_at(queue_.front().due);
+		timer_.async_wait([self = shared_from_this()](err_t err) {
+			if (err) return;
+			asio::async_write(self->to_, asio::buffer(self->queue_.front().data),
+				[self](err_t err, std::size_t len) {
+					if (err) {
+						self->conn_->close();
+						return;
+					}
+					self->queued_ -= len;
+					self->queue_.pop_front();
+					if (self->paused_ && self->queued_ < max_in_flight) {
+						self->paused_ = false;
+						self->read();
+					}
+					self->write();
+				});
+		});
+	}
+
+	/// Forward the end of the stream (or the connection loss) to the other end
+	void finish() {
+		asio::error_code ec;
+		to_.shutdown(tcp::socket::shutdown_send, ec);
+		if (ec) conn_->close();
+	}
+
+	impairment_proxy &proxy_;
+	std::shared_ptr<tcp_connection> conn_;
+	const bool from_target_;
+	tcp::socket &from_, &to_;
+	asio::steady_timer timer_;
+	time_point link_free_, last_due_;
+	std::deque<packet> queue_;
+	std::size_t queued_{0};
+	bool writing_{false}, paused_{false}, eof_{false};
+	char buf_[16384];
+};
+
+impairment_proxy::impairment_proxy(
+	uint16_t tcp_target_port, uint16_t udp_target_port, impairment_profile profile)
+	: acceptor_(ctx_), tcp_target_(address_v4::loopback(), tcp_target_port), udp_sock_(ctx_),
+	  udp_target_(address_v4::loopback(), udp_target_port), profile_{profile, profile} {
+	udp_free_[0] = udp_free_[1] = std::chrono::steady_clock::now();
+	if (tcp_target_port) {
+		acceptor_.open(tcp::v4());
+		acceptor_.bind(tcp::endpoint(address_v4::loopback(), 0));
+		acceptor_.listen();
+		accept();
+	}
+	if (udp_target_port) {
+		udp_sock_.open(udp::v4());
+		udp_sock_.bind(udp::endpoint(address_v4::loopback(), 0));
+		receive_udp();
+	}
+	thread_ = std::thread([this]() { ctx_.run(); });
+}
+
+impairment_proxy::~impairment_proxy() {
+	ctx_.stop();
+	thread_.join();
+}
+
+void impairment_proxy::set_profile(
+	const impairment_profile &to_target, const impairment_profile &from_target) {
+	std::lock_guard<std::mutex> lock(profile_mut_);
+	profile_[0] = to_target;
+	profile_[1] = from_target;
+}
+
+void impairment_proxy::disconnect() {
+	asio::post(ctx_, [this]() {
+		for (auto &weak_conn : tcp_connections_)
+			if (auto conn = weak_conn.lock()) conn->close();
+		tcp_connections_.clear();
+	});
+}
+
+void impairment_proxy::refuse_connections(bool refuse) {
+	asio::post(ctx_, [this, refuse]() { refuse_ = refuse; });
+}
+
+impairment_proxy::time_point impairment_proxy::due_time(
+	bool from_target, std::size_t len, time_point &link_free, bool tcp) {
+	std::lock_guard<std::mutex> lock(profile_mut_);
+	const impairment_profile &profile = profile_[from_target];
+	const auto now = std::chrono::steady_clock::now();
+	double delay = profile.latency;
+	if (profile.jitter > 0)
+		delay += std::exponential_distribution<double>(1. / profile.jitter)(rng_);
+	if (profile.loss > 0 && std::bernoulli_distribution(profile.loss)(rng_)) {
+		if (!tcp) return time_point::max();
+		delay += profile.retransmit_timeout;
+	}
+	if (!tcp && profile.reorder > 0 && std::bernoulli_distribution(profile.reorder)(rng_))
+		delay += profile.reorder_delay;
+	// the packet is sent as soon as the link has finished sending the previous packets
+	time_point sent = std::max(now, link_free);
+	if (profile.bandwidth > 0) sent += to_duration(len / profile.bandwidth);
+	link_free = sent;
+	return sent + to_duration(delay);
+}
+
+void impairment_proxy::accept() {
+	auto conn = std::make_shared<tcp_connection>(ctx_);
+	acceptor_.async_accept(conn->client, [this, conn](err_t err) {
+		if (err == asio::error::operation_aborted) return;
+		if (!err && !refuse_) {
+			++connections_;
+			asio::error_code ec;
+			conn->server.connect(tcp_target_, ec);
+			if (!ec) {
+				conn->client.set_option(tcp::no_delay(true), ec);
+				conn->server.set_option(tcp::no_delay(true), ec);
+				tcp_connections_.remove_if(
+					[](const std::weak_ptr<tcp_connection> &c) { return c.expired(); });
+				tcp_connections_.push_back(conn);
+				std::make_shared<pipe>(*this, conn, false)->read();
+				std::make_shared<pipe>(*this, conn, true)->read();
+			}
+		}
+		accept();
+	});
+}
+
+void impairment_proxy::receive_udp() {
+	udp_sock_.async_receive_from(
+		asio::buffer(udp_buf_), udp_sender_, [this](err_t err, std::size_t len) {
+			if (err == asio::error::operation_aborted) return;
+			if (!err) {
+				const bool from_target = udp_sender_ == udp_target_;
+				if (!from_target) udp_peer_ = udp_sender_;
+				const time_point due = due_time(from_target, len, udp_free_[from_target], false);
+				if (due != time_point::max()) {
+					auto msg = std::make_shared<std::vector<char>>(udp_buf_, udp_buf_ + len);
+					auto timer = std::make_shared<asio::steady_timer>(ctx_, due);
+					udp::endpoint dest = from_target ? udp_peer_ : udp_target_;
+					timer->async_wait([this, msg, timer, dest](err_t err) {
+						if (err) return;
+						asio::error_code ec;
+						udp_sock_.send_to(asio::buffer(*msg), dest, 0, ec);
+					});
+				}
+			}
+			receive_udp();
+		});
+}
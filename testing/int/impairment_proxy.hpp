@@ -0,0 +1,106 @@
+#pragma once
+
+#include <asio/io_context.hpp>
+#include <asio/ip/tcp.hpp>
+#include <asio/ip/udp.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+/**
+ * Network conditions to simulate, per direction.
+ *
+ * TCP streams keep their byte order, so for TCP a packet is whatever a single read returned,
+ * a lost packet stalls the whole stream for `retransmit_timeout` (like a TCP retransmission) and
+ * reordering doesn't apply.
+ */
+struct impairment_profile {
+	/// constant one-way delay, in seconds
+	double latency{0};
+	/// mean of the exponentially distributed additional delay (queueing jitter), in seconds
+	double jitter{0};
+	/// maximum throughput, in bytes per second (0: unlimited)
+	double bandwidth{0};
+	/// probability that a packet is lost
+	double loss{0};
+	/// probability that a UDP datagram is held back by an additional `reorder_delay`
+	double reorder{0};
+	double reorder_delay{0.01};
+	/// delay of a lost TCP segment until it's delivered
+	double retransmit_timeout{0.2};
+};
+
+/**
+ * A loopback proxy for an outlet's TCP data port and UDP service port that impairs the traffic.
+ *
+ * Point an inlet at the proxy by setting the `v4data_port` / `v4service_port` of its
+ * stream_info to tcp_port() / udp_port(). Since the inlet still sees the outlet's UID, its
+ * recovery logic reconnects through the proxy after disconnect().
+ *
+ * UDP datagrams from the target are sent back to the last peer that sent something to the proxy.
+ */
+class impairment_proxy {
+public:
+	/// Create a proxy for the given target ports on 127.0.0.1 (0: don't proxy this protocol)
+	impairment_proxy(uint16_t tcp_target_port, uint16_t udp_target_port,
+		impairment_profile profile = impairment_profile());
+	~impairment_proxy();
+
+	uint16_t tcp_port() const { return acceptor_.local_endpoint().port(); }
+	uint16_t udp_port() const { return udp_sock_.local_endpoint().port(); }
+
+	/// Change the network conditions for all traffic from now on
+	void set_profile(const impairment_profile &profile) { set_profile(profile, profile); }
+
+	/// Change the network conditions separately for traffic to and from the target
+	void set_profile(const impairment_profile &to_target, const impairment_profile &from_target);
+
+	/// Drop all proxied TCP connections, new connections are still accepted
+	void disconnect();
+
+	/// Close TCP connections immediately after accepting them (simulates an outage)
+	void refuse_connections(bool refuse);
+
+	/// Number of TCP connections accepted so far
+	int connections() const { return connections_; }
+
+private:
+	class tcp_connection;
+	class pipe;
+
+	using time_point = std::chrono::steady_clock::time_point;
+
+	/**
+	 * Decide when a packet of the given size that is sent now arrives at the receiving end.
+	 * @param from_target The direction: 0 for packets to the target, 1 for packets from it.
+	 * @param link_free When the link is available for the next packet in this direction; updated.
+	 * @return The arrival time or time_point::max() if a UDP datagram is lost.
+	 */
+	time_point due_time(bool from_target, std::size_t len, time_point &link_free, bool tcp);
+	void accept();
+	void receive_udp();
+
+	asio::io_context ctx_;
+	asio::ip::tcp::acceptor acceptor_;
+	asio::ip::tcp::endpoint tcp_target_;
+	asio::ip::udp::socket udp_sock_;
+	asio::ip::udp::endpoint udp_target_, udp_peer_, udp_sender_;
+	/// when the simulated link is available for the next UDP datagram, per direction
+	time_point udp_free_[2];
+	char udp_buf_[65536];
+
+	/// protects the profiles and the random number generator
+	std::mutex profile_mut_;
+	/// the network conditions for packets to / from the target
+	impairment_profile profile_[2];
+	std::mt19937 rng_{42};
+	std::list<std::weak_ptr<tcp_connection>> tcp_connections_;
+	bool refuse_{false};
+	std::atomic<int> connections_{0};
+	std::thread thread_;
+};
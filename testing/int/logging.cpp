@@ -0,0 +1,54 @@
+#include "../src/logging.h"
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+// Include loguru before catch
+#include <catch2/catch_test_macros.hpp>
+
+// clazy:excludeall=non-pod-global-static
+
+namespace {
+struct captured_messages {
+	std::mutex mut;
+	std::vector<std::string> messages;
+};
+
+void capture(void *user_data, const loguru::Message &message) {
+	// other tests' background threads may log at the same time
+	if (std::string(message.message).compare(0, 10, "[log_test]") != 0) return;
+	auto &captured = *static_cast<captured_messages *>(user_data);
+	std::lock_guard<std::mutex> lock(captured.mut);
+	captured.messages.emplace_back(message.message);
+}
+} // namespace
+
+TEST_CASE("asynchronous logging", "[logging][basic]") {
+	captured_messages captured;
+	loguru::add_callback("lsl_test", capture, &captured, loguru::Verbosity_INFO);
+	std::thread([]() {
+		loguru::set_thread_name("log_test");
+		for (int i = 0; i < 25; ++i) LSL_LOG_F(INFO, "message %d", i);
+	}).join();
+	// the ring of the exited thread is still written
+	lsl::logging::flush();
+	loguru::remove_callback("lsl_test");
+
+	// the call site is rate limited
+	REQUIRE(captured.messages.size() == lsl::logging::rate_limit::burst);
+	CHECK(captured.messages.front() == "[log_test] message 0");
+	CHECK(captured.messages.back() == "[log_test] message 9");
+}
+
+TEST_CASE("log rate limit", "[logging][basic]") {
+	lsl::logging::rate_limit limit;
+	uint32_t suppressed = 0;
+	for (uint32_t i = 0; i < lsl::logging::rate_limit::burst; ++i) REQUIRE(limit.admit(suppressed));
+	CHECK(suppressed == 0);
+	for (int i = 0; i < 3; ++i) REQUIRE_FALSE(limit.admit(suppressed));
+
+	std::this_thread::sleep_for(std::chrono::nanoseconds(lsl::logging::rate_limit::window_ns));
+	REQUIRE(limit.admit(suppressed));
+	CHECK(suppressed == 3);
+}
@@ -1,4 +1,11 @@
+#include "../src/api_config.h"
 #include "../src/cancellable_streambuf.h"
+#include "../src/inlet_connection.h"
+#include "../src/stream_info_impl.h"
+#include "../src/stream_outlet_impl.h"
+#include "../src/time_beacon.h"
+#include "../src/time_receiver.h"
+#include "../src/util/handler_memory.hpp"
 #include <asio/io_context.hpp>
 #include <asio/ip/multicast.hpp>
 #include <asio/ip/tcp.hpp>
@@ -7,15 +14,19 @@
 #include <asio/read.hpp>
 #include <asio/use_future.hpp>
 #include <asio/write.hpp>
+#include <atomic>
 #include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_approx.hpp>
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/generators/catch_generators.hpp>
 #include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <future>
 #include <iostream>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 // clazy:excludeall=non-pod-global-static
 
@@ -132,6 +143,103 @@ TEST_CASE("unconnected streambufs don't crash", "[streambuf][basic][network]") {
 	lsl::cancellable_streambuf().cancel();
 }
 
+TEST_CASE("streambuf connects to the first reachable endpoint", "[streambuf][network]") {
+	asio::io_context io_ctx;
+	ip::tcp::endpoint ep(ip::address_v4::loopback(), port++);
+	ip::tcp::acceptor remote(io_ctx, ep, true);
+	remote.listen(1);
+	// a refused port and an unroutable address (TEST-NET-1) before the listening endpoint
+	std::vector<ip::tcp::endpoint> endpoints{{ip::address_v4::loopback(), 1},
+		{ip::make_address("192.0.2.1"), ep.port()}, ep};
+	lsl::cancellable_streambuf sb;
+	REQUIRE(sb.connect(endpoints, 0.05) != nullptr);
+	CHECK(sb.remote_endpoint() == ep);
+
+	lsl::cancellable_streambuf sb_empty;
+	CHECK(sb_empty.connect(std::vector<ip::tcp::endpoint>()) == nullptr);
+	CHECK(sb_empty.error() == asio::error::host_not_found);
+}
+
+TEST_CASE("streambuf connects after a refused endpoint", "[streambuf][network]") {
+	asio::io_context io_ctx;
+	ip::tcp::endpoint ep(ip::address_v4::loopback(), port++);
+	ip::tcp::acceptor remote(io_ctx, ep, true);
+	remote.listen(1);
+	// the refused attempt starts the next one right away, long before the attempt delay
+	std::vector<ip::tcp::endpoint> endpoints{{ip::address_v4::loopback(), 1}, ep};
+	lsl::cancellable_streambuf sb;
+	REQUIRE(sb.connect(endpoints, 5.) != nullptr);
+	CHECK(sb.remote_endpoint() == ep);
+
+	// reading runs the streambuf's io_context, so handlers of the connect() must be done
+	ip::tcp::socket sock(remote.accept());
+	REQUIRE(sock.send(asio::buffer(hello, 3)) == 3);
+	char buf[3];
+	REQUIRE(sb.read_some(buf, sizeof(buf)) == 3);
+	CHECK(std::string(buf, 3) == hellostr.substr(0, 3));
+}
+
+TEST_CASE("time beacon messages", "[network][basic]") {
+	const std::string msg = lsl::time_beacon::message("labpc", 12345.678901234, "lab session");
+	std::string hostname, session_id;
+	double timestamp;
+	REQUIRE(lsl::time_beacon::parse(msg.data(), msg.size(), hostname, timestamp, session_id));
+	CHECK(hostname == "labpc");
+	CHECK(timestamp == 12345.678901234);
+	CHECK(session_id == "lab session");
+
+	const std::string timedata("LSL:timedata\r\n1 2\r\n");
+	CHECK_FALSE(lsl::time_beacon::parse(
+		timedata.data(), timedata.size(), hostname, timestamp, session_id));
+	CHECK_FALSE(
+		lsl::time_beacon::parse(msg.data(), msg.size() - 20, hostname, timestamp, session_id));
+}
+
+TEST_CASE("time beacons update the time correction", "[network][timesync]") {
+	const lsl::api_config *cfg = lsl::api_config::get_instance();
+	lsl::stream_outlet_impl outlet(
+		lsl::stream_info_impl("BeaconTest", "Test", 1, lsl::IRREGULAR_RATE, cft_float32, ""));
+	lsl::stream_info_impl info(outlet.info());
+	info.v4address("127.0.0.1");
+	lsl::inlet_connection conn(info, false);
+	conn.engage();
+
+	// a simulated beacon sender on the outlet host whose clock can be shifted
+	std::atomic<double> shift{0.};
+	lsl::time_beacon sender(0.02, [&shift]() { return lsl::lsl_clock() + shift; });
+	{
+		lsl::time_receiver receiver(conn, true);
+		// the first estimate is probed and calibrates the beacons' delay
+		CHECK(receiver.time_correction(5.) == Catch::Approx(0.).margin(0.01));
+
+		// beacons of the same host name in another session must not move the estimate
+		io_context io_ctx;
+		ip::udp::socket foreign(io_ctx, ip::udp::v4());
+		const ip::udp::endpoint listener(ip::address_v4::loopback(), cfg->time_beacon_port());
+		auto send_foreign = [&]() {
+			const std::string msg = lsl::time_beacon::message(
+				conn.current_hostname(), lsl::lsl_clock() + 5., "foreign" + cfg->session_id());
+			foreign.send_to(asio::buffer(msg), listener);
+		};
+
+		// the outlet still answers probes with the unshifted clock, so only the beacons can
+		// explain a time correction that follows the shift; the uncertainty is back to normal
+		// once the beacons from before the shift are forgotten
+		shift = 1.;
+		double offset = 0., uncertainty = 1.;
+		const double deadline = lsl::lsl_clock() + 4 * cfg->time_update_interval() + 1.;
+		while (lsl::lsl_clock() < deadline) {
+			send_foreign();
+			REQUIRE(receiver.last_time_correction(offset, uncertainty));
+			if (offset == Catch::Approx(-1.).margin(0.01) && uncertainty < 0.01) break;
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		}
+		CHECK(offset == Catch::Approx(-1.).margin(0.01));
+		CHECK(uncertainty < 0.01);
+	}
+	conn.disengage();
+}
+
 TEST_CASE("cancel streambuf reads", "[streambuf][network][!mayfail]") {
 	asio::io_context io_ctx;
 	lsl::cancellable_streambuf sb_read;
@@ -302,6 +410,45 @@ TEST_CASE("bindzero", "[network][basic]") {
 	REQUIRE(sock.local_endpoint().port() != 0);
 }
 
+TEST_CASE("recycled handler memory", "[network][basic]") {
+	auto memory = std::make_shared<lsl::handler_memory>();
+	void *first = memory->allocate(100), *second = memory->allocate(100);
+	// only one operation at a time gets the recycled block
+	CHECK(first != second);
+	memory->deallocate(second);
+	memory->deallocate(first);
+	CHECK(memory->allocate(200) == first);
+	void *large = memory->allocate(1 << 16);
+	CHECK(large != first);
+	memory->deallocate(large);
+
+	// the memory stays alive until the handler returns it
+	std::weak_ptr<lsl::handler_memory> weak(memory);
+	lsl::handler_memory *raw = memory.get();
+	memory.reset();
+	CHECK(!weak.expired());
+	raw->deallocate(first);
+	CHECK(weak.expired());
+
+	// a chain of asio operations where each handler starts the next one
+	io_context ctx;
+	ip::udp::socket sock(ctx, ip::udp::endpoint(ip::address_v4::loopback(), 0));
+	const auto ep = sock.local_endpoint();
+	memory = std::make_shared<lsl::handler_memory>();
+	int received = 0;
+	char buf[sizeof(hello)];
+	std::function<void()> next = [&]() {
+		sock.send_to(hellobuf(), ep);
+		sock.async_receive(asio::buffer(buf), lsl::recycle_memory(*memory, [&](err_t err, size_t) {
+			REQUIRE(!err);
+			if (++received < 5) next();
+		}));
+	};
+	next();
+	ctx.run();
+	CHECK(received == 5);
+}
+
 #ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
 
 TEST_CASE("streambuf throughput", "[streambuf][network]") {
@@ -79,3 +79,31 @@ TEST_CASE("rls_smoothing", "[basic]") {
 	CHECK(fabs(pp.w0_ - latency) < .1);
 	CHECK(fabs(pp.w1_ - 1 / srate) < 1e-6);
 }
+
+TEST_CASE("resuming the dejitter state", "[basic]") {
+	const double t0 = 5000, latency = 0.05, srate = 100.;
+	lsl::postproc_dejitterer saved(t0, srate, 90);
+	std::default_random_engine rng;
+	std::normal_distribution<double> jitter(latency, .005);
+	for (int i = 0; i < 20000; ++i) saved.dejitter(t0 + i / srate + jitter(rng));
+
+	auto no_offset = []() { return 0.; };
+	auto get_srate = [&]() { return srate; };
+	auto no_reset = []() { return false; };
+	lsl::time_postprocessor fresh(no_offset, get_srate, no_reset),
+		resumed(no_offset, get_srate, no_reset);
+	fresh.set_options(proc_dejitter);
+	resumed.set_options(proc_dejitter);
+	resumed.set_state(saved, 0.);
+
+	// after a gap of 500 samples, the resumed state continues the regression line
+	const double t = t0 + 20500 / srate, outlier = t + latency + .004;
+	CHECK(fresh.process_timestamp(outlier) == Catch::Approx(outlier));
+	CHECK(std::fabs(resumed.process_timestamp(outlier) - t - latency) < .001);
+	CHECK(std::fabs(resumed.process_timestamp(t + 1 / srate + latency) - t - latency - 1 / srate) <
+		  .001);
+
+	double offset = -1;
+	CHECK(resumed.get_state(offset).samples_since_t0_ == 20502);
+	CHECK(offset == 0.);
+}
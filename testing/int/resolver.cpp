@@ -0,0 +1,84 @@
+#include "../src/api_config.h"
+#include "../src/resolver_impl.h"
+#include "../src/stream_info_impl.h"
+#include "../src/stream_outlet_impl.h"
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// clazy:excludeall=non-pod-global-static
+
+namespace {
+
+/// Poll the cache until the lookup returns `expected` or the timeout expires
+bool cached_within(lsl::resolver_impl &cache, const std::string &query, int minimum,
+	bool expected, double timeout) {
+	std::vector<lsl::stream_info_impl> result;
+	const auto deadline =
+		std::chrono::steady_clock::now() + std::chrono::duration<double>(timeout);
+	while (lsl::resolver_impl::resolve_cached(cache, query, minimum, result) != expected) {
+		if (std::chrono::steady_clock::now() > deadline) return false;
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+	return true;
+}
+
+std::unique_ptr<lsl::stream_outlet_impl> outlet(const std::string &name, const std::string &type) {
+	return std::make_unique<lsl::stream_outlet_impl>(
+		lsl::stream_info_impl(name, type, 1, lsl::IRREGULAR_RATE, cft_float32, name));
+}
+
+TEST_CASE("discovery cache", "[resolver][network]") {
+	const double ttl = 1.5;
+	const std::string type = "CacheTest" + std::to_string(std::random_device()());
+	// the process-wide cache follows all streams, this one only those of the test
+	std::unique_ptr<lsl::resolver_impl> cache(
+		lsl::resolver_impl::create_resolver(ttl, "type", type.c_str()));
+	REQUIRE(cache);
+	const std::string query_a = lsl::resolver_impl::build_query("name", "CacheA"),
+					  query_b = lsl::resolver_impl::build_query("name", "CacheB"),
+					  query_type = lsl::resolver_impl::build_query("type", type.c_str());
+	std::vector<lsl::stream_info_impl> result;
+
+	auto a = outlet("CacheA", type);
+	REQUIRE(cached_within(*cache, query_a, 1, true, 5.));
+
+	// a stream that was closed is still served from the cache within the TTL
+	a.reset();
+	const auto closed = std::chrono::steady_clock::now();
+	CHECK(lsl::resolver_impl::resolve_cached(*cache, query_a, 1, result));
+	REQUIRE(result.size() == 1);
+	CHECK(result[0].name() == "CacheA");
+
+	// and forgotten once it hasn't answered for longer than the TTL
+	REQUIRE(cached_within(*cache, query_a, 1, false, ttl + 5.));
+	const std::chrono::duration<double> forgotten_after = std::chrono::steady_clock::now() - closed;
+	// the last answer came at most one resolve interval before the outlet was closed
+	CHECK(forgotten_after.count() > ttl - 1.);
+	CHECK_FALSE(lsl::resolver_impl::resolve_cached(*cache, query_type, 1, result));
+	CHECK(result.empty());
+
+	// a stream that appears after the expiry is picked up by the next resolve wave
+	auto b = outlet("CacheB", type);
+	REQUIRE(cached_within(*cache, query_b, 1, true, 5.));
+	CHECK(lsl::resolver_impl::resolve_cached(*cache, query_type, 1, result));
+	CHECK(result.size() == 1);
+
+	// too few cached streams fail the lookup, so the caller has to resolve them on the network
+	auto c = outlet("CacheC", "Other" + type);
+	const std::string query_c = lsl::resolver_impl::build_query("name", "CacheC");
+	CHECK_FALSE(lsl::resolver_impl::resolve_cached(*cache, query_b, 2, result));
+	CHECK(result.size() == 1);
+	CHECK_FALSE(lsl::resolver_impl::resolve_cached(*cache, query_c, 1, result));
+	CHECK(lsl::resolver_impl().resolve_oneshot(query_c, 1, 5.).size() == 1);
+
+	// without tuning.DiscoveryCacheTTL, the process-wide cache always defers to the network
+	if (lsl::api_config::get_instance()->discovery_cache_ttl() <= 0)
+		CHECK_FALSE(lsl::resolver_impl::resolve_cached(query_b, 1, result));
+}
+
+} // namespace
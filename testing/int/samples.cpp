@@ -1,7 +1,14 @@
 #include "../src/consumer_queue.h"
 #include "../src/sample.h"
+#include "../src/sample_codec.h"
+#include "../src/sample_filter.h"
+#include "../src/send_buffer.h"
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cmath>
 #include <catch2/catch_all.hpp>
+#include <sstream>
 #include <thread>
 
 // clazy:excludeall=non-pod-global-static
@@ -25,6 +32,43 @@ TEST_CASE("consumer_queue", "[queue][basic]") {
 	CHECK(queue.empty());
 }
 
+TEST_CASE("consumer_queue resizing", "[queue][basic]") {
+	lsl::factory fac(lsl_channel_format_t::cft_int8, 4, 16);
+	auto buffer = std::make_shared<lsl::send_buffer>(100);
+	auto queue = buffer->new_consumer(10);
+	for (int i = 0; i < 8; ++i) buffer->push_sample(fac.new_sample(i, true));
+
+	// shrinking keeps twice the queued samples
+	buffer->resize_consumer(queue, 4);
+	for (int i = 0; i < 8; ++i) CHECK(queue->pop_sample(0.0)->timestamp() == i);
+	for (int i = 0; i < 30; ++i) buffer->push_sample(fac.new_sample(i, true));
+	CHECK(queue->read_available() == 16);
+	CHECK(queue->dropped() == 14);
+
+	// the replaced queue doesn't receive samples anymore
+	auto old = queue;
+	buffer->resize_consumer(queue, 50);
+	CHECK(old != queue);
+	buffer->push_sample(fac.new_sample(30, true));
+	CHECK(old->empty());
+	CHECK(queue->read_available() == 17);
+	int32_t consumers, depth;
+	uint64_t dropped;
+	buffer->consumer_stats(consumers, depth, dropped);
+	CHECK(consumers == 1);
+	CHECK(dropped == 14);
+
+	// closing a queue wakes up waiting consumers
+	lsl::consumer_queue closed(4);
+	std::thread closer([&]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		closed.close();
+	});
+	CHECK(!closed.pop_sample(lsl::FOREVER));
+	CHECK(closed.closed());
+	closer.join();
+}
+
 TEST_CASE("consumer_queue_threaded", "[queue][threads]") {
 	const unsigned int size = 100000;
 	lsl::factory fac(lsl_channel_format_t::cft_int8, 4, 1);
@@ -72,3 +116,278 @@ TEST_CASE("sample conversion", "[basic]") {
 		values[1] = (double)(-buf[0]);
 	}
 }
+
+TEST_CASE("sample filter", "[basic][filter]") {
+	lsl::factory strfac(cft_string, 2, 1);
+	auto marker = strfac.new_sample(0.0, true);
+	auto with_markers = [&](std::string a, std::string b) -> const lsl::sample & {
+		std::string values[] = {std::move(a), std::move(b)};
+		marker->assign_typed(values);
+		return *marker;
+	};
+	lsl::sample_filter quoted("ch1 == 'a | b' | ch0 ^= \"x&\"", cft_string, 2);
+	CHECK(quoted.matches(with_markers("", "a | b")));
+	CHECK(quoted.matches(with_markers("x&y", "")));
+	CHECK_FALSE(quoted.matches(with_markers("x", "a")));
+	// unquoted values may contain non-ASCII bytes
+	lsl::sample_filter utf8("ch0 == caf\xc3\xa9", cft_string, 2);
+	CHECK(utf8.matches(with_markers("caf\xc3\xa9", "")));
+	CHECK_FALSE(utf8.matches(with_markers("cafe", "")));
+
+	lsl::factory numfac(cft_double64, 2, 1);
+	auto sample = numfac.new_sample(0.0, true);
+	auto with_values = [&](double a, double b) -> const lsl::sample & {
+		double values[] = {a, b};
+		sample->assign_typed(values);
+		return *sample;
+	};
+	lsl::sample_filter range("ch1 > 0.5 & ch1 <= 1 | == -1e3", cft_double64, 2);
+	CHECK(range.matches(with_values(0, 1)));
+	CHECK(range.matches(with_values(-1000, 0)));
+	CHECK_FALSE(range.matches(with_values(0, 0.5)));
+
+	for (const char *invalid :
+		{"", "ch0", "ch2 == 1", "ch0 ^= 1", "== 1 |", "< 'a", "== 1\n| == 2"})
+		CHECK_THROWS_AS(lsl::sample_filter(invalid, cft_double64, 2), std::invalid_argument);
+	CHECK_THROWS_AS(lsl::sample_filter("< 'a'", cft_string, 2), std::invalid_argument);
+}
+
+TEST_CASE("sample load_buffer", "[basic][serialization]") {
+	for (auto fmt : {cft_float32, cft_int16, cft_string}) {
+		lsl::factory fac(fmt, 3, 4);
+		// serialize two samples (transmitted and deduced timestamp) with the streambuf code path
+		std::stringbuf sb;
+		auto first = fac.new_sample(0., false), second = fac.new_sample(0., false);
+		first->assign_test_pattern(4);
+		second->assign_test_pattern(2);
+		second->timestamp() = lsl::DEDUCED_TIMESTAMP;
+		char scratch[64];
+		for (bool reverse : {false, true}) {
+			sb.str(std::string());
+			first->save_streambuf(sb, 110, reverse, scratch);
+			second->save_streambuf(sb, 110, reverse, scratch);
+			const std::string wire = sb.str();
+			const char *begin = wire.data(), *end = begin + wire.size();
+
+			auto loaded = fac.new_sample(0., false);
+			const char *next = loaded->load_buffer(begin, end, reverse, false);
+			REQUIRE(next != nullptr);
+			CHECK(*loaded == *first);
+			// every truncated buffer is reported as incomplete
+			for (const char *trunc = next; trunc < end; ++trunc)
+				CHECK(loaded->load_buffer(next, trunc, reverse, false) == nullptr);
+			CHECK(loaded->load_buffer(next, end, reverse, false) == end);
+			CHECK(*loaded == *second);
+		}
+	}
+}
+
+TEST_CASE("sample save_buffer", "[basic][serialization]") {
+	for (auto fmt : {cft_float32, cft_double64, cft_int16, cft_int8}) {
+		lsl::factory fac(fmt, 5, 4);
+		auto samp = fac.new_sample(0., false);
+		samp->assign_test_pattern(4);
+		char scratch[64];
+		for (double ts : {1234.5, lsl::DEDUCED_TIMESTAMP}) {
+			samp->timestamp() = ts;
+			for (bool reverse : {false, true}) {
+				std::stringbuf sb;
+				samp->save_streambuf(sb, 110, reverse, scratch);
+				const std::string expected = sb.str();
+				REQUIRE(samp->serialized_size() == expected.size());
+				// serializing the channels in separate ranges gives the same result
+				std::string out(expected.size(), '\0');
+				samp->save_buffer(&out[0], reverse, 2, 5);
+				samp->save_buffer(&out[0], reverse, 0, 2);
+				CHECK(out == expected);
+			}
+		}
+	}
+}
+
+TEST_CASE("sample change masks", "[basic][serialization]") {
+	for (auto fmt : {cft_float32, cft_double64, cft_int16, cft_int8}) {
+		INFO(fmt);
+		const uint32_t nchans = 20;
+		lsl::factory fac(fmt, nchans, 4);
+		auto first = fac.new_sample(0., false), second = fac.new_sample(0., false),
+			 third = fac.new_sample(0., false);
+		first->assign_test_pattern(4);
+		second->assign_test_pattern(4);
+		third->assign_test_pattern(2);
+		// change two channels, one of them past the first mask byte
+		double values[nchans];
+		second->retrieve_typed(values);
+		values[3] = 5;
+		values[17] = -7;
+		second->assign_typed(values);
+		second->timestamp() = lsl::DEDUCED_TIMESTAMP;
+		char scratch[nchans * 8];
+		for (bool reverse : {false, true}) {
+			std::stringbuf sb;
+			first->save_changes(sb, nullptr, reverse, scratch);
+			const std::size_t full_size = sb.str().size();
+			CHECK(full_size == first->serialized_size());
+			second->save_changes(sb, first.get(), reverse, scratch);
+			const std::size_t masked_size = sb.str().size() - full_size;
+			CHECK(masked_size == 1 + 3 + 2 * std::size_t{lsl::format_sizes[fmt]});
+			// all channels differ, so the sample is sent completely
+			third->save_changes(sb, second.get(), reverse, scratch);
+			CHECK(sb.str().size() - full_size - masked_size == third->serialized_size());
+
+			const std::string wire = sb.str();
+			const char *pos = wire.data(), *end = pos + wire.size();
+			auto loaded = fac.new_sample(0., false), previous = fac.new_sample(0., false);
+			pos = previous->load_buffer(pos, end, reverse, false);
+			REQUIRE(pos != nullptr);
+			CHECK(*previous == *first);
+			// a change mask sample needs a reference
+			CHECK_THROWS(loaded->load_buffer(pos, end, reverse, false));
+			// truncated buffers are reported as incomplete and leave the reference's values intact
+			for (const char *trunc = pos; trunc < pos + masked_size; ++trunc)
+				CHECK(previous->load_buffer(pos, trunc, reverse, false, previous.get()) == nullptr);
+			previous->timestamp() = first->timestamp();
+			CHECK(*previous == *first);
+			// the sample can be decoded in place of its reference
+			pos = previous->load_buffer(pos, end, reverse, false, previous.get());
+			REQUIRE(pos != nullptr);
+			CHECK(*previous == *second);
+			CHECK(loaded->load_buffer(pos, end, reverse, false, previous.get()) == end);
+			CHECK(*loaded == *third);
+		}
+	}
+}
+
+TEST_CASE("record samples", "[basic][serialization][record]") {
+	auto layout = std::make_shared<const lsl::record_layout>(std::vector<lsl_channel_format_t>{
+		cft_int16, cft_float32, cft_int8, cft_double64, cft_int32});
+	const uint32_t nchans = 5;
+	CHECK(layout->size() == 19);
+	CHECK(layout->offset(3) == 7);
+	lsl::factory fac(cft_record, nchans, 4, layout);
+	auto first = fac.new_sample(0., false), second = fac.new_sample(0., false);
+	first->assign_test_pattern(4);
+	// typed values are converted to each channel's format
+	const double values[nchans] = {-300., 0.5, 100., 1e-300, 70000.};
+	second->assign_typed(values);
+	double retrieved[nchans];
+	second->retrieve_typed(retrieved);
+	for (uint32_t ch = 0; ch < nchans; ++ch) CHECK(retrieved[ch] == values[ch]);
+	int16_t narrow[nchans];
+	second->retrieve_typed(narrow);
+	CHECK(narrow[4] == static_cast<int16_t>(70000));
+
+	char scratch[64];
+	for (bool reverse : {false, true}) {
+		std::stringbuf sb;
+		first->save_changes(sb, nullptr, reverse, scratch);
+		CHECK(sb.str().size() == first->serialized_size());
+		// two changed channels are sent with their own sizes
+		const std::size_t full_size = sb.str().size();
+		second->timestamp() = lsl::DEDUCED_TIMESTAMP;
+		auto changed = fac.new_sample(0., false);
+		changed->timestamp() = lsl::DEDUCED_TIMESTAMP;
+		double typed[nchans];
+		first->retrieve_typed(typed);
+		typed[1] = 2.5;
+		typed[3] = -1.;
+		changed->assign_typed(typed);
+		changed->save_changes(sb, first.get(), reverse, scratch);
+		CHECK(sb.str().size() - full_size == 1 + 1 + 4 + 8);
+
+		const std::string wire = sb.str();
+		const char *pos = wire.data(), *end = pos + wire.size();
+		auto loaded = fac.new_sample(0., false);
+		pos = loaded->load_buffer(pos, end, reverse, false);
+		REQUIRE(pos != nullptr);
+		CHECK(*loaded == *first);
+		CHECK(loaded->load_buffer(pos, end, reverse, false, loaded.get()) == end);
+		CHECK(*loaded == *changed);
+	}
+}
+
+TEST_CASE("sample codecs", "[basic][serialization]") {
+	CHECK(lsl::select_codec(cft_string, 4, false, false) == nullptr);
+	CHECK(lsl::select_codec(cft_record, 4, false, false) == nullptr);
+	for (auto fmt : {cft_float32, cft_double64, cft_int8, cft_int16, cft_int32, cft_int64}) {
+		for (uint32_t nchans : {1u, 3u, lsl::max_unrolled_channels, 9u, 40u}) {
+			lsl::factory fac(fmt, nchans, 4);
+			auto samp = fac.new_sample(1234.5, false), loaded = fac.new_sample(0., false);
+			samp->assign_test_pattern(4);
+			const std::size_t width = lsl::format_sizes[fmt], size = width * nchans;
+			std::vector<char> scratch(size);
+			for (bool reverse : {false, true}) {
+				INFO("format " << fmt << ", " << nchans << " channels, reverse: " << reverse);
+				const lsl::sample_codec *codec = lsl::select_codec(fmt, nchans, reverse, true);
+				REQUIRE(codec != nullptr);
+				CHECK(codec->value_size == width);
+				std::stringbuf sb;
+				samp->save_streambuf(sb, *codec, scratch.data());
+				const std::string wire = sb.str();
+				REQUIRE(wire.size() == samp->serialized_size());
+				// the values are the sample's bytes, each in the requested byte order
+				samp->retrieve_untyped(scratch.data());
+				for (std::size_t pos = 0; reverse && pos < size; pos += width)
+					std::reverse(scratch.begin() + pos, scratch.begin() + pos + width);
+				CHECK(wire.compare(9, size, scratch.data(), size) == 0);
+				// each codec gives the same result as the generic code
+				std::stringbuf generic;
+				samp->save_streambuf(generic, 110, reverse, scratch.data());
+				CHECK(generic.str() == wire);
+				std::string buffer(wire.size(), '\0');
+				samp->save_buffer(&buffer[0], *codec, 0, nchans / 2);
+				samp->save_buffer(&buffer[0], *codec, nchans / 2, nchans);
+				CHECK(buffer == wire);
+
+				CHECK(loaded->load_buffer(wire.data(), wire.data() + wire.size(), *codec) ==
+					  wire.data() + wire.size());
+				CHECK(*loaded == *samp);
+				CHECK(loaded->load_buffer(wire.data(), wire.data() + wire.size() - 1, *codec) ==
+					  nullptr);
+			}
+		}
+	}
+
+	// subnormal values are flushed to zero while decoding if requested
+	lsl::factory fac(cft_float32, 3, 4);
+	auto samp = fac.new_sample(lsl::DEDUCED_TIMESTAMP, false);
+	const float values[] = {1e-40f, -1e-40f, 1.f};
+	samp->assign_typed(values);
+	char scratch[3 * sizeof(float)];
+	for (bool reverse : {false, true}) {
+		std::stringbuf sb;
+		samp->save_streambuf(sb, *lsl::select_codec(cft_float32, 3, reverse, false), scratch);
+		const std::string wire = sb.str();
+		for (bool suppress : {false, true}) {
+			auto loaded = fac.new_sample(0., false);
+			REQUIRE(loaded->load_buffer(wire.data(), wire.data() + wire.size(),
+						*lsl::select_codec(cft_float32, 3, reverse, suppress)) != nullptr);
+			float received[3];
+			loaded->retrieve_typed(received);
+			CHECK(received[0] == (suppress ? 0.f : values[0]));
+			CHECK(std::signbit(received[1]));
+			CHECK(received[2] == 1.f);
+		}
+	}
+
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+	for (uint32_t nchans : {8u, 64u}) {
+		lsl::factory benchfac(cft_float32, nchans, 4);
+		auto src = benchfac.new_sample(1.0, false), dst = benchfac.new_sample(0., false);
+		src->assign_test_pattern(4);
+		for (bool reverse : {false, true}) {
+			const lsl::sample_codec &codec = *lsl::select_codec(cft_float32, nchans, reverse, true);
+			std::string wire(src->serialized_size(), '\0');
+			const std::string suffix =
+				std::to_string(nchans) + " channels" + (reverse ? ", reversed" : "");
+			BENCHMARK("encode " + suffix) {
+				src->save_buffer(&wire[0], codec, 0, nchans);
+				return wire[1];
+			};
+			BENCHMARK("decode " + suffix) {
+				return dst->load_buffer(wire.data(), wire.data() + wire.size(), codec);
+			};
+		}
+	}
+#endif
+}
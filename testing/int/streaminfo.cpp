@@ -30,6 +30,41 @@ TEST_CASE("uid", "[basic][streaminfo]") {
 	REQUIRE(uid != info.reset_uid());
 }
 
+TEST_CASE("binary shortinfo", "[basic][streaminfo]") {
+	lsl::stream_info_impl info("streamname", "streamtype", 8, 500.25, cft_int16, "sourceid");
+	info.reset_uid();
+	info.created_at(1234.5678);
+	info.hostname("host");
+	info.boot_id("bootid");
+	info.v4address("127.0.0.1");
+	info.v4data_port(16572);
+	info.v6service_port(16573);
+	info.desc().append_child("channels");
+
+	const std::string msg = info.to_binary_shortinfo_message();
+	INFO(info.to_shortinfo_message());
+	REQUIRE(msg.size() < info.to_shortinfo_message().size() / 4);
+
+	lsl::stream_info_impl binary, xml;
+	binary.from_shortinfo_message(msg);
+	xml.from_shortinfo_message(info.to_shortinfo_message());
+	CHECK(binary.name() == "streamname");
+	CHECK(binary.nominal_srate() == 500.25);
+	CHECK(binary.channel_format() == cft_int16);
+	CHECK(binary.v6service_port() == 16573);
+	CHECK(binary.boot_id() == "bootid");
+	// both formats result in the same stream_info (without the description)
+	CHECK(binary.to_shortinfo_message() == xml.to_shortinfo_message());
+	CHECK(binary.matches_query("name='streamname' and channel_count=8"));
+
+	// truncated messages result in an invalid stream_info
+	for (std::size_t len = 4; len < msg.size(); len += 7) {
+		lsl::stream_info_impl truncated;
+		truncated.from_shortinfo_message(msg.substr(0, len));
+		CHECK(truncated.name().find("(invalid: ") == 0);
+	}
+}
+
 TEST_CASE("streaminfo matching via XPath", "[basic][streaminfo][xml]") {
 	lsl::stream_info_impl info(
 		"streamname", "streamtype", 8, 500, lsl_channel_format_t::cft_string, "sourceid");
@@ -27,8 +27,8 @@ public:
 	tcp_server_wrapper(std::shared_ptr<lsl::stream_info_impl> info) {
 		auto sendbuf = std::make_shared<lsl::send_buffer>(10);
 		srv_ctx = std::make_shared<asio::io_context>(1);
-		auto factory =
-			std::make_shared<lsl::factory>(info->channel_format(), info->channel_count(), 10);
+		auto factory = std::make_shared<lsl::factory>(
+			info->channel_format(), info->channel_count(), 10, info->record_layout());
 		srv = std::make_shared<lsl::tcp_server>(info, srv_ctx, sendbuf, factory, 5, true, true);
 		srv->begin_serving();
 	}
@@ -207,3 +207,32 @@ TEST_CASE("tcpserver_float", "[network]") {
 	tcp_server.run();
 	ctx.run();
 }
+
+TEST_CASE("tcpserver_record", "[network][record]") {
+	asio::io_context ctx(1);
+
+	auto info = std::make_shared<lsl::stream_info_impl>("TCP_rec", "",
+		std::vector<lsl_channel_format_t>{cft_int16, cft_float32}, 4., "abc123");
+	tcp_server_wrapper tcp_server(info);
+	tcp::endpoint ep(address_v4(0x7f000001), info->v4data_port());
+
+	send_request(ctx, ep, asio::buffer("LSL:streamfeed/110 \n\r\n\r\n"),
+		with_read_callback("record", [](const std::string &res) {
+			REQUIRE(res.substr(0, 14) == "LSL/110 200 OK");
+			REQUIRE(res.find("Data-Protocol-Version: 110") != std::string::npos);
+		}));
+
+	// record samples can't be sent when the data protocol falls back to 1.00
+	send_request(ctx, ep, asio::buffer("LSL:streamfeed\n0 0\r\n"),
+		with_read_callback("record 100", [](const std::string &res) {
+			REQUIRE(res.substr(0, 11) == "LSL/110 400");
+		}));
+
+	send_request(ctx, ep, asio::buffer("LSL:streamfeed/110 \nProtocol-Version: 100\r\n\r\n"),
+		with_read_callback("record downgraded", [](const std::string &res) {
+			REQUIRE(res.substr(0, 11) == "LSL/110 400");
+		}));
+
+	tcp_server.run();
+	ctx.run();
+}
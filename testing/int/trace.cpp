@@ -0,0 +1,38 @@
+#include "../src/trace.h"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+// clazy:excludeall=non-pod-global-static
+
+TEST_CASE("dump traces while recording", "[trace][basic]") {
+	lsl::trace::clear();
+	std::atomic<bool> started{false}, stop{false};
+	// each event's sample count matches its timestamp, so torn copies would show up in the dump
+	std::thread writer([&started, &stop]() {
+		for (uint32_t i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+			lsl::trace::record("race", lsl::trace::now(), i, i);
+			started.store(true, std::memory_order_release);
+		}
+	});
+	while (!started.load(std::memory_order_acquire)) std::this_thread::yield();
+	const std::string name = "{\"name\":\"race\"", key = "\"timestamp\":";
+	std::size_t checked = 0, torn = 0;
+	for (int dump = 0; dump < 50; ++dump) {
+		const std::string json = lsl::trace::to_chrome_json();
+		for (auto pos = json.find(name); pos != std::string::npos; pos = json.find(name, pos + 1)) {
+			const auto ts = json.find(key, pos) + key.size();
+			const auto samples = json.find("\"samples\":", ts) + 10;
+			const char *data = json.c_str();
+			if (std::strtod(data + ts, nullptr) != std::strtod(data + samples, nullptr)) ++torn;
+			++checked;
+		}
+	}
+	stop = true;
+	writer.join();
+	lsl::trace::clear();
+	CHECK(checked > 0);
+	CHECK(torn == 0);
+}